@@ -20,7 +20,11 @@
 #include "kis_benchmark_values.h"
 
 #include <QTest>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QBuffer>
 #include <kis_datamanager.h>
+#include <kis_paint_device_writer.h>
 
 // RGBA
 #define PIXEL_SIZE 4
@@ -198,5 +202,177 @@ void KisDatamanagerBenchmark::benchmarkMemCpy()
     delete[] dst;
 }
 
+/**
+ * Every job looks up all the tiles of the image in its own order,
+ * so that different threads hit different buckets of the hash table
+ * at the same time. Half of the requests are read-only.
+ */
+class TileLookupJob : public QRunnable
+{
+public:
+    TileLookupJob(KisDataManager *dm, int numCols, int numRows, int numCycles, int seed)
+        : m_dm(dm),
+          m_numCols(numCols),
+          m_numRows(numRows),
+          m_numCycles(numCycles),
+          m_seed(seed)
+    {
+    }
+
+    void run() override {
+        const int numTiles = m_numCols * m_numRows;
+
+        for (int cycle = 0; cycle < m_numCycles; cycle++) {
+            for (int i = 0; i < numTiles; i++) {
+                const int index = (i + m_seed * 97) % numTiles;
+                const int col = index % m_numCols;
+                const int row = index / m_numCols;
+
+                KisTileSP tile = m_dm->getTile(col, row, i & 0x1);
+                Q_UNUSED(tile);
+            }
+        }
+    }
+
+private:
+    KisDataManager *m_dm;
+    int m_numCols;
+    int m_numRows;
+    int m_numCycles;
+    int m_seed;
+};
+
+void KisDatamanagerBenchmark::benchmarkTileLookupThreads_data()
+{
+    QTest::addColumn<int>("numThreads");
+
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("8 threads") << 8;
+    QTest::newRow("16 threads") << 16;
+    QTest::newRow("32 threads") << 32;
+}
+
+void KisDatamanagerBenchmark::benchmarkTileLookupThreads()
+{
+    QFETCH(int, numThreads);
+
+    quint8 *p = new quint8[PIXEL_SIZE];
+    memset(p, 0, PIXEL_SIZE);
+    KisDataManager dm(PIXEL_SIZE, p);
+
+    // 16k x 16k image, i.e. 65536 tiles
+    const int numCols = 256;
+    const int numRows = 256;
+
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numCols; col++) {
+            KisTileSP tile = dm.getTile(col, row, true);
+            Q_UNUSED(tile);
+        }
+    }
+
+    /**
+     * The total number of lookups is the same for any number of
+     * threads, so the time reported is inversely proportional to
+     * the lookup throughput
+     */
+    const int totalCycles = 32;
+    const int cyclesPerThread = totalCycles / numThreads;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+
+    QBENCHMARK {
+        for (int i = 0; i < numThreads; i++) {
+            pool.start(new TileLookupJob(&dm, numCols, numRows, cyclesPerThread, i));
+        }
+        pool.waitForDone();
+    }
+
+    delete[] p;
+}
+
+class BufferPaintDeviceWriter : public KisPaintDeviceWriter
+{
+public:
+    BufferPaintDeviceWriter(QBuffer *buffer)
+        : m_buffer(buffer)
+    {
+    }
+
+    bool write(const QByteArray &data) override {
+        return m_buffer->write(data) == data.size();
+    }
+
+    bool write(const char* data, qint64 length) override {
+        return m_buffer->write(data, length) == length;
+    }
+
+private:
+    QBuffer *m_buffer;
+};
+
+/**
+ * Fills the data manager with a gradient with some noise added,
+ * which compresses roughly as well as a usual painting does
+ */
+void fillForSaving(KisDataManager &dm)
+{
+    const int numBytes = PIXEL_SIZE * TEST_IMAGE_WIDTH * TEST_IMAGE_HEIGHT;
+    quint8 *bytes = new quint8[numBytes];
+
+    for (int i = 0; i < numBytes; i++) {
+        bytes[i] = ((i / PIXEL_SIZE) % TEST_IMAGE_WIDTH) / 16 + ((quint32(i) * 2654435761U) >> 30);
+    }
+
+    dm.writeBytes(bytes, 0, 0, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT);
+    delete[] bytes;
+}
+
+void KisDatamanagerBenchmark::benchmarkWrite()
+{
+    quint8 *p = new quint8[PIXEL_SIZE];
+    memset(p, 0, PIXEL_SIZE);
+    KisDataManager dm(PIXEL_SIZE, p);
+
+    fillForSaving(dm);
+
+    QBENCHMARK {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+
+        BufferPaintDeviceWriter writer(&buffer);
+        dm.write(writer);
+    }
+
+    delete[] p;
+}
+
+void KisDatamanagerBenchmark::benchmarkRead()
+{
+    quint8 *p = new quint8[PIXEL_SIZE];
+    memset(p, 0, PIXEL_SIZE);
+    KisDataManager dm(PIXEL_SIZE, p);
+
+    fillForSaving(dm);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+
+    BufferPaintDeviceWriter writer(&buffer);
+    dm.write(writer);
+
+    KisDataManager dstDM(PIXEL_SIZE, p);
+
+    QBENCHMARK {
+        buffer.seek(0);
+        dstDM.read(&buffer);
+    }
+
+    delete[] p;
+}
+
 
 QTEST_MAIN(KisDatamanagerBenchmark)
@@ -36,6 +36,10 @@ private Q_SLOTS:
     void benchmarkExtent();
     void benchmarkClear();
     void benchmarkMemCpy();
+    void benchmarkTileLookupThreads_data();
+    void benchmarkTileLookupThreads();
+    void benchmarkWrite();
+    void benchmarkRead();
 };
 
 #endif
@@ -19,6 +19,7 @@
 #include "kis_low_memory_benchmark.h"
 
 #include <QTest>
+#include <QElapsedTimer>
 
 #include "kis_benchmark_values.h"
 
@@ -37,6 +38,7 @@
 #include <brushengine/kis_paintop_preset.h>
 
 #include "tiles3/kis_tile_data_store.h"
+#include "tiles3/swap/kis_compression_factory.h"
 #include "kis_surrogate_undo_adapter.h"
 #include "kis_image_config.h"
 #define LOAD_PRESET_OR_RETURN(preset, fileName)                         \
@@ -228,4 +230,80 @@ void KisLowMemoryBenchmark::memory2000History100Pool500HugeBrush()
                       2000, 600, 500, 0);
 }
 
+void KisLowMemoryBenchmark::benchmarkSwapThroughput_data()
+{
+    QTest::addColumn<QString>("algorithm");
+    QTest::addColumn<int>("numThreads");
+
+    Q_FOREACH (const QString &algorithm, KisCompressionFactory::availableCompressions()) {
+        QTest::newRow(QString("%1, 1 thread").arg(algorithm).toLatin1()) << algorithm << 1;
+        QTest::newRow(QString("%1, %2 threads").arg(algorithm).arg(QThread::idealThreadCount()).toLatin1())
+            << algorithm << QThread::idealThreadCount();
+    }
+}
+
+/**
+ * Measures the speed of swapping out all the tiles of a huge device
+ * and reading them back. The reported values are in MiB per second
+ * of *uncompressed* data.
+ */
+void KisLowMemoryBenchmark::benchmarkSwapThroughput()
+{
+    QFETCH(QString, algorithm);
+    QFETCH(int, numThreads);
+
+    KisImageConfig config;
+    const QString oldAlgorithm = config.swapCompressionAlgorithm();
+    const int oldNumThreads = config.swapCompressionThreads();
+
+    config.setSwapCompressionAlgorithm(algorithm);
+    config.setSwapCompressionThreads(numThreads);
+    KisTileDataStore::instance()->testingRereadConfig();
+
+    const KoColorSpace *colorSpace = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(colorSpace);
+
+    /**
+     * Fill the device with some data that is neither trivially
+     * compressible nor pure noise
+     */
+    const QRect rc(0, 0, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT);
+    const int pixelSize = colorSpace->pixelSize();
+    QByteArray buffer(rc.width() * rc.height() * pixelSize, 0);
+    quint8 *ptr = reinterpret_cast<quint8*>(buffer.data());
+
+    for (int y = 0; y < rc.height(); y++) {
+        for (int x = 0; x < rc.width(); x++) {
+            ptr[0] = x & 0xFF;
+            ptr[1] = y & 0xFF;
+            ptr[2] = (x * y) >> 8;
+            ptr[3] = 255;
+            ptr += pixelSize;
+        }
+    }
+
+    dev->writeBytes(reinterpret_cast<quint8*>(buffer.data()), rc);
+
+    const qreal dataSizeMiB = qreal(buffer.size()) / (1 << 20);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    KisTileDataStore::instance()->debugSwapAll();
+
+    const qint64 swapOutTime = timer.restart();
+
+    dev->readBytes(reinterpret_cast<quint8*>(buffer.data()), rc);
+
+    const qint64 swapInTime = timer.elapsed();
+
+    dbgKrita << "Swap throughput:" << algorithm << ppVar(numThreads);
+    dbgKrita << "    swap-out:" << dataSizeMiB * 1000.0 / qMax(swapOutTime, qint64(1)) << "MiB/s";
+    dbgKrita << "    swap-in: " << dataSizeMiB * 1000.0 / qMax(swapInTime, qint64(1)) << "MiB/s";
+
+    config.setSwapCompressionAlgorithm(oldAlgorithm);
+    config.setSwapCompressionThreads(oldNumThreads);
+    KisTileDataStore::instance()->testingRereadConfig();
+}
+
 QTEST_MAIN(KisLowMemoryBenchmark)
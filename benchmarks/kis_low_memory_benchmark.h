@@ -31,6 +31,9 @@ private Q_SLOTS:
 
     void memory2000History100Pool500HugeBrush();
 
+    void benchmarkSwapThroughput_data();
+    void benchmarkSwapThroughput();
+
 private:
     void benchmarkWideArea(const QString presetFileName,
                            const QRectF &rect, qreal vstep,
@@ -32,6 +32,7 @@ private Q_SLOTS:
 
     void benchmarkProjection();
     void benchmarkLoading();
+    void benchmarkSaving();
 };
 
 #endif
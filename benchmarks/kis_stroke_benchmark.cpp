@@ -43,6 +43,11 @@ inline double drand48()
 
 #include <brushengine/kis_paint_information.h>
 #include <brushengine/kis_paintop_preset.h>
+#include <brushengine/kis_paintop_settings.h>
+
+#include <kis_brush_server.h>
+#include <kis_gbr_brush.h>
+#include <QDomDocument>
 
 #define GMP_IMAGE_WIDTH 3274
 #define GMP_IMAGE_HEIGHT 2067
@@ -327,6 +332,21 @@ void KisStrokeBenchmark::colorsmudgeRL()
     benchmarkStroke(presetFileName);
 }
 
+void KisStrokeBenchmark::colorsmudgeLargeSmearing()
+{
+    benchmarkColorSmudge(0, false);
+}
+
+void KisStrokeBenchmark::colorsmudgeLargeDulling()
+{
+    benchmarkColorSmudge(1, false);
+}
+
+void KisStrokeBenchmark::colorsmudgeLargeOverlay()
+{
+    benchmarkColorSmudge(0, true);
+}
+
 /*
 void KisStrokeBenchmark::predefinedBrush()
 {
@@ -363,6 +383,11 @@ inline void KisStrokeBenchmark::benchmarkLine(QString presetFileName)
 {
     KisPaintOpPresetSP preset = new KisPaintOpPreset(m_dataPath + presetFileName);
     preset->load();
+    benchmarkLine(preset, presetFileName);
+}
+
+inline void KisStrokeBenchmark::benchmarkLine(KisPaintOpPresetSP preset, const QString &outputName)
+{
     m_painter->setPaintOpPreset(preset, m_layer, m_image);
 
     QPointF startPoint(0.10 * TEST_IMAGE_WIDTH, 0.5 * TEST_IMAGE_HEIGHT);
@@ -377,11 +402,81 @@ inline void KisStrokeBenchmark::benchmarkLine(QString presetFileName)
     }
 
 #ifdef SAVE_OUTPUT
-    m_layer->paintDevice()->convertToQImage(0).save(m_outputPath + presetFileName + "_line" + OUTPUT_FORMAT);
+    m_layer->paintDevice()->convertToQImage(0).save(m_outputPath + outputName + "_line" + OUTPUT_FORMAT);
+#else
+    Q_UNUSED(outputName);
 #endif
 
 }
 
+/**
+ * Paints a line with a scaled and rotated 512px gbr tip, so every
+ * dab is resampled from the tip pyramid by KisQImagePyramid::createMask()
+ */
+void KisStrokeBenchmark::predefinedBrushMask()
+{
+    const QString brushFileName = "testing_brush_512_bars.gbr";
+
+    // the tip is shared with the brush tests
+    KisBrushSP brush = new KisGbrBrush(QString(BRUSH_FILES_DATA_DIR) + QDir::separator() + brushFileName);
+    QVERIFY(brush->load());
+    brush->setSpacing(0.05);
+    brush->setScale(0.6);
+    brush->setAngle(0.3);
+
+    // the predefined brushes are looked up in the resource server
+    KisBrushServer::instance()->brushServer()->addResource(brush, false);
+
+    KisPaintOpPresetSP preset = new KisPaintOpPreset(m_dataPath + "autobrush_300px.kpp");
+    QVERIFY(preset->load());
+
+    QDomDocument d;
+    QDomElement e = d.createElement("Brush");
+    brush->toXML(d, e);
+    d.appendChild(e);
+    preset->settings()->setProperty("brush_definition", d.toString());
+    preset->settings()->setProperty("requiredBrushFile", brush->shortFilename());
+
+    benchmarkLine(preset, brushFileName);
+}
+
+/**
+ * Paints a straight line with a 300px color smudge brush. The spacing
+ * of the preset is fixed, so the time of the line is inversely
+ * proportional to the dab rate of the paintop.
+ */
+inline void KisStrokeBenchmark::benchmarkColorSmudge(int smudgeMode, bool overlayMode)
+{
+    QString presetFileName = "colorsmudge.kpp";
+
+    KisPaintOpPresetSP preset = new KisPaintOpPreset(m_dataPath + presetFileName);
+    if (!preset->load()) {
+        dbgKrita << "The preset was not loaded correctly. Done.";
+        return;
+    }
+
+    preset->settings()->setPaintOpSize(300);
+    preset->settings()->setProperty("SmudgeRateMode", smudgeMode);
+    preset->settings()->setProperty("MergedPaint", overlayMode);
+
+    m_painter->setPaintOpPreset(preset, m_layer, m_image);
+
+    QPointF startPoint(0.10 * TEST_IMAGE_WIDTH, 0.5 * TEST_IMAGE_HEIGHT);
+    QPointF endPoint(0.90 * TEST_IMAGE_WIDTH, 0.5 * TEST_IMAGE_HEIGHT);
+
+    KisPaintInformation pi1(startPoint, 0.0);
+    KisPaintInformation pi2(endPoint, 1.0);
+
+    QBENCHMARK{
+        KisDistanceInformation currentDistance;
+        m_painter->paintLine(pi1, pi2, &currentDistance);
+    }
+
+#ifdef SAVE_OUTPUT
+    m_layer->paintDevice()->convertToQImage(0).save(m_outputPath + presetFileName + "_large_smudge" + OUTPUT_FORMAT);
+#endif
+}
+
 void KisStrokeBenchmark::benchmarkCircle(QString presetFileName)
 {
     dbgKrita << "(circle)preset : " << presetFileName;
@@ -21,6 +21,7 @@
 
 #include <QtTest>
 #include <kis_types.h>
+#include <brushengine/kis_paintop_preset.h>
 #include <KoColor.h>
 #include <kis_painter.h>
 #include <brushengine/kis_paint_information.h>
@@ -61,7 +62,9 @@ private:
         inline void benchmarkRandomLines(QString presetFileName);
         inline void benchmarkStroke(QString presetFileName);
         inline void benchmarkLine(QString presetFileName);
+        inline void benchmarkLine(KisPaintOpPresetSP preset, const QString &outputName);
         inline void benchmarkCircle(QString presetFileName);
+        inline void benchmarkColorSmudge(int smudgeMode, bool overlayMode);
 
 private Q_SLOTS:
     void initTestCase();
@@ -120,6 +123,14 @@ private Q_SLOTS:
 
     void colorsmudge();
     void colorsmudgeRL();
+
+    // Large color smudge brushes
+    void colorsmudgeLargeSmearing();
+    void colorsmudgeLargeDulling();
+    void colorsmudgeLargeOverlay();
+
+    // Predefined brush tip, generated from the tip pyramid masks
+    void predefinedBrushMask();
 /*
     void predefinedBrush();
     void predefinedBrushRL();
@@ -0,0 +1,166 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_updater_context_benchmark.h"
+
+#include <QTest>
+#include <QThread>
+#include <QThreadPool>
+
+#include "kis_updater_context.h"
+#include "kis_spontaneous_job.h"
+#include "kis_work_stealing_thread_pool.h"
+
+/**
+ * The jobs do (almost) nothing, so the benchmarks measure the cost
+ * of passing a job to a thread and getting it back
+ */
+const int NUM_JOBS = 100000;
+
+
+class EmptyRunnable : public QRunnable
+{
+public:
+    EmptyRunnable(QAtomicInt &counter)
+        : m_counter(counter)
+    {
+        setAutoDelete(false);
+    }
+
+    void run() override {
+        m_counter.ref();
+    }
+
+private:
+    QAtomicInt &m_counter;
+};
+
+class EmptySpontaneousJob : public KisSpontaneousJob
+{
+public:
+    EmptySpontaneousJob(QAtomicInt &counter)
+        : m_counter(counter)
+    {
+    }
+
+    bool overrides(const KisSpontaneousJob *otherJob) override {
+        Q_UNUSED(otherJob);
+        return false;
+    }
+
+    int levelOfDetail() const override {
+        return 0;
+    }
+
+    void run() override {
+        m_counter.ref();
+    }
+
+private:
+    QAtomicInt &m_counter;
+};
+
+void KisUpdaterContextBenchmark::benchmarkPoolDispatch_data()
+{
+    QTest::addColumn<int>("numThreads");
+    QTest::addColumn<bool>("useWorkStealing");
+
+    for (int numThreads = 1; numThreads <= 32; numThreads *= 2) {
+        QTest::newRow(QString("QThreadPool, %1 threads").arg(numThreads).toLatin1())
+            << numThreads << false;
+        QTest::newRow(QString("work-stealing, %1 threads").arg(numThreads).toLatin1())
+            << numThreads << true;
+    }
+}
+
+void KisUpdaterContextBenchmark::benchmarkPoolDispatch()
+{
+    QFETCH(int, numThreads);
+    QFETCH(bool, useWorkStealing);
+
+    QAtomicInt counter;
+    EmptyRunnable job(counter);
+
+    if (useWorkStealing) {
+        KisWorkStealingThreadPool pool(numThreads);
+
+        QBENCHMARK {
+            for (int i = 0; i < NUM_JOBS; i++) {
+                pool.start(&job);
+            }
+            pool.waitForDone();
+        }
+
+        qDebug() << "Stolen jobs:" << pool.numStolenJobs();
+    } else {
+        QThreadPool pool;
+        pool.setMaxThreadCount(numThreads);
+
+        QBENCHMARK {
+            for (int i = 0; i < NUM_JOBS; i++) {
+                pool.start(&job);
+            }
+            pool.waitForDone();
+        }
+    }
+
+    QVERIFY(counter.load() >= NUM_JOBS);
+}
+
+void KisUpdaterContextBenchmark::benchmarkContextDispatch_data()
+{
+    QTest::addColumn<int>("numThreads");
+
+    for (int numThreads = 1; numThreads <= 32; numThreads *= 2) {
+        QTest::newRow(QString("%1 threads").arg(numThreads).toLatin1()) << numThreads;
+    }
+}
+
+void KisUpdaterContextBenchmark::benchmarkContextDispatch()
+{
+    QFETCH(int, numThreads);
+
+    QAtomicInt counter;
+    KisUpdaterContext context(numThreads);
+
+    /**
+     * Mimic the way KisUpdateScheduler feeds the context: the
+     * producer takes the lock, checks for a spare thread and adds
+     * the job
+     */
+    QBENCHMARK {
+        int numAdded = 0;
+
+        while (numAdded < NUM_JOBS) {
+            context.lock();
+            while (numAdded < NUM_JOBS && context.hasSpareThread()) {
+                context.addSpontaneousJob(new EmptySpontaneousJob(counter));
+                numAdded++;
+            }
+            context.unlock();
+
+            QThread::yieldCurrentThread();
+        }
+
+        context.waitForDone();
+    }
+
+    QVERIFY(counter.load() >= NUM_JOBS);
+}
+
+QTEST_MAIN(KisUpdaterContextBenchmark)
@@ -0,0 +1,40 @@
+# - Find LZ4
+# Find the LZ4 compression library
+# This module defines
+#  LZ4_INCLUDE_DIR, where to find lz4.h
+#  LZ4_LIBRARIES, the libraries needed to use LZ4.
+#  LZ4_FOUND, If false, do not try to use LZ4.
+
+#
+# Redistribution and use is allowed according to the terms of the BSD license.
+# For details see the accompanying COPYING-CMAKE-SCRIPTS file.
+
+if(LZ4_PATH)
+    message(STATUS "LZ4 path explicitly specified: ${LZ4_PATH}")
+endif()
+
+find_path(LZ4_INCLUDE_DIR lz4.h
+        ${LZ4_PATH}/include/
+        /usr/include
+        /usr/local/include
+        /sw/include
+        /opt/local/include
+        DOC "The directory where lz4.h resides"
+)
+
+find_library(LZ4_LIBRARIES lz4
+        PATHS
+        ${LZ4_PATH}/lib/
+        /usr/lib64
+        /usr/lib
+        /usr/local/lib64
+        /usr/local/lib
+        /sw/lib
+        /opt/local/lib
+        DOC "The LZ4 library"
+)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(LZ4 DEFAULT_MSG LZ4_LIBRARIES LZ4_INCLUDE_DIR)
+
+mark_as_advanced(LZ4_INCLUDE_DIR LZ4_LIBRARIES)
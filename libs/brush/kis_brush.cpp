@@ -33,7 +33,6 @@
 #include <klocalizedstring.h>
 
 #include <KoColor.h>
-#include <KoColorSpaceMaths.h>
 #include <KoColorSpaceRegistry.h>
 
 #include "kis_datamanager.h"
@@ -46,6 +45,7 @@
 #include <brushengine/kis_paint_information.h>
 #include <kis_fixed_paint_device.h>
 #include <kis_qimage_pyramid.h>
+#include "kis_brush_tip_cache.h"
 #include <brushengine/kis_paintop_lod_limitations.h>
 
 
@@ -437,8 +437,17 @@ void KisBrush::notifyCachedDabPainted(const KisPaintInformation& info)
 
 void KisBrush::prepareBrushPyramid() const
 {
-    if (!d->brushPyramid) {
-        d->brushPyramid = toQShared(new KisQImagePyramid(brushTipImage()));
+    const KisQImagePyramid::MaskMode maskMode =
+        hasColor() ? KisQImagePyramid::ColorMask : KisQImagePyramid::GrayscaleMask;
+
+    /**
+     * The pyramids are shared between all the clones of the brush
+     * (and all the brushes using the same tip image), so a paintop
+     * never rebuilds a pyramid that has already been built by some
+     * other one
+     */
+    if (!d->brushPyramid || d->brushPyramid->maskMode() != maskMode) {
+        d->brushPyramid = KisBrushTipCache::instance()->pyramid(brushTipImage(), maskMode);
     }
 }
 
@@ -476,13 +485,13 @@ void KisBrush::generateMaskAndApplyMaskOrCreateDab(KisFixedPaintDeviceSP dst,
     Q_UNUSED(softnessFactor);
 
     prepareBrushPyramid();
-    QImage outputImage = d->brushPyramid->createImage(KisDabShape(
+    KisFixedPaintDeviceSP outputMask = d->brushPyramid->createMask(KisDabShape(
             shape.scale() * d->scale, shape.ratio(),
             -normalizeAngle(shape.rotation() + d->angle)),
         subPixelX, subPixelY);
 
-    qint32 maskWidth = outputImage.width();
-    qint32 maskHeight = outputImage.height();
+    qint32 maskWidth = outputMask->bounds().width();
+    qint32 maskHeight = outputMask->bounds().height();
 
     dst->setRect(QRect(0, 0, maskWidth, maskHeight));
     dst->initialize();
@@ -499,11 +508,9 @@ void KisBrush::generateMaskAndApplyMaskOrCreateDab(KisFixedPaintDeviceSP dst,
     qint32 pixelSize = cs->pixelSize();
     quint8 *dabPointer = dst->data();
     quint8 *rowPointer = dabPointer;
-    quint8 *alphaArray = new quint8[maskWidth];
-    bool hasColor = this->hasColor();
+    const quint8 *maskPointer = outputMask->data();
 
     for (int y = 0; y < maskHeight; y++) {
-        const quint8* maskPointer = outputImage.constScanLine(y);
         if (coloringInformation) {
             for (int x = 0; x < maskWidth; x++) {
                 if (color) {
@@ -517,30 +524,8 @@ void KisBrush::generateMaskAndApplyMaskOrCreateDab(KisFixedPaintDeviceSP dst,
             }
         }
 
-        if (hasColor) {
-            const quint8 *src = maskPointer;
-            quint8 *dst = alphaArray;
-            for (int x = 0; x < maskWidth; x++) {
-                const QRgb *c = reinterpret_cast<const QRgb*>(src);
-
-                *dst = KoColorSpaceMaths<quint8>::multiply(255 - qGray(*c), qAlpha(*c));
-                src += 4;
-                dst++;
-            }
-        }
-        else {
-            const quint8 *src = maskPointer;
-            quint8 *dst = alphaArray;
-            for (int x = 0; x < maskWidth; x++) {
-                const QRgb *c = reinterpret_cast<const QRgb*>(src);
-
-                *dst = KoColorSpaceMaths<quint8>::multiply(255 - *src, qAlpha(*c));
-                src += 4;
-                dst++;
-            }
-        }
-
-        cs->applyAlphaU8Mask(rowPointer, alphaArray, maskWidth);
+        cs->applyAlphaU8Mask(rowPointer, maskPointer, maskWidth);
+        maskPointer += maskWidth;
         rowPointer += maskWidth * pixelSize;
         dabPointer = rowPointer;
 
@@ -548,8 +533,6 @@ void KisBrush::generateMaskAndApplyMaskOrCreateDab(KisFixedPaintDeviceSP dst,
             coloringInformation->nextRow();
         }
     }
-
-    delete[] alphaArray;
 }
 
 KisFixedPaintDeviceSP KisBrush::paintDevice(const KoColorSpace * colorSpace,
@@ -0,0 +1,137 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_brush_tip_cache.h"
+
+#include <QCache>
+#include <QGlobalStatic>
+#include <QImage>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+
+
+/**
+ * The pyramids of the big tips take megabytes, so the memory is
+ * accounted in kibibytes to fit the int cost of QCache
+ */
+static const qint64 costUnit = 1024;
+static const qint64 defaultMemoryLimit = 128 * 1024 * 1024;
+
+Q_GLOBAL_STATIC_WITH_ARGS(KisBrushTipCache, s_instance, (defaultMemoryLimit))
+
+
+struct KisBrushTipCache::Private
+{
+    typedef QPair<qint64, int> Key;
+
+    struct Entry {
+        Entry(QSharedPointer<const KisQImagePyramid> _pyramid) : pyramid(_pyramid) {}
+        QSharedPointer<const KisQImagePyramid> pyramid;
+    };
+
+    Private(qint64 _memoryLimit)
+        : pyramids(int(_memoryLimit / costUnit)),
+          memoryLimit(_memoryLimit)
+    {
+    }
+
+    mutable QMutex mutex;
+    QCache<Key, Entry> pyramids;
+    qint64 memoryLimit;
+};
+
+
+KisBrushTipCache::KisBrushTipCache(qint64 memoryLimit)
+    : m_d(new Private(memoryLimit))
+{
+}
+
+KisBrushTipCache::~KisBrushTipCache()
+{
+}
+
+KisBrushTipCache* KisBrushTipCache::instance()
+{
+    return s_instance;
+}
+
+QSharedPointer<const KisQImagePyramid>
+KisBrushTipCache::pyramid(const QImage &image, KisQImagePyramid::MaskMode maskMode)
+{
+    const Private::Key key(image.cacheKey(), int(maskMode));
+
+    {
+        QMutexLocker l(&m_d->mutex);
+
+        Private::Entry *entry = m_d->pyramids.object(key);
+        if (entry) {
+            return entry->pyramid;
+        }
+    }
+
+    /**
+     * Build the pyramid without holding the lock, so the other
+     * brushes are not blocked. If two threads build the same
+     * pyramid concurrently, the one inserted first wins.
+     */
+    QSharedPointer<const KisQImagePyramid> pyramid =
+        QSharedPointer<const KisQImagePyramid>(new KisQImagePyramid(image, maskMode));
+
+    const int cost = qMax(1, int((pyramid->memoryUsage() + costUnit - 1) / costUnit));
+
+    QMutexLocker l(&m_d->mutex);
+
+    Private::Entry *entry = m_d->pyramids.object(key);
+    if (entry) {
+        return entry->pyramid;
+    }
+
+    /**
+     * If the pyramid is bigger than the whole cache, QCache just
+     * drops it, the caller still owns its own reference though
+     */
+    m_d->pyramids.insert(key, new Private::Entry(pyramid), cost);
+
+    return pyramid;
+}
+
+void KisBrushTipCache::setMemoryLimit(qint64 bytes)
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->memoryLimit = bytes;
+    m_d->pyramids.setMaxCost(int(bytes / costUnit));
+}
+
+qint64 KisBrushTipCache::memoryLimit() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->memoryLimit;
+}
+
+qint64 KisBrushTipCache::memoryUsage() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return qint64(m_d->pyramids.totalCost()) * costUnit;
+}
+
+void KisBrushTipCache::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->pyramids.clear();
+}
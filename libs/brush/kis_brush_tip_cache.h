@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_BRUSH_TIP_CACHE_H
+#define __KIS_BRUSH_TIP_CACHE_H
+
+#include <QScopedPointer>
+#include <QSharedPointer>
+
+#include "kritabrush_export.h"
+#include "kis_qimage_pyramid.h"
+
+class QImage;
+
+
+/**
+ * A bounded LRU cache of the mip-mapped pyramids of the predefined
+ * brush tips.
+ *
+ * Building a pyramid means smooth-scaling the tip into all the levels
+ * and converting them into masks, which is quite expensive for big
+ * tips. Without the cache every clone of a brush (and every paintop
+ * owns its own clone) builds the same pyramid again. Here the
+ * pyramids are keyed by QImage::cacheKey() of the tip and the mask
+ * mode, so all the brushes sharing the tip image share the pyramid
+ * as well.
+ *
+ * The cache is shared by all the paintops, all the methods are
+ * thread-safe. The pyramids are immutable, so they can be used from
+ * any number of threads at once.
+ */
+class BRUSH_EXPORT KisBrushTipCache
+{
+public:
+    KisBrushTipCache(qint64 memoryLimit);
+    ~KisBrushTipCache();
+
+    static KisBrushTipCache* instance();
+
+    /**
+     * Returns the pyramid of \p image, building it if it is not
+     * present in the cache yet. The pyramid becomes the most
+     * recently used one.
+     */
+    QSharedPointer<const KisQImagePyramid> pyramid(const QImage &image,
+                                                   KisQImagePyramid::MaskMode maskMode);
+
+    void setMemoryLimit(qint64 bytes);
+    qint64 memoryLimit() const;
+
+    /**
+     * The size of the cached pyramids (in bytes)
+     */
+    qint64 memoryUsage() const;
+
+    void clear();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_BRUSH_TIP_CACHE_H */
@@ -19,16 +19,23 @@
 #include "kis_qimage_pyramid.h"
 
 #include <limits>
+#include <cmath>
 #include <QPainter>
 #include <kis_debug.h>
 
+#include <KoColorSpaceMaths.h>
+#include <KoColorSpaceRegistry.h>
+#include <kis_fixed_paint_device.h>
+
 #define MIPMAP_SIZE_THRESHOLD 512
 #define MAX_MIPMAP_SCALE 8.0
 
 #define QPAINTER_WORKAROUND_BORDER 1
 
 
-KisQImagePyramid::KisQImagePyramid(const QImage &baseImage)
+KisQImagePyramid::KisQImagePyramid(const QImage &baseImage, MaskMode maskMode)
+    : m_baseScale(1.0),
+      m_maskMode(maskMode)
 {
     KIS_SAFE_ASSERT_RECOVER_RETURN(!baseImage.isNull());
 
@@ -253,14 +260,92 @@ void KisQImagePyramid::appendPyramidLevel(const QImage &image)
      *
      * See a unittest in: KisGbrBrushTest::testQPainterTransformationBorder
      */
-    
-QSize levelSize = image.size();
+
+    QSize levelSize = image.size();
     QImage tmp = image.convertToFormat(QImage::Format_ARGB32);
     tmp = tmp.copy(-QPAINTER_WORKAROUND_BORDER,
                    -QPAINTER_WORKAROUND_BORDER,
                    image.width() + 2 * QPAINTER_WORKAROUND_BORDER,
                    image.height() + 2 * QPAINTER_WORKAROUND_BORDER);
-    m_levels.append(PyramidLevel(tmp, levelSize));
+
+    KisFixedPaintDeviceSP mask;
+
+    if (m_maskMode != NoMask) {
+        /**
+         * The mask keeps the same transparent border as the image, so
+         * the bilinear sampling in createMask() fades out smoothly on
+         * the edges of the tip exactly like QPainter does
+         */
+        mask = new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+        mask->setRect(QRect(QPoint(), tmp.size()));
+        mask->lazyGrowBufferWithoutInitialization();
+
+        quint8 *dstPtr = mask->data();
+
+        for (int y = 0; y < tmp.height(); y++) {
+            const QRgb *srcPtr = reinterpret_cast<const QRgb*>(tmp.constScanLine(y));
+
+            if (m_maskMode == ColorMask) {
+                for (int x = 0; x < tmp.width(); x++) {
+                    *dstPtr++ = KoColorSpaceMaths<quint8>::multiply(255 - qGray(*srcPtr), qAlpha(*srcPtr));
+                    srcPtr++;
+                }
+            } else {
+                for (int x = 0; x < tmp.width(); x++) {
+                    *dstPtr++ = KoColorSpaceMaths<quint8>::multiply(255 - qBlue(*srcPtr), qAlpha(*srcPtr));
+                    srcPtr++;
+                }
+            }
+        }
+    }
+
+    /**
+     * The grayscale tips are painted through their masks only, so
+     * their pyramids don't keep the ARGB32 levels at all, see
+     * levelImage()
+     */
+    m_levels.append(PyramidLevel(m_maskMode == GrayscaleMask ? QImage() : tmp, levelSize, mask));
+}
+
+QImage KisQImagePyramid::levelImage(int level) const
+{
+    const PyramidLevel &pyramidLevel = m_levels[level];
+
+    if (!pyramidLevel.image.isNull()) {
+        return pyramidLevel.image;
+    }
+
+    /**
+     * Rebuild the level from the mask as an opaque gray image with a
+     * transparent border. It is exactly the original level for the
+     * opaque grayscale tips. For the translucent ones the alpha gets
+     * merged into the gray value, which still gives the same mask.
+     */
+    const KisFixedPaintDevice *mask = pyramidLevel.mask.data();
+    const QRect bounds = mask->bounds();
+
+    QImage image(bounds.size(), QImage::Format_ARGB32);
+    image.fill(0);
+
+    const quint8 *srcPtr = mask->data();
+
+    for (int y = 0; y < bounds.height(); y++) {
+        QRgb *dstPtr = reinterpret_cast<QRgb*>(image.scanLine(y));
+
+        for (int x = 0; x < bounds.width(); x++) {
+            if (x >= QPAINTER_WORKAROUND_BORDER && x < bounds.width() - QPAINTER_WORKAROUND_BORDER &&
+                y >= QPAINTER_WORKAROUND_BORDER && y < bounds.height() - QPAINTER_WORKAROUND_BORDER) {
+
+                const int value = 255 - *srcPtr;
+                *dstPtr = qRgb(value, value, value);
+            }
+
+            srcPtr++;
+            dstPtr++;
+        }
+    }
+
+    return image;
 }
 
 QImage KisQImagePyramid::createImage(KisDabShape const& shape,
@@ -269,7 +354,7 @@ QImage KisQImagePyramid::createImage(KisDabShape const& shape,
     qreal baseScale = -1.0;
     int level = findNearestLevel(shape.scale(), &baseScale);
 
-    const QImage &srcImage = m_levels[level].image;
+    const QImage srcImage = levelImage(level);
 
     QTransform transform;
     QSize dstSize;
@@ -316,3 +401,231 @@ QImage KisQImagePyramid::createImage(KisDabShape const& shape,
     return dstImage;
 }
 
+
+KisQImagePyramid::MaskMode KisQImagePyramid::maskMode() const
+{
+    return m_maskMode;
+}
+
+/**
+ * createMask() walks the source with 32.32 fixed point coordinates,
+ * which keeps the accumulated error of the per-pixel steps far below
+ * the 8-bit weights precision even for the biggest tips
+ */
+static const int FIXED_SHIFT = 32;
+static const qint64 FIXED_ONE = qint64(1) << FIXED_SHIFT;
+
+inline qint64 toFixed(qreal value)
+{
+    return qRound64(value * FIXED_ONE);
+}
+
+inline int fixedWeight(qint64 value)
+{
+    return int(value >> (FIXED_SHIFT - 8)) & 0xff;
+}
+
+inline quint8 interpolateBilinear(int topLeft, int topRight,
+                                  int bottomLeft, int bottomRight,
+                                  int weightX, int weightY)
+{
+    const int top = (topLeft << 8) + weightX * (topRight - topLeft);
+    const int bottom = (bottomLeft << 8) + weightX * (bottomRight - bottomLeft);
+
+    return quint8(((top << 8) + weightY * (bottom - top) + 0x8000) >> 16);
+}
+
+/**
+ * Samples the level at the fixed point position that may lie
+ * outside of it, the pixels outside are transparent. The position
+ * is shifted by one pixel, so that the shifts below never touch
+ * negative values.
+ */
+inline quint8 sampleChecked(const quint8 *data, int width, int height, qint64 fx, qint64 fy)
+{
+    fx += FIXED_ONE;
+    fy += FIXED_ONE;
+
+    if (fx < 0 || fy < 0) return 0;
+
+    const int x0 = int(fx >> FIXED_SHIFT) - 1;
+    const int y0 = int(fy >> FIXED_SHIFT) - 1;
+
+    if (x0 >= width || y0 >= height) return 0;
+
+    auto sample = [data, width, height] (int x, int y) -> int {
+        return x >= 0 && y >= 0 && x < width && y < height ?
+            data[y * width + x] : 0;
+    };
+
+    return interpolateBilinear(sample(x0, y0), sample(x0 + 1, y0),
+                               sample(x0, y0 + 1), sample(x0 + 1, y0 + 1),
+                               fixedWeight(fx), fixedWeight(fy));
+}
+
+/**
+ * Narrows [*begin, *end) down to the destination pixels whose source
+ * coordinate start + x * step has both its bilinear neighbours in
+ * [0, size). The range is shrunk by a small margin, so the rounding
+ * of the fixed point steps can never push a sample out of it.
+ */
+inline void intersectInteriorSpan(qreal start, qreal step, int size, int *begin, int *end)
+{
+    const qreal margin = 1e-3;
+    const qreal minPos = margin;
+    const qreal maxPos = size - 1 - margin;
+
+    if (qAbs(step) < 1e-9) {
+        if (start < minPos || start > maxPos) {
+            *end = *begin;
+        }
+        return;
+    }
+
+    qreal lo = (minPos - start) / step;
+    qreal hi = (maxPos - start) / step;
+    if (step < 0) {
+        std::swap(lo, hi);
+    }
+
+    lo = qBound(qreal(-1.0), lo, qreal(*end + 1));
+    hi = qBound(qreal(-1.0), hi, qreal(*end + 1));
+
+    const int newBegin = qMax(*begin, int(std::ceil(lo)));
+    const int newEnd = qMin(*end, int(std::floor(hi)) + 1);
+
+    if (newBegin < newEnd) {
+        *begin = newBegin;
+        *end = newEnd;
+    } else {
+        *end = *begin;
+    }
+}
+
+KisFixedPaintDeviceSP KisQImagePyramid::createMask(KisDabShape const& shape,
+                                                   qreal subPixelX, qreal subPixelY) const
+{
+    KIS_SAFE_ASSERT_RECOVER_RETURN_VALUE(m_maskMode != NoMask, KisFixedPaintDeviceSP());
+
+    qreal baseScale = -1.0;
+    int level = findNearestLevel(shape.scale(), &baseScale);
+
+    /**
+     * The pyramid may be shared between threads, so never touch the
+     * non-const accessors of the level masks
+     */
+    const KisFixedPaintDevice *srcMask = m_levels[level].mask.data();
+    const QRect srcBounds = srcMask->bounds();
+    const int srcWidth = srcBounds.width();
+    const int srcHeight = srcBounds.height();
+    const quint8 *srcData = srcMask->data();
+
+    QTransform transform;
+    QSize dstSize;
+
+    calculateParams(shape, subPixelX, subPixelY,
+                    m_originalSize, baseScale, m_levels[level].size,
+                    &transform, &dstSize);
+
+    KisFixedPaintDeviceSP dstMask = new KisFixedPaintDevice(srcMask->colorSpace());
+
+    if (transform.isIdentity()) {
+        const int width = srcWidth - 2 * QPAINTER_WORKAROUND_BORDER;
+        const int height = srcHeight - 2 * QPAINTER_WORKAROUND_BORDER;
+
+        dstMask->setRect(QRect(0, 0, width, height));
+        dstMask->lazyGrowBufferWithoutInitialization();
+
+        const quint8 *srcPtr = srcData + QPAINTER_WORKAROUND_BORDER * srcWidth + QPAINTER_WORKAROUND_BORDER;
+        quint8 *dstPtr = dstMask->data();
+
+        for (int y = 0; y < height; y++) {
+            memcpy(dstPtr, srcPtr, width);
+            srcPtr += srcWidth;
+            dstPtr += width;
+        }
+
+        return dstMask;
+    }
+
+    dstMask->setRect(QRect(QPoint(), dstSize));
+    dstMask->lazyGrowBufferWithoutInitialization();
+
+    /**
+     * createImage() paints the bordered level with the transform
+     * translate(-border) * transform, so the center of a destination
+     * pixel maps into the bordered level as
+     * inverted(transform) + border. Pixel centers lie at half-integer
+     * coordinates, hence the extra shift by 0.5 before sampling.
+     */
+    const QTransform invertedTransform = transform.inverted();
+    const qreal stepX = invertedTransform.m11();
+    const qreal stepY = invertedTransform.m12();
+    const qreal offset = QPAINTER_WORKAROUND_BORDER - 0.5;
+
+    const qint64 fixedStepX = toFixed(stepX);
+    const qint64 fixedStepY = toFixed(stepY);
+
+    const int dstWidth = dstSize.width();
+    quint8 *dstPtr = dstMask->data();
+
+    for (int y = 0; y < dstSize.height(); y++) {
+        const QPointF rowStart = invertedTransform.map(QPointF(0.5, y + 0.5));
+        const qreal srcX = rowStart.x() + offset;
+        const qreal srcY = rowStart.y() + offset;
+
+        /**
+         * All four samples of the pixels in [interiorBegin, interiorEnd)
+         * lie inside the level, so the interior span needs no checks
+         */
+        int interiorBegin = 0;
+        int interiorEnd = dstWidth;
+        intersectInteriorSpan(srcX, stepX, srcWidth, &interiorBegin, &interiorEnd);
+        intersectInteriorSpan(srcY, stepY, srcHeight, &interiorBegin, &interiorEnd);
+
+        qint64 fx = toFixed(srcX);
+        qint64 fy = toFixed(srcY);
+        int x = 0;
+
+        for (; x < interiorBegin; x++) {
+            *dstPtr++ = sampleChecked(srcData, srcWidth, srcHeight, fx, fy);
+            fx += fixedStepX;
+            fy += fixedStepY;
+        }
+
+        for (; x < interiorEnd; x++) {
+            const int x0 = int(fx >> FIXED_SHIFT);
+            const int y0 = int(fy >> FIXED_SHIFT);
+            const quint8 *srcPtr = srcData + y0 * srcWidth + x0;
+
+            *dstPtr++ = interpolateBilinear(srcPtr[0], srcPtr[1],
+                                            srcPtr[srcWidth], srcPtr[srcWidth + 1],
+                                            fixedWeight(fx), fixedWeight(fy));
+            fx += fixedStepX;
+            fy += fixedStepY;
+        }
+
+        for (; x < dstWidth; x++) {
+            *dstPtr++ = sampleChecked(srcData, srcWidth, srcHeight, fx, fy);
+            fx += fixedStepX;
+            fy += fixedStepY;
+        }
+    }
+
+    return dstMask;
+}
+
+qint64 KisQImagePyramid::memoryUsage() const
+{
+    qint64 result = 0;
+
+    Q_FOREACH (const PyramidLevel &level, m_levels) {
+        result += level.image.byteCount();
+
+        if (level.mask) {
+            result += level.mask->allocatedPixels() * level.mask->pixelSize();
+        }
+    }
+
+    return result;
+}
@@ -22,13 +22,25 @@
 #include <QImage>
 #include <QVector>
 #include <kis_dab_shape.h>
+#include <kis_types.h>
 #include <kritabrush_export.h>
 
 
 class BRUSH_EXPORT KisQImagePyramid
 {
 public:
-    KisQImagePyramid(const QImage &baseImage);
+    /**
+     * Defines whether the pyramid also keeps alpha8 masks of every
+     * level and how they are calculated from the tip image
+     */
+    enum MaskMode {
+        NoMask,
+        GrayscaleMask, ///< the tip is grayscale, mask = (255 - value) * alpha
+        ColorMask      ///< mask = (255 - gray(color)) * alpha
+    };
+
+public:
+    KisQImagePyramid(const QImage &baseImage, MaskMode maskMode = NoMask);
     ~KisQImagePyramid();
 
     static QSize imageSize(const QSize &originalSize,
@@ -37,13 +49,38 @@ public:
 
     static QSizeF characteristicSize(const QSize &originalSize, KisDabShape const&);
 
+    /**
+     * The GrayscaleMask pyramids keep no ARGB32 levels, so for them
+     * the level is rebuilt from its mask on every call (see
+     * levelImage()). Their tips are painted through createMask().
+     */
     QImage createImage(KisDabShape const&,
                        qreal subPixelX, qreal subPixelY) const;
 
+    MaskMode maskMode() const;
+
+    /**
+     * Generates an alpha8 mask of the transformed tip by sampling the
+     * precalculated mask levels bilinearly. It has the same size and
+     * geometry as the image returned by createImage(), but skips
+     * QPainter and the per-pixel conversion from ARGB32 completely.
+     *
+     * Available only when the pyramid has been created with a mask
+     * mode other than NoMask.
+     */
+    KisFixedPaintDeviceSP createMask(KisDabShape const&,
+                                     qreal subPixelX, qreal subPixelY) const;
+
+    /**
+     * The size of all the levels of the pyramid (in bytes)
+     */
+    qint64 memoryUsage() const;
+
 private:
     friend class KisGbrBrushTest;
     int findNearestLevel(qreal scale, qreal *baseScale) const;
     void appendPyramidLevel(const QImage &image);
+    QImage levelImage(int level) const;
 
     static void calculateParams(KisDabShape const& shape,
                                 qreal subPixelX, qreal subPixelY,
@@ -59,13 +96,25 @@ private:
 private:
     QSize m_originalSize;
     qreal m_baseScale;
+    MaskMode m_maskMode;
 
     struct PyramidLevel {
         PyramidLevel() {}
-        PyramidLevel(QImage _image, QSize _size) : image(_image), size(_size) {}
+        PyramidLevel(QImage _image, QSize _size, KisFixedPaintDeviceSP _mask)
+            : image(_image), size(_size), mask(_mask) {}
 
+        /**
+         * The ARGB32 level with the workaround border, null if the
+         * mask mode is GrayscaleMask
+         */
         QImage image;
         QSize size;
+
+        /**
+         * The alpha8 mask of the image, including the workaround
+         * border, null if the mask mode is NoMask
+         */
+        KisFixedPaintDeviceSP mask;
     };
 
     QVector<PyramidLevel> m_levels;
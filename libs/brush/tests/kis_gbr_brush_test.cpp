@@ -24,6 +24,7 @@
 #include <KoColor.h>
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
+#include <KoColorSpaceMaths.h>
 #include "testutil.h"
 #include "../kis_gbr_brush.h"
 #include "kis_types.h"
@@ -31,6 +32,7 @@
 #include "brushengine/kis_paint_information.h"
 #include <kis_fixed_paint_device.h>
 #include "kis_qimage_pyramid.h"
+#include "kis_brush_tip_cache.h"
 
 void KisGbrBrushTest::testMaskGenerationNoColor()
 {
@@ -310,6 +312,115 @@ void KisGbrBrushTest::testPyramidDabTransform()
     QCOMPARE(dabTransformHelper(KisDabShape(1.0, 0.5, M_PI / 4)), QSize(160, 160));
 }
 
+void KisGbrBrushTest::testPyramidMaskGeneration()
+{
+    KisGbrBrush* brush = new KisGbrBrush(QString(FILES_DATA_DIR) + QDir::separator() + "testing_brush_512_bars.gbr");
+    brush->load();
+    QVERIFY(!brush->brushTipImage().isNull());
+
+    // the reference images are painted from the original ARGB32 levels
+    KisQImagePyramid imagePyramid(brush->brushTipImage(), KisQImagePyramid::NoMask);
+    KisQImagePyramid maskPyramid(brush->brushTipImage(), KisQImagePyramid::GrayscaleMask);
+
+    // the grayscale pyramid keeps only the alpha8 levels
+    QVERIFY(maskPyramid.memoryUsage() * 3 < imagePyramid.memoryUsage());
+
+    struct TestCase {
+        KisDabShape shape;
+        qreal subPixelX;
+        qreal subPixelY;
+    };
+
+    QList<TestCase> testCases;
+    testCases << TestCase{KisDabShape(1.0, 1.0, 0.0), 0.0, 0.0}
+              << TestCase{KisDabShape(1.0, 1.0, 0.0), 0.3, 0.6}
+              << TestCase{KisDabShape(0.3, 1.0, 0.0), 0.3, 0.6}
+              << TestCase{KisDabShape(0.7, 0.5, 0.0), 0.3, 0.6}
+              << TestCase{KisDabShape(1.3, 1.0, M_PI / 3), 0.3, 0.6}
+              << TestCase{KisDabShape(0.2, 0.8, M_PI / 4), 0.3, 0.6};
+
+    Q_FOREACH (const TestCase &testCase, testCases) {
+        const QImage image = imagePyramid.createImage(testCase.shape, testCase.subPixelX, testCase.subPixelY);
+        const KisFixedPaintDeviceSP mask = maskPyramid.createMask(testCase.shape, testCase.subPixelX, testCase.subPixelY);
+
+        QCOMPARE(mask->bounds().size(), image.size());
+
+        const quint8 *maskPtr = mask->data();
+        qint64 totalDifference = 0;
+        int maxDifference = 0;
+
+        for (int y = 0; y < image.height(); y++) {
+            const QRgb *imagePtr = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+
+            for (int x = 0; x < image.width(); x++) {
+                const int expected =
+                    KoColorSpaceMaths<quint8>::multiply(255 - qBlue(*imagePtr), qAlpha(*imagePtr));
+
+                const int difference = qAbs(expected - int(*maskPtr));
+                totalDifference += difference;
+                maxDifference = qMax(maxDifference, difference);
+
+                imagePtr++;
+                maskPtr++;
+            }
+        }
+
+        const bool isIdentity =
+            testCase.shape.scale() == 1.0 && testCase.shape.ratio() == 1.0 &&
+            testCase.shape.rotation() == 0.0 &&
+            testCase.subPixelX == 0.0 && testCase.subPixelY == 0.0;
+
+        if (isIdentity) {
+            // the identity transform just copies the level
+            QCOMPARE(image.size(), brush->brushTipImage().size());
+            QCOMPARE(maxDifference, 0);
+        } else {
+            // QPainter samples with a fixed point precision and
+            // rounds differently, so the results may differ a bit,
+            // but a shift of the sampling grid would give much bigger
+            // errors on the sharp edges of the bars
+            const qreal averageDifference =
+                qreal(totalDifference) / (image.width() * image.height());
+
+            QVERIFY(averageDifference < 2.0);
+            QVERIFY2(maxDifference <= 16, qPrintable(QString("max difference %1").arg(maxDifference)));
+        }
+    }
+
+    delete brush;
+}
+
+void KisGbrBrushTest::testBrushTipCacheSharing()
+{
+    QImage image(64, 64, QImage::Format_ARGB32);
+    image.fill(Qt::black);
+
+    KisBrushTipCache cache(16 * 1024 * 1024);
+
+    QSharedPointer<const KisQImagePyramid> pyramid1 =
+        cache.pyramid(image, KisQImagePyramid::GrayscaleMask);
+
+    QSharedPointer<const KisQImagePyramid> pyramid2 =
+        cache.pyramid(QImage(image), KisQImagePyramid::GrayscaleMask);
+
+    QSharedPointer<const KisQImagePyramid> pyramid3 =
+        cache.pyramid(image, KisQImagePyramid::ColorMask);
+
+    QCOMPARE(pyramid1.data(), pyramid2.data());
+    QVERIFY(pyramid1.data() != pyramid3.data());
+    QCOMPARE(pyramid3->maskMode(), KisQImagePyramid::ColorMask);
+    QCOMPARE(cache.memoryUsage() / 1024,
+             (pyramid1->memoryUsage() + 1023) / 1024 + (pyramid3->memoryUsage() + 1023) / 1024);
+
+    cache.clear();
+    QCOMPARE(cache.memoryUsage(), qint64(0));
+
+    QSharedPointer<const KisQImagePyramid> pyramid4 =
+        cache.pyramid(image, KisQImagePyramid::GrayscaleMask);
+
+    QVERIFY(pyramid1.data() != pyramid4.data());
+}
+
 // see comment in KisQImagePyramid::appendPyramidLevel
 void KisGbrBrushTest::testQPainterTransformationBorder()
 {
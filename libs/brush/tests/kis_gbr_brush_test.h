@@ -42,6 +42,8 @@ private Q_SLOTS:
 
     void testPyramidLevelRounding();
     void testPyramidDabTransform();
+    void testPyramidMaskGeneration();
+    void testBrushTipCacheSharing();
 
     void testQPainterTransformationBorder();
 };
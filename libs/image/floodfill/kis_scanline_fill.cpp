@@ -21,6 +21,7 @@
 #include <KoAlwaysInline.h>
 
 #include <QStack>
+#include <QVector>
 #include <KoColor.h>
 #include <KoColorSpace.h>
 #include <KoCompositeOpRegistry.h>
@@ -132,7 +133,12 @@ private:
     int m_pixelSize;
 };
 
-class DifferencePolicySlow
+/**
+ * Computes the differences with KoColorSpace::differenceRow(), so
+ * the color space can process the whole contiguous chunk of pixels
+ * in one go instead of being called for every pixel separately.
+ */
+class DifferencePolicy
 {
 public:
     ALWAYS_INLINE void initDifferencies(KisPaintDeviceSP device, const KoColor &srcPixel) {
@@ -145,45 +151,11 @@ public:
         return m_colorSpace->difference(m_srcPixelPtr, pixelPtr);
     }
 
-private:
-    const KoColorSpace *m_colorSpace;
-    KoColor m_srcPixel;
-    const quint8 *m_srcPixelPtr;
-};
-
-template <typename SrcPixelType>
-class DifferencePolicyOptimized
-{
-    typedef SrcPixelType HashKeyType;
-    typedef QHash<HashKeyType, quint8> HashType;
-
-public:
-    ALWAYS_INLINE void initDifferencies(KisPaintDeviceSP device, const KoColor &srcPixel) {
-        m_colorSpace = device->colorSpace();
-        m_srcPixel = srcPixel;
-        m_srcPixelPtr = m_srcPixel.data();
-    }
-
-    ALWAYS_INLINE quint8 calculateDifference(quint8* pixelPtr) {
-        HashKeyType key = *reinterpret_cast<HashKeyType*>(pixelPtr);
-
-        quint8 result;
-
-        typename HashType::iterator it = m_differences.find(key);
-
-        if (it != m_differences.end()) {
-            result = *it;
-        } else {
-            result = m_colorSpace->difference(m_srcPixelPtr, pixelPtr);
-            m_differences.insert(key, result);
-        }
-
-        return result;
+    ALWAYS_INLINE void calculateDifferences(quint8* pixelPtr, int numPixels, quint8 *differences) {
+        m_colorSpace->differenceRow(m_srcPixelPtr, pixelPtr, numPixels, differences);
     }
 
 private:
-    HashType m_differences;
-
     const KoColorSpace *m_colorSpace;
     KoColor m_srcPixel;
     const quint8 *m_srcPixelPtr;
@@ -206,8 +178,23 @@ public:
     }
 
     ALWAYS_INLINE quint8 calculateOpacity(quint8* pixelPtr) {
-        quint8 diff = this->calculateDifference(pixelPtr);
+        return opacityForDifference(this->calculateDifference(pixelPtr));
+    }
 
+    /**
+     * Calculates the opacities of \p numPixels consecutive pixels
+     * starting at \p pixelPtr
+     */
+    ALWAYS_INLINE void calculateOpacities(quint8* pixelPtr, int numPixels, quint8 *opacities) {
+        this->calculateDifferences(pixelPtr, numPixels, opacities);
+
+        for (int i = 0; i < numPixels; i++) {
+            opacities[i] = opacityForDifference(opacities[i]);
+        }
+    }
+
+private:
+    ALWAYS_INLINE quint8 opacityForDifference(quint8 diff) const {
         if (!useSmoothSelection) {
             return diff <= m_threshold ? MAX_SELECTED : MIN_SELECTED;
         } else {
@@ -242,6 +229,13 @@ public:
         return memcmp(m_testPixel.data(), pixelPtr, m_pixelSize);
     }
 
+    ALWAYS_INLINE void calculateDifferences(quint8* pixelPtr, int numPixels, quint8 *differences) {
+        for (int i = 0; i < numPixels; i++) {
+            differences[i] = calculateDifference(pixelPtr);
+            pixelPtr += m_pixelSize;
+        }
+    }
+
 private:
     int m_pixelSize;
     QByteArray m_testPixel;
@@ -260,6 +254,14 @@ public:
         SrcPixelType *pixel = reinterpret_cast<SrcPixelType*>(pixelPtr);
         return *pixel == 0;
     }
+
+    ALWAYS_INLINE void calculateDifferences(quint8* pixelPtr, int numPixels, quint8 *differences) {
+        SrcPixelType *pixel = reinterpret_cast<SrcPixelType*>(pixelPtr);
+
+        for (int i = 0; i < numPixels; i++) {
+            differences[i] = pixel[i] == 0;
+        }
+    }
 };
 
 struct Q_DECL_HIDDEN KisScanlineFill::Private
@@ -274,6 +276,8 @@ struct Q_DECL_HIDDEN KisScanlineFill::Private
     KisFillIntervalMap backwardMap;
     QStack<KisFillInterval> forwardStack;
 
+    QVector<quint8> opacities;
+
 
     inline void swapDirection() {
         rowIncrement *= -1;
@@ -377,6 +381,7 @@ void KisScanlineFill::processLine(KisFillInterval interval, const int rowIncreme
 
     int numPixelsLeft = 0;
     quint8 *dataPtr = 0;
+    const quint8 *opacityPtr = 0;
     const int pixelSize = m_d->device->pixelSize();
 
     while(x <= lastX) {
@@ -386,13 +391,27 @@ void KisScanlineFill::processLine(KisFillInterval interval, const int rowIncreme
             pixelPolicy.m_srcIt->moveTo(x, row);
             numPixelsLeft = pixelPolicy.m_srcIt->numContiguousColumns(x) - 1;
             dataPtr = const_cast<quint8*>(pixelPolicy.m_srcIt->rawDataConst());
+
+            /**
+             * The opacities of the whole contiguous chunk are calculated
+             * in one go. It is safe, because the filling of the current
+             * pixel and the extended passes never touch the pixels of
+             * the chunk that are still to be processed.
+             */
+            const int numPixels = qMin(numPixelsLeft + 1, lastX - x + 1);
+            if (m_d->opacities.size() < numPixels) {
+                m_d->opacities.resize(numPixels);
+            }
+            pixelPolicy.calculateOpacities(dataPtr, numPixels, m_d->opacities.data());
+            opacityPtr = m_d->opacities.constData();
         } else {
             numPixelsLeft--;
             dataPtr += pixelSize;
+            opacityPtr++;
         }
 
         quint8 *pixelPtr = dataPtr;
-        quint8 opacity = pixelPolicy.calculateOpacity(pixelPtr);
+        quint8 opacity = *opacityPtr;
 
         if (opacity) {
             if (!currentForwardInterval.isValid()) {
@@ -471,34 +490,10 @@ void KisScanlineFill::fillColor(const KoColor &fillColor)
     KisRandomConstAccessorSP it = m_d->device->createRandomConstAccessorNG(m_d->startPoint.x(), m_d->startPoint.y());
     KoColor srcColor(it->rawDataConst(), m_d->device->colorSpace());
 
-    const int pixelSize = m_d->device->pixelSize();
-
-    if (pixelSize == 1) {
-        SelectionPolicy<false, DifferencePolicyOptimized<quint8>, FillWithColor>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setFillColor(fillColor);
-        runImpl(policy);
-    } else if (pixelSize == 2) {
-        SelectionPolicy<false, DifferencePolicyOptimized<quint16>, FillWithColor>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setFillColor(fillColor);
-        runImpl(policy);
-    } else if (pixelSize == 4) {
-        SelectionPolicy<false, DifferencePolicyOptimized<quint32>, FillWithColor>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setFillColor(fillColor);
-        runImpl(policy);
-    } else if (pixelSize == 8) {
-        SelectionPolicy<false, DifferencePolicyOptimized<quint64>, FillWithColor>
-              policy(m_d->device, srcColor, m_d->threshold);
-        policy.setFillColor(fillColor);
-        runImpl(policy);
-    } else {
-        SelectionPolicy<false, DifferencePolicySlow, FillWithColor>
-              policy(m_d->device, srcColor, m_d->threshold);
-        policy.setFillColor(fillColor);
-        runImpl(policy);
-    }
+    SelectionPolicy<false, DifferencePolicy, FillWithColor>
+        policy(m_d->device, srcColor, m_d->threshold);
+    policy.setFillColor(fillColor);
+    runImpl(policy);
 }
 
 void KisScanlineFill::fillColor(const KoColor &fillColor, KisPaintDeviceSP externalDevice)
@@ -506,39 +501,11 @@ void KisScanlineFill::fillColor(const KoColor &fillColor, KisPaintDeviceSP exter
     KisRandomConstAccessorSP it = m_d->device->createRandomConstAccessorNG(m_d->startPoint.x(), m_d->startPoint.y());
     KoColor srcColor(it->rawDataConst(), m_d->device->colorSpace());
 
-    const int pixelSize = m_d->device->pixelSize();
-
-    if (pixelSize == 1) {
-        SelectionPolicy<false, DifferencePolicyOptimized<quint8>, FillWithColorExternal>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationDevice(externalDevice);
-        policy.setFillColor(fillColor);
-        runImpl(policy);
-    } else if (pixelSize == 2) {
-        SelectionPolicy<false, DifferencePolicyOptimized<quint16>, FillWithColorExternal>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationDevice(externalDevice);
-        policy.setFillColor(fillColor);
-        runImpl(policy);
-    } else if (pixelSize == 4) {
-        SelectionPolicy<false, DifferencePolicyOptimized<quint32>, FillWithColorExternal>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationDevice(externalDevice);
-        policy.setFillColor(fillColor);
-        runImpl(policy);
-    } else if (pixelSize == 8) {
-        SelectionPolicy<false, DifferencePolicyOptimized<quint64>, FillWithColorExternal>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationDevice(externalDevice);
-        policy.setFillColor(fillColor);
-        runImpl(policy);
-    } else {
-        SelectionPolicy<false, DifferencePolicySlow, FillWithColorExternal>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationDevice(externalDevice);
-        policy.setFillColor(fillColor);
-        runImpl(policy);
-    }
+    SelectionPolicy<false, DifferencePolicy, FillWithColorExternal>
+        policy(m_d->device, srcColor, m_d->threshold);
+    policy.setDestinationDevice(externalDevice);
+    policy.setFillColor(fillColor);
+    runImpl(policy);
 }
 
 void KisScanlineFill::fillSelection(KisPixelSelectionSP pixelSelection)
@@ -546,34 +513,10 @@ void KisScanlineFill::fillSelection(KisPixelSelectionSP pixelSelection)
     KisRandomConstAccessorSP it = m_d->device->createRandomConstAccessorNG(m_d->startPoint.x(), m_d->startPoint.y());
     KoColor srcColor(it->rawDataConst(), m_d->device->colorSpace());
 
-    const int pixelSize = m_d->device->pixelSize();
-
-    if (pixelSize == 1) {
-        SelectionPolicy<true, DifferencePolicyOptimized<quint8>, CopyToSelection>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationSelection(pixelSelection);
-        runImpl(policy);
-    } else if (pixelSize == 2) {
-        SelectionPolicy<true, DifferencePolicyOptimized<quint16>, CopyToSelection>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationSelection(pixelSelection);
-        runImpl(policy);
-    } else if (pixelSize == 4) {
-        SelectionPolicy<true, DifferencePolicyOptimized<quint32>, CopyToSelection>
-            policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationSelection(pixelSelection);
-        runImpl(policy);
-    } else if (pixelSize == 8) {
-        SelectionPolicy<true, DifferencePolicyOptimized<quint64>, CopyToSelection>
-              policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationSelection(pixelSelection);
-        runImpl(policy);
-    } else {
-        SelectionPolicy<true, DifferencePolicySlow, CopyToSelection>
-              policy(m_d->device, srcColor, m_d->threshold);
-        policy.setDestinationSelection(pixelSelection);
-        runImpl(policy);
-    }
+    SelectionPolicy<true, DifferencePolicy, CopyToSelection>
+        policy(m_d->device, srcColor, m_d->threshold);
+    policy.setDestinationSelection(pixelSelection);
+    runImpl(policy);
 }
 
 void KisScanlineFill::clearNonZeroComponent()
@@ -614,7 +557,7 @@ void KisScanlineFill::testingProcessLine(const KisFillInterval &processInterval)
     KoColor srcColor(QColor(0,0,0,0), m_d->device->colorSpace());
     KoColor fillColor(QColor(200,200,200,200), m_d->device->colorSpace());
 
-    SelectionPolicy<false, DifferencePolicyOptimized<quint32>, FillWithColor>
+    SelectionPolicy<false, DifferencePolicy, FillWithColor>
         policy(m_d->device, srcColor, m_d->threshold);
 
     policy.setFillColor(fillColor);
@@ -21,6 +21,8 @@
 
 #include "kis_global.h"
 
+#include <compositeops/KoVcMultiArchBuildSupport.h>
+
 template <class BaseFade>
 class KisAntialiasingFadeMaker1D
 {
@@ -83,6 +85,27 @@ public:
         return false;
     }
 
+#if defined HAVE_VC
+    /**
+     * A vectorized version of needFade(). The \p value should contain
+     * the (normalized) values of the base fade, the lanes that need
+     * fading are overwritten.
+     */
+    inline void applyFade(const Vc::float_v &dist, Vc::float_v *value) const {
+        if (m_enableAntialiasing) {
+            const Vc::float_v vFadeStart(m_antialiasingFadeStart);
+            const Vc::float_m fadeMask = dist > vFadeStart;
+
+            (*value)(fadeMask) =
+                (Vc::float_v(float(m_fadeStartValue)) +
+                 (dist - vFadeStart) * Vc::float_v(m_antialiasingFadeCoeff)) *
+                Vc::float_v(1.0f / 255.0f);
+        }
+
+        (*value)(dist > Vc::float_v(m_radius)) = Vc::float_v(Vc::One);
+    }
+#endif /* defined HAVE_VC */
+
 private:
     qreal m_radius;
     quint8 m_fadeStartValue;
@@ -174,6 +197,30 @@ public:
         return false;
     }
 
+#if defined HAVE_VC
+    /**
+     * A vectorized version of needFade(). The \p value should contain
+     * the (normalized) values of the base fade, the lanes that need
+     * fading are overwritten. The coordinates must be non-negative.
+     */
+    inline void applyFade(const Vc::float_v &x, const Vc::float_v &y, Vc::float_v *value) const {
+        const Vc::float_v vOne(Vc::One);
+
+        if (m_enableAntialiasing) {
+            const Vc::float_v vXFadeLimitStart(m_xFadeLimitStart);
+            const Vc::float_v vYFadeLimitStart(m_yFadeLimitStart);
+
+            const Vc::float_m xFadeMask = x > vXFadeLimitStart;
+            (*value)(xFadeMask) = *value + (vOne - *value) * (x - vXFadeLimitStart) * Vc::float_v(m_xFadeCoeff);
+
+            const Vc::float_m yFadeMask = y > vYFadeLimitStart;
+            (*value)(yFadeMask) = *value + (vOne - *value) * (y - vYFadeLimitStart) * Vc::float_v(m_yFadeCoeff);
+        }
+
+        (*value)(x > Vc::float_v(m_xLimit) || y > Vc::float_v(m_yLimit)) = vOne;
+    }
+#endif /* defined HAVE_VC */
+
 private:
     qreal m_xLimit;
     qreal m_yLimit;
@@ -32,7 +32,8 @@ class QDomDocument;
  */
 class KRITAIMAGE_EXPORT KisCurveRectangleMaskGenerator : public KisMaskGenerator
 {
-
+public:
+    struct FastRowProcessor;
 public:
 
     KisCurveRectangleMaskGenerator(qreal radius, qreal ratio, qreal fh, qreal fv, int spikes, const KisCubicCurve& curve, bool antialiasEdges);
@@ -44,6 +45,10 @@ public:
 
     void setScale(qreal scaleX, qreal scaleY) override;
 
+    bool shouldVectorize() const override;
+
+    KisBrushMaskApplicatorBase* applicator() override;
+
     void toXML(QDomDocument& , QDomElement&) const override;
     
     void setSoftness(qreal softness) override;
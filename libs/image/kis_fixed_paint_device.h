@@ -92,6 +92,14 @@ public:
      */
     bool initialize(quint8 defaultValue = 0);
 
+    /**
+     * Makes sure the data area is big enough to hold bounds(), but,
+     * unlike initialize(), neither shrinks it nor fills it with
+     * anything. Useful for the scratch devices reused for dabs of
+     * different sizes, which are overwritten completely anyway.
+     */
+    void lazyGrowBufferWithoutInitialization();
+
     /**
      * @return a pointer to the beginning of the data associated with this fixed paint device.
      */
@@ -33,6 +33,7 @@
 #include <QDir>
 
 #include "kis_global.h"
+#include "tiles3/swap/kis_compression_factory.h"
 #include <cmath>
 
 #ifdef Q_OS_OSX
@@ -104,6 +105,17 @@ void KisImageConfig::setUpdatePatchWidth(int value)
     m_config.writeEntry("updatePatchWidth", value);
 }
 
+bool KisImageConfig::adaptiveUpdatePatchSize(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("adaptiveUpdatePatchSize", true) : true;
+}
+
+void KisImageConfig::setAdaptiveUpdatePatchSize(bool value)
+{
+    m_config.writeEntry("adaptiveUpdatePatchSize", value);
+}
+
 qreal KisImageConfig::maxCollectAlpha() const
 {
     return m_config.readEntry("maxCollectAlpha", 2.5);
@@ -163,6 +175,29 @@ void KisImageConfig::setSwapWindowSize(int value)
     m_config.writeEntry("swapWindowSize", value);
 }
 
+QString KisImageConfig::swapCompressionAlgorithm(bool requestDefault) const
+{
+    const QString defaultAlgorithm = KisCompressionFactory::availableCompressions().first();
+
+    return !requestDefault ?
+        m_config.readEntry("swapCompressionAlgorithm", defaultAlgorithm) : defaultAlgorithm;
+}
+
+void KisImageConfig::setSwapCompressionAlgorithm(const QString &value)
+{
+    m_config.writeEntry("swapCompressionAlgorithm", value);
+}
+
+int KisImageConfig::swapCompressionThreads() const
+{
+    return m_config.readEntry("swapCompressionThreads", QThread::idealThreadCount());
+}
+
+void KisImageConfig::setSwapCompressionThreads(int value)
+{
+    m_config.writeEntry("swapCompressionThreads", value);
+}
+
 int KisImageConfig::tilesHardLimit() const
 {
     qreal hp = qreal(memoryHardLimitPercent()) / 100.0;
@@ -186,6 +221,17 @@ int KisImageConfig::poolLimit() const
     return totalRAM() * hp * pp;
 }
 
+int KisImageConfig::tilesArenaLimit(bool requestDefault) const
+{
+    return !requestDefault ?
+        m_config.readEntry("tilesArenaLimit", 128) : 128;
+}
+
+void KisImageConfig::setTilesArenaLimit(int value)
+{
+    m_config.writeEntry("tilesArenaLimit", value);
+}
+
 qreal KisImageConfig::memoryHardLimitPercent(bool requestDefault) const
 {
     return !requestDefault ?
@@ -231,6 +277,17 @@ void KisImageConfig::setSwapDir(const QString &swapDir)
     m_config.writeEntry("swaplocation", swapDir);
 }
 
+QStringList KisImageConfig::additionalSwapDirs(bool requestDefault)
+{
+    return !requestDefault ?
+            m_config.readEntry("additionalSwapLocations", QStringList()) : QStringList();
+}
+
+void KisImageConfig::setAdditionalSwapDirs(const QStringList &swapDirs)
+{
+    m_config.writeEntry("additionalSwapLocations", swapDirs);
+}
+
 int KisImageConfig::numberOfOnionSkins() const
 {
     return m_config.readEntry("numberOfOnionSkins", 10);
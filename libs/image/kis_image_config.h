@@ -43,6 +43,9 @@ public:
     int updatePatchWidth() const;
     void setUpdatePatchWidth(int value);
 
+    bool adaptiveUpdatePatchSize(bool requestDefault = false) const;
+    void setAdaptiveUpdatePatchSize(bool value);
+
     qreal maxCollectAlpha() const;
     qreal maxMergeAlpha() const;
     qreal maxMergeCollectAlpha() const;
@@ -58,10 +61,24 @@ public:
     int swapWindowSize() const;
     void setSwapWindowSize(int value);
 
+    QString swapCompressionAlgorithm(bool requestDefault = false) const;
+    void setSwapCompressionAlgorithm(const QString &value);
+
+    int swapCompressionThreads() const;
+    void setSwapCompressionThreads(int value);
+
     int tilesHardLimit() const; // MiB
     int tilesSoftLimit() const; // MiB
     int poolLimit() const; // MiB
 
+    /**
+     * The high-water mark for the free tile chunks kept by
+     * KisTileDataArena for reuse. Everything above is returned
+     * to the system.
+     */
+    int tilesArenaLimit(bool requestDefault = false) const; // MiB
+    void setTilesArenaLimit(int value);
+
     qreal memoryHardLimitPercent(bool requestDefault = false) const; // % of total RAM
     qreal memorySoftLimitPercent(bool requestDefault = false) const; // % of memoryHardLimitPercent() * (1 - 0.01 * memoryPoolLimitPercent())
     qreal memoryPoolLimitPercent(bool requestDefault = false) const; // % of memoryHardLimitPercent()
@@ -78,6 +95,15 @@ public:
     QString swapDir(bool requestDefault = false);
     void setSwapDir(const QString &swapDir);
 
+    /**
+     * @return the directories for the extra swap files. The swapped
+     * tiles are spread over the file in swapDir() and one file in
+     * each of these directories, so placing them on different drives
+     * multiplies the swap bandwidth. Empty by default.
+     */
+    QStringList additionalSwapDirs(bool requestDefault = false);
+    void setAdditionalSwapDirs(const QStringList &swapDirs);
+
     int numberOfOnionSkins() const;
     void setNumberOfOnionSkins(int value);
 
@@ -19,10 +19,12 @@
 #include "kis_layer_projection_plane.h"
 
 #include <QBitArray>
+#include <KoColor.h>
 #include <KoColorSpace.h>
 #include <KoChannelInfo.h>
 #include <KoCompositeOpRegistry.h>
 #include "kis_painter.h"
+#include "kis_paint_device.h"
 #include "kis_projection_leaf.h"
 
 
@@ -54,15 +56,36 @@ void KisLayerProjectionPlane::apply(KisPainter *painter, const QRect &rect)
 
     QRect needRect = rect;
 
-    if (m_d->layer->compositeOpId() != COMPOSITE_COPY &&
+    const bool transparentSourceIsNoop =
+        m_d->layer->compositeOpId() != COMPOSITE_COPY &&
         m_d->layer->compositeOpId() != COMPOSITE_DESTINATION_IN  &&
-        m_d->layer->compositeOpId() != COMPOSITE_DESTINATION_ATOP) {
+        m_d->layer->compositeOpId() != COMPOSITE_DESTINATION_ATOP;
 
+    if (transparentSourceIsNoop) {
         needRect &= device->extent();
     }
 
     if(needRect.isEmpty()) return;
 
+    QVector<QRect> applyRects;
+
+    if (transparentSourceIsNoop &&
+        device->defaultPixel().opacityU8() == OPACITY_TRANSPARENT_U8) {
+
+        /**
+         * The extent may be much bigger than the actually painted
+         * area, e.g. when there are two strokes in the opposite
+         * corners of the layer. Skip the tiles that have never been
+         * allocated: they contain the transparent default pixel,
+         * which doesn't change the projection. On a tall stack of
+         * sparse layers it saves most of the compositing work.
+         */
+        applyRects = device->region(needRect).rects();
+        if (applyRects.isEmpty()) return;
+    } else {
+        applyRects << needRect;
+    }
+
     QBitArray channelFlags = m_d->layer->projectionLeaf()->channelFlags();
 
 
@@ -96,7 +119,10 @@ void KisLayerProjectionPlane::apply(KisPainter *painter, const QRect &rect)
     painter->setChannelFlags(channelFlags);
     painter->setCompositeOp(m_d->layer->compositeOpId());
     painter->setOpacity(m_d->layer->projectionLeaf()->opacity());
-    painter->bitBlt(needRect.topLeft(), device, needRect);
+
+    Q_FOREACH (const QRect &applyRect, applyRects) {
+        painter->bitBlt(applyRect.topLeft(), device, applyRect);
+    }
 }
 
 KisPaintDeviceList KisLayerProjectionPlane::getLodCapableDevices() const
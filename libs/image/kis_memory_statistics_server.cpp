@@ -114,6 +114,10 @@ KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
     stats.historicalMemorySize = tileStats.historicalMemorySize;
     stats.poolSize = tileStats.poolSize;
 
+    stats.arenaSize = tileStats.arenaSize;
+    stats.arenaNumAllocatedChunks = tileStats.arenaNumAllocatedChunks;
+    stats.arenaNumReusedChunks = tileStats.arenaNumReusedChunks;
+
     stats.swapSize = tileStats.swapSize;
 
     KisImageConfig cfg;
@@ -121,7 +125,8 @@ KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
     stats.tilesHardLimit = cfg.tilesHardLimit() * MiB;
     stats.tilesSoftLimit = cfg.tilesSoftLimit() * MiB;
     stats.tilesPoolLimit = cfg.poolLimit() * MiB;
-    stats.totalMemoryLimit = stats.tilesHardLimit + stats.tilesPoolLimit;
+    stats.tilesArenaLimit = tileStats.arenaLimit;
+    stats.totalMemoryLimit = stats.tilesHardLimit + stats.tilesPoolLimit + stats.tilesArenaLimit;
 
     return stats;
 }
@@ -41,12 +41,17 @@ public:
               historicalMemorySize(0),
               poolSize(0),
 
+              arenaSize(0),
+              arenaNumAllocatedChunks(0),
+              arenaNumReusedChunks(0),
+
               swapSize(0),
 
               totalMemoryLimit(0),
               tilesHardLimit(0),
               tilesSoftLimit(0),
-              tilesPoolLimit(0)
+              tilesPoolLimit(0),
+              tilesArenaLimit(0)
         {
         }
 
@@ -57,12 +62,21 @@ public:
         qint64 historicalMemorySize;
         qint64 poolSize;
 
+        /**
+         * Free tile chunks cached for reuse and the counters of
+         * the tile allocations
+         */
+        qint64 arenaSize;
+        qint64 arenaNumAllocatedChunks;
+        qint64 arenaNumReusedChunks;
+
         qint64 swapSize;
 
         qint64 totalMemoryLimit;
         qint64 tilesHardLimit;
         qint64 tilesSoftLimit;
         qint64 tilesPoolLimit;
+        qint64 tilesArenaLimit;
     };
 
 
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_MERGE_COST_ESTIMATOR_H
+#define __KIS_MERGE_COST_ESTIMATOR_H
+
+#include <QMutex>
+#include <QMutexLocker>
+
+
+/**
+ * Collects the running cost of the merge jobs executed by the
+ * updater context. The values are exponential moving averages, so
+ * the estimation follows the changes of the layer stack and of the
+ * load of the machine.
+ *
+ * The samples are reported by the update job items from the worker
+ * threads, one sample per merge job, so a simple mutex is enough
+ * here.
+ */
+class KisMergeCostEstimator
+{
+public:
+    KisMergeCostEstimator()
+        : m_numSamples(0),
+          m_nsPerPixel(0.0),
+          m_stackDepth(0.0)
+    {
+    }
+
+    void reportMergeJob(qint64 nsecs, qint64 numPixels, int stackDepth) {
+        if (numPixels <= 0) return;
+
+        const qreal nsPerPixel = qreal(nsecs) / numPixels;
+
+        QMutexLocker l(&m_lock);
+
+        if (!m_numSamples) {
+            m_nsPerPixel = nsPerPixel;
+            m_stackDepth = stackDepth;
+        } else {
+            m_nsPerPixel += SMOOTHING * (nsPerPixel - m_nsPerPixel);
+            m_stackDepth += SMOOTHING * (stackDepth - m_stackDepth);
+        }
+
+        m_numSamples++;
+    }
+
+    bool hasSamples() const {
+        QMutexLocker l(&m_lock);
+        return m_numSamples > 0;
+    }
+
+    /**
+     * Average time spent by a merge job on a single pixel of the
+     * requested rect, in nanoseconds. It already includes the depth
+     * of the stack being merged.
+     */
+    qreal nsPerPixel() const {
+        QMutexLocker l(&m_lock);
+        return m_nsPerPixel;
+    }
+
+    /**
+     * Average number of the nodes merged by a single job
+     */
+    qreal stackDepth() const {
+        QMutexLocker l(&m_lock);
+        return m_stackDepth;
+    }
+
+    void testingClear() {
+        QMutexLocker l(&m_lock);
+        m_numSamples = 0;
+        m_nsPerPixel = 0.0;
+        m_stackDepth = 0.0;
+    }
+
+private:
+    static constexpr qreal SMOOTHING = 0.125;
+
+    mutable QMutex m_lock;
+    int m_numSamples;
+    qreal m_nsPerPixel;
+    qreal m_stackDepth;
+};
+
+#endif /* __KIS_MERGE_COST_ESTIMATOR_H */
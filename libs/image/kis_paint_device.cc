@@ -1132,6 +1132,11 @@ QRegion KisPaintDevice::region() const
     return m_d->currentStrategy()->region();
 }
 
+QRegion KisPaintDevice::region(const QRect &rect) const
+{
+    return m_d->currentStrategy()->region(rect);
+}
+
 QRect KisPaintDevice::nonDefaultPixelArea() const
 {
     return m_d->cache()->nonDefaultPixelArea();
@@ -247,6 +247,15 @@ public:
      */
     QRegion region() const;
 
+    /**
+     * Returns the part of \p rect covered by the device's tiles.
+     * Everything in \p rect outside the returned region is
+     * guaranteed to contain the default pixel. The value is not
+     * cached and only the tiles inside \p rect are visited, so the
+     * call is cheap enough to be done on every merge.
+     */
+    QRegion region(const QRect &rect) const;
+
     /**
      * The slow version of region() that searches for exact bounds of
      * each rectangle in the region
@@ -64,6 +64,11 @@ public:
         return m_d->cache()->region().translated(m_d->x(), m_d->y());
     }
 
+    virtual QRegion region(const QRect &rect) const {
+        const QPoint offset(m_d->x(), m_d->y());
+        return m_d->dataManager()->region(rect.translated(-offset)).translated(offset);
+    }
+
     virtual void crop(const QRect &rect) {
         m_d->dataManager()->setExtent(rect.translated(-m_d->x(), -m_d->y()));
         m_d->cache()->invalidate();
@@ -264,6 +269,14 @@ public:
         return KisPaintDeviceStrategy::region() & m_wrapRect;
     }
 
+    QRegion region(const QRect &rect) const override {
+        /**
+         * Any point of the rect may map onto any tile of the wrapped
+         * device, so be conservative here
+         */
+        return QRegion(rect);
+    }
+
     void crop(const QRect &rect) override {
         KisPaintDeviceStrategy::crop(rect & m_wrapRect);
     }
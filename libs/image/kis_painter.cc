@@ -50,6 +50,7 @@
 #include "filter/kis_filter.h"
 #include "kis_layer.h"
 #include "kis_paint_device.h"
+#include "kis_default_bounds_base.h"
 #include "kis_fixed_paint_device.h"
 #include "kis_transaction.h"
 #include "kis_vec.h"
@@ -208,6 +209,21 @@ void copyAreaOptimizedImpl(const QPoint &dstPt,
     if (!srcEmpty || !dstEmpty) {
         if (srcEmpty) {
             dst->clear(dstRect);
+        } else if (dstRect == srcRect &&
+                   !src->defaultBounds()->wrapAroundMode() &&
+                   !dst->defaultBounds()->wrapAroundMode() &&
+                   dst->fastBitBltPossible(src)) {
+
+            /**
+             * When the tiles of the devices are aligned and the pixel
+             * formats match, the whole tiles of the area are shared
+             * copy-on-write instead of being copied pixel by pixel
+             */
+            if (useOldData) {
+                dst->fastBitBltOldData(src, srcRect);
+            } else {
+                dst->fastBitBlt(src, srcRect);
+            }
         } else {
             KisPainter gc(dst);
             gc.setCompositeOp(dst->colorSpace()->compositeOp(COMPOSITE_COPY));
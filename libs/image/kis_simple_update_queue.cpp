@@ -18,11 +18,16 @@
 
 #include "kis_simple_update_queue.h"
 
+#include <cmath>
+
 #include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QSize>
 
 #include "kis_image_config.h"
 #include "kis_full_refresh_walker.h"
 #include "kis_spontaneous_job.h"
+#include "kis_update_time_monitor.h"
 
 
 //#define ENABLE_DEBUG_JOIN
@@ -52,8 +57,32 @@
 #endif /* ENABLE_ACCUMULATOR */
 
 
+/**
+ * Parameters of the adaptive patch size
+ */
+
+// the time a single merge job is expected to take, in nanoseconds
+static const qreal TARGET_JOB_TIME = 2e6;
+
+// a merge job should take at least that many times longer than
+// the creation of its walker
+static const qreal WALKER_OVERHEAD_FACTOR = 10.0;
+
+// the limit on how much the patches are shrunk to feed idle threads
+static const int MAX_SPLIT_FACTOR = 4;
+
+// the patch size never goes further than that from the configured one
+static const int MAX_PATCH_SCALE = 4;
+static const int MIN_PATCH_SIZE = 64;
+static const int PATCH_SIZE_ALIGNMENT = 64;
+
+static const qreal MIN_NS_PER_PIXEL = 0.01;
+static const qreal WALKER_OVERHEAD_SMOOTHING = 0.125;
+
+
 KisSimpleUpdateQueue::KisSimpleUpdateQueue()
-    : m_overrideLevelOfDetail(-1)
+    : m_walkerOverhead(0.0),
+      m_overrideLevelOfDetail(-1)
 {
     updateSettings();
 }
@@ -71,12 +100,106 @@ void KisSimpleUpdateQueue::updateSettings()
 {
     KisImageConfig config;
 
-    m_patchWidth = config.updatePatchWidth();
-    m_patchHeight = config.updatePatchHeight();
+    QMutexLocker locker(&m_lock);
+
+    m_adaptivePatchSize = config.adaptiveUpdatePatchSize();
+
+    m_basePatchWidth = config.updatePatchWidth();
+    m_basePatchHeight = config.updatePatchHeight();
+    m_baseMaxCollectAlpha = config.maxCollectAlpha();
+    m_baseMaxMergeAlpha = config.maxMergeAlpha();
+    m_baseMaxMergeCollectAlpha = config.maxMergeCollectAlpha();
+
+    m_patchWidth = m_basePatchWidth;
+    m_patchHeight = m_basePatchHeight;
+    m_maxCollectAlpha = m_baseMaxCollectAlpha;
+    m_maxMergeAlpha = m_baseMaxMergeAlpha;
+    m_maxMergeCollectAlpha = m_baseMaxMergeCollectAlpha;
+}
+
+static qint32 alignPatchSize(qreal size, qint32 baseSize)
+{
+    const qint32 minSize = qMax(MIN_PATCH_SIZE, baseSize / MAX_PATCH_SCALE);
+    const qint32 maxSize = qMax(minSize, baseSize * MAX_PATCH_SCALE);
+
+    qint32 alignedSize =
+        (qint32(size) + PATCH_SIZE_ALIGNMENT - 1) /
+        PATCH_SIZE_ALIGNMENT * PATCH_SIZE_ALIGNMENT;
+
+    return qBound(minSize, alignedSize, maxSize);
+}
+
+void KisSimpleUpdateQueue::updateAdaptiveSettings(const KisUpdaterContext &updaterContext)
+{
+    const KisMergeCostEstimator &estimator = updaterContext.mergeCostEstimator();
+
+    /**
+     * Until the first merge job is finished we have nothing to base
+     * our decision on, so just use the configured values
+     */
+    if (!estimator.hasSamples()) return;
+
+    const qreal nsPerPixel = qMax(estimator.nsPerPixel(), MIN_NS_PER_PIXEL);
+    const qreal stackDepth = estimator.stackDepth();
+    const int numThreads = updaterContext.threadsCount();
+    const int numSpareThreads = updaterContext.numSpareThreads();
+
+    QSize patchSize;
+    qreal walkerOverhead;
+
+    {
+        QMutexLocker locker(&m_lock);
+
+        if (!m_adaptivePatchSize) return;
+
+        const int numPendingJobs = m_updatesList.size();
+        walkerOverhead = m_walkerOverhead;
+
+        /**
+         * The patch should be big enough for the walker overhead to
+         * be negligible in comparison to the merge itself. The
+         * overhead grows with the depth of the stack, so deep
+         * stacks get bigger patches...
+         */
+        const qreal minArea = WALKER_OVERHEAD_FACTOR * walkerOverhead / nsPerPixel;
+
+        /**
+         * ...but small enough for a job to be finished in about
+         * TARGET_JOB_TIME, so that the load is spread over the
+         * threads evenly. When some threads are idle and the queue
+         * has nothing to feed them with, the upcoming updates are
+         * split into smaller pieces.
+         */
+        const int numStarvingThreads = qMax(0, numSpareThreads - numPendingJobs);
+        const qreal targetArea =
+            TARGET_JOB_TIME / nsPerPixel /
+            qMin(1 + numStarvingThreads, MAX_SPLIT_FACTOR);
+
+        const qreal area = qMax(minArea, targetArea);
+        const qreal aspect = qreal(m_basePatchWidth) / m_basePatchHeight;
 
-    m_maxCollectAlpha = config.maxCollectAlpha();
-    m_maxMergeAlpha = config.maxMergeAlpha();
-    m_maxMergeCollectAlpha = config.maxMergeCollectAlpha();
+        m_patchWidth = alignPatchSize(std::sqrt(area * aspect), m_basePatchWidth);
+        m_patchHeight = alignPatchSize(std::sqrt(area / aspect), m_basePatchHeight);
+        patchSize = QSize(m_patchWidth, m_patchHeight);
+
+        /**
+         * When all the threads are busy and the queue grows, merging
+         * of the overlapping updates saves more work than it wastes,
+         * when the threads are idle it is the other way round. The
+         * configured alphas are the maximums: they are used as they
+         * are when there are at least as many pending jobs as threads
+         * and are moved halfway to 1.0 when the queue is empty.
+         */
+        const qreal loadFactor = qBound(0.5, qreal(numPendingJobs) / qMax(1, numThreads), 1.0);
+
+        m_maxCollectAlpha = 1.0 + (m_baseMaxCollectAlpha - 1.0) * loadFactor;
+        m_maxMergeAlpha = 1.0 + (m_baseMaxMergeAlpha - 1.0) * loadFactor;
+        m_maxMergeCollectAlpha = 1.0 + (m_baseMaxMergeCollectAlpha - 1.0) * loadFactor;
+    }
+
+    KisUpdateTimeMonitor::instance()->
+        reportUpdatePatchSize(patchSize, nsPerPixel, walkerOverhead,
+                              stackDepth, numSpareThreads);
 }
 
 int KisSimpleUpdateQueue::overrideLevelOfDetail() const
@@ -88,6 +211,8 @@ void KisSimpleUpdateQueue::processQueue(KisUpdaterContext &updaterContext)
 {
     updaterContext.lock();
 
+    updateAdaptiveSettings(updaterContext);
+
     while(updaterContext.hasSpareThread() &&
           processOneJob(updaterContext));
 
@@ -188,9 +313,17 @@ void KisSimpleUpdateQueue::addJob(KisNodeSP node, const QRect& rc,
     }
     /* else if(type == KisBaseRectsWalker::UNSUPPORTED) fatalKrita; */
 
+    QElapsedTimer timer;
+    timer.start();
+
     walker->collectRects(node, rc);
 
+    const qint64 walkerTime = timer.nsecsElapsed();
+
     m_lock.lock();
+    m_walkerOverhead = m_walkerOverhead > 0.0 ?
+        m_walkerOverhead + WALKER_OVERHEAD_SMOOTHING * (walkerTime - m_walkerOverhead) :
+        walkerTime;
     m_updatesList.append(walker);
     m_lock.unlock();
 }
@@ -233,21 +366,30 @@ bool KisSimpleUpdateQueue::trySplitJob(KisNodeSP node, const QRect& rc,
                                        int levelOfDetail,
                                        KisBaseRectsWalker::UpdateType type)
 {
-    if(rc.width() <= m_patchWidth || rc.height() <= m_patchHeight)
+    qint32 patchWidth;
+    qint32 patchHeight;
+
+    {
+        QMutexLocker locker(&m_lock);
+        patchWidth = m_patchWidth;
+        patchHeight = m_patchHeight;
+    }
+
+    if(rc.width() <= patchWidth || rc.height() <= patchHeight)
         return false;
 
     // a bit of recursive splitting...
 
-    qint32 firstCol = rc.x() / m_patchWidth;
-    qint32 firstRow = rc.y() / m_patchHeight;
+    qint32 firstCol = rc.x() / patchWidth;
+    qint32 firstRow = rc.y() / patchHeight;
 
-    qint32 lastCol = (rc.x() + rc.width()) / m_patchWidth;
-    qint32 lastRow = (rc.y() + rc.height()) / m_patchHeight;
+    qint32 lastCol = (rc.x() + rc.width()) / patchWidth;
+    qint32 lastRow = (rc.y() + rc.height()) / patchHeight;
 
     for(qint32 i = firstRow; i <= lastRow; i++) {
         for(qint32 j = firstCol; j <= lastCol; j++) {
-            QRect maxPatchRect(j * m_patchWidth, i * m_patchHeight,
-                               m_patchWidth, m_patchHeight);
+            QRect maxPatchRect(j * patchWidth, i * patchHeight,
+                               patchWidth, patchHeight);
             QRect patchRect = rc & maxPatchRect;
             addJob(node, patchRect, cropRect, levelOfDetail, type);
         }
@@ -362,6 +504,24 @@ bool KisSimpleUpdateQueue::joinRects(QRect& baseRect,
     return result;
 }
 
+qreal KisTestableSimpleUpdateQueue::testingMaxCollectAlpha() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_maxCollectAlpha;
+}
+
+qreal KisTestableSimpleUpdateQueue::testingMaxMergeAlpha() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_maxMergeAlpha;
+}
+
+qreal KisTestableSimpleUpdateQueue::testingMaxMergeCollectAlpha() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_maxMergeCollectAlpha;
+}
+
 KisWalkersList& KisTestableSimpleUpdateQueue::getWalkersList()
 {
     return m_updatesList;
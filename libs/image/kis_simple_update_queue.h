@@ -66,6 +66,8 @@ protected:
                      const qreal maxAlpha);
     bool joinRects(QRect& baseRect, const QRect& newRect, qreal maxAlpha);
 
+    void updateAdaptiveSettings(const KisUpdaterContext &updaterContext);
+
 protected:
 
     mutable QMutex m_lock;
@@ -75,7 +77,27 @@ protected:
     /**
      * Parameters of optimization
      * (loaded from a configuration file)
+     *
+     * When m_adaptivePatchSize is set, the values loaded from the
+     * configuration are only the starting point. As soon as the
+     * updater context has measured the cost of some merge jobs,
+     * the patch size and the alphas are recalculated on every
+     * processQueue() call, see updateAdaptiveSettings(). The
+     * current values are protected by m_lock.
+     */
+    bool m_adaptivePatchSize;
+
+    qint32 m_basePatchWidth;
+    qint32 m_basePatchHeight;
+    qreal m_baseMaxCollectAlpha;
+    qreal m_baseMaxMergeAlpha;
+    qreal m_baseMaxMergeCollectAlpha;
+
+    /**
+     * Average time needed to create a walker and collect its
+     * rects, in nanoseconds. Zero if not measured yet.
      */
+    qreal m_walkerOverhead;
 
     /**
      * Big update areas are split into a set of smaller
@@ -109,6 +131,10 @@ class KRITAIMAGE_EXPORT KisTestableSimpleUpdateQueue : public KisSimpleUpdateQue
 public:
     KisWalkersList& getWalkersList();
     KisSpontaneousJobsList& getSpontaneousJobsList();
+
+    qreal testingMaxCollectAlpha() const;
+    qreal testingMaxMergeAlpha() const;
+    qreal testingMaxMergeCollectAlpha() const;
 };
 
 #endif /* __KIS_SIMPLE_UPDATE_QUEUE_H */
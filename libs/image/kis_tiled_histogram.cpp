@@ -0,0 +1,294 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_tiled_histogram.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QVector>
+#include <QtConcurrent>
+
+#include <KoColorSpace.h>
+
+#include "kis_paint_device.h"
+#include "kis_iterator_ng.h"
+
+
+namespace {
+
+typedef quint64 CellKey;
+typedef std::vector<quint16> CellBins;
+
+static_assert(KisTiledHistogram::CELL_SIZE * KisTiledHistogram::CELL_SIZE <= 0xFFFF,
+              "the pixels of a cell must fit into the 16-bit partial bins");
+
+inline int cellIndex(int coordinate)
+{
+    return coordinate >= 0 ?
+        coordinate / KisTiledHistogram::CELL_SIZE :
+        -((-coordinate - 1) / KisTiledHistogram::CELL_SIZE) - 1;
+}
+
+inline CellKey cellKey(int col, int row)
+{
+    return (CellKey(quint32(col)) << 32) | CellKey(quint32(row));
+}
+
+inline QRect cellRect(CellKey key)
+{
+    const int col = qint32(key >> 32);
+    const int row = qint32(key & 0xFFFFFFFF);
+
+    return QRect(col * KisTiledHistogram::CELL_SIZE,
+                 row * KisTiledHistogram::CELL_SIZE,
+                 KisTiledHistogram::CELL_SIZE,
+                 KisTiledHistogram::CELL_SIZE);
+}
+
+struct CellJob
+{
+    CellKey key;
+    QRect rect;
+    CellBins bins;
+};
+
+}
+
+struct KisTiledHistogram::Private
+{
+    KisPaintDeviceSP device;
+    int numChannels;
+
+    /**
+     * Protects bounds and dirtyCells
+     */
+    mutable QMutex dirtyLock;
+    QRect bounds;
+    QSet<CellKey> dirtyCells;
+
+    /**
+     * Serializes recalculate(), the partial histograms are accessed
+     * under this lock only
+     */
+    QMutex calculationLock;
+    QHash<CellKey, CellBins> partials;
+
+    mutable QMutex totalLock;
+    std::vector<quint32> total;
+
+    void markDirty(const QRect &rect);
+    void markChangedCellsDirty(const QRect &oldBounds, const QRect &newBounds);
+    void calculateCell(CellJob &job) const;
+};
+
+void KisTiledHistogram::Private::markDirty(const QRect &rect)
+{
+    const QRect rc = rect & bounds;
+    if (rc.isEmpty()) return;
+
+    const int lastCol = cellIndex(rc.right());
+    const int lastRow = cellIndex(rc.bottom());
+
+    for (int row = cellIndex(rc.top()); row <= lastRow; row++) {
+        for (int col = cellIndex(rc.left()); col <= lastCol; col++) {
+            dirtyCells.insert(cellKey(col, row));
+        }
+    }
+}
+
+void KisTiledHistogram::Private::markChangedCellsDirty(const QRect &oldBounds, const QRect &newBounds)
+{
+    const QRect rc = oldBounds | newBounds;
+    if (rc.isEmpty()) return;
+
+    const int lastCol = cellIndex(rc.right());
+    const int lastRow = cellIndex(rc.bottom());
+
+    for (int row = cellIndex(rc.top()); row <= lastRow; row++) {
+        for (int col = cellIndex(rc.left()); col <= lastCol; col++) {
+            const CellKey key = cellKey(col, row);
+            const QRect cell = cellRect(key);
+
+            if ((cell & oldBounds) != (cell & newBounds)) {
+                dirtyCells.insert(key);
+            }
+        }
+    }
+}
+
+void KisTiledHistogram::Private::calculateCell(CellJob &job) const
+{
+    job.bins.assign(numChannels * NUM_BINS, 0);
+    if (job.rect.isEmpty()) return;
+
+    const KoColorSpace *cs = device->colorSpace();
+    const int pixelSize = cs->pixelSize();
+    quint16 *bins = job.bins.data();
+
+    KisSequentialConstIterator it(device, job.rect);
+    int numPixels;
+
+    do {
+        numPixels = it.nConseqPixels();
+        const quint8 *pixel = it.rawDataConst();
+
+        for (int i = 0; i < numPixels; i++) {
+            for (int channel = 0; channel < numChannels; channel++) {
+                bins[channel * NUM_BINS + cs->scaleToU8(pixel, channel)]++;
+            }
+            pixel += pixelSize;
+        }
+    } while (it.nextPixels(numPixels));
+}
+
+
+KisTiledHistogram::KisTiledHistogram(KisPaintDeviceSP device, const QRect &bounds)
+    : m_d(new Private)
+{
+    m_d->device = device;
+    m_d->numChannels = device->channelCount();
+    m_d->total.assign(m_d->numChannels * NUM_BINS, 0);
+
+    setBounds(bounds);
+}
+
+KisTiledHistogram::~KisTiledHistogram()
+{
+}
+
+KisPaintDeviceSP KisTiledHistogram::device() const
+{
+    return m_d->device;
+}
+
+int KisTiledHistogram::numChannels() const
+{
+    return m_d->numChannels;
+}
+
+void KisTiledHistogram::setBounds(const QRect &bounds)
+{
+    QMutexLocker l(&m_d->dirtyLock);
+
+    /**
+     * The cells that are no longer covered by the bounds get an empty
+     * rect on the next recalculate(), so their partial histograms are
+     * subtracted from the total and dropped there
+     */
+    m_d->markChangedCellsDirty(m_d->bounds, bounds);
+    m_d->bounds = bounds;
+}
+
+QRect KisTiledHistogram::bounds() const
+{
+    QMutexLocker l(&m_d->dirtyLock);
+    return m_d->bounds;
+}
+
+void KisTiledHistogram::invalidate(const QRect &rect)
+{
+    QMutexLocker l(&m_d->dirtyLock);
+    m_d->markDirty(rect);
+}
+
+bool KisTiledHistogram::isDirty() const
+{
+    QMutexLocker l(&m_d->dirtyLock);
+    return !m_d->dirtyCells.isEmpty();
+}
+
+void KisTiledHistogram::recalculate()
+{
+    QMutexLocker calculationLocker(&m_d->calculationLock);
+
+    QVector<CellJob> jobs;
+
+    {
+        QMutexLocker l(&m_d->dirtyLock);
+
+        jobs.reserve(m_d->dirtyCells.size());
+        Q_FOREACH (CellKey key, m_d->dirtyCells) {
+            CellJob job;
+            job.key = key;
+            job.rect = cellRect(key) & m_d->bounds;
+            jobs.append(job);
+        }
+
+        m_d->dirtyCells.clear();
+    }
+
+    if (jobs.isEmpty()) return;
+
+    const Private *d = m_d.data();
+    QtConcurrent::blockingMap(jobs, [d] (CellJob &job) { d->calculateCell(job); });
+
+    /**
+     * Merge the difference between the old and the new partial
+     * histograms into a copy of the total one, so that bins() is
+     * never blocked for the duration of the merge
+     */
+    std::vector<quint32> total;
+
+    {
+        QMutexLocker l(&m_d->totalLock);
+        total = m_d->total;
+    }
+
+    const int numBins = total.size();
+
+    for (int i = 0; i < jobs.size(); i++) {
+        CellJob &job = jobs[i];
+
+        auto it = m_d->partials.find(job.key);
+        if (it != m_d->partials.end()) {
+            const CellBins &oldBins = *it;
+            for (int bin = 0; bin < numBins; bin++) {
+                total[bin] -= oldBins[bin];
+            }
+        }
+
+        for (int bin = 0; bin < numBins; bin++) {
+            total[bin] += job.bins[bin];
+        }
+
+        if (job.rect.isEmpty()) {
+            m_d->partials.remove(job.key);
+        } else {
+            m_d->partials[job.key].swap(job.bins);
+        }
+    }
+
+    QMutexLocker l(&m_d->totalLock);
+    m_d->total.swap(total);
+}
+
+KisTiledHistogram::Bins KisTiledHistogram::bins() const
+{
+    Bins result(m_d->numChannels);
+
+    QMutexLocker l(&m_d->totalLock);
+
+    for (int channel = 0; channel < m_d->numChannels; channel++) {
+        result[channel].assign(m_d->total.begin() + channel * NUM_BINS,
+                               m_d->total.begin() + (channel + 1) * NUM_BINS);
+    }
+
+    return result;
+}
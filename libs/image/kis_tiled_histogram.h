@@ -0,0 +1,101 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_TILED_HISTOGRAM_H
+#define __KIS_TILED_HISTOGRAM_H
+
+#include <vector>
+
+#include <QRect>
+#include <QScopedPointer>
+
+#include "kis_types.h"
+#include "kritaimage_export.h"
+
+
+/**
+ * Keeps the 8-bit per-channel histogram of a paint device up to date.
+ *
+ * The bounds of the device are split into cells of CELL_SIZE x
+ * CELL_SIZE pixels aligned with the tiles of the device. Every cell
+ * has its own partial histogram, the total one is the sum of them.
+ * A cell never holds more than 65535 pixels, so the partial bins are
+ * 16-bit, which keeps them at about 3% of the size of an RGBA8
+ * device.
+ *
+ * invalidate() just marks the cells touched by the rect as dirty, so
+ * it is cheap enough to be called on every update of the image.
+ * recalculate() rebuilds the partial histograms of the dirty cells in
+ * parallel and merges the difference into the total, so after a
+ * stroke only the painted tiles are scanned again.
+ *
+ * invalidate() and bins() may be called from any thread, concurrent
+ * calls to recalculate() are serialized.
+ */
+class KRITAIMAGE_EXPORT KisTiledHistogram
+{
+public:
+    typedef std::vector<std::vector<quint32> > Bins;
+
+    static const int CELL_SIZE = 128;
+    static const int NUM_BINS = 256;
+
+public:
+    KisTiledHistogram(KisPaintDeviceSP device, const QRect &bounds);
+    ~KisTiledHistogram();
+
+    KisPaintDeviceSP device() const;
+    int numChannels() const;
+
+    /**
+     * Changes the area covered by the histogram. Only the cells whose
+     * intersection with the bounds has changed become dirty, the
+     * partial histograms of the cells that left the area are
+     * subtracted on the next recalculate().
+     */
+    void setBounds(const QRect &bounds);
+    QRect bounds() const;
+
+    /**
+     * Marks the cells intersecting \p rect as dirty
+     */
+    void invalidate(const QRect &rect);
+
+    /**
+     * Returns true if there are dirty cells not yet recalculated
+     */
+    bool isDirty() const;
+
+    /**
+     * Recalculates the partial histograms of the dirty cells using
+     * all the available cores. Blocks until the work is done.
+     */
+    void recalculate();
+
+    /**
+     * Returns a copy of the total histogram: numChannels() vectors
+     * with NUM_BINS bins each
+     */
+    Bins bins() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_TILED_HISTOGRAM_H */
@@ -21,11 +21,13 @@
 
 #include <QRunnable>
 #include <QReadWriteLock>
+#include <QElapsedTimer>
 
 #include "kis_stroke_job.h"
 #include "kis_spontaneous_job.h"
 #include "kis_base_rects_walker.h"
 #include "kis_async_merger.h"
+#include "kis_merge_cost_estimator.h"
 
 
 class KisUpdateJobItem :  public QObject, public QRunnable
@@ -40,8 +42,12 @@ public:
     };
 
 public:
-    KisUpdateJobItem(QReadWriteLock *exclusiveJobLock)
+    KisUpdateJobItem(QReadWriteLock *exclusiveJobLock,
+                     KisMergeCostEstimator *costEstimator,
+                     int index)
         : m_exclusiveJobLock(exclusiveJobLock),
+          m_costEstimator(costEstimator),
+          m_index(index),
           m_type(EMPTY),
           m_runnableJob(0)
     {
@@ -71,7 +77,7 @@ public:
         setDone();
 
         emit sigDoSomeUsefulWork();
-        emit sigJobFinished();
+        emit sigJobFinished(m_index);
 
         m_exclusiveJobLock->unlock();
     }
@@ -80,8 +86,18 @@ public:
         Q_ASSERT(m_type == MERGE);
         // dbgKrita << "Executing merge job" << m_walker->changeRect()
         //          << "on thread" << QThread::currentThreadId();
+        const int stackDepth = m_walker->leafStack().size();
+
+        QElapsedTimer timer;
+        timer.start();
+
         m_merger.startMerge(*m_walker);
 
+        const QRect requestedRect = m_walker->requestedRect();
+        m_costEstimator->reportMergeJob(timer.nsecsElapsed(),
+                                        qint64(requestedRect.width()) * requestedRect.height(),
+                                        stackDepth);
+
         QRect changeRect = m_walker->changeRect();
         emit sigContinueUpdate(changeRect);
     }
@@ -124,6 +140,10 @@ public:
         return m_type != EMPTY;
     }
 
+    inline int index() const {
+        return m_index;
+    }
+
     inline Type type() const {
         return m_type;
     }
@@ -139,7 +159,7 @@ public:
 Q_SIGNALS:
     void sigContinueUpdate(const QRect& rc);
     void sigDoSomeUsefulWork();
-    void sigJobFinished();
+    void sigJobFinished(int index);
 
 private:
     /**
@@ -175,6 +195,17 @@ private:
      */
     QReadWriteLock *m_exclusiveJobLock;
 
+    /**
+     * \see KisUpdaterContext::m_costEstimator
+     */
+    KisMergeCostEstimator *m_costEstimator;
+
+    /**
+     * Position of the item in KisUpdaterContext::m_jobs. It is also
+     * used as a preferred worker of the thread pool.
+     */
+    const int m_index;
+
     bool m_exclusive;
 
     volatile Type m_type;
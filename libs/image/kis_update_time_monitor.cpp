@@ -25,6 +25,7 @@
 #include <QMutexLocker>
 #include <QPointF>
 #include <QRect>
+#include <QSize>
 #include <QRegion>
 #include <QFile>
 #include <QDir>
@@ -85,6 +86,12 @@ struct Q_DECL_HIDDEN KisUpdateTimeMonitor::Private
           numTickets(0),
           numUpdates(0),
           mousePath(0.0),
+          numPatchDecisions(0),
+          patchAreaSum(0.0),
+          nsPerPixelSum(0.0),
+          walkerOverheadSum(0.0),
+          stackDepthSum(0.0),
+          spareThreadsSum(0),
           loggingEnabled(false)
     {
         loggingEnabled = KisImageConfig().enablePerfLog();
@@ -104,6 +111,13 @@ struct Q_DECL_HIDDEN KisUpdateTimeMonitor::Private
     QElapsedTimer strokeTime;
     KisPaintOpPresetSP preset;
 
+    qint32 numPatchDecisions;
+    qreal patchAreaSum;
+    qreal nsPerPixelSum;
+    qreal walkerOverheadSum;
+    qreal stackDepthSum;
+    qint64 spareThreadsSum;
+
     bool loggingEnabled;
 };
 
@@ -141,6 +155,13 @@ void KisUpdateTimeMonitor::startStrokeMeasure()
     m_d->numUpdates = 0;
     m_d->mousePath = 0;
 
+    m_d->numPatchDecisions = 0;
+    m_d->patchAreaSum = 0.0;
+    m_d->nsPerPixelSum = 0.0;
+    m_d->walkerOverheadSum = 0.0;
+    m_d->stackDepthSum = 0.0;
+    m_d->spareThreadsSum = 0;
+
     m_d->lastMousePos = QPointF();
     m_d->preset = 0;
     m_d->strokeTime.start();
@@ -186,6 +207,13 @@ void KisUpdateTimeMonitor::printValues()
     qreal jobsPerUpdate = qreal(m_d->numTickets) / m_d->numUpdates;    
     qreal mouseSpeed = qreal(m_d->mousePath) / strokeTime;
 
+    const qreal numDecisions = qMax(1, m_d->numPatchDecisions);
+    qreal patchSize = std::sqrt(m_d->patchAreaSum / numDecisions);
+    qreal nsPerPixel = m_d->nsPerPixelSum / numDecisions;
+    qreal walkerOverhead = m_d->walkerOverheadSum / numDecisions;
+    qreal stackDepth = m_d->stackDepthSum / numDecisions;
+    qreal spareThreads = qreal(m_d->spareThreadsSum) / numDecisions;
+
     QString prefix;
 
     if (m_d->preset) {
@@ -203,7 +231,12 @@ void KisUpdateTimeMonitor::printValues()
            << i18n("Mouse Speed:") << QString::number( mouseSpeed, 'f', 3 ) << "\t"
            << i18n("Jobs/Update:") << QString::number( jobsPerUpdate, 'f', 3 ) << "\t"
            << i18n("Non Update Time:") << QString::number( nonUpdateTime, 'f', 3 ) << "\t"
-           << i18n("Response Time:") << responseTime << endl; // 'endl' will use the correct OS line ending
+           << i18n("Response Time:") << responseTime << "\t"
+           << i18n("Patch Size:") << QString::number( patchSize, 'f', 1 ) << "\t"
+           << i18n("Merge ns/px:") << QString::number( nsPerPixel, 'f', 3 ) << "\t"
+           << i18n("Walker Overhead:") << QString::number( walkerOverhead, 'f', 0 ) << "\t"
+           << i18n("Stack Depth:") << QString::number( stackDepth, 'f', 1 ) << "\t"
+           << i18n("Spare Threads:") << QString::number( spareThreads, 'f', 2 ) << endl; // 'endl' will use the correct OS line ending
     logFile.close();
 }
 
@@ -256,3 +289,21 @@ void KisUpdateTimeMonitor::reportUpdateFinished(const QRect &rect)
     }
     m_d->numUpdates++;
 }
+
+void KisUpdateTimeMonitor::reportUpdatePatchSize(const QSize &patchSize,
+                                                 qreal nsPerPixel,
+                                                 qreal walkerOverhead,
+                                                 qreal stackDepth,
+                                                 int numSpareThreads)
+{
+    if (!m_d->loggingEnabled) return;
+
+    QMutexLocker locker(&m_d->mutex);
+
+    m_d->numPatchDecisions++;
+    m_d->patchAreaSum += qreal(patchSize.width()) * patchSize.height();
+    m_d->nsPerPixelSum += nsPerPixel;
+    m_d->walkerOverheadSum += walkerOverhead;
+    m_d->stackDepthSum += stackDepth;
+    m_d->spareThreadsSum += numSpareThreads;
+}
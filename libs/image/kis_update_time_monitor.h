@@ -26,6 +26,7 @@
 #include <QVector>
 class QPointF;
 class QRect;
+class QSize;
 
 
 class KRITAIMAGE_EXPORT KisUpdateTimeMonitor
@@ -46,6 +47,17 @@ public:
     void reportJobFinished(void *key, const QVector<QRect> &rects);
     void reportUpdateFinished(const QRect &rect);
 
+    /**
+     * Reports a decision of KisSimpleUpdateQueue about the size of
+     * the update patches together with the measurements it was
+     * based on. The averages are written into the stroke log.
+     */
+    void reportUpdatePatchSize(const QSize &patchSize,
+                               qreal nsPerPixel,
+                               qreal walkerOverhead,
+                               qreal stackDepth,
+                               int numSpareThreads);
+
 
 private:
     struct Private;
@@ -19,24 +19,28 @@
 #include "kis_updater_context.h"
 
 #include <QThread>
-#include <QThreadPool>
 
 #include "kis_update_job_item.h"
 #include "kis_stroke_job.h"
 
 const int KisUpdaterContext::useIdealThreadCountTag = -1;
 
-KisUpdaterContext::KisUpdaterContext(qint32 threadCount, QObject *parent)
-    : QObject(parent)
+static qint32 calculateThreadCount(qint32 threadCount)
 {
     if(threadCount <= 0) {
         threadCount = QThread::idealThreadCount();
         threadCount = threadCount > 0 ? threadCount : 1;
     }
+    return threadCount;
+}
 
-    m_jobs.resize(threadCount);
+KisUpdaterContext::KisUpdaterContext(qint32 threadCount, QObject *parent)
+    : QObject(parent),
+      m_threadPool(calculateThreadCount(threadCount))
+{
+    m_jobs.resize(m_threadPool.numWorkers());
     for(qint32 i = 0; i < m_jobs.size(); i++) {
-        m_jobs[i] = new KisUpdateJobItem(&m_exclusiveJobLock);
+        m_jobs[i] = new KisUpdateJobItem(&m_exclusiveJobLock, &m_costEstimator, i);
         connect(m_jobs[i], SIGNAL(sigContinueUpdate(const QRect&)),
                 SIGNAL(sigContinueUpdate(const QRect&)),
                 Qt::DirectConnection);
@@ -44,9 +48,11 @@ KisUpdaterContext::KisUpdaterContext(qint32 threadCount, QObject *parent)
         connect(m_jobs[i], SIGNAL(sigDoSomeUsefulWork()),
                 SIGNAL(sigDoSomeUsefulWork()), Qt::DirectConnection);
 
-        connect(m_jobs[i], SIGNAL(sigJobFinished()),
-                SLOT(slotJobFinished()), Qt::DirectConnection);
+        connect(m_jobs[i], SIGNAL(sigJobFinished(int)),
+                SLOT(slotJobFinished(int)), Qt::DirectConnection);
     }
+
+    resetSpareThreads();
 }
 
 KisUpdaterContext::~KisUpdaterContext()
@@ -80,15 +86,22 @@ int KisUpdaterContext::currentLevelOfDetail() const
 
 bool KisUpdaterContext::hasSpareThread()
 {
-    bool found = false;
+    return m_numSpareJobs.load() > 0;
+}
 
-    Q_FOREACH (const KisUpdateJobItem *item, m_jobs) {
-        if(!item->isRunning()) {
-            found = true;
-            break;
-        }
-    }
-    return found;
+int KisUpdaterContext::numSpareThreads() const
+{
+    return m_numSpareJobs.load();
+}
+
+int KisUpdaterContext::threadsCount() const
+{
+    return m_jobs.size();
+}
+
+const KisMergeCostEstimator& KisUpdaterContext::mergeCostEstimator() const
+{
+    return m_costEstimator;
 }
 
 bool KisUpdaterContext::isJobAllowed(KisBaseRectsWalkerSP walker)
@@ -123,7 +136,7 @@ void KisUpdaterContext::addMergeJob(KisBaseRectsWalkerSP walker)
     Q_ASSERT(jobIndex >= 0);
 
     m_jobs[jobIndex]->setWalker(walker);
-    m_threadPool.start(m_jobs[jobIndex]);
+    m_threadPool.start(m_jobs[jobIndex], jobIndex);
 }
 
 /**
@@ -146,7 +159,7 @@ void KisUpdaterContext::addStrokeJob(KisStrokeJob *strokeJob)
     Q_ASSERT(jobIndex >= 0);
 
     m_jobs[jobIndex]->setStrokeJob(strokeJob);
-    m_threadPool.start(m_jobs[jobIndex]);
+    m_threadPool.start(m_jobs[jobIndex], jobIndex);
 }
 
 /**
@@ -169,7 +182,7 @@ void KisUpdaterContext::addSpontaneousJob(KisSpontaneousJob *spontaneousJob)
     Q_ASSERT(jobIndex >= 0);
 
     m_jobs[jobIndex]->setSpontaneousJob(spontaneousJob);
-    m_threadPool.start(m_jobs[jobIndex]);
+    m_threadPool.start(m_jobs[jobIndex], jobIndex);
 }
 
 /**
@@ -199,15 +212,47 @@ bool KisUpdaterContext::walkerIntersectsJob(KisBaseRectsWalkerSP walker,
 
 qint32 KisUpdaterContext::findSpareThread()
 {
-    for(qint32 i=0; i < m_jobs.size(); i++)
-        if(!m_jobs[i]->isRunning())
-            return i;
+    QMutexLocker l(&m_spareJobsLock);
+
+    if (m_spareJobs.isEmpty()) return -1;
+
+    m_numSpareJobs.deref();
+    const qint32 jobIndex = m_spareJobs.takeLast();
+    Q_ASSERT(!m_jobs[jobIndex]->isRunning());
+
+    return jobIndex;
+}
+
+void KisUpdaterContext::releaseSpareThread(qint32 jobIndex)
+{
+    QMutexLocker l(&m_spareJobsLock);
+
+    m_spareJobs.append(jobIndex);
+    m_numSpareJobs.ref();
+}
+
+void KisUpdaterContext::resetSpareThreads()
+{
+    QMutexLocker l(&m_spareJobsLock);
 
-    return -1;
+    m_spareJobs.clear();
+
+    /**
+     * The stack is popped from the back, so keep the lowest
+     * index on the top
+     */
+    for (qint32 i = m_jobs.size() - 1; i >= 0; i--) {
+        if (!m_jobs[i]->isRunning()) {
+            m_spareJobs.append(i);
+        }
+    }
+
+    m_numSpareJobs.store(m_spareJobs.size());
 }
 
-void KisUpdaterContext::slotJobFinished()
+void KisUpdaterContext::slotJobFinished(int jobIndex)
 {
+    releaseSpareThread(jobIndex);
     m_lodCounter.removeLod();
 
     // Be careful. This slot can be called asynchronously without locks.
@@ -244,6 +289,16 @@ void KisTestableUpdaterContext::clear()
         item->testingSetDone();
     }
 
+    resetSpareThreads();
     m_lodCounter.testingClear();
 }
 
+void KisTestableUpdaterContext::testingReportMergeJob(qint64 nsecs, qint64 numPixels, int stackDepth)
+{
+    m_costEstimator.reportMergeJob(nsecs, numPixels, stackDepth);
+}
+
+void KisTestableUpdaterContext::testingClearMergeCost()
+{
+    m_costEstimator.testingClear();
+}
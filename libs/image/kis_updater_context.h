@@ -22,11 +22,13 @@
 #include <QObject>
 #include <QMutex>
 #include <QReadWriteLock>
-#include <QThreadPool>
+#include <QAtomicInt>
 
 #include "kis_base_rects_walker.h"
 #include "kis_async_merger.h"
 #include "kis_lock_free_lod_counter.h"
+#include "kis_work_stealing_thread_pool.h"
+#include "kis_merge_cost_estimator.h"
 
 
 class KisUpdateJobItem;
@@ -60,10 +62,28 @@ public:
 
     /**
      * Check whether there is a spare thread for running
-     * one more job
+     * one more job. The check is lock-free.
      */
     bool hasSpareThread();
 
+    /**
+     * Returns the number of threads that are not running
+     * anything at the moment
+     */
+    int numSpareThreads() const;
+
+    /**
+     * Returns the total number of threads of the context
+     */
+    int threadsCount() const;
+
+    /**
+     * Returns the measured cost of the merge jobs executed by
+     * the context. Used by KisSimpleUpdateQueue to choose the
+     * size of the update patches.
+     */
+    const KisMergeCostEstimator& mergeCostEstimator() const;
+
     /**
      * Checks whether the walker intersects with any
      * of currently executing walkers. If it does,
@@ -125,13 +145,21 @@ Q_SIGNALS:
     void sigSpareThreadAppeared();
 
 protected Q_SLOTS:
-    void slotJobFinished();
+    void slotJobFinished(int jobIndex);
 
 protected:
     static bool walkerIntersectsJob(KisBaseRectsWalkerSP walker,
                                     const KisUpdateJobItem* job);
+
+    /**
+     * Takes a spare job item out of the list of spare items.
+     * Returns -1 if there are no spare items.
+     */
     qint32 findSpareThread();
 
+    void releaseSpareThread(qint32 jobIndex);
+    void resetSpareThreads();
+
 protected:
     /**
      * The lock is shared by all the child update job items.
@@ -143,7 +171,24 @@ protected:
 
     QMutex m_lock;
     QVector<KisUpdateJobItem*> m_jobs;
-    QThreadPool m_threadPool;
+
+    /**
+     * A stack of indexes of the items in m_jobs that are not
+     * running anything. The items are returned to the stack by the
+     * worker threads, so it has a separate lock, which is never
+     * held for more than a push or a pop.
+     */
+    QMutex m_spareJobsLock;
+    QVector<qint32> m_spareJobs;
+    QAtomicInt m_numSpareJobs;
+
+    /**
+     * Shared by all the child update job items. Every merge
+     * job reports its execution time here.
+     */
+    KisMergeCostEstimator m_costEstimator;
+
+    KisWorkStealingThreadPool m_threadPool;
     KisLockFreeLodCounter m_lodCounter;
 };
 
@@ -166,6 +211,12 @@ public:
 
     const QVector<KisUpdateJobItem*> getJobs();
     void clear();
+
+    /**
+     * Pretends a merge job with the given cost has been executed
+     */
+    void testingReportMergeJob(qint64 nsecs, qint64 numPixels, int stackDepth);
+    void testingClearMergeCost();
 };
 
 
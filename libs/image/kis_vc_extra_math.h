@@ -0,0 +1,62 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_VC_EXTRA_MATH_H
+#define __KIS_VC_EXTRA_MATH_H
+
+#include <compositeops/KoVcMultiArchBuildSupport.h>
+
+#if defined HAVE_VC
+
+namespace KisVcExtraMath {
+
+/**
+ * Vectorized version of erf(x). Uses the approximation 7.1.26 from
+ * Abramowitz and Stegun, the absolute error is below 1.5e-7, which is
+ * much less than a single step of an 8-bit mask.
+ */
+template<class FloatVector>
+inline FloatVector erf(const FloatVector &x)
+{
+    const FloatVector a1(0.254829592f);
+    const FloatVector a2(-0.284496736f);
+    const FloatVector a3(1.421413741f);
+    const FloatVector a4(-1.453152027f);
+    const FloatVector a5(1.061405429f);
+    const FloatVector p(0.3275911f);
+    const FloatVector vOne(Vc::One);
+
+    const FloatVector xa = Vc::abs(x);
+
+    const FloatVector t = vOne / (vOne + p * xa);
+    const FloatVector poly = ((((a5 * t + a4) * t + a3) * t + a2) * t + a1) * t;
+
+    FloatVector y = vOne - poly * Vc::exp(-xa * xa);
+
+    // exp() underflows long before erf() reaches 1.0 in float precision
+    y(xa > FloatVector(9.0f)) = vOne;
+    y(x < FloatVector(Vc::Zero)) = -y;
+
+    return y;
+}
+
+}
+
+#endif /* defined HAVE_VC */
+
+#endif /* __KIS_VC_EXTRA_MATH_H */
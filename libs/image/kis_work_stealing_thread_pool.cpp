@@ -0,0 +1,261 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_work_stealing_thread_pool.h"
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include "kis_assert.h"
+
+
+namespace {
+
+struct WorkerQueue
+{
+    QMutex lock;
+    QList<QRunnable*> jobs;
+};
+
+}
+
+struct Q_DECL_HIDDEN KisWorkStealingThreadPool::Private
+{
+    class Worker : public QThread
+    {
+    public:
+        Worker(Private *pool, int index)
+            : m_pool(pool), m_index(index)
+        {
+        }
+
+        void run() override {
+            m_pool->workerLoop(m_index);
+        }
+
+    private:
+        Private *m_pool;
+        int m_index;
+    };
+
+    Private(int _numWorkers)
+        : numWorkers(_numWorkers),
+          exitFlag(false)
+    {
+    }
+
+    void ensureStarted();
+    QRunnable* takeJob(int workerIndex);
+    void runJob(QRunnable *runnable);
+    void workerLoop(int workerIndex);
+
+    int numWorkers;
+    QVector<WorkerQueue*> queues;
+    QVector<Worker*> workers;
+
+    QMutex startLock;
+    QAtomicInt threadsStarted;
+
+    QAtomicInt roundRobinCounter;
+
+    /**
+     * Number of jobs sitting in the queues, used by the workers
+     * to decide whether they may go to sleep
+     */
+    QAtomicInt numQueuedJobs;
+
+    /**
+     * Number of jobs either queued or running, used by waitForDone()
+     */
+    QAtomicInt numPendingJobs;
+
+    QAtomicInt numStolenJobs;
+
+    QMutex sleepLock;
+    QWaitCondition workAvailable;
+    bool exitFlag;
+
+    QMutex doneLock;
+    QWaitCondition allJobsDone;
+};
+
+void KisWorkStealingThreadPool::Private::ensureStarted()
+{
+    if (threadsStarted.loadAcquire()) return;
+
+    QMutexLocker l(&startLock);
+    if (threadsStarted.load()) return;
+
+    for (int i = 0; i < numWorkers; i++) {
+        Worker *worker = new Worker(this, i);
+        workers.append(worker);
+        worker->start();
+    }
+
+    threadsStarted.storeRelease(1);
+}
+
+QRunnable* KisWorkStealingThreadPool::Private::takeJob(int workerIndex)
+{
+    QRunnable *job = 0;
+
+    /**
+     * The owner takes the oldest job from its own queue, so the
+     * order of submission is mostly preserved. The thieves take the
+     * newest jobs from the victims' queues to reduce the chance of
+     * fighting with the owner for the same end of the queue.
+     */
+    {
+        WorkerQueue *queue = queues[workerIndex];
+        QMutexLocker l(&queue->lock);
+        if (!queue->jobs.isEmpty()) {
+            job = queue->jobs.takeFirst();
+        }
+    }
+
+    for (int i = 1; !job && i < numWorkers; i++) {
+        WorkerQueue *queue = queues[(workerIndex + i) % numWorkers];
+        QMutexLocker l(&queue->lock);
+        if (!queue->jobs.isEmpty()) {
+            job = queue->jobs.takeLast();
+            numStolenJobs.ref();
+        }
+    }
+
+    if (job) {
+        numQueuedJobs.deref();
+    }
+
+    return job;
+}
+
+void KisWorkStealingThreadPool::Private::runJob(QRunnable *runnable)
+{
+    /**
+     * The runnable may be queued again while it is still finishing
+     * its run(), so the flag should be read beforehand, just like
+     * QThreadPool does
+     */
+    const bool autoDelete = runnable->autoDelete();
+
+    runnable->run();
+
+    if (autoDelete) {
+        delete runnable;
+    }
+
+    if (!numPendingJobs.deref()) {
+        QMutexLocker l(&doneLock);
+        allJobsDone.wakeAll();
+    }
+}
+
+void KisWorkStealingThreadPool::Private::workerLoop(int workerIndex)
+{
+    forever {
+        QRunnable *job = takeJob(workerIndex);
+
+        if (job) {
+            runJob(job);
+            continue;
+        }
+
+        QMutexLocker l(&sleepLock);
+
+        if (exitFlag) break;
+        if (numQueuedJobs.load() > 0) continue;
+
+        workAvailable.wait(&sleepLock);
+    }
+}
+
+KisWorkStealingThreadPool::KisWorkStealingThreadPool(int numWorkers)
+    : m_d(new Private(qMax(1, numWorkers)))
+{
+    for (int i = 0; i < m_d->numWorkers; i++) {
+        m_d->queues.append(new WorkerQueue());
+    }
+}
+
+KisWorkStealingThreadPool::~KisWorkStealingThreadPool()
+{
+    waitForDone();
+
+    {
+        QMutexLocker l(&m_d->sleepLock);
+        m_d->exitFlag = true;
+        m_d->workAvailable.wakeAll();
+    }
+
+    Q_FOREACH (Private::Worker *worker, m_d->workers) {
+        worker->wait();
+        delete worker;
+    }
+
+    qDeleteAll(m_d->queues);
+}
+
+int KisWorkStealingThreadPool::numWorkers() const
+{
+    return m_d->numWorkers;
+}
+
+void KisWorkStealingThreadPool::start(QRunnable *runnable, int preferredWorker)
+{
+    KIS_ASSERT_RECOVER_RETURN(runnable);
+
+    m_d->ensureStarted();
+
+    const int workerIndex =
+        preferredWorker >= 0 ?
+        preferredWorker % m_d->numWorkers :
+        (m_d->roundRobinCounter.fetchAndAddRelaxed(1) & 0x7fffffff) % m_d->numWorkers;
+
+    m_d->numPendingJobs.ref();
+
+    {
+        WorkerQueue *queue = m_d->queues[workerIndex];
+        QMutexLocker l(&queue->lock);
+        queue->jobs.append(runnable);
+    }
+
+    m_d->numQueuedJobs.ref();
+
+    QMutexLocker l(&m_d->sleepLock);
+    m_d->workAvailable.wakeOne();
+}
+
+void KisWorkStealingThreadPool::waitForDone()
+{
+    QMutexLocker l(&m_d->doneLock);
+
+    while (m_d->numPendingJobs.load()) {
+        m_d->allJobsDone.wait(&m_d->doneLock);
+    }
+}
+
+int KisWorkStealingThreadPool::numStolenJobs() const
+{
+    return m_d->numStolenJobs.load();
+}
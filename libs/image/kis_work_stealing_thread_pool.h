@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_WORK_STEALING_THREAD_POOL_H
+#define __KIS_WORK_STEALING_THREAD_POOL_H
+
+#include <QScopedPointer>
+
+#include "kritaimage_export.h"
+
+class QRunnable;
+
+
+/**
+ * A fixed-size thread pool with a separate job queue per worker.
+ *
+ * QThreadPool keeps a single queue protected by a single mutex, so
+ * every start() and every job pickup on every thread serialize on it.
+ * Here each worker owns a deque: jobs are pushed into the deque of a
+ * preferred (or the next round-robin) worker, the owner pops from the
+ * front of its own deque and, when it runs dry, steals from the back
+ * of the other workers' deques. That keeps the dispatch path mostly
+ * uncontended even with a lot of cores.
+ *
+ * The pool knows nothing about the ordering of the jobs. Sequential,
+ * concurrent and barrier semantics of the strokes are still ensured
+ * by KisStrokesQueue before a job is ever passed to the pool, and
+ * exclusiveness by KisUpdaterContext::m_exclusiveJobLock.
+ *
+ * The worker threads are started lazily on the first call to start(),
+ * so creating a pool that never runs anything (like the one of
+ * KisTestableUpdaterContext) is cheap.
+ */
+class KRITAIMAGE_EXPORT KisWorkStealingThreadPool
+{
+public:
+    KisWorkStealingThreadPool(int numWorkers);
+    ~KisWorkStealingThreadPool();
+
+    int numWorkers() const;
+
+    /**
+     * Queues \p runnable for execution. If \p preferredWorker is
+     * non-negative, the job is put into the queue of that worker,
+     * otherwise the workers are chosen in round-robin order. The job
+     * may still be stolen by any idle worker.
+     *
+     * If runnable->autoDelete() is true, the runnable is deleted
+     * after its execution.
+     */
+    void start(QRunnable *runnable, int preferredWorker = -1);
+
+    /**
+     * Blocks until all the queued and currently running jobs are
+     * finished
+     */
+    void waitForDone();
+
+    /**
+     * Returns the number of jobs that were stolen from the queue
+     * of another worker since the creation of the pool
+     */
+    int numStolenJobs() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_WORK_STEALING_THREAD_POOL_H */
@@ -181,5 +181,102 @@ void KisMaskGeneratorTest::testCopyCtorGaussRect()
     testCopyCtor(&gen);
 }
 
+#include <QtMath>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include "kis_fixed_paint_device.h"
+#include "kis_brush_mask_applicator_base.h"
+
+/**
+ * Compares the result of the applicator of the generator (which is
+ * vectorized when Vc is available) with its scalar valueAt()
+ */
+void testVectorizedApplicator(KisMaskGenerator *gen)
+{
+    gen->setScale(1.0, 1.0);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect bounds(0, 0, qCeil(gen->width()) + 2, qCeil(gen->height()) + 2);
+
+    KisFixedPaintDeviceSP dev = new KisFixedPaintDevice(cs);
+    dev->setRect(bounds);
+    dev->initialize(255);
+
+    MaskProcessingData data(dev, cs,
+                            0.0, 1.0,
+                            0.5 * bounds.width(), 0.5 * bounds.height(),
+                            0.3);
+
+    KisBrushMaskApplicatorBase *applicator = gen->applicator();
+    applicator->initializeData(&data);
+    applicator->process(bounds);
+
+    const quint8 *pixel = dev->data();
+    const int alphaPos = 3;
+
+    for (int y = 0; y < bounds.height(); y++) {
+        for (int x = 0; x < bounds.width(); x++) {
+            const qreal x_ = x - data.centerX;
+            const qreal y_ = y - data.centerY;
+            const qreal maskX = data.cosa * x_ - data.sina * y_;
+            const qreal maskY = data.sina * x_ + data.cosa * y_;
+
+            const int expected = 255 - gen->valueAt(maskX, maskY);
+            const int actual = pixel[alphaPos];
+
+            if (qAbs(expected - actual) > 3) {
+                qDebug() << ppVar(x) << ppVar(y) << ppVar(expected) << ppVar(actual);
+                QFAIL("Vectorized mask differs from valueAt()");
+            }
+
+            pixel += cs->pixelSize();
+        }
+    }
+}
+
+void KisMaskGeneratorTest::testVectorizedRect()
+{
+    KisRectangleMaskGenerator gen(50, 0.8, 0.75, 0.85, 2, true);
+    testVectorizedApplicator(&gen);
+}
+
+void KisMaskGeneratorTest::testVectorizedGaussCircle()
+{
+    KisGaussCircleMaskGenerator gen(50, 0.8, 0.75, 0.85, 2, true);
+    testVectorizedApplicator(&gen);
+}
+
+void KisMaskGeneratorTest::testVectorizedGaussRect()
+{
+    KisGaussRectangleMaskGenerator gen(50, 0.8, 0.75, 0.85, 2, true);
+    testVectorizedApplicator(&gen);
+}
+
+/**
+ * A clearly non-linear curve, so that a wrong lookup or interpolation
+ * in the curve table could not pass the check by chance
+ */
+KisCubicCurve sCurve()
+{
+    QList<QPointF> points;
+    points << QPointF(0.0, 0.0)
+           << QPointF(0.25, 0.05)
+           << QPointF(0.75, 0.95)
+           << QPointF(1.0, 1.0);
+    return KisCubicCurve(points);
+}
+
+void KisMaskGeneratorTest::testVectorizedCurveCircle()
+{
+    KisCurveCircleMaskGenerator gen(50, 0.8, 0.75, 0.85, 2, sCurve(), true);
+    testVectorizedApplicator(&gen);
+}
+
+void KisMaskGeneratorTest::testVectorizedCurveRect()
+{
+    KisCurveRectangleMaskGenerator gen(50, 0.8, 0.75, 0.85, 2, sCurve(), true);
+    testVectorizedApplicator(&gen);
+}
+
 
 QTEST_MAIN(KisMaskGeneratorTest)
@@ -37,6 +37,12 @@ private Q_SLOTS:
 
     void testCopyCtorGaussCircle();
     void testCopyCtorGaussRect();
+
+    void testVectorizedRect();
+    void testVectorizedGaussCircle();
+    void testVectorizedGaussRect();
+    void testVectorizedCurveCircle();
+    void testVectorizedCurveRect();
 };
 
 #endif
@@ -479,6 +479,37 @@ void KisPainterTest::testBitBltOldData()
     srcGc.deleteTransaction();
 }
 
+void KisPainterTest::testCopyAreaOptimizedSharesTiles()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->alpha8();
+
+    KisPaintDeviceSP src = new KisPaintDevice(cs);
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+
+    quint8 p1 = 128;
+    quint8 p2 = 129;
+    KoColor color1(&p1, cs);
+    KoColor color2(&p2, cs);
+
+    // the source has data in the first row of tiles only
+    src->fill(QRect(0,0,256,64), color1);
+    dst->fill(QRect(0,0,256,256), color2);
+
+    const QRect copyRect(0,0,256,256);
+    KisPainter::copyAreaOptimized(copyRect.topLeft(), src, dst, copyRect);
+
+    QVERIFY(TestUtil::checkAlphaDeviceFilledWithPixel(dst, QRect(0,0,256,64), p1));
+    QVERIFY(TestUtil::checkAlphaDeviceFilledWithPixel(dst, QRect(0,64,256,192), 0));
+
+    // the painted tiles are shared with the source...
+    KisTileSP srcTile = src->dataManager()->getTile(1, 0, false);
+    KisTileSP dstTile = dst->dataManager()->getTile(1, 0, false);
+    QCOMPARE(dstTile->tileData(), srcTile->tileData());
+
+    // ...and the empty ones are not allocated at all
+    QCOMPARE(dst->region(QRect(0,64,256,192)), QRegion());
+}
+
 void KisPainterTest::benchmarkBitBlt()
 {
     quint8 p = 128;
@@ -51,6 +51,7 @@ private Q_SLOTS:
     void testSelectionBitBltEraseCompositeOp();
 
     void testBitBltOldData();
+    void testCopyAreaOptimizedSharesTiles();
     void benchmarkBitBlt();
     void benchmarkBitBltOldData();
 
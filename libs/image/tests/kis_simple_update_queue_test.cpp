@@ -32,6 +32,7 @@
 
 #include "kis_update_job_item.h"
 #include "kis_simple_update_queue.h"
+#include "kis_image_config.h"
 #include "scheduler_utils.h"
 
 #include "lod_override.h"
@@ -277,5 +278,108 @@ void KisSimpleUpdateQueueTest::testSpontaneousJobsCompression()
     QCOMPARE(jobsList[0], job3);
 }
 
+void KisSimpleUpdateQueueTest::testAdaptivePatchSize()
+{
+    QRect imageRect(0,0,1024,1024);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "merge test");
+
+    KisPaintLayerSP paintLayer = new KisPaintLayer(image, "test", OPACITY_OPAQUE_U8);
+
+    image->lock();
+    image->addNode(paintLayer);
+    image->unlock();
+
+    QRect dirtyRect(0,0,300,300);
+
+    KisTestableUpdaterContext context(2);
+    KisTestableSimpleUpdateQueue queue;
+    KisWalkersList& walkersList = queue.getWalkersList();
+
+    /**
+     * Nothing has been measured yet, so the configured
+     * patch size is used
+     */
+    queue.processQueue(context);
+    queue.addUpdateJob(paintLayer, dirtyRect, imageRect, 0);
+    QCOMPARE(walkersList.size(), 1);
+    walkersList.clear();
+
+    /**
+     * The merge is very expensive and both threads are idle,
+     * the update should be split into small patches
+     */
+    context.testingReportMergeJob(100 * 512 * 512, 512 * 512, 10);
+    queue.processQueue(context);
+    queue.addUpdateJob(paintLayer, dirtyRect, imageRect, 0);
+    QVERIFY(walkersList.size() > 1);
+
+    Q_FOREACH (KisBaseRectsWalkerSP walker, walkersList) {
+        QVERIFY(walker->requestedRect().width() <= 256);
+        QVERIFY(walker->requestedRect().height() <= 256);
+    }
+    walkersList.clear();
+
+    /**
+     * The merge is almost free, the patches should grow
+     */
+    context.testingClearMergeCost();
+    context.testingReportMergeJob(512 * 512 / 100, 512 * 512, 1);
+    queue.processQueue(context);
+    queue.addUpdateJob(paintLayer, QRect(0,0,1000,1000), imageRect, 0);
+    QCOMPARE(walkersList.size(), 1);
+    walkersList.clear();
+}
+
+void KisSimpleUpdateQueueTest::testAdaptiveMergeAlphas()
+{
+    QRect imageRect(0,0,1024,1024);
+
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "merge test");
+
+    KisPaintLayerSP paintLayer = new KisPaintLayer(image, "test", OPACITY_OPAQUE_U8);
+
+    image->lock();
+    image->addNode(paintLayer);
+    image->unlock();
+
+    KisImageConfig config;
+    const qreal baseCollectAlpha = config.maxCollectAlpha();
+    const qreal baseMergeAlpha = config.maxMergeAlpha();
+    const qreal baseMergeCollectAlpha = config.maxMergeCollectAlpha();
+
+    KisTestableUpdaterContext context(2);
+    KisTestableSimpleUpdateQueue queue;
+    KisWalkersList& walkersList = queue.getWalkersList();
+
+    context.testingReportMergeJob(512 * 512, 512 * 512, 1);
+
+    /**
+     * The queue is empty, the alphas are moved halfway to 1.0
+     */
+    queue.processQueue(context);
+    QCOMPARE(queue.testingMaxCollectAlpha(), 1.0 + 0.5 * (baseCollectAlpha - 1.0));
+    QCOMPARE(queue.testingMaxMergeAlpha(), 1.0 + 0.5 * (baseMergeAlpha - 1.0));
+    QCOMPARE(queue.testingMaxMergeCollectAlpha(), 1.0 + 0.5 * (baseMergeCollectAlpha - 1.0));
+
+    /**
+     * The queue is much longer than the number of threads, still
+     * the alphas never exceed the configured values
+     */
+    for (int i = 0; i < 8; i++) {
+        queue.addUpdateJob(paintLayer, QRect(i * 120, i * 120, 10, 10), imageRect, 0);
+    }
+    QVERIFY(walkersList.size() >= 4);
+
+    queue.processQueue(context);
+    QCOMPARE(queue.testingMaxCollectAlpha(), baseCollectAlpha);
+    QCOMPARE(queue.testingMaxMergeAlpha(), baseMergeAlpha);
+    QCOMPARE(queue.testingMaxMergeCollectAlpha(), baseMergeCollectAlpha);
+
+    walkersList.clear();
+}
+
 QTEST_MAIN(KisSimpleUpdateQueueTest)
 
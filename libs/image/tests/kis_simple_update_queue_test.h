@@ -36,6 +36,8 @@ private Q_SLOTS:
     void testChecksum();
     void testMixingTypes();
     void testSpontaneousJobsCompression();
+    void testAdaptivePatchSize();
+    void testAdaptiveMergeAlphas();
 };
 
 #endif /* KIS_SIMPLE_UPDATE_QUEUE_TEST_H */
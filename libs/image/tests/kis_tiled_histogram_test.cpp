@@ -0,0 +1,219 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_tiled_histogram_test.h"
+
+#include <QTest>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_paint_device.h"
+#include "kis_iterator_ng.h"
+#include "kis_tiled_histogram.h"
+
+
+namespace {
+
+void fillRandomly(KisPaintDeviceSP dev, const QRect &rc, int seed)
+{
+    qsrand(seed);
+
+    const int pixelSize = dev->pixelSize();
+    KisSequentialIterator it(dev, rc);
+
+    do {
+        quint8 *pixel = it.rawData();
+        for (int i = 0; i < pixelSize; i++) {
+            pixel[i] = qrand() % 256;
+        }
+    } while (it.nextPixel());
+}
+
+KisTiledHistogram::Bins calculateDirectly(KisPaintDeviceSP dev, const QRect &bounds)
+{
+    const KoColorSpace *cs = dev->colorSpace();
+    const int numChannels = dev->channelCount();
+
+    KisTiledHistogram::Bins bins(numChannels,
+                                 std::vector<quint32>(KisTiledHistogram::NUM_BINS, 0));
+
+    KisSequentialConstIterator it(dev, bounds);
+
+    do {
+        for (int channel = 0; channel < numChannels; channel++) {
+            bins[channel][cs->scaleToU8(it.rawDataConst(), channel)]++;
+        }
+    } while (it.nextPixel());
+
+    return bins;
+}
+
+}
+
+void KisTiledHistogramTest::testFullCalculation()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect bounds(0, 0, 300, 200);
+    fillRandomly(dev, QRect(10, 20, 250, 150), 1);
+
+    KisTiledHistogram histogram(dev, bounds);
+    QCOMPARE(histogram.numChannels(), 4);
+    QVERIFY(histogram.isDirty());
+
+    histogram.recalculate();
+    QVERIFY(!histogram.isDirty());
+
+    QVERIFY(histogram.bins() == calculateDirectly(dev, bounds));
+
+    quint32 numPixels = 0;
+    Q_FOREACH (quint32 value, histogram.bins()[0]) {
+        numPixels += value;
+    }
+    QCOMPARE(numPixels, quint32(bounds.width() * bounds.height()));
+}
+
+void KisTiledHistogramTest::testIncrementalUpdate()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect bounds(0, 0, 400, 300);
+    fillRandomly(dev, bounds, 2);
+
+    KisTiledHistogram histogram(dev, bounds);
+    histogram.recalculate();
+    QVERIFY(histogram.bins() == calculateDirectly(dev, bounds));
+
+    const QRect changedRect(70, 50, 100, 20);
+    fillRandomly(dev, changedRect, 3);
+
+    histogram.invalidate(changedRect);
+    QVERIFY(histogram.isDirty());
+
+    histogram.recalculate();
+    QVERIFY(histogram.bins() == calculateDirectly(dev, bounds));
+
+    // the change outside the bounds is not counted
+    const QRect outerRect(350, 250, 100, 100);
+    dev->fill(outerRect, KoColor(Qt::red, cs));
+
+    histogram.invalidate(outerRect);
+    histogram.recalculate();
+    QVERIFY(histogram.bins() == calculateDirectly(dev, bounds));
+
+    // a rect that was not invalidated keeps the old values
+    dev->fill(QRect(0, 0, 10, 10), KoColor(Qt::red, cs));
+    histogram.recalculate();
+    QVERIFY(histogram.bins() != calculateDirectly(dev, bounds));
+
+    histogram.invalidate(QRect(5, 5, 1, 1));
+    histogram.recalculate();
+    QVERIFY(histogram.bins() == calculateDirectly(dev, bounds));
+}
+
+void KisTiledHistogramTest::testNegativeBounds()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect bounds(-100, -70, 250, 170);
+    fillRandomly(dev, bounds, 4);
+
+    KisTiledHistogram histogram(dev, bounds);
+    histogram.recalculate();
+    QVERIFY(histogram.bins() == calculateDirectly(dev, bounds));
+
+    const QRect changedRect(-65, -65, 2, 130);
+    fillRandomly(dev, changedRect, 5);
+
+    histogram.invalidate(changedRect);
+    histogram.recalculate();
+    QVERIFY(histogram.bins() == calculateDirectly(dev, bounds));
+}
+
+void KisTiledHistogramTest::testChangeBounds()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    fillRandomly(dev, QRect(0, 0, 500, 500), 6);
+
+    KisTiledHistogram histogram(dev, QRect(0, 0, 200, 200));
+    histogram.recalculate();
+
+    const QRect newBounds(30, 40, 350, 100);
+    histogram.setBounds(newBounds);
+    QCOMPARE(histogram.bounds(), newBounds);
+    QVERIFY(histogram.isDirty());
+
+    histogram.recalculate();
+    QVERIFY(histogram.bins() == calculateDirectly(dev, newBounds));
+}
+
+void KisTiledHistogramTest::testIncrementalBoundsChange()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    fillRandomly(dev, QRect(-50, -50, 700, 700), 7);
+
+    KisTiledHistogram histogram(dev, QRect(0, 0, 300, 300));
+    histogram.recalculate();
+
+    QList<QRect> boundsSequence;
+    boundsSequence << QRect(0, 0, 310, 300)       // grow to the right
+                   << QRect(-20, 0, 330, 450)     // grow to the left and down
+                   << QRect(10, 20, 200, 150)     // shrink on all sides
+                   << QRect(400, 400, 100, 100)   // move away completely
+                   << QRect(0, 0, 600, 600);      // cover everything
+
+    Q_FOREACH (const QRect &bounds, boundsSequence) {
+        histogram.setBounds(bounds);
+        histogram.recalculate();
+        QVERIFY(histogram.bins() == calculateDirectly(dev, bounds));
+    }
+
+    // the cells inside the area are not recounted
+    dev->fill(QRect(200, 200, 10, 10), KoColor(Qt::red, cs));
+    histogram.setBounds(QRect(0, 0, 601, 600));
+    histogram.recalculate();
+    QVERIFY(histogram.bins() != calculateDirectly(dev, QRect(0, 0, 601, 600)));
+}
+
+void KisTiledHistogramTest::testUniformCells()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect bounds(0, 0, 4 * KisTiledHistogram::CELL_SIZE, 3 * KisTiledHistogram::CELL_SIZE);
+    dev->fill(bounds, KoColor(Qt::black, cs));
+
+    KisTiledHistogram histogram(dev, bounds);
+    histogram.recalculate();
+
+    // every cell puts all its pixels into the same 16-bit bin
+    const quint32 numPixels = bounds.width() * bounds.height();
+    QCOMPARE(histogram.bins()[0][0], numPixels);
+    QCOMPARE(histogram.bins()[3][255], numPixels);
+}
+
+QTEST_MAIN(KisTiledHistogramTest)
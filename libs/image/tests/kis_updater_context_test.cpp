@@ -27,6 +27,7 @@
 
 #include "kis_merge_walker.h"
 #include "kis_updater_context.h"
+#include "kis_work_stealing_thread_pool.h"
 #include "kis_image.h"
 
 #include "scheduler_utils.h"
@@ -237,5 +238,59 @@ void KisUpdaterContextTest::stressTestExclusiveJobs()
              << "/" << NUM_CHECKS * NUM_JOBS;
 }
 
+class CountingRunnable : public QRunnable
+{
+public:
+    CountingRunnable(QAtomicInt &counter, bool autoDelete)
+        : m_counter(counter)
+    {
+        setAutoDelete(autoDelete);
+    }
+
+    void run() override {
+        m_counter.ref();
+    }
+
+private:
+    QAtomicInt &m_counter;
+};
+
+void KisUpdaterContextTest::testWorkStealingThreadPool()
+{
+    const int numJobs = 10000;
+
+    QAtomicInt counter;
+    CountingRunnable sharedJob(counter, false);
+
+    {
+        KisWorkStealingThreadPool pool(4);
+
+        /**
+         * Put everything into the queue of a single worker, so that
+         * the other workers have to steal it
+         */
+        for (int i = 0; i < numJobs; i++) {
+            pool.start(&sharedJob, 0);
+        }
+        pool.waitForDone();
+        QCOMPARE(counter.load(), numJobs);
+
+        for (int i = 0; i < numJobs; i++) {
+            pool.start(new CountingRunnable(counter, true));
+        }
+        pool.waitForDone();
+        QCOMPARE(counter.load(), 2 * numJobs);
+
+        dbgKrita << "Stolen jobs:" << pool.numStolenJobs();
+
+        // the destructor should wait for the pending jobs
+        for (int i = 0; i < numJobs; i++) {
+            pool.start(&sharedJob);
+        }
+    }
+
+    QCOMPARE(counter.load(), 3 * numJobs);
+}
+
 QTEST_MAIN(KisUpdaterContextTest)
 
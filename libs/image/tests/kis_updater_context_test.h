@@ -29,6 +29,7 @@ private Q_SLOTS:
     void testJobInterference();
     void testSnapshot();
     void stressTestExclusiveJobs();
+    void testWorkStealingThreadPool();
 };
 
 #endif /* KIS_UPDATER_CONTEXT_TEST_H */
@@ -71,6 +71,14 @@ protected:
     inline qint32 calcYInTile(qint32 y, qint32 row) const {
         return y - row * KisTileData::HEIGHT;
     }
+
+    /**
+     * Ask the data manager to load the tiles we are going to
+     * access next from the swap in the background
+     */
+    inline void prefetchTiles(qint32 leftCol, qint32 topRow, qint32 rightCol, qint32 bottomRow) {
+        m_dataManager->prefetchTiles(QRect(QPoint(leftCol, topRow), QPoint(rightCol, bottomRow)));
+    }
     
 private:
     KisIteratorCompleteListener *m_completeListener;
@@ -58,6 +58,9 @@ KisHLineIterator2::KisHLineIterator2(KisDataManager *dataManager, qint32 x, qint
 
     m_tileWidth = m_pixelSize * KisTileData::HEIGHT;
 
+    // the next row of tiles is loaded from swap while we are working on this one
+    prefetchTiles(m_leftCol, m_row + 1, m_rightCol, m_row + 1);
+
     // let's prealocate first row
     for (quint32 i = 0; i < m_tilesCacheSize; i++){
         fetchTileDataForCache(m_tilesCache[i], m_leftCol + i, m_row);
@@ -215,6 +218,8 @@ void KisHLineIterator2::fetchTileDataForCache(KisTileInfo& kti, qint32 col, qint
 
 void KisHLineIterator2::preallocateTiles()
 {
+    prefetchTiles(m_leftCol, m_row + 1, m_rightCol, m_row + 1);
+
     for (quint32 i = 0; i < m_tilesCacheSize; ++i){
         unlockTile(m_tilesCache[i].tile);
         unlockTile(m_tilesCache[i].oldtile);
@@ -209,6 +209,19 @@ void KisTile::unlock() const
 }
 
 
+void KisTile::prefetchTileData()
+{
+    /**
+     * COW mutex guarantees m_tileData will not be released
+     * while the prefetcher is taking its reference
+     */
+    QMutexLocker locker(&m_COWMutex);
+
+    if (!m_tileData->data()) {
+        KisTileDataStore::instance()->prefetchTileData(m_tileData);
+    }
+}
+
 #include <stdio.h>
 void KisTile::debugPrintInfo()
 {
@@ -113,6 +113,13 @@ public:
         return m_tileData;
     }
 
+    /**
+     * Asks the tile data store to load the data of the tile from
+     * the swap file in the background. This is only a hint, the
+     * data will be loaded on demand in any case.
+     */
+    void prefetchTileData();
+
 private:
     void init(qint32 col, qint32 row,
               KisTileData *defaultTileData, KisMementoManager* mm);
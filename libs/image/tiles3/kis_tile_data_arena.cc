@@ -0,0 +1,175 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_tile_data_arena.h"
+
+#include <stdlib.h>
+
+#include <QGlobalStatic>
+
+#include "kis_tile_data_interface.h"
+
+
+Q_GLOBAL_STATIC_WITH_ARGS(KisTileDataArena, s_instance,
+                          (__TILE_DATA_WIDTH * __TILE_DATA_HEIGHT))
+
+
+KisTileDataArena::KisTileDataArena(qint32 numPixelsInChunk)
+    : m_numPixelsInChunk(numPixelsInChunk),
+      m_cachedMetric(0),
+      m_cacheLimitMetric(0)
+{
+}
+
+KisTileDataArena::~KisTileDataArena()
+{
+    purge();
+}
+
+KisTileDataArena* KisTileDataArena::instance()
+{
+    return s_instance;
+}
+
+quint8* KisTileDataArena::allocate(qint32 pixelSize)
+{
+    Q_ASSERT(pixelSize > 0);
+
+    if (pixelSize > MAX_POOLED_PIXEL_SIZE) {
+        return (quint8*) ::malloc(chunkSize(pixelSize));
+    }
+
+    SizeClass &sizeClass = m_sizeClasses[pixelSize];
+
+    quint8 *ptr = 0;
+
+    if (sizeClass.freeChunks.pop(ptr)) {
+        m_cachedMetric.fetchAndAddOrdered(-pixelSize);
+        sizeClass.numReusedChunks.ref();
+    } else {
+        ptr = (quint8*) ::malloc(chunkSize(pixelSize));
+        sizeClass.numAllocatedChunks.ref();
+    }
+
+    sizeClass.numUsedChunks.ref();
+
+    return ptr;
+}
+
+void KisTileDataArena::free(quint8 *ptr, qint32 pixelSize)
+{
+    if (!ptr) return;
+
+    if (pixelSize > MAX_POOLED_PIXEL_SIZE) {
+        ::free(ptr);
+        return;
+    }
+
+    SizeClass &sizeClass = m_sizeClasses[pixelSize];
+    sizeClass.numUsedChunks.deref();
+
+    /**
+     * Reserve the space in the cache first, so that concurrent
+     * calls could never overshoot the limit
+     */
+    const int newCachedMetric =
+        m_cachedMetric.fetchAndAddOrdered(pixelSize) + pixelSize;
+
+    if (newCachedMetric <= m_cacheLimitMetric.load()) {
+        sizeClass.freeChunks.push(ptr);
+    } else {
+        m_cachedMetric.fetchAndAddOrdered(-pixelSize);
+        ::free(ptr);
+    }
+}
+
+void KisTileDataArena::setCacheLimit(qint64 bytes)
+{
+    const qint32 limitMetric = qMax(qint64(0), bytes / m_numPixelsInChunk);
+    m_cacheLimitMetric.store(limitMetric);
+
+    releaseCachedChunks(limitMetric);
+}
+
+qint64 KisTileDataArena::cacheLimit() const
+{
+    return qint64(m_cacheLimitMetric.load()) * m_numPixelsInChunk;
+}
+
+qint64 KisTileDataArena::cachedMemorySize() const
+{
+    return qint64(m_cachedMetric.load()) * m_numPixelsInChunk;
+}
+
+qint64 KisTileDataArena::usedMemorySize() const
+{
+    qint64 result = 0;
+
+    for (qint32 pixelSize = 1; pixelSize <= MAX_POOLED_PIXEL_SIZE; pixelSize++) {
+        result += qint64(m_sizeClasses[pixelSize].numUsedChunks.load()) *
+            chunkSize(pixelSize);
+    }
+
+    return result;
+}
+
+void KisTileDataArena::purge()
+{
+    releaseCachedChunks(0);
+}
+
+void KisTileDataArena::releaseCachedChunks(qint32 targetMetric)
+{
+    /**
+     * Start from the biggest chunks, they give back the most memory
+     * per a single free() call
+     */
+    for (qint32 pixelSize = MAX_POOLED_PIXEL_SIZE; pixelSize > 0; pixelSize--) {
+        SizeClass &sizeClass = m_sizeClasses[pixelSize];
+
+        quint8 *ptr = 0;
+        while (m_cachedMetric.load() > targetMetric &&
+               sizeClass.freeChunks.pop(ptr)) {
+
+            m_cachedMetric.fetchAndAddOrdered(-pixelSize);
+            ::free(ptr);
+        }
+    }
+}
+
+QVector<KisTileDataArena::Statistics> KisTileDataArena::statistics() const
+{
+    QVector<Statistics> result;
+
+    for (qint32 pixelSize = 1; pixelSize <= MAX_POOLED_PIXEL_SIZE; pixelSize++) {
+        const SizeClass &sizeClass = m_sizeClasses[pixelSize];
+
+        if (!sizeClass.numAllocatedChunks.load()) continue;
+
+        Statistics stats;
+        stats.pixelSize = pixelSize;
+        stats.numUsedChunks = sizeClass.numUsedChunks.load();
+        stats.numCachedChunks = sizeClass.freeChunks.size();
+        stats.numAllocatedChunks = sizeClass.numAllocatedChunks.load();
+        stats.numReusedChunks = sizeClass.numReusedChunks.load();
+
+        result << stats;
+    }
+
+    return result;
+}
@@ -0,0 +1,153 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_TILE_DATA_ARENA_H
+#define __KIS_TILE_DATA_ARENA_H
+
+#include <QAtomicInt>
+#include <QVector>
+
+#include "kis_lockless_stack.h"
+
+
+/**
+ * Allocates the pixel buffers of the tile data objects.
+ *
+ * Every pixel size has its own size class with a separate list of
+ * free chunks, so the tiles of an RGBA8 document never fragment the
+ * chunks of an RGBA-F32 one and vice versa. The freed chunks are kept
+ * for reuse until the total size of the cached chunks reaches the
+ * high-water mark (cacheLimit()). Everything above the limit is given
+ * back to the system immediately, so the resident size of the process
+ * follows the real number of tiles instead of the historical maximum,
+ * as it used to be with the boost pools.
+ *
+ * The chunks bigger than MAX_POOLED_PIXEL_SIZE bytes per pixel are
+ * never cached.
+ *
+ * All the methods are thread-safe and lock-free.
+ */
+class KisTileDataArena
+{
+public:
+    struct Statistics
+    {
+        Statistics()
+            : pixelSize(0),
+              numUsedChunks(0),
+              numCachedChunks(0),
+              numAllocatedChunks(0),
+              numReusedChunks(0)
+        {
+        }
+
+        qint32 pixelSize;
+
+        /**
+         * Number of chunks currently owned by the tiles
+         */
+        qint64 numUsedChunks;
+
+        /**
+         * Number of free chunks kept for reuse
+         */
+        qint64 numCachedChunks;
+
+        /**
+         * Total number of chunks requested from the system
+         */
+        qint64 numAllocatedChunks;
+
+        /**
+         * Total number of allocations served from the cached chunks
+         */
+        qint64 numReusedChunks;
+    };
+
+    static const qint32 MAX_POOLED_PIXEL_SIZE = 32;
+
+public:
+    KisTileDataArena(qint32 numPixelsInChunk);
+    ~KisTileDataArena();
+
+    static KisTileDataArena* instance();
+
+    quint8* allocate(qint32 pixelSize);
+    void free(quint8 *ptr, qint32 pixelSize);
+
+    /**
+     * Sets the high-water mark for the size of the cached chunks
+     * (in bytes). If the cache is already bigger than that, the
+     * extra chunks are released immediately.
+     */
+    void setCacheLimit(qint64 bytes);
+    qint64 cacheLimit() const;
+
+    /**
+     * The size of the free chunks kept for reuse (in bytes)
+     */
+    qint64 cachedMemorySize() const;
+
+    /**
+     * The size of the chunks currently owned by the tiles (in bytes)
+     */
+    qint64 usedMemorySize() const;
+
+    /**
+     * Releases all the cached chunks back to the system
+     */
+    void purge();
+
+    /**
+     * Returns the counters of every size class that has ever been
+     * used
+     */
+    QVector<Statistics> statistics() const;
+
+private:
+    struct SizeClass
+    {
+        KisLocklessStack<quint8*> freeChunks;
+
+        QAtomicInt numUsedChunks;
+        QAtomicInt numAllocatedChunks;
+        QAtomicInt numReusedChunks;
+    };
+
+    inline qint32 chunkSize(qint32 pixelSize) const {
+        return pixelSize * m_numPixelsInChunk;
+    }
+
+    void releaseCachedChunks(qint32 targetMetric);
+
+private:
+    Q_DISABLE_COPY(KisTileDataArena)
+
+    const qint32 m_numPixelsInChunk;
+
+    /**
+     * The sizes are measured in the units of m_numPixelsInChunk bytes,
+     * so a chunk of a size class takes exactly pixelSize units
+     */
+    QAtomicInt m_cachedMetric;
+    QAtomicInt m_cacheLimitMetric;
+
+    SizeClass m_sizeClasses[MAX_POOLED_PIXEL_SIZE + 1];
+};
+
+#endif /* __KIS_TILE_DATA_ARENA_H */
@@ -23,6 +23,7 @@
 #include "kis_tile_data_store_iterators.h"
 #include "kis_debug.h"
 #include "kis_tile_data_pooler.h"
+#include "kis_tile_data_arena.h"
 #include "kis_image_config.h"
 
 
@@ -101,6 +102,7 @@ KisTileDataPooler::KisTileDataPooler(KisTileDataStore *store, qint32 memoryLimit
     else {
         KisImageConfig config;
         m_memoryLimit = MiB_TO_METRIC(config.poolLimit());
+        KisTileDataArena::instance()->setCacheLimit(config.tilesArenaLimit() * MiB);
     }
 }
 
@@ -394,4 +396,5 @@ void KisTileDataPooler::testingRereadConfig()
 {
     KisImageConfig config;
     m_memoryLimit = MiB_TO_METRIC(config.poolLimit());
+    KisTileDataArena::instance()->setCacheLimit(config.tilesArenaLimit() * MiB);
 }
@@ -26,6 +26,7 @@
 #include "kis_debug.h"
 
 #include "kis_tile_data_store_iterators.h"
+#include "kis_tile_data_arena.h"
 
 Q_GLOBAL_STATIC(KisTileDataStore, s_instance)
 
@@ -69,16 +70,19 @@ qint64 __preclone_miss_age = 0;
 KisTileDataStore::KisTileDataStore()
     : m_pooler(this),
       m_swapper(this),
+      m_prefetcher(this),
       m_numTiles(0),
       m_memoryMetric(0)
 {
     m_clockIterator = m_tileDataList.end();
     m_pooler.start();
     m_swapper.start();
+    m_prefetcher.start();
 }
 
 KisTileDataStore::~KisTileDataStore()
 {
+    m_prefetcher.terminatePrefetcher();
     m_pooler.terminatePooler();
     m_swapper.terminateSwapper();
 
@@ -106,7 +110,18 @@ KisTileDataStore::MemoryStatistics KisTileDataStore::memoryStatistics()
     stats.historicalMemorySize = m_pooler.lastHistoricalMemoryMetric() * metricCoeff;
     stats.poolSize = m_pooler.lastPoolMemoryMetric() * metricCoeff;
 
-    stats.totalMemorySize = memoryMetric() * metricCoeff + stats.poolSize;
+    KisTileDataArena *arena = KisTileDataArena::instance();
+    stats.arenaSize = arena->cachedMemorySize();
+    stats.arenaLimit = arena->cacheLimit();
+    stats.arenaNumAllocatedChunks = 0;
+    stats.arenaNumReusedChunks = 0;
+
+    Q_FOREACH (const KisTileDataArena::Statistics &sizeClass, arena->statistics()) {
+        stats.arenaNumAllocatedChunks += sizeClass.numAllocatedChunks;
+        stats.arenaNumReusedChunks += sizeClass.numReusedChunks;
+    }
+
+    stats.totalMemorySize = memoryMetric() * metricCoeff + stats.poolSize + stats.arenaSize;
 
     stats.swapSize = m_swappedStore.totalMemoryMetric() * metricCoeff;
 
@@ -261,6 +276,46 @@ bool KisTileDataStore::trySwapTileData(KisTileData *td)
     return result;
 }
 
+bool KisTileDataStore::tryQueueSwapTileData(KisTileData *td)
+{
+    /**
+     * This function is called with m_listLock acquired
+     */
+
+    if(!td->m_swapLock.tryLockForWrite()) return false;
+
+    if(!td->data()) {
+        td->m_swapLock.unlock();
+        return false;
+    }
+
+    /**
+     * The swap lock is kept until the data is actually swapped
+     * out, so nobody can access the data in the meantime
+     */
+    unregisterTileDataImp(td);
+    m_swapOutQueue.append(td);
+
+    return true;
+}
+
+void KisTileDataStore::swapOutQueuedTileData()
+{
+    /**
+     * This function is called with m_listLock acquired
+     */
+
+    if(m_swapOutQueue.isEmpty()) return;
+
+    m_swappedStore.swapOutTileData(m_swapOutQueue);
+
+    Q_FOREACH (KisTileData *td, m_swapOutQueue) {
+        td->m_swapLock.unlock();
+    }
+
+    m_swapOutQueue.clear();
+}
+
 KisTileDataStoreIterator* KisTileDataStore::beginIteration()
 {
     m_listLock.lock();
@@ -312,8 +367,9 @@ void KisTileDataStore::debugSwapAll()
     KisTileData *item;
     while(iter->hasNext()) {
         item = iter->next();
-        iter->trySwapOut(item);
+        iter->tryQueueSwapOut(item);
     }
+    swapOutQueuedTileData();
     endIteration(iter);
 
 //    dbgKrita << "Number of tiles:" << numTiles();
@@ -339,6 +395,7 @@ void KisTileDataStore::debugClear()
 void KisTileDataStore::testingRereadConfig() {
     m_pooler.testingRereadConfig();
     m_swapper.testingRereadConfig();
+    m_swappedStore.testingRereadConfig();
     kickPooler();
 }
 
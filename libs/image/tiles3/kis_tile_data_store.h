@@ -21,11 +21,13 @@
 #include "kritaimage_export.h"
 
 #include <QReadWriteLock>
+#include <QVector>
 #include "kis_tile_data_interface.h"
 
 #include "kis_tile_data_pooler.h"
 #include "swap/kis_tile_data_swapper.h"
 #include "swap/kis_swapped_data_store.h"
+#include "swap/kis_tile_data_prefetcher.h"
 
 class KisTileDataStoreIterator;
 class KisTileDataStoreReverseIterator;
@@ -50,6 +52,11 @@ public:
 
         qint64 poolSize;
 
+        qint64 arenaSize;
+        qint64 arenaLimit;
+        qint64 arenaNumAllocatedChunks;
+        qint64 arenaNumReusedChunks;
+
         qint64 swapSize;
     };
 
@@ -70,6 +77,14 @@ public:
         return m_numTiles;
     }
 
+    /**
+     * Returns true if some of the tile data objects are swapped
+     * out. Used as a quick check before prefetching the tiles.
+     */
+    inline bool hasSwappedTileData() const {
+        return m_swappedStore.numTiles() > 0;
+    }
+
     inline void checkFreeMemory() {
         m_swapper.checkFreeMemory();
     }
@@ -109,6 +124,27 @@ public:
      */
     bool trySwapTileData(KisTileData *td);
 
+    /**
+     * Try to put the tile data into the queue of the tiles waiting
+     * to be swapped out. The tile data is locked and removed from
+     * the list of the tiles in memory immediately, but the data is
+     * actually swapped out only in swapOutQueuedTileData(), which
+     * compresses the whole queue in parallel.
+     * It may fail in case the tile is being accessed
+     * at the same moment of time.
+     * LOCKING: both functions should be called with m_listLock
+     *          acquired, that is while iterating the store
+     */
+    bool tryQueueSwapTileData(KisTileData *td);
+    void swapOutQueuedTileData();
+
+    /**
+     * Returns the number of tiles waiting in the swap-out queue
+     */
+    inline qint32 numQueuedTileData() const {
+        return m_swapOutQueue.size();
+    }
+
 
     /**
      * WARN: The following three method are only for usage
@@ -131,6 +167,17 @@ public:
      */
     void ensureTileDataLoaded(KisTileData *td);
 
+    /**
+     * Asks the prefetcher thread to load \p td from the swap in
+     * the background. Does nothing if the data is already in memory.
+     * PRECONDITIONS: the caller guarantees \p td will not be freed
+     *                during the call (e.g. holds the COW lock of
+     *                the tile owning it)
+     */
+    inline void prefetchTileData(KisTileData *td) {
+        m_prefetcher.prefetch(td);
+    }
+
 private:
     KisTileData *allocTileData(qint32 pixelSize, const quint8 *defPixel);
 
@@ -154,6 +201,7 @@ private:
 private:
     KisTileDataPooler m_pooler;
     KisTileDataSwapper m_swapper;
+    KisTileDataPrefetcher m_prefetcher;
 
     friend class KisTileDataStoreTest;
     friend class KisTileDataPoolerTest;
@@ -165,6 +213,12 @@ private:
     KisTileDataList m_tileDataList;
     qint32 m_numTiles;
 
+    /**
+     * Tile data objects locked for swapping out
+     * \see tryQueueSwapTileData()
+     */
+    QVector<KisTileData*> m_swapOutQueue;
+
     /**
      * This metric is used for computing the volume
      * of memory occupied by tile data objects.
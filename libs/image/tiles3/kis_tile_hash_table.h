@@ -30,6 +30,17 @@
  * col()/row() methods and be able to answer setNext()/next() requests to
  * be   stored   here.    It   is   used   in   KisTiledDataManager   and
  * KisMementoManager.
+ *
+ * Locking scheme: the table has two levels of locks. The global lock
+ * (m_lock) guards the structure of the table, that is the array of
+ * buckets itself. It is taken for reading by all the regular lookup
+ * and modification functions and for writing only when the table is
+ * resized, cleared or walked through by an iterator. The buckets
+ * are guarded by an array of striped locks, so concurrent threads
+ * accessing different tiles don't contend on the same mutex.
+ *
+ * The table grows twice every time the number of tiles exceeds the
+ * number of buckets, so the chains stay short even on huge images.
  */
 
 template<class T>
@@ -48,7 +59,7 @@ public:
     ~KisTileHashTableTraits();
 
     bool isEmpty() {
-        return !m_numTiles;
+        return !m_numTiles.load();
     }
 
     bool tileExists(qint32 col, qint32 row);
@@ -90,7 +101,7 @@ public:
     KisTileData* defaultTileData() const;
 
     qint32 numTiles() {
-        return m_numTiles;
+        return m_numTiles.load();
     }
 
     void debugPrintInfo();
@@ -104,7 +115,12 @@ private:
     inline void setDefaultTileDataImp(KisTileData *defaultTileData);
     inline KisTileData* defaultTileDataImp() const;
 
-    static inline quint32 calculateHash(qint32 col, qint32 row);
+    inline quint32 calculateHash(qint32 col, qint32 row) const;
+    inline QReadWriteLock* stripeLock(quint32 idx) const;
+
+    void allocateTable(qint32 tableBits);
+    void maybeGrow();
+    void resizeTable(qint32 newTableBits);
 
     inline qint32 debugChainLen(qint32 idx);
     void debugListLengthDistibution();
@@ -112,14 +128,20 @@ private:
 private:
     template<class U> friend class KisTileHashTableIteratorTraits;
 
-    static const qint32 TABLE_SIZE = 1024;
+    static const qint32 INITIAL_TABLE_BITS = 10;
+    static const qint32 MAX_TABLE_BITS = 20;
+    static const qint32 NUM_LOCK_STRIPES = 64;
+
     TileTypeSP *m_hashTable;
-    qint32 m_numTiles;
+    qint32 m_tableBits;
+    qint32 m_tableSize;
+    QAtomicInt m_numTiles;
 
     KisTileData *m_defaultTileData;
     KisMementoManager *m_mementoManager;
 
     mutable QReadWriteLock m_lock;
+    mutable QReadWriteLock m_stripeLocks[NUM_LOCK_STRIPES];
 };
 
 #include "kis_tile_hash_table_p.h"
@@ -141,11 +163,11 @@ public:
 
     KisTileHashTableIteratorTraits(KisTileHashTableTraits<T> *ht) {
         m_hashTable = ht;
+        m_hashTable->m_lock.lockForWrite();
+
         m_index = nextNonEmptyList(0);
-        if (m_index < KisTileHashTableTraits<T>::TABLE_SIZE)
+        if (m_index < m_hashTable->m_tableSize)
             m_tile = m_hashTable->m_hashTable[m_index];
-
-        m_hashTable->m_lock.lockForWrite();
     }
 
     ~KisTileHashTableIteratorTraits<T>() {
@@ -163,7 +185,7 @@ public:
             m_tile = m_tile->next();
             if (!m_tile) {
                 qint32 idx = nextNonEmptyList(m_index + 1);
-                if (idx < KisTileHashTableTraits<T>::TABLE_SIZE) {
+                if (idx < m_hashTable->m_tableSize) {
                     m_index = idx;
                     m_tile = m_hashTable->m_hashTable[idx];
                 } else {
@@ -208,7 +230,7 @@ protected:
     qint32 nextNonEmptyList(qint32 startIdx) {
         qint32 idx = startIdx;
 
-        while (idx < KisTileHashTableTraits<T>::TABLE_SIZE &&
+        while (idx < m_hashTable->m_tableSize &&
                 !m_hashTable->m_hashTable[idx]) {
             idx++;
         }
@@ -28,10 +28,10 @@ template<class T>
 KisTileHashTableTraits<T>::KisTileHashTableTraits(KisMementoManager *mm)
         : m_lock(QReadWriteLock::NonRecursive)
 {
-    m_hashTable = new TileTypeSP [TABLE_SIZE];
-    Q_CHECK_PTR(m_hashTable);
+    m_hashTable = 0;
+    allocateTable(INITIAL_TABLE_BITS);
 
-    m_numTiles = 0;
+    m_numTiles.store(0);
     m_defaultTileData = 0;
     m_mementoManager = mm;
 }
@@ -41,20 +41,27 @@ KisTileHashTableTraits<T>::KisTileHashTableTraits(const KisTileHashTableTraits<T
         KisMementoManager *mm)
         : m_lock(QReadWriteLock::NonRecursive)
 {
-    QReadLocker locker(&ht.m_lock);
+    /**
+     * Take the structure lock for writing to be sure no bucket of the
+     * source table is changed while we are copying it
+     */
+    QWriteLocker locker(&ht.m_lock);
 
     m_mementoManager = mm;
     m_defaultTileData = 0;
     setDefaultTileDataImp(ht.m_defaultTileData);
 
-    m_hashTable = new TileTypeSP [TABLE_SIZE];
-    Q_CHECK_PTR(m_hashTable);
-
+    /**
+     * The size of the table is kept the same, so the tiles are
+     * guaranteed to fall into the buckets with the same indexes
+     */
+    m_hashTable = 0;
+    allocateTable(ht.m_tableBits);
 
     TileTypeSP foreignTile;
     TileTypeSP nativeTile;
     TileTypeSP nativeTileHead;
-    for (qint32 i = 0; i < TABLE_SIZE; i++) {
+    for (qint32 i = 0; i < m_tableSize; i++) {
         nativeTileHead = 0;
 
         foreignTile = ht.m_hashTable[i];
@@ -68,7 +75,7 @@ KisTileHashTableTraits<T>::KisTileHashTableTraits(const KisTileHashTableTraits<T
 
         m_hashTable[i] = nativeTileHead;
     }
-    m_numTiles = ht.m_numTiles;
+    m_numTiles.store(ht.m_numTiles.load());
 }
 
 template<class T>
@@ -80,9 +87,37 @@ KisTileHashTableTraits<T>::~KisTileHashTableTraits()
 }
 
 template<class T>
-quint32 KisTileHashTableTraits<T>::calculateHash(qint32 col, qint32 row)
+void KisTileHashTableTraits<T>::allocateTable(qint32 tableBits)
 {
-    return ((row << 5) + (col & 0x1F)) & 0x3FF;
+    Q_ASSERT(!m_hashTable);
+
+    m_tableBits = tableBits;
+    m_tableSize = 1 << tableBits;
+
+    m_hashTable = new TileTypeSP [m_tableSize];
+    Q_CHECK_PTR(m_hashTable);
+}
+
+template<class T>
+quint32 KisTileHashTableTraits<T>::calculateHash(qint32 col, qint32 row) const
+{
+    /**
+     * Multiplicative (Fibonacci) hashing of the packed coordinates. The
+     * upper bits of the product depend on all the bits of the key, so
+     * we can take any number of them to index a power-of-two table.
+     */
+    const quint32 key = (quint32(row) << 16) ^ (quint32(col) & 0xFFFF);
+    return (key * 2654435769U) >> (32 - m_tableBits);
+}
+
+template<class T>
+inline QReadWriteLock* KisTileHashTableTraits<T>::stripeLock(quint32 idx) const
+{
+    /**
+     * The table never has less buckets than the stripes, so every
+     * bucket is guarded by exactly one stripe lock
+     */
+    return &m_stripeLocks[idx & (NUM_LOCK_STRIPES - 1)];
 }
 
 template<class T>
@@ -116,7 +151,7 @@ void KisTileHashTableTraits<T>::linkTile(TileTypeSP tile)
 
     tile->setNext(firstTile);
     m_hashTable[idx] = tile;
-    m_numTiles++;
+    m_numTiles.ref();
 }
 
 template<class T>
@@ -146,7 +181,7 @@ KisTileHashTableTraits<T>::unlinkTile(qint32 col, qint32 row)
             tile->notifyDead();
             tile = TileTypeSP();
 
-            m_numTiles--;
+            m_numTiles.deref();
             return tile;
         }
         prevTile = tile;
@@ -155,6 +190,58 @@ KisTileHashTableTraits<T>::unlinkTile(qint32 col, qint32 row)
     return TileTypeSP();
 }
 
+template<class T>
+void KisTileHashTableTraits<T>::maybeGrow()
+{
+    /**
+     * Keep the average length of the chain below one. The check is
+     * done without any lock, so we should recheck it after the
+     * structure lock is taken.
+     */
+    if (m_numTiles.load() <= m_tableSize ||
+        m_tableBits >= MAX_TABLE_BITS) return;
+
+    QWriteLocker locker(&m_lock);
+
+    if (m_numTiles.load() > m_tableSize &&
+        m_tableBits < MAX_TABLE_BITS) {
+
+        resizeTable(m_tableBits + 1);
+    }
+}
+
+template<class T>
+void KisTileHashTableTraits<T>::resizeTable(qint32 newTableBits)
+{
+    /**
+     * We assume the structure lock has already been taken for writing
+     */
+
+    TileTypeSP *oldTable = m_hashTable;
+    const qint32 oldTableSize = m_tableSize;
+
+    m_hashTable = 0;
+    allocateTable(newTableBits);
+
+    for (qint32 i = 0; i < oldTableSize; i++) {
+        TileTypeSP tile = oldTable[i];
+
+        while (tile) {
+            TileTypeSP next = tile->next();
+
+            const qint32 idx = calculateHash(tile->col(), tile->row());
+            tile->setNext(m_hashTable[idx]);
+            m_hashTable[idx] = tile;
+
+            tile = next;
+        }
+
+        oldTable[i] = 0;
+    }
+
+    delete[] oldTable;
+}
+
 template<class T>
 inline void KisTileHashTableTraits<T>::setDefaultTileDataImp(KisTileData *defaultTileData)
 {
@@ -179,8 +266,7 @@ inline KisTileData* KisTileHashTableTraits<T>::defaultTileDataImp() const
 template<class T>
 bool KisTileHashTableTraits<T>::tileExists(qint32 col, qint32 row)
 {
-    QReadLocker locker(&m_lock);
-    return getTile(col, row);
+    return getExistedTile(col, row);
 }
 
 template<class T>
@@ -188,6 +274,8 @@ typename KisTileHashTableTraits<T>::TileTypeSP
 KisTileHashTableTraits<T>::getExistedTile(qint32 col, qint32 row)
 {
     QReadLocker locker(&m_lock);
+    QReadLocker stripeLocker(stripeLock(calculateHash(col, row)));
+
     return getTile(col, row);
 }
 
@@ -196,17 +284,35 @@ typename KisTileHashTableTraits<T>::TileTypeSP
 KisTileHashTableTraits<T>::getTileLazy(qint32 col, qint32 row,
                                        bool& newTile)
 {
-    /**
-     * FIXME: Read access is better
-     */
-    QWriteLocker locker(&m_lock);
-
     newTile = false;
-    TileTypeSP tile = getTile(col, row);
-    if (!tile) {
-        tile = new TileType(col, row, m_defaultTileData, m_mementoManager);
-        linkTile(tile);
-        newTile = true;
+    TileTypeSP tile;
+
+    {
+        QReadLocker locker(&m_lock);
+        QReadWriteLock *lock = stripeLock(calculateHash(col, row));
+
+        /**
+         * Most of the requests come for already existing tiles,
+         * so try to find the tile under the shared lock first
+         */
+        lock->lockForRead();
+        tile = getTile(col, row);
+        lock->unlock();
+
+        if (tile) return tile;
+
+        QWriteLocker stripeLocker(lock);
+
+        tile = getTile(col, row);
+        if (!tile) {
+            tile = new TileType(col, row, m_defaultTileData, m_mementoManager);
+            linkTile(tile);
+            newTile = true;
+        }
+    }
+
+    if (newTile) {
+        maybeGrow();
     }
 
     return tile;
@@ -217,6 +323,7 @@ typename KisTileHashTableTraits<T>::TileTypeSP
 KisTileHashTableTraits<T>::getReadOnlyTileLazy(qint32 col, qint32 row)
 {
     QReadLocker locker(&m_lock);
+    QReadLocker stripeLocker(stripeLock(calculateHash(col, row)));
 
     TileTypeSP tile = getTile(col, row);
     if (!tile)
@@ -228,14 +335,20 @@ KisTileHashTableTraits<T>::getReadOnlyTileLazy(qint32 col, qint32 row)
 template<class T>
 void KisTileHashTableTraits<T>::addTile(TileTypeSP tile)
 {
-    QWriteLocker locker(&m_lock);
-    linkTile(tile);
+    {
+        QReadLocker locker(&m_lock);
+        QWriteLocker stripeLocker(stripeLock(calculateHash(tile->col(), tile->row())));
+        linkTile(tile);
+    }
+
+    maybeGrow();
 }
 
 template<class T>
 void KisTileHashTableTraits<T>::deleteTile(qint32 col, qint32 row)
 {
-    QWriteLocker locker(&m_lock);
+    QReadLocker locker(&m_lock);
+    QWriteLocker stripeLocker(stripeLock(calculateHash(col, row)));
 
     TileTypeSP tile = unlinkTile(col, row);
 
@@ -258,7 +371,7 @@ void KisTileHashTableTraits<T>::clear()
     TileTypeSP tile = TileTypeSP();
     qint32 i;
 
-    for (i = 0; i < TABLE_SIZE; i++) {
+    for (i = 0; i < m_tableSize; i++) {
         tile = m_hashTable[i];
 
         while (tile) {
@@ -273,13 +386,13 @@ void KisTileHashTableTraits<T>::clear()
             tmp->notifyDead();
             tmp = 0;
 
-            m_numTiles--;
+            m_numTiles.deref();
         }
 
         m_hashTable[i] = 0;
     }
 
-    Q_ASSERT(!m_numTiles);
+    Q_ASSERT(!m_numTiles.load());
 }
 
 template<class T>
@@ -305,7 +418,8 @@ void KisTileHashTableTraits<T>::debugPrintInfo()
     dbgTiles << "==========================\n"
              << "TileHashTable:"
              << "\n   def. data:\t\t" << m_defaultTileData
-             << "\n   numTiles:\t\t" << m_numTiles;
+             << "\n   numTiles:\t\t" << m_numTiles.load()
+             << "\n   tableSize:\t\t" << m_tableSize;
     debugListLengthDistibution();
     dbgTiles << "==========================\n";
 }
@@ -323,10 +437,10 @@ void KisTileHashTableTraits<T>::debugMaxListLength(qint32 &min, qint32 &max)
 {
     TileTypeSP tile;
     qint32 maxLen = 0;
-    qint32 minLen = m_numTiles;
+    qint32 minLen = m_numTiles.load();
     qint32 tmp = 0;
 
-    for (qint32 i = 0; i < TABLE_SIZE; i++) {
+    for (qint32 i = 0; i < m_tableSize; i++) {
         tmp = debugChainLen(i);
         if (tmp > maxLen)
             maxLen = tmp;
@@ -351,7 +465,7 @@ void KisTileHashTableTraits<T>::debugListLengthDistibution()
     qint32 *array = new qint32[arraySize];
     memset(array, 0, sizeof(qint32)*arraySize);
 
-    for (qint32 i = 0; i < TABLE_SIZE; i++) {
+    for (qint32 i = 0; i < m_tableSize; i++) {
         tmp = debugChainLen(i);
         array[tmp-min]++;
     }
@@ -378,7 +492,7 @@ void KisTileHashTableTraits<T>::sanityChecksumCheck()
     TileTypeSP tile = 0;
     qint32 exactNumTiles = 0;
 
-    for (qint32 i = 0; i < TABLE_SIZE; i++) {
+    for (qint32 i = 0; i < m_tableSize; i++) {
         tile = m_hashTable[i];
         while (tile) {
             exactNumTiles++;
@@ -386,10 +500,10 @@ void KisTileHashTableTraits<T>::sanityChecksumCheck()
         }
     }
 
-    if (exactNumTiles != m_numTiles) {
+    if (exactNumTiles != m_numTiles.load()) {
         dbgKrita << "Sanity check failed!";
         dbgKrita << ppVar(exactNumTiles);
-        dbgKrita << ppVar(m_numTiles);
+        dbgKrita << ppVar(m_numTiles.load());
         dbgKrita << "Wrong tiles checksum!";
         Q_ASSERT(0); // not fatalKrita for a backtrace support
     }
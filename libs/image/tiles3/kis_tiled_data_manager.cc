@@ -130,22 +130,23 @@ bool KisTiledDataManager::write(KisPaintDeviceWriter &store)
     }
 
 
+    if (!retval) return false;
+
+    QVector<KisTileSP> tiles;
+    tiles.reserve(m_hashTable->numTiles());
+
     KisTileHashTableIterator iter(m_hashTable);
     KisTileSP tile;
 
-    KisAbstractTileCompressorSP compressor =
-        KisTileCompressorFactory::create(CURRENT_VERSION);
-
     while ((tile = iter.tile())) {
-        retval = compressor->writeTile(tile, store);
-        if (!retval) {
-            warnFile << "Failed to write tile";
-            break;
-        }
+        tiles.append(tile);
         ++iter;
     }
 
-    return retval;
+    KisAbstractTileCompressorSP compressor =
+        KisTileCompressorFactory::create(CURRENT_VERSION);
+
+    return compressor->writeTiles(tiles, store);
 }
 bool KisTiledDataManager::read(QIODevice *stream)
 {
@@ -185,12 +186,7 @@ bool KisTiledDataManager::read(QIODevice *stream)
     KisAbstractTileCompressorSP compressor =
         KisTileCompressorFactory::create(tilesVersion);
 
-    bool readSuccess = true;
-    for (quint32 i = 0; i < numTiles; i++) {
-        if (!compressor->readTile(stream, this)) {
-            readSuccess = false;
-        }
-    }
+    bool readSuccess = compressor->readTiles(stream, this, numTiles);
 
     m_mementoManager->commit();
     return readSuccess;
@@ -457,6 +453,12 @@ void KisTiledDataManager::clear()
 }
 
 
+bool KisTiledDataManager::hasSameDefaultPixel(const KisTiledDataManager *other) const
+{
+    return m_pixelSize == other->m_pixelSize &&
+        !memcmp(m_defaultPixel, other->m_defaultPixel, m_pixelSize);
+}
+
 template<bool useOldSrcData>
 void KisTiledDataManager::bitBltImpl(KisTiledDataManager *srcDM, const QRect &rect)
 {
@@ -473,18 +475,37 @@ void KisTiledDataManager::bitBltImpl(KisTiledDataManager *srcDM, const QRect &re
     qint32 firstRow = yToRow(rect.top());
     qint32 lastRow = yToRow(rect.bottom());
 
+    const bool canSkipDefaultTiles = !useOldSrcData && hasSameDefaultPixel(srcDM);
+    bool needsRecalculateExtent = false;
+
     for (qint32 row = firstRow; row <= lastRow; ++row) {
         for (qint32 column = firstColumn; column <= lastColumn; ++column) {
 
+            QRect tileRect(column*KisTileData::WIDTH, row*KisTileData::HEIGHT,
+                           KisTileData::WIDTH, KisTileData::HEIGHT);
+            QRect cloneTileRect = rect & tileRect;
+
+            /**
+             * There is no need to allocate a tile for an empty area of
+             * the source: just drop our own tile, and the default one
+             * will be shared instead
+             */
+            if (canSkipDefaultTiles &&
+                cloneTileRect == tileRect &&
+                !srcDM->m_hashTable->tileExists(column, row)) {
+
+                if (m_hashTable->tileExists(column, row)) {
+                    m_hashTable->deleteTile(column, row);
+                    needsRecalculateExtent = true;
+                }
+                continue;
+            }
+
             // this is the only variation in the template
             KisTileSP srcTile = useOldSrcData ?
                 srcDM->getOldTile(column, row) :
                 srcDM->getTile(column, row, false);
 
-            QRect tileRect(column*KisTileData::WIDTH, row*KisTileData::HEIGHT,
-                           KisTileData::WIDTH, KisTileData::HEIGHT);
-            QRect cloneTileRect = rect & tileRect;
-
             if (cloneTileRect == tileRect) {
                  // Clone whole tile
                  m_hashTable->deleteTile(column, row);
@@ -520,6 +541,10 @@ void KisTiledDataManager::bitBltImpl(KisTiledDataManager *srcDM, const QRect &re
             }
         }
     }
+
+    if (needsRecalculateExtent) {
+        recalculateExtent();
+    }
 }
 
 template<bool useOldSrcData>
@@ -535,6 +560,9 @@ void KisTiledDataManager::bitBltRoughImpl(KisTiledDataManager *srcDM, const QRec
     qint32 firstRow = yToRow(rect.top());
     qint32 lastRow = yToRow(rect.bottom());
 
+    const bool canSkipDefaultTiles = !useOldSrcData && hasSameDefaultPixel(srcDM);
+    bool needsRecalculateExtent = false;
+
     for (qint32 row = firstRow; row <= lastRow; ++row) {
         for (qint32 column = firstColumn; column <= lastColumn; ++column) {
 
@@ -543,6 +571,16 @@ void KisTiledDataManager::bitBltRoughImpl(KisTiledDataManager *srcDM, const QRec
              * to check any borders :)
              */
 
+            if (canSkipDefaultTiles &&
+                !srcDM->m_hashTable->tileExists(column, row)) {
+
+                if (m_hashTable->tileExists(column, row)) {
+                    m_hashTable->deleteTile(column, row);
+                    needsRecalculateExtent = true;
+                }
+                continue;
+            }
+
             // this is the only variation in the template
             KisTileSP srcTile = useOldSrcData ?
                 srcDM->getOldTile(column, row) :
@@ -559,6 +597,10 @@ void KisTiledDataManager::bitBltRoughImpl(KisTiledDataManager *srcDM, const QRec
             updateExtent(column, row);
         }
     }
+
+    if (needsRecalculateExtent) {
+        recalculateExtent();
+    }
 }
 
 void KisTiledDataManager::bitBlt(KisTiledDataManager *srcDM, const QRect &rect)
@@ -678,6 +720,24 @@ QRect KisTiledDataManager::extentImpl() const
     return QRect(x, y, w, h);
 }
 
+void KisTiledDataManager::prefetchTiles(const QRect &tilesRect)
+{
+    /**
+     * Don't waste time on the hash table lookups
+     * if nothing is swapped out
+     */
+    if (!KisTileDataStore::instance()->hasSwappedTileData()) return;
+
+    for (qint32 row = tilesRect.top(); row <= tilesRect.bottom(); row++) {
+        for (qint32 col = tilesRect.left(); col <= tilesRect.right(); col++) {
+            KisTileSP tile = m_hashTable->getExistedTile(col, row);
+            if (tile) {
+                tile->prefetchTileData();
+            }
+        }
+    }
+}
+
 void KisTiledDataManager::extent(qint32 &x, qint32 &y, qint32 &w, qint32 &h) const
 {
     QRect rect = extent();
@@ -704,6 +764,43 @@ QRegion KisTiledDataManager::region() const
     return region;
 }
 
+QRegion KisTiledDataManager::region(const QRect &rect) const
+{
+    QRegion region;
+    if (rect.isEmpty()) return region;
+
+    const qint32 firstColumn = xToCol(rect.left());
+    const qint32 lastColumn = xToCol(rect.right());
+    const qint32 firstRow = yToRow(rect.top());
+    const qint32 lastRow = yToRow(rect.bottom());
+
+    for (qint32 row = firstRow; row <= lastRow; row++) {
+        qint32 runStart = -1;
+
+        /**
+         * Join the neighbouring tiles of a row into a single
+         * rect to keep the region small
+         */
+        for (qint32 column = firstColumn; column <= lastColumn + 1; column++) {
+            const bool exists =
+                column <= lastColumn && m_hashTable->tileExists(column, row);
+
+            if (exists && runStart < 0) {
+                runStart = column;
+            } else if (!exists && runStart >= 0) {
+                QRect runRect(runStart * KisTileData::WIDTH,
+                              row * KisTileData::HEIGHT,
+                              (column - runStart) * KisTileData::WIDTH,
+                              KisTileData::HEIGHT);
+                region += runRect & rect;
+                runStart = -1;
+            }
+        }
+    }
+
+    return region;
+}
+
 void KisTiledDataManager::setPixel(qint32 x, qint32 y, const quint8 * data)
 {
     QWriteLocker locker(&m_lock);
@@ -107,6 +107,13 @@ public:
         return tile ? tile : getTile(col, row, false);
     }
 
+    /**
+     * Asks the store to load the swapped-out tiles in the \p tilesRect
+     * (in tile coordinates) in the background. Used by the iterators
+     * to get the tiles they are going to access soon.
+     */
+    void prefetchTiles(const QRect &tilesRect);
+
     KisMementoSP getMemento() {
         QWriteLocker locker(&m_lock);
         KisMementoSP memento = m_mementoManager->getMemento();
@@ -192,6 +199,13 @@ public:
 
     QRegion region() const;
 
+    /**
+     * Returns the part of \p rect covered by existing tiles. Unlike
+     * region() it visits only the tiles inside \p rect, so the cost
+     * doesn't depend on the size of the whole device.
+     */
+    QRegion region(const QRect &rect) const;
+
     void clear(QRect clearRect, quint8 clearValue);
     void clear(QRect clearRect, const quint8 *clearPixel);
     void clear(qint32 x, qint32 y, qint32 w, qint32 h, quint8 clearValue);
@@ -336,6 +350,8 @@ private:
 
     quint8* duplicatePixel(qint32 num, const quint8 *pixel);
 
+    bool hasSameDefaultPixel(const KisTiledDataManager *other) const;
+
     template<bool useOldSrcData>
         void bitBltImpl(KisTiledDataManager *srcDM, const QRect &rect);
     template<bool useOldSrcData>
@@ -62,6 +62,9 @@ KisVLineIterator2::KisVLineIterator2(KisDataManager *dataManager, qint32 x, qint
 
     m_tileSize = m_lineStride * KisTileData::HEIGHT;
 
+    // the next column of tiles is loaded from swap while we are working on this one
+    prefetchTiles(m_column + 1, m_topRow, m_column + 1, m_bottomRow);
+
     // let's prealocate first row
     for (int i = 0; i < m_tilesCacheSize; i++){
         fetchTileDataForCache(m_tilesCache[i], m_column, m_topRow + i);
@@ -217,6 +220,8 @@ void KisVLineIterator2::fetchTileDataForCache(KisTileInfo& kti, qint32 col, qint
 
 void KisVLineIterator2::preallocateTiles()
 {
+    prefetchTiles(m_column + 1, m_topRow, m_column + 1, m_bottomRow);
+
     for (int i = 0; i < m_tilesCacheSize; ++i){
         unlockTile(m_tilesCache[i].tile);
         unlockTile(m_tilesCache[i].oldtile);
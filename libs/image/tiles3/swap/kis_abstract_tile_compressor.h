@@ -19,6 +19,8 @@
 #ifndef __KIS_ABSTRACT_TILE_COMPRESSOR_H
 #define __KIS_ABSTRACT_TILE_COMPRESSOR_H
 
+#include <QVector>
+
 #include "kritaimage_export.h"
 #include "../kis_tile.h"
 #include "../kis_tiled_data_manager.h"
@@ -55,6 +57,23 @@ public:
      */
     virtual bool readTile(QIODevice *stream, KisTiledDataManager *dm) = 0;
 
+    /**
+     * Writes all the \a tiles into the \a store in the given order.
+     * The default implementation just calls writeTile() for every
+     * tile, the descendants may compress the tiles in parallel as
+     * long as the resulting stream stays the same.
+     */
+    virtual bool writeTiles(const QVector<KisTileSP> &tiles, KisPaintDeviceWriter &store);
+
+    /**
+     * Reads \a numTiles tiles from the \a stream into \a dm.
+     * Returns false if any of the tiles failed to load, the rest
+     * of the tiles are still loaded.
+     *
+     * \see writeTiles()
+     */
+    virtual bool readTiles(QIODevice *stream, KisTiledDataManager *dm, quint32 numTiles);
+
     /**
      * Compresses a \a tileData and writes it into the \a buffer.
      * The buffer must be at least tileDataBufferSize() bytes long.
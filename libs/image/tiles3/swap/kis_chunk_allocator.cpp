@@ -27,17 +27,19 @@
 
 #define PEEK_NEXT(iter) (*(iter))
 #define PEEK_PREVIOUS(iter) (*((iter)-1))
-#define WRAP_PREVIOUS_CHUNK_DATA(iter) (KisChunk((iter)-1))
 
 
-KisChunkAllocator::KisChunkAllocator(quint64 slabSize, quint64 storeSize)
+KisChunkAllocator::KisChunkAllocator(quint64 slabSize, quint64 storeSize, int swapFileIndex)
 {
     m_storeMaxSize = storeSize;
     m_storeSlabSize = slabSize;
+    m_swapFileIndex = swapFileIndex;
 
-    m_iterator = m_list.begin();
     m_storeSize = m_storeSlabSize;
+    m_allocatedSize = 0;
     INIT_FAIL_COUNTER();
+
+    registerGap(m_list.end());
 }
 
 KisChunkAllocator::~KisChunkAllocator()
@@ -46,82 +48,84 @@ KisChunkAllocator::~KisChunkAllocator()
 
 KisChunk KisChunkAllocator::getChunk(quint64 size)
 {
-    KisChunkDataListIterator startPosition = m_iterator;
-    START_COUNTING();
+    FreeGapsMap::iterator gap = m_freeGaps.lowerBound(GapKey(size, 0));
+
+    while (gap == m_freeGaps.end()) {
+        REGISTER_FAIL();
 
-    forever {
-        if(tryInsertChunk(m_list, m_iterator, size))
-            return WRAP_PREVIOUS_CHUNK_DATA(m_iterator);
+        if (m_storeSize + m_storeSlabSize > m_storeMaxSize) {
+            qFatal("KisChunkAllocator: out of swap space");
+        }
 
-        if(m_iterator == m_list.end())
-            break;
+        /**
+         * Only the tail gap depends on the size of the store
+         */
+        unregisterGap(m_list.end());
+        m_storeSize += m_storeSlabSize;
+        registerGap(m_list.end());
 
-        m_iterator++;
-        REGISTER_STEP();
+        gap = m_freeGaps.lowerBound(GapKey(size, 0));
     }
 
-    REGISTER_FAIL();
-    m_iterator = m_list.begin();
+    const quint64 begin = gap.key().second;
+    KisChunkDataListIterator next = gap.value();
+    m_freeGaps.erase(gap);
 
-    forever {
-        if(tryInsertChunk(m_list, m_iterator, size))
-            return WRAP_PREVIOUS_CHUNK_DATA(m_iterator);
+    KisChunkDataListIterator position =
+        m_list.insert(next, KisChunkData(begin, size));
 
-        if(m_iterator == m_list.end() || m_iterator == startPosition)
-            break;
+    // the rest of the gap, if anything is left
+    registerGap(next);
 
-        m_iterator++;
-        REGISTER_STEP();
-    }
+    m_allocatedSize += size;
 
-    REGISTER_FAIL();
-    m_iterator = m_list.end();
+    return KisChunk(position, m_swapFileIndex);
+}
 
-    while ((m_storeSize += m_storeSlabSize) <= m_storeMaxSize) {
-        if(tryInsertChunk(m_list, m_iterator, size))
-            return WRAP_PREVIOUS_CHUNK_DATA(m_iterator);
-    }
+void KisChunkAllocator::freeChunk(KisChunk chunk)
+{
+    KisChunkDataListIterator position = chunk.position();
+    Q_ASSERT(position->m_begin == chunk.begin());
+
+    KisChunkDataListIterator next = position + 1;
 
-    qFatal("KisChunkAllocator: out of swap space");
+    unregisterGap(position);
+    unregisterGap(next);
 
-    // just let gcc be happy! :)
-    return KisChunk(m_list.end());
+    m_allocatedSize -= position->size();
+    m_list.erase(position);
+
+    // the two gaps are merged together with the freed space
+    registerGap(next);
 }
 
-bool KisChunkAllocator::tryInsertChunk(KisChunkDataList &list,
-                                       KisChunkDataListIterator &iterator,
-                                       quint64 size)
+KisChunkAllocator::GapKey KisChunkAllocator::gapBefore(KisChunkDataListIterator next)
 {
-    bool result = false;
-    quint64 highBound = m_storeSize;
-    quint64 lowBound = 0;
-    quint64 shift = 0;
+    const quint64 begin = HAS_PREVIOUS(m_list, next) ?
+        PEEK_PREVIOUS(next).m_end + 1 : 0;
 
-    if(HAS_NEXT(list, iterator))
-        highBound = PEEK_NEXT(iterator).m_begin;
+    const quint64 end = HAS_NEXT(m_list, next) ?
+        PEEK_NEXT(next).m_begin : m_storeSize;
 
-    if(HAS_PREVIOUS(list, iterator)) {
-        lowBound = PEEK_PREVIOUS(iterator).m_end;
-        shift = 1;
-    }
+    return GapKey(end > begin ? end - begin : 0, begin);
+}
 
-    if(GAP_SIZE(lowBound, highBound) >= size) {
-        list.insert(iterator, KisChunkData(lowBound + shift, size));
-        result = true;
-    }
+void KisChunkAllocator::registerGap(KisChunkDataListIterator next)
+{
+    const GapKey key = gapBefore(next);
 
-    return result;
+    if (key.first > 0) {
+        m_freeGaps.insert(key, next);
+    }
 }
 
-void KisChunkAllocator::freeChunk(KisChunk chunk)
+void KisChunkAllocator::unregisterGap(KisChunkDataListIterator next)
 {
-    if(m_iterator != m_list.end() && m_iterator == chunk.position()) {
-        m_iterator = m_list.erase(m_iterator);
-        return;
-    }
+    const GapKey key = gapBefore(next);
 
-    Q_ASSERT(chunk.position()->m_begin == chunk.begin());
-    m_list.erase(chunk.position());
+    if (key.first > 0) {
+        m_freeGaps.remove(key);
+    }
 }
 
 
@@ -164,6 +168,20 @@ bool KisChunkAllocator::sanityCheck(bool pleaseCrash)
         }
     }
 
+    quint64 freeSize = 0;
+    FreeGapsMap::const_iterator gap;
+    for(gap = m_freeGaps.constBegin(); gap != m_freeGaps.constEnd(); ++gap) {
+        freeSize += gap.key().first;
+    }
+
+    if(freeSize + m_allocatedSize != m_storeSize) {
+        warnKrita << "Free gaps are out of sync:"
+                  << "free" << freeSize
+                  << "allocated" << m_allocatedSize
+                  << "store" << m_storeSize;
+        failed = true;
+    }
+
     if(failed && pleaseCrash)
         qFatal("KisChunkAllocator: sanity check failed!");
 
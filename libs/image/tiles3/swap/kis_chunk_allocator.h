@@ -20,6 +20,8 @@
 #define __KIS_CHUNK_LIST_H
 
 #include <QLinkedList>
+#include <QMap>
+#include <QPair>
 
 #define MiB (1ULL << 20)
 
@@ -92,10 +94,11 @@ public:
 class KisChunk
 {
 public:
-    KisChunk() {}
+    KisChunk() : m_swapFileIndex(0) {}
 
-    KisChunk(KisChunkDataListIterator iterator)
-        : m_iterator(iterator)
+    KisChunk(KisChunkDataListIterator iterator, int swapFileIndex = 0)
+        : m_iterator(iterator),
+          m_swapFileIndex(swapFileIndex)
     {
     }
 
@@ -119,22 +122,65 @@ public:
         return *m_iterator;
     }
 
+    /**
+     * The index of the swap file the chunk lives in
+     */
+    inline int swapFileIndex() const {
+        return m_swapFileIndex;
+    }
+
 private:
     KisChunkDataListIterator m_iterator;
+    int m_swapFileIndex;
 };
 
 
+/**
+ * Allocates the chunks of the swap file.
+ *
+ * The chunks are kept in a list sorted by their offset, and every
+ * gap between them is also registered in a map sorted by the size
+ * of the gap. getChunk() takes the smallest gap that can hold the
+ * requested size (best fit), so the holes left by the swapped-in
+ * tiles are filled first and the file grows only when none of them
+ * is big enough. freeChunk() merges the freed space with the
+ * neighbouring gaps.
+ *
+ * The allocator is not thread-safe.
+ */
 class KisChunkAllocator
 {
 public:
+    /**
+     * @param swapFileIndex the index of the swap file managed by the
+     *        allocator. It is stored in every chunk the allocator
+     *        returns, so that the owner of several swap files could
+     *        find the file of the chunk.
+     */
     KisChunkAllocator(quint64 slabSize = DEFAULT_SLAB_SIZE,
-                      quint64 storeSize = DEFAULT_STORE_SIZE);
+                      quint64 storeSize = DEFAULT_STORE_SIZE,
+                      int swapFileIndex = 0);
     ~KisChunkAllocator();
 
     inline quint64 numChunks() const {
         return m_list.size();
     }
 
+    /**
+     * The total size of the allocated chunks
+     */
+    inline quint64 allocatedSize() const {
+        return m_allocatedSize;
+    }
+
+    /**
+     * The size of the space reserved for the store. It grows
+     * slab by slab up to the size limit of the store.
+     */
+    inline quint64 storeSize() const {
+        return m_storeSize;
+    }
+
     KisChunk getChunk(quint64 size);
     void freeChunk(KisChunk chunk);
 
@@ -143,18 +189,30 @@ public:
     qreal debugFragmentation(bool toStderr = true);
 
 private:
-    bool tryInsertChunk(KisChunkDataList &list,
-                        KisChunkDataListIterator &iterator,
-                        quint64 size);
+    /**
+     * The gaps are identified by their size and their offset, so
+     * the keys are unique and the smallest suitable gap is always
+     * the first one found by lowerBound(). The value is the position
+     * of the chunk following the gap (or end() for the tail of the
+     * store).
+     */
+    typedef QPair<quint64, quint64> GapKey;
+    typedef QMap<GapKey, KisChunkDataListIterator> FreeGapsMap;
+
+    GapKey gapBefore(KisChunkDataListIterator next);
+    void registerGap(KisChunkDataListIterator next);
+    void unregisterGap(KisChunkDataListIterator next);
 
 private:
     quint64 m_storeMaxSize;
     quint64 m_storeSlabSize;
+    int m_swapFileIndex;
 
 
     KisChunkDataList m_list;
-    KisChunkDataListIterator m_iterator;
+    FreeGapsMap m_freeGaps;
     quint64 m_storeSize;
+    quint64 m_allocatedSize;
     DECLARE_FAIL_COUNTER()
 };
 
@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2016 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_COMPRESSION_FACTORY_H
+#define __KIS_COMPRESSION_FACTORY_H
+
+#include <QString>
+#include <QStringList>
+
+#include <config-lz4.h>
+
+#include "kis_debug.h"
+#include "tiles3/swap/kis_lzf_compression.h"
+
+#ifdef HAVE_LZ4
+#include "tiles3/swap/kis_lz4_compression.h"
+#endif
+
+/**
+ * Creates a compression backend by its name. Used for choosing
+ * the algorithm of the swap file at runtime.
+ */
+class KRITAIMAGE_EXPORT KisCompressionFactory
+{
+public:
+    static KisAbstractCompression* create(const QString &name) {
+#ifdef HAVE_LZ4
+        if (name == "LZ4") {
+            return new KisLz4Compression();
+        }
+#endif
+
+        if (name != "LZF") {
+            warnKrita << "Unknown compression algorithm" << name << "falling back to LZF";
+        }
+
+        return new KisLzfCompression();
+    }
+
+    /**
+     * The list of the algorithms available in this build. The
+     * fastest one goes first.
+     */
+    static QStringList availableCompressions() {
+        QStringList result;
+#ifdef HAVE_LZ4
+        result << "LZ4";
+#endif
+        result << "LZF";
+        return result;
+    }
+
+private:
+    KisCompressionFactory();
+};
+
+#endif /* __KIS_COMPRESSION_FACTORY_H */
@@ -16,35 +16,106 @@
  *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
-//#include "kis_debug.h"
+#include "kis_debug.h"
 #include "kis_swapped_data_store.h"
 #include "kis_memory_window.h"
 #include "kis_image_config.h"
 
 #include "kis_tile_compressor_2.h"
+#include "kis_compression_factory.h"
+
+#include <functional>
+#include <QtConcurrent>
 
 //#define COMPRESSOR_VERSION 2
 
 KisSwappedDataStore::KisSwappedDataStore()
-    : m_memoryMetric(0)
+    : m_compressor(0),
+      m_memoryMetric(0)
 {
     KisImageConfig config;
     const quint64 maxSwapSize = config.maxSwapSize() * MiB;
     const quint64 swapSlabSize = config.swapSlabSize() * MiB;
     const quint64 swapWindowSize = config.swapWindowSize() * MiB;
 
-    m_allocator = new KisChunkAllocator(swapSlabSize, maxSwapSize);
-    m_swapSpace = new KisMemoryWindow(config.swapDir(), swapWindowSize);
+    QStringList swapDirs;
+    swapDirs << config.swapDir();
+    swapDirs << config.additionalSwapDirs();
+
+    /**
+     * The size limit is shared by all the files
+     */
+    const quint64 maxFileSize =
+        qMax(swapSlabSize, maxSwapSize / swapDirs.size());
+
+    for (int i = 0; i < swapDirs.size(); i++) {
+        SwapFile file;
+        file.allocator = new KisChunkAllocator(swapSlabSize, maxFileSize, i);
+        file.window = new KisMemoryWindow(swapDirs[i], swapWindowSize);
+        m_swapFiles << file;
+    }
 
-    // FIXME: use a factory after the patch is committed
-    m_compressor = new KisTileCompressor2();
+    createCompressors();
 }
 
 KisSwappedDataStore::~KisSwappedDataStore()
 {
+    destroyCompressors();
+
+    Q_FOREACH (const SwapFile &file, m_swapFiles) {
+        delete file.window;
+        delete file.allocator;
+    }
+}
+
+void KisSwappedDataStore::createCompressors()
+{
+    KisImageConfig config;
+    const QString algorithm = config.swapCompressionAlgorithm();
+    const int numWorkers = qMax(1, config.swapCompressionThreads());
+
+    m_compressor = new KisTileCompressor2(KisCompressionFactory::create(algorithm));
+
+    for (int i = 0; i < numWorkers; i++) {
+        m_workerCompressors << new KisTileCompressor2(KisCompressionFactory::create(algorithm));
+    }
+
+    /**
+     * The calling thread takes a part of the work
+     * itself, so we need one thread less
+     */
+    m_compressionPool.setMaxThreadCount(qMax(1, numWorkers - 1));
+}
+
+void KisSwappedDataStore::destroyCompressors()
+{
+    m_compressionPool.waitForDone();
+
+    qDeleteAll(m_workerCompressors);
+    m_workerCompressors.clear();
+
     delete m_compressor;
-    delete m_swapSpace;
-    delete m_allocator;
+    m_compressor = 0;
+}
+
+void KisSwappedDataStore::testingRereadConfig()
+{
+    QMutexLocker locker(&m_lock);
+
+    /**
+     * The headers of the swapped chunks do not store the codec they
+     * were compressed with, so the codec can be changed only while
+     * the swap is empty
+     */
+    const quint64 numSwappedTiles = numTiles();
+    if (numSwappedTiles) {
+        warnKrita << "WARNING: the swap still holds" << numSwappedTiles
+                  << "tiles, the swap compression settings are left unchanged";
+        return;
+    }
+
+    destroyCompressors();
+    createCompressors();
 }
 
 quint64 KisSwappedDataStore::numTiles() const
@@ -52,7 +123,34 @@ quint64 KisSwappedDataStore::numTiles() const
     // We are not acquiring the lock here...
     // Hope QLinkedList will ensure atomic access to it's size...
 
-    return m_allocator->numChunks();
+    quint64 result = 0;
+
+    Q_FOREACH (const SwapFile &file, m_swapFiles) {
+        result += file.allocator->numChunks();
+    }
+
+    return result;
+}
+
+KisChunk KisSwappedDataStore::writeChunk(const quint8 *data, quint64 size)
+{
+    int fileIndex = 0;
+
+    for (int i = 1; i < m_swapFiles.size(); i++) {
+        if (m_swapFiles[i].allocator->allocatedSize() <
+            m_swapFiles[fileIndex].allocator->allocatedSize()) {
+
+            fileIndex = i;
+        }
+    }
+
+    const SwapFile &file = m_swapFiles[fileIndex];
+
+    KisChunk chunk = file.allocator->getChunk(size);
+    quint8 *ptr = file.window->getWriteChunkPtr(chunk);
+    memcpy(ptr, data, size);
+
+    return chunk;
 }
 
 void KisSwappedDataStore::swapOutTileData(KisTileData *td)
@@ -73,9 +171,7 @@ void KisSwappedDataStore::swapOutTileData(KisTileData *td)
     qint32 bytesWritten;
     m_compressor->compressTileData(td, (quint8*) m_buffer.data(), m_buffer.size(), bytesWritten);
 
-    KisChunk chunk = m_allocator->getChunk(bytesWritten);
-    quint8 *ptr = m_swapSpace->getWriteChunkPtr(chunk);
-    memcpy(ptr, m_buffer.data(), bytesWritten);
+    KisChunk chunk = writeChunk((quint8*) m_buffer.data(), bytesWritten);
 
     td->releaseMemory();
     td->setSwapChunk(chunk);
@@ -83,6 +179,78 @@ void KisSwappedDataStore::swapOutTileData(KisTileData *td)
     m_memoryMetric += td->pixelSize();
 }
 
+void KisSwappedDataStore::compressTileDataPart(int worker, int numWorkers,
+                                               const QVector<KisTileData*> &tileDataList,
+                                               const QVector<qint32> &offsets,
+                                               QVector<qint32> *bytesWritten)
+{
+    KisAbstractTileCompressor *compressor = m_workerCompressors[worker];
+
+    for (int i = worker; i < tileDataList.size(); i += numWorkers) {
+        const qint32 bufferSize = offsets[i + 1] - offsets[i];
+
+        compressor->compressTileData(tileDataList[i],
+                                     (quint8*) m_batchBuffer.data() + offsets[i],
+                                     bufferSize, (*bytesWritten)[i]);
+    }
+}
+
+void KisSwappedDataStore::swapOutTileData(const QVector<KisTileData*> &tileDataList)
+{
+    if (tileDataList.isEmpty()) return;
+
+    QMutexLocker locker(&m_lock);
+
+    /**
+     * Every tile gets its own slot in the batch buffer, so the
+     * workers never write to the same memory
+     */
+    QVector<qint32> offsets(tileDataList.size() + 1);
+    offsets[0] = 0;
+    for (int i = 0; i < tileDataList.size(); i++) {
+        Q_ASSERT(tileDataList[i]->data());
+        offsets[i + 1] = offsets[i] + m_compressor->tileDataBufferSize(tileDataList[i]);
+    }
+
+    if (m_batchBuffer.size() < offsets.last()) {
+        m_batchBuffer.resize(offsets.last());
+    }
+
+    QVector<qint32> bytesWritten(tileDataList.size());
+    const int numWorkers = qMin(m_workerCompressors.size(), tileDataList.size());
+
+    QVector<QFuture<void>> futures;
+    for (int worker = 1; worker < numWorkers; worker++) {
+        futures << QtConcurrent::run(&m_compressionPool,
+                                     std::bind(&KisSwappedDataStore::compressTileDataPart, this,
+                                               worker, numWorkers,
+                                               std::cref(tileDataList), std::cref(offsets),
+                                               &bytesWritten));
+    }
+
+    compressTileDataPart(0, numWorkers, tileDataList, offsets, &bytesWritten);
+
+    Q_FOREACH (QFuture<void> future, futures) {
+        future.waitForFinished();
+    }
+
+    /**
+     * The allocators and the memory windows are not thread-safe,
+     * so the compressed data is written sequentially
+     */
+    for (int i = 0; i < tileDataList.size(); i++) {
+        KisTileData *td = tileDataList[i];
+
+        KisChunk chunk = writeChunk((quint8*) m_batchBuffer.data() + offsets[i],
+                                    bytesWritten[i]);
+
+        td->releaseMemory();
+        td->setSwapChunk(chunk);
+
+        m_memoryMetric += td->pixelSize();
+    }
+}
+
 void KisSwappedDataStore::swapInTileData(KisTileData *td)
 {
     Q_ASSERT(!td->data());
@@ -95,9 +263,11 @@ void KisSwappedDataStore::swapInTileData(KisTileData *td)
     td->allocateMemory();
     td->setSwapChunk(KisChunk());
 
-    quint8 *ptr = m_swapSpace->getReadChunkPtr(chunk);
+    const SwapFile &file = m_swapFiles[chunk.swapFileIndex()];
+
+    quint8 *ptr = file.window->getReadChunkPtr(chunk);
     m_compressor->decompressTileData(ptr, chunk.size(), td);
-    m_allocator->freeChunk(chunk);
+    file.allocator->freeChunk(chunk);
 
     m_memoryMetric -= td->pixelSize();
 }
@@ -106,7 +276,8 @@ void KisSwappedDataStore::forgetTileData(KisTileData *td)
 {
     QMutexLocker locker(&m_lock);
 
-    m_allocator->freeChunk(td->swapChunk());
+    KisChunk chunk = td->swapChunk();
+    m_swapFiles[chunk.swapFileIndex()].allocator->freeChunk(chunk);
     td->setSwapChunk(KisChunk());
 
     m_memoryMetric -= td->pixelSize();
@@ -119,6 +290,8 @@ qint64 KisSwappedDataStore::totalMemoryMetric() const
 
 void KisSwappedDataStore::debugStatistics()
 {
-    m_allocator->sanityCheck();
-    m_allocator->debugFragmentation();
+    Q_FOREACH (const SwapFile &file, m_swapFiles) {
+        file.allocator->sanityCheck();
+        file.allocator->debugFragmentation();
+    }
 }
@@ -23,12 +23,15 @@
 
 #include <QMutex>
 #include <QByteArray>
+#include <QVector>
+#include <QThreadPool>
 
 
 class QMutex;
 class KisTileData;
 class KisAbstractTileCompressor;
 class KisChunkAllocator;
+class KisChunk;
 class KisMemoryWindow;
 
 class KRITAIMAGE_EXPORT KisSwappedDataStore
@@ -50,6 +53,15 @@ public:
      */
     void swapOutTileData(KisTileData *td);
 
+    /**
+     * Swap out a batch of tile data objects. The tiles are
+     * compressed in parallel by a pool of compressors and then
+     * written to the swap file sequentially.
+     * LOCKING: the locks on all the tile data objects should
+     *          be taken by the caller before making a call.
+     */
+    void swapOutTileData(const QVector<KisTileData*> &tileDataList);
+
     /**
      * Restore the data of a \a td basing on information
      * stored in the swap file.
@@ -76,12 +88,50 @@ public:
      */
     void debugStatistics();
 
+    /**
+     * Recreates the compressors according to the
+     * current configuration. Does nothing while there
+     * are tiles swapped out, because they could not be
+     * decompressed with a different codec.
+     */
+    void testingRereadConfig();
+
+private:
+    void createCompressors();
+    void destroyCompressors();
+
+    void compressTileDataPart(int worker, int numWorkers,
+                              const QVector<KisTileData*> &tileDataList,
+                              const QVector<qint32> &offsets,
+                              QVector<qint32> *bytesWritten);
+
+    KisChunk writeChunk(const quint8 *data, quint64 size);
+
 private:
     QByteArray m_buffer;
     KisAbstractTileCompressor *m_compressor;
 
-    KisChunkAllocator *m_allocator;
-    KisMemoryWindow *m_swapSpace;
+    /**
+     * Compressors used for the parallel compression of the
+     * batches, one per worker thread. The compressed data of the
+     * whole batch is stored in m_batchBuffer.
+     */
+    QVector<KisAbstractTileCompressor*> m_workerCompressors;
+    QThreadPool m_compressionPool;
+    QByteArray m_batchBuffer;
+
+    /**
+     * Every swap directory gets its own file with its own allocator.
+     * A new chunk is always put into the file with the least amount
+     * of allocated data, so the consecutive writes of a batch are
+     * striped over all the files.
+     */
+    struct SwapFile {
+        KisChunkAllocator *allocator;
+        KisMemoryWindow *window;
+    };
+
+    QVector<SwapFile> m_swapFiles;
 
     QMutex m_lock;
 
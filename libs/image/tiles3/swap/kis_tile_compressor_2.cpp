@@ -19,6 +19,8 @@
 #include "kis_tile_compressor_2.h"
 #include "kis_lzf_compression.h"
 #include <QIODevice>
+#include <QThread>
+#include <QtConcurrent>
 #include "kis_paint_device_writer.h"
 #define TILE_DATA_SIZE(pixelSize) ((pixelSize) * KisTileData::WIDTH * KisTileData::HEIGHT)
 
@@ -30,6 +32,11 @@ KisTileCompressor2::KisTileCompressor2()
     m_compression = new KisLzfCompression();
 }
 
+KisTileCompressor2::KisTileCompressor2(KisAbstractCompression *compression)
+    : m_compression(compression)
+{
+}
+
 KisTileCompressor2::~KisTileCompressor2()
 {
     delete m_compression;
@@ -65,31 +72,297 @@ bool KisTileCompressor2::readTile(QIODevice *stream, KisTiledDataManager *dm)
     const qint32 tileDataSize = TILE_DATA_SIZE(pixelSize(dm));
     prepareStreamingBuffer(tileDataSize);
 
+    qint32 dataSize = 0;
+    KisTileSP tile = readHeader(stream, dm, dataSize);
+    if (!tile) return false;
+
+    if (m_streamingBuffer.size() < dataSize) {
+        m_streamingBuffer.resize(dataSize);
+    }
+
+    stream->read(m_streamingBuffer.data(), dataSize);
+
+    tile->lockForWrite();
+    bool res = decompressTileData((quint8*)m_streamingBuffer.data(), dataSize, tile->tileData());
+    tile->unlock();
+    return res;
+}
+
+KisTileSP KisTileCompressor2::readHeader(QIODevice *stream, KisTiledDataManager *dm, qint32 &dataSize)
+{
     QByteArray header = stream->readLine(maxHeaderLength());
 
     QList<QByteArray> headerItems = header.trimmed().split(',');
-    if (headerItems.size() == 4) {
-        qint32 x = headerItems.takeFirst().toInt();
-        qint32 y = headerItems.takeFirst().toInt();
-        QString compressionName = headerItems.takeFirst();
-        qint32 dataSize = headerItems.takeFirst().toInt();
+    if (headerItems.size() != 4) return KisTileSP();
 
-        Q_ASSERT(headerItems.isEmpty());
-        Q_ASSERT(compressionName == m_compressionName);
+    qint32 x = headerItems.takeFirst().toInt();
+    qint32 y = headerItems.takeFirst().toInt();
+    QString compressionName = headerItems.takeFirst();
+    dataSize = headerItems.takeFirst().toInt();
 
-        qint32 row = yToRow(dm, y);
-        qint32 col = xToCol(dm, x);
+    Q_ASSERT(headerItems.isEmpty());
+    Q_ASSERT(compressionName == m_compressionName);
+
+    qint32 row = yToRow(dm, y);
+    qint32 col = xToCol(dm, x);
+
+    return dm->getTile(col, row, true);
+}
 
-        KisTileSP tile = dm->getTile(col, row, true);
+namespace {
+
+/**
+ * The number of tiles every worker processes in a single batch
+ */
+const int TILES_PER_WORKER = 16;
+
+struct StreamingSlot
+{
+    StreamingSlot() : dataSize(0), result(false) {}
+
+    KisTileSP tile;
+    QByteArray buffer;
+    qint32 dataSize;
+    bool result;
+};
+
+void compressTiles(KisAbstractTileCompressor *compressor,
+                   StreamingSlot *begin, StreamingSlot *end)
+{
+    for (StreamingSlot *slot = begin; slot != end; ++slot) {
+        KisTileSP tile = slot->tile;
+
+        tile->lockForRead();
+
+        const qint32 bufferSize = compressor->tileDataBufferSize(tile->tileData());
+        if (slot->buffer.size() < bufferSize) {
+            slot->buffer.resize(bufferSize);
+        }
+
+        compressor->compressTileData(tile->tileData(),
+                                     (quint8*)slot->buffer.data(), bufferSize,
+                                     slot->dataSize);
+        tile->unlock();
+    }
+}
 
-        stream->read(m_streamingBuffer.data(), dataSize);
+/**
+ * The lock of a tile must be released by the thread that has taken
+ * it, so every worker locks the tiles of its own part itself
+ */
+void decompressTiles(KisAbstractTileCompressor *compressor,
+                     StreamingSlot *begin, StreamingSlot *end)
+{
+    for (StreamingSlot *slot = begin; slot != end; ++slot) {
+        KisTileSP tile = slot->tile;
 
         tile->lockForWrite();
-        bool res = decompressTileData((quint8*)m_streamingBuffer.data(), dataSize, tile->tileData());
+        slot->result =
+            compressor->decompressTileData((quint8*)slot->buffer.data(),
+                                           slot->dataSize,
+                                           tile->tileData());
         tile->unlock();
-        return res;
+
+        slot->tile.clear();
     }
-    return false;
+}
+
+typedef void (*StreamingFunc)(KisAbstractTileCompressor*, StreamingSlot*, StreamingSlot*);
+
+/**
+ * Splits \p numSlots slots into contiguous parts and runs \p func
+ * on every part with a separate compressor
+ */
+QVector<QFuture<void>> startBatch(StreamingFunc func,
+                                  const QVector<KisAbstractTileCompressor*> &compressors,
+                                  StreamingSlot *slots, int numSlots)
+{
+    QVector<QFuture<void>> futures;
+
+    const int numWorkers = compressors.size();
+    const int partSize = (numSlots + numWorkers - 1) / numWorkers;
+
+    for (int i = 0; i < numWorkers; i++) {
+        const int begin = i * partSize;
+        const int end = qMin(numSlots, begin + partSize);
+        if (begin >= end) break;
+
+        futures << QtConcurrent::run(func, compressors[i], slots + begin, slots + end);
+    }
+
+    return futures;
+}
+
+void waitForBatch(QVector<QFuture<void>> &futures)
+{
+    Q_FOREACH (QFuture<void> future, futures) {
+        future.waitForFinished();
+    }
+    futures.clear();
+}
+
+}
+
+bool KisTileCompressor2::writeTiles(const QVector<KisTileSP> &tiles, KisPaintDeviceWriter &store)
+{
+    const int numWorkers = QThread::idealThreadCount();
+
+    if (numWorkers <= 1 || tiles.size() <= TILES_PER_WORKER) {
+        return KisAbstractTileCompressor::writeTiles(tiles, store);
+    }
+
+    QVector<KisAbstractTileCompressor*> compressors;
+    for (int i = 0; i < numWorkers; i++) {
+        compressors << new KisTileCompressor2();
+    }
+
+    /**
+     * Two batches are in flight: the workers compress the next one,
+     * while the current thread writes the previous one to the store
+     */
+    const int batchSize = numWorkers * TILES_PER_WORKER;
+    QVector<StreamingSlot> batches[2] = {
+        QVector<StreamingSlot>(batchSize),
+        QVector<StreamingSlot>(batchSize)
+    };
+    QVector<QFuture<void>> futures;
+
+    auto prepareBatch = [&] (int batchIndex, int firstTile) {
+        const int numSlots = qMin(batchSize, tiles.size() - firstTile);
+        StreamingSlot *slots = batches[batchIndex].data();
+
+        for (int i = 0; i < numSlots; i++) {
+            slots[i].tile = tiles[firstTile + i];
+        }
+
+        futures = startBatch(compressTiles, compressors, slots, numSlots);
+    };
+
+    bool retval = true;
+
+    prepareBatch(0, 0);
+
+    for (int firstTile = 0, batchIndex = 0;
+         firstTile < tiles.size();
+         firstTile += batchSize, batchIndex ^= 1) {
+
+        waitForBatch(futures);
+
+        const int numSlots = qMin(batchSize, tiles.size() - firstTile);
+        const int nextTile = firstTile + batchSize;
+
+        if (retval && nextTile < tiles.size()) {
+            prepareBatch(batchIndex ^ 1, nextTile);
+        }
+
+        StreamingSlot *slots = batches[batchIndex].data();
+
+        for (int i = 0; retval && i < numSlots; i++) {
+            QString header = getHeader(slots[i].tile, slots[i].dataSize);
+
+            retval = store.write(header.toLatin1()) &&
+                store.write(slots[i].buffer.data(), slots[i].dataSize);
+
+            if (!retval) {
+                warnFile << "Failed to write tile";
+            }
+        }
+
+        for (int i = 0; i < numSlots; i++) {
+            slots[i].tile.clear();
+        }
+
+        if (!retval) break;
+    }
+
+    waitForBatch(futures);
+    qDeleteAll(compressors);
+
+    return retval;
+}
+
+bool KisTileCompressor2::readTiles(QIODevice *stream, KisTiledDataManager *dm, quint32 numTiles)
+{
+    const int numWorkers = QThread::idealThreadCount();
+
+    if (numWorkers <= 1 || numTiles <= quint32(TILES_PER_WORKER)) {
+        return KisAbstractTileCompressor::readTiles(stream, dm, numTiles);
+    }
+
+    QVector<KisAbstractTileCompressor*> compressors;
+    for (int i = 0; i < numWorkers; i++) {
+        compressors << new KisTileCompressor2();
+    }
+
+    /**
+     * The stream can be read by the current thread only, so it
+     * reads the next batch while the workers decompress the
+     * previous one
+     */
+    const int batchSize = numWorkers * TILES_PER_WORKER;
+    QVector<StreamingSlot> batches[2] = {
+        QVector<StreamingSlot>(batchSize),
+        QVector<StreamingSlot>(batchSize)
+    };
+    int batchFill[2] = {0, 0};
+    QVector<QFuture<void>> futures;
+
+    const qint32 minBufferSize = TILE_DATA_SIZE(pixelSize(dm)) + 1;
+    bool readSuccess = true;
+
+    auto collectResults = [&] (int batchIndex) {
+        StreamingSlot *slots = batches[batchIndex].data();
+        for (int i = 0; i < batchFill[batchIndex]; i++) {
+            readSuccess &= slots[i].result;
+        }
+        batchFill[batchIndex] = 0;
+    };
+
+    quint32 tilesRead = 0;
+    int batchIndex = 0;
+
+    while (tilesRead < numTiles) {
+        StreamingSlot *slots = batches[batchIndex].data();
+        int &numSlots = batchFill[batchIndex];
+
+        while (numSlots < batchSize && tilesRead < numTiles) {
+            tilesRead++;
+
+            StreamingSlot &slot = slots[numSlots];
+
+            qint32 dataSize = 0;
+            KisTileSP tile = readHeader(stream, dm, dataSize);
+            if (!tile) {
+                readSuccess = false;
+                continue;
+            }
+
+            if (slot.buffer.size() < qMax(dataSize, minBufferSize)) {
+                slot.buffer.resize(qMax(dataSize, minBufferSize));
+            }
+
+            stream->read(slot.buffer.data(), dataSize);
+
+            slot.tile = tile;
+            slot.dataSize = dataSize;
+            slot.result = false;
+
+            numSlots++;
+        }
+
+        waitForBatch(futures);
+        collectResults(batchIndex ^ 1);
+
+        futures = startBatch(decompressTiles, compressors, slots, numSlots);
+        batchIndex ^= 1;
+    }
+
+    waitForBatch(futures);
+    collectResults(batchIndex ^ 1);
+
+    qDeleteAll(compressors);
+
+    return readSuccess;
 }
 
 void KisTileCompressor2::prepareStreamingBuffer(qint32 tileDataSize)
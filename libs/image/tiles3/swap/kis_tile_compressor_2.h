@@ -27,11 +27,36 @@ class KRITAIMAGE_EXPORT KisTileCompressor2 : public KisAbstractTileCompressor
 {
 public:
     KisTileCompressor2();
+
+    /**
+     * Creates a compressor that uses a custom \p compression
+     * backend. The compressor takes ownership of the object.
+     *
+     * NOTE: the file format always uses LZF, so the compressors
+     * with a custom backend are supposed to be used with
+     * compressTileData()/decompressTileData() only, that is for
+     * swapping.
+     */
+    KisTileCompressor2(KisAbstractCompression *compression);
     ~KisTileCompressor2() override;
 
     bool writeTile(KisTileSP tile, KisPaintDeviceWriter &store) override;
     bool readTile(QIODevice *io, KisTiledDataManager *dm) override;
 
+    /**
+     * Compresses the tiles in parallel batches, while the previous
+     * batch is being written to the \a store. The tiles are still
+     * written in the order of \a tiles, so the resulting stream is
+     * the same as the one written by writeTile().
+     */
+    bool writeTiles(const QVector<KisTileSP> &tiles, KisPaintDeviceWriter &store) override;
+
+    /**
+     * Reads the next batch of the compressed tiles from the \a stream
+     * while the previous one is being decompressed in parallel
+     */
+    bool readTiles(QIODevice *stream, KisTiledDataManager *dm, quint32 numTiles) override;
+
 
     void compressTileData(KisTileData *tileData,quint8 *buffer,
                           qint32 bufferSize, qint32 &bytesWritten) override;
@@ -46,6 +71,13 @@ private:
 
     QString getHeader(KisTileSP tile, qint32 compressedSize);
 
+    /**
+     * Reads the header of the next tile from the \a stream and
+     * returns the writable tile it belongs to. Returns a null
+     * pointer if the header is corrupted.
+     */
+    KisTileSP readHeader(QIODevice *stream, KisTiledDataManager *dm, qint32 &dataSize);
+
     void prepareWorkBuffers(qint32 tileDataSize);
     void prepareStreamingBuffer(qint32 tileDataSize);
 
@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) 2016 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_tile_data_prefetcher.h"
+
+#include <QSemaphore>
+#include <QMutex>
+#include <QQueue>
+
+#include "tiles3/kis_tile_data.h"
+#include "tiles3/kis_tile_data_store.h"
+#include "kis_debug.h"
+
+
+const qint32 KisTileDataPrefetcher::MAX_QUEUE_SIZE = 512;
+
+struct Q_DECL_HIDDEN KisTileDataPrefetcher::Private
+{
+    QSemaphore semaphore;
+    QAtomicInt shouldExitFlag;
+    KisTileDataStore *store;
+
+    QMutex queueLock;
+    QQueue<KisTileData*> queue;
+
+    QAtomicInt numRequests;
+    QAtomicInt numLoaded;
+};
+
+KisTileDataPrefetcher::KisTileDataPrefetcher(KisTileDataStore *store)
+    : QThread(),
+      m_d(new Private())
+{
+    m_d->shouldExitFlag = 0;
+    m_d->store = store;
+    m_d->numRequests = 0;
+    m_d->numLoaded = 0;
+}
+
+KisTileDataPrefetcher::~KisTileDataPrefetcher()
+{
+    releaseQueue();
+    delete m_d;
+}
+
+void KisTileDataPrefetcher::prefetch(KisTileData *td)
+{
+    {
+        QMutexLocker locker(&m_d->queueLock);
+        if (m_d->queue.size() >= MAX_QUEUE_SIZE) return;
+
+        td->ref();
+        m_d->queue.enqueue(td);
+    }
+
+    m_d->numRequests.ref();
+    m_d->semaphore.release();
+}
+
+void KisTileDataPrefetcher::terminatePrefetcher()
+{
+    unsigned long exitTimeout = 100;
+    do {
+        m_d->shouldExitFlag = true;
+        m_d->semaphore.release();
+    } while(!wait(exitTimeout));
+
+    releaseQueue();
+}
+
+qint64 KisTileDataPrefetcher::numRequests() const
+{
+    return m_d->numRequests;
+}
+
+qint64 KisTileDataPrefetcher::numLoaded() const
+{
+    return m_d->numLoaded;
+}
+
+void KisTileDataPrefetcher::releaseQueue()
+{
+    QMutexLocker locker(&m_d->queueLock);
+
+    while (!m_d->queue.isEmpty()) {
+        m_d->queue.dequeue()->deref();
+    }
+}
+
+void KisTileDataPrefetcher::run()
+{
+    while (1) {
+        m_d->semaphore.acquire();
+
+        if (m_d->shouldExitFlag)
+            return;
+
+        KisTileData *td = 0;
+
+        {
+            QMutexLocker locker(&m_d->queueLock);
+            if (m_d->queue.isEmpty()) continue;
+            td = m_d->queue.dequeue();
+        }
+
+        /**
+         * The data might have been loaded by someone else while the
+         * request was waiting in the queue. It is a racy check, but
+         * blockSwapping() will do the proper one.
+         */
+        if (!td->data()) {
+            td->blockSwapping();
+            td->unblockSwapping();
+            m_d->numLoaded.ref();
+        }
+
+        /**
+         * We might be holding the last reference to the tile data
+         * here, in such a case it will be freed
+         */
+        td->deref();
+    }
+}
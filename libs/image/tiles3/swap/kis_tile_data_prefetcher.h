@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2016 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_TILE_DATA_PREFETCHER_H
+#define __KIS_TILE_DATA_PREFETCHER_H
+
+#include <QThread>
+
+#include "kritaimage_export.h"
+
+class KisTileDataStore;
+class KisTileData;
+
+/**
+ * A thread that loads swapped-out tile data objects in the background.
+ *
+ * The iterators ask it to load the tiles they are going to access
+ * soon (e.g. the next row of tiles), so that by the time the painting
+ * thread reaches them, the data is already decompressed and the
+ * iterator doesn't stall on the swap file.
+ *
+ * The requests are just hints: if the queue is full, new requests
+ * are silently dropped and the data is loaded on demand as usual.
+ */
+class KRITAIMAGE_EXPORT KisTileDataPrefetcher : public QThread
+{
+    Q_OBJECT
+
+public:
+    KisTileDataPrefetcher(KisTileDataStore *store);
+    ~KisTileDataPrefetcher() override;
+
+    /**
+     * Queue \p td for loading from the swap. The prefetcher holds
+     * a reference to the tile data until the request is processed.
+     * LOCKING: the caller should guarantee the tile data is not
+     *          destroyed while the call is in progress
+     */
+    void prefetch(KisTileData *td);
+
+    void terminatePrefetcher();
+
+    /**
+     * Statistics: the number of requests accepted and the
+     * number of tile data objects actually loaded by the thread
+     */
+    qint64 numRequests() const;
+    qint64 numLoaded() const;
+
+private:
+    void run() override;
+    void releaseQueue();
+
+private:
+    static const qint32 MAX_QUEUE_SIZE;
+
+private:
+    struct Private;
+    Private * const m_d;
+};
+
+#endif /* __KIS_TILE_DATA_PREFETCHER_H */
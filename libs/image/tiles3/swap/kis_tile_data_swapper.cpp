@@ -30,6 +30,11 @@
 const qint32 KisTileDataSwapper::TIMEOUT = -1;
 const qint32 KisTileDataSwapper::DELAY = 0.7 * SEC;
 
+/**
+ * The number of tiles compressed in parallel in a single batch
+ */
+const qint32 KisTileDataSwapper::BATCH_SIZE = 128;
+
 //#define DEBUG_SWAPPER
 
 #ifdef DEBUG_SWAPPER
@@ -212,8 +217,9 @@ qint64 KisTileDataSwapper::pass(qint64 needToFreeMetric)
         if(!strategy::isInteresting(item)) continue;
 
         if(strategy::swapOutFirst(item)) {
-            if(iter->trySwapOut(item)) {
+            if(iter->tryQueueSwapOut(item)) {
                 freedMetric += item->pixelSize();
+                flushSwapQueue(false);
             }
         }
         else {
@@ -226,16 +232,25 @@ qint64 KisTileDataSwapper::pass(qint64 needToFreeMetric)
     Q_FOREACH (item, additionalCandidates) {
         if(freedMetric >= needToFreeMetric) break;
 
-        if(iter->trySwapOut(item)) {
+        if(iter->tryQueueSwapOut(item)) {
             freedMetric += item->pixelSize();
+            flushSwapQueue(false);
         }
     }
 
+    flushSwapQueue(true);
     strategy::endIteration(m_d->store, iter);
 
     return freedMetric;
 }
 
+void KisTileDataSwapper::flushSwapQueue(bool force)
+{
+    if(force || m_d->store->numQueuedTileData() >= BATCH_SIZE) {
+        m_d->store->swapOutQueuedTileData();
+    }
+}
+
 void KisTileDataSwapper::testingRereadConfig()
 {
     m_d->limits = KisStoreLimits();
@@ -48,10 +48,12 @@ private:
 
     void doJob();
     template<class strategy> qint64 pass(qint64 needToFreeMetric);
+    void flushSwapQueue(bool force);
 
 private:
     static const qint32 TIMEOUT;
     static const qint32 DELAY;
+    static const qint32 BATCH_SIZE;
 
 private:
     struct Private;
@@ -39,7 +39,46 @@ void KisChunkAllocatorTest::testOperations()
 
     allocator.debugChunks();
     allocator.sanityCheck();
-    QVERIFY(qFuzzyCompare(allocator.debugFragmentation(), 1./6));
+
+    // the freed hole is reused instead of growing the used space
+    QCOMPARE(chunk3.begin(), 25ULL);
+    QCOMPARE(allocator.debugFragmentation(), 0.0);
+}
+
+void KisChunkAllocatorTest::testBestFit()
+{
+    KisChunkAllocator allocator(1000, 4000, 3);
+
+    allocator.getChunk(100);
+    KisChunk chunk2 = allocator.getChunk(50);
+    KisChunk chunk3 = allocator.getChunk(100);
+    KisChunk chunk4 = allocator.getChunk(30);
+    allocator.getChunk(10);
+
+    QCOMPARE(chunk2.swapFileIndex(), 3);
+    QCOMPARE(allocator.allocatedSize(), 290ULL);
+
+    allocator.freeChunk(chunk2);
+    allocator.freeChunk(chunk4);
+    QVERIFY(allocator.sanityCheck(false));
+
+    // the smallest suitable hole is taken
+    QCOMPARE(allocator.getChunk(25).begin(), 250ULL);
+    QCOMPARE(allocator.getChunk(40).begin(), 100ULL);
+    QVERIFY(allocator.sanityCheck(false));
+
+    // the freed chunk is merged with the rest of the hole before it
+    allocator.freeChunk(chunk3);
+    QCOMPARE(allocator.getChunk(110).begin(), 140ULL);
+    QVERIFY(allocator.sanityCheck(false));
+
+    // the store grows slab by slab when no hole is big enough
+    QCOMPARE(allocator.storeSize(), 1000ULL);
+    QCOMPARE(allocator.getChunk(2500).begin(), 290ULL);
+    QCOMPARE(allocator.storeSize(), 3000ULL);
+    QVERIFY(allocator.sanityCheck(false));
+
+    QCOMPARE(allocator.allocatedSize(), 2500ULL + 275ULL + 10ULL);
 }
 
 
@@ -23,6 +23,7 @@
 
 #include "../../../sdk/tests/testutil.h"
 #include "tiles3/swap/kis_lzf_compression.h"
+#include "tiles3/swap/kis_compression_factory.h"
 #include <kis_debug.h>
 
 #define TEST_FILE "tile.png"
@@ -221,6 +222,28 @@ void KisCompressionTests::testLzfOverflow()
     delete compression;
 }
 
+void KisCompressionTests::testAvailableCompressions_data()
+{
+    QTest::addColumn<QString>("name");
+
+    Q_FOREACH (const QString &name, KisCompressionFactory::availableCompressions()) {
+        QTest::newRow(name.toLatin1()) << name;
+    }
+}
+
+void KisCompressionTests::testAvailableCompressions()
+{
+    QFETCH(QString, name);
+
+    KisAbstractCompression *compression = KisCompressionFactory::create(name);
+
+    roundTrip(compression);
+    roundTripTwoPass(compression);
+    testOverflow(compression);
+
+    delete compression;
+}
+
 void KisCompressionTests::benchmarkMemCpy()
 {
     QImage image(QString(FILES_DATA_DIR) + QDir::separator() + TEST_FILE);
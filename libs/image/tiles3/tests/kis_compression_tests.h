@@ -42,6 +42,9 @@ private Q_SLOTS:
     void testLzfRoundTrip();
     void testLzfOverflow();
 
+    void testAvailableCompressions_data();
+    void testAvailableCompressions();
+
     void benchmarkMemCpy();
 
     void benchmarkCompressionLzf();
@@ -212,4 +212,52 @@ void KisLowMemoryTests::hangingTilesTest()
     dstTile = 0;
 }
 
+void KisLowMemoryTests::prefetchSwappedTiles()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    const int NUM_TILES = 10;
+
+    for (int i = 0; i < NUM_TILES; i++) {
+        KisTileSP tile = dm.getTile(i, 0, true);
+        tile->lockForWrite();
+        memset(tile->data(), i + 1, TILESIZE);
+        tile->unlock();
+    }
+
+    KisTileDataStore::instance()->debugSwapAll();
+
+    for (int i = 0; i < NUM_TILES; i++) {
+        KisTileSP tile = dm.getTile(i, 0, false);
+        QVERIFY(!tile->tileData()->data());
+    }
+
+    dm.prefetchTiles(QRect(0, 0, NUM_TILES, 1));
+
+    /**
+     * The tiles are loaded asynchronously, so just wait
+     * for the prefetcher a bit
+     */
+    bool allLoaded = false;
+    for (int attempt = 0; attempt < 100 && !allLoaded; attempt++) {
+        QTest::qSleep(50);
+
+        allLoaded = true;
+        for (int i = 0; i < NUM_TILES; i++) {
+            KisTileSP tile = dm.getTile(i, 0, false);
+            allLoaded &= bool(tile->tileData()->data());
+        }
+    }
+
+    QVERIFY(allLoaded);
+
+    for (int i = 0; i < NUM_TILES; i++) {
+        KisTileSP tile = dm.getTile(i, 0, false);
+        tile->lockForRead();
+        QVERIFY(memoryIsFilled(i + 1, tile->data(), TILESIZE));
+        tile->unlock();
+    }
+}
+
 QTEST_MAIN(KisLowMemoryTests)
@@ -18,6 +18,7 @@
 
 #include "kis_swapped_data_store_test.h"
 #include <QTest>
+#include <QTemporaryDir>
 
 #include "kis_debug.h"
 
@@ -131,5 +132,114 @@ void KisSwappedDataStoreTest::testRandomAccess()
         delete tileDataList[i];
 }
 
+void KisSwappedDataStoreTest::testStripedSwapFiles()
+{
+    const qint32 pixelSize = 1;
+    const quint8 defaultPixel = 128;
+    const qint32 NUM_TILES = 1000;
+
+    QTemporaryDir extraSwapDir1;
+    QTemporaryDir extraSwapDir2;
+
+    KisImageConfig config;
+    config.setMaxSwapSize(12);
+    config.setSwapSlabSize(1);
+    config.setSwapWindowSize(1);
+    config.setAdditionalSwapDirs(QStringList() << extraSwapDir1.path() << extraSwapDir2.path());
+
+    {
+        KisSwappedDataStore store;
+
+        QVector<KisTileData*> tileDataList;
+        for(qint32 i = 0; i < NUM_TILES; i++) {
+            KisTileData *td = new KisTileData(pixelSize, &defaultPixel, KisTileDataStore::instance());
+            memset(td->data(), COLUMN2COLOR(i), TILESIZE);
+            tileDataList.append(td);
+        }
+
+        store.swapOutTileData(tileDataList.mid(0, NUM_TILES / 2));
+
+        for(qint32 i = NUM_TILES / 2; i < NUM_TILES; i++) {
+            store.swapOutTileData(tileDataList[i]);
+        }
+
+        QCOMPARE(store.numTiles(), quint64(NUM_TILES));
+        store.debugStatistics();
+
+        for(qint32 i = 0; i < NUM_TILES; i++) {
+            KisTileData *td = tileDataList[i];
+            QVERIFY(!td->data());
+
+            store.swapInTileData(td);
+            QVERIFY(memoryIsFilled(COLUMN2COLOR(i), td->data(), TILESIZE));
+        }
+
+        QCOMPARE(store.numTiles(), quint64(0));
+
+        qDeleteAll(tileDataList);
+    }
+
+    config.setAdditionalSwapDirs(QStringList());
+}
+
+void KisSwappedDataStoreTest::testCodecChangeWithSwappedTiles()
+{
+    const qint32 pixelSize = 1;
+    const quint8 defaultPixel = 128;
+    const qint32 NUM_TILES = 100;
+
+    KisImageConfig config;
+    config.setMaxSwapSize(4);
+    config.setSwapSlabSize(1);
+    config.setSwapWindowSize(1);
+
+    const QString oldAlgorithm = config.swapCompressionAlgorithm();
+    config.setSwapCompressionAlgorithm("LZF");
+
+    {
+        KisSwappedDataStore store;
+
+        QVector<KisTileData*> tileDataList;
+        for(qint32 i = 0; i < NUM_TILES; i++) {
+            KisTileData *td = new KisTileData(pixelSize, &defaultPixel, KisTileDataStore::instance());
+            memset(td->data(), COLUMN2COLOR(i), TILESIZE);
+            store.swapOutTileData(td);
+            tileDataList.append(td);
+        }
+
+        /**
+         * The tiles swapped out with the old codec must still
+         * be readable after the config has changed
+         */
+        config.setSwapCompressionAlgorithm("LZ4");
+        store.testingRereadConfig();
+
+        for(qint32 i = 0; i < NUM_TILES; i++) {
+            KisTileData *td = tileDataList[i];
+            store.swapInTileData(td);
+            QVERIFY(memoryIsFilled(COLUMN2COLOR(i), td->data(), TILESIZE));
+        }
+
+        QCOMPARE(store.numTiles(), quint64(0));
+
+        // the swap is empty now, so the codec is actually switched
+        store.testingRereadConfig();
+
+        for(qint32 i = 0; i < NUM_TILES; i++) {
+            store.swapOutTileData(tileDataList[i]);
+        }
+
+        for(qint32 i = 0; i < NUM_TILES; i++) {
+            KisTileData *td = tileDataList[i];
+            store.swapInTileData(td);
+            QVERIFY(memoryIsFilled(COLUMN2COLOR(i), td->data(), TILESIZE));
+        }
+
+        qDeleteAll(tileDataList);
+    }
+
+    config.setSwapCompressionAlgorithm(oldAlgorithm);
+}
+
 QTEST_MAIN(KisSwappedDataStoreTest)
 
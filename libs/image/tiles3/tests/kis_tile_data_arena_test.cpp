@@ -0,0 +1,175 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_tile_data_arena_test.h"
+
+#include <QTest>
+#include <QThreadPool>
+
+#include "../kis_tile_data_arena.h"
+
+#define NUM_PIXELS 4096
+
+
+void KisTileDataArenaTest::testReuse()
+{
+    KisTileDataArena arena(NUM_PIXELS);
+    arena.setCacheLimit(16 * NUM_PIXELS * 4);
+
+    quint8 *ptr1 = arena.allocate(4);
+    QVERIFY(ptr1);
+    QCOMPARE(arena.usedMemorySize(), qint64(NUM_PIXELS * 4));
+
+    arena.free(ptr1, 4);
+    QCOMPARE(arena.usedMemorySize(), qint64(0));
+    QCOMPARE(arena.cachedMemorySize(), qint64(NUM_PIXELS * 4));
+
+    quint8 *ptr2 = arena.allocate(4);
+    QCOMPARE(ptr2, ptr1);
+    QCOMPARE(arena.cachedMemorySize(), qint64(0));
+
+    QVector<KisTileDataArena::Statistics> stats = arena.statistics();
+    QCOMPARE(stats.size(), 1);
+    QCOMPARE(stats[0].pixelSize, 4);
+    QCOMPARE(stats[0].numUsedChunks, qint64(1));
+    QCOMPARE(stats[0].numAllocatedChunks, qint64(1));
+    QCOMPARE(stats[0].numReusedChunks, qint64(1));
+
+    arena.free(ptr2, 4);
+    arena.purge();
+    QCOMPARE(arena.cachedMemorySize(), qint64(0));
+    QCOMPARE(arena.statistics()[0].numCachedChunks, qint64(0));
+}
+
+void KisTileDataArenaTest::testCacheLimit()
+{
+    KisTileDataArena arena(NUM_PIXELS);
+    arena.setCacheLimit(2 * NUM_PIXELS * 8);
+
+    QVector<quint8*> chunks;
+    for (int i = 0; i < 5; i++) {
+        chunks << arena.allocate(8);
+    }
+
+    Q_FOREACH (quint8 *ptr, chunks) {
+        arena.free(ptr, 8);
+    }
+
+    // only two chunks fit into the cache
+    QCOMPARE(arena.cachedMemorySize(), qint64(2 * NUM_PIXELS * 8));
+    QCOMPARE(arena.statistics()[0].numCachedChunks, qint64(2));
+
+    // shrinking the limit releases the extra chunks immediately
+    arena.setCacheLimit(NUM_PIXELS * 8);
+    QCOMPARE(arena.cachedMemorySize(), qint64(NUM_PIXELS * 8));
+
+    arena.setCacheLimit(0);
+    QCOMPARE(arena.cachedMemorySize(), qint64(0));
+
+    // with no cache at all every chunk is given back
+    quint8 *ptr = arena.allocate(8);
+    arena.free(ptr, 8);
+    QCOMPARE(arena.cachedMemorySize(), qint64(0));
+}
+
+void KisTileDataArenaTest::testSizeClasses()
+{
+    KisTileDataArena arena(NUM_PIXELS);
+    arena.setCacheLimit(16 * NUM_PIXELS * 16);
+
+    quint8 *ptr4 = arena.allocate(4);
+    quint8 *ptr16 = arena.allocate(16);
+
+    arena.free(ptr4, 4);
+    arena.free(ptr16, 16);
+
+    // a freed RGBA8 chunk is never given to an RGBA-F32 tile
+    quint8 *newPtr16 = arena.allocate(16);
+    QCOMPARE(newPtr16, ptr16);
+    QCOMPARE(arena.cachedMemorySize(), qint64(NUM_PIXELS * 4));
+
+    memset(newPtr16, 0xff, NUM_PIXELS * 16);
+    arena.free(newPtr16, 16);
+
+    QVector<KisTileDataArena::Statistics> stats = arena.statistics();
+    QCOMPARE(stats.size(), 2);
+    QCOMPARE(stats[0].pixelSize, 4);
+    QCOMPARE(stats[1].pixelSize, 16);
+
+    // too big pixels are not pooled at all
+    quint8 *hugePtr = arena.allocate(KisTileDataArena::MAX_POOLED_PIXEL_SIZE + 8);
+    QVERIFY(hugePtr);
+    arena.free(hugePtr, KisTileDataArena::MAX_POOLED_PIXEL_SIZE + 8);
+    QCOMPARE(arena.statistics().size(), 2);
+}
+
+class ArenaStressJob : public QRunnable
+{
+public:
+    ArenaStressJob(KisTileDataArena &arena, int pixelSize)
+        : m_arena(arena),
+          m_pixelSize(pixelSize)
+    {
+    }
+
+    void run() override {
+        const int numChunks = 32;
+        quint8 *chunks[numChunks];
+
+        for (int i = 0; i < 1000; i++) {
+            for (int j = 0; j < numChunks; j++) {
+                chunks[j] = m_arena.allocate(m_pixelSize);
+                chunks[j][0] = j;
+            }
+
+            for (int j = 0; j < numChunks; j++) {
+                Q_ASSERT(chunks[j][0] == j);
+                m_arena.free(chunks[j], m_pixelSize);
+            }
+        }
+    }
+
+private:
+    KisTileDataArena &m_arena;
+    int m_pixelSize;
+};
+
+void KisTileDataArenaTest::testConcurrentAccess()
+{
+    KisTileDataArena arena(NUM_PIXELS);
+    arena.setCacheLimit(64 * NUM_PIXELS * 8);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(4);
+
+    for (int i = 0; i < 4; i++) {
+        pool.start(new ArenaStressJob(arena, i % 2 ? 4 : 8));
+    }
+    pool.waitForDone();
+
+    QCOMPARE(arena.usedMemorySize(), qint64(0));
+    QVERIFY(arena.cachedMemorySize() <= arena.cacheLimit());
+
+    qint64 cachedSize = 0;
+    Q_FOREACH (const KisTileDataArena::Statistics &stats, arena.statistics()) {
+        cachedSize += stats.numCachedChunks * stats.pixelSize * NUM_PIXELS;
+    }
+    QCOMPARE(cachedSize, arena.cachedMemorySize());
+}
+
+QTEST_MAIN(KisTileDataArenaTest)
@@ -20,6 +20,7 @@
 #include <QTest>
 
 #include "tiles3/kis_tiled_data_manager.h"
+#include "tiles3/swap/kis_tile_compressor_2.h"
 
 #include "tiles_test_utils.h"
 
@@ -539,6 +540,51 @@ void KisTiledDataManagerTest::testUndoSetDefaultPixel()
     QVERIFY(memoryIsFilled(oddPixel2, tile10->data(), TILESIZE));
 }
 
+void KisTiledDataManagerTest::testHashTableGrowth()
+{
+    const QRect nullRect(qint32_MAX,qint32_MAX,0,0);
+
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    /**
+     * 10000 tiles is much more than the initial size of the
+     * hash table, so it will be resized several times
+     */
+    const qint32 numCols = 100;
+    const qint32 numRows = 100;
+
+    KisMementoSP memento = dm.getMemento();
+
+    for(qint32 row = 0; row < numRows; row++) {
+        for(qint32 col = 0; col < numCols; col++) {
+            KisTileSP tile = dm.getTile(col, row, true);
+            tile->lockForWrite();
+            memset(tile->data(), (col + row) % 255 + 1, TILESIZE);
+            tile->unlock();
+        }
+    }
+
+    dm.commit();
+
+    QCOMPARE(dm.extent(), QRect(0, 0, numCols * 64, numRows * 64));
+
+    for(qint32 row = 0; row < numRows; row++) {
+        for(qint32 col = 0; col < numCols; col++) {
+            KisTileSP tile = dm.getTile(col, row, false);
+            tile->lockForRead();
+            QVERIFY(memoryIsFilled((col + row) % 255 + 1, tile->data(), TILESIZE));
+            tile->unlock();
+        }
+    }
+
+    dm.rollback(memento);
+    QCOMPARE(dm.extent(), nullRect);
+
+    dm.rollforward(memento);
+    QCOMPARE(dm.extent(), QRect(0, 0, numCols * 64, numRows * 64));
+}
+
 //#include <valgrind/callgrind.h>
 
 void KisTiledDataManagerTest::benchmarkReadOnlyTileLazy()
@@ -807,5 +853,122 @@ void KisTiledDataManagerTest::stressTest()
     pool.waitForDone();
 }
 
+void KisTiledDataManagerTest::testRegionInRect()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager dm(1, &defaultPixel);
+
+    quint8 oddPixel = 128;
+
+    // two groups of tiles: (0,0)-(1,0) and (5,0)
+    dm.clear(QRect(0, 0, 128, 64), &oddPixel);
+    dm.clear(QRect(320, 0, 64, 64), &oddPixel);
+
+    QCOMPARE(dm.region(QRect()), QRegion());
+    QCOMPARE(dm.region(QRect(0, 64, 512, 64)), QRegion());
+
+    QRegion expected;
+    expected += QRect(10, 10, 118, 54);
+    expected += QRect(320, 10, 64, 54);
+    QCOMPARE(dm.region(QRect(10, 10, 500, 100)), expected);
+
+    // the region should agree with the full one
+    QCOMPARE(dm.region(QRect(-1000, -1000, 2000, 2000)), dm.region());
+}
+
+void KisTiledDataManagerTest::testBitBltSkipsDefaultTiles()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager srcDM(1, &defaultPixel);
+    KisTiledDataManager dstDM(1, &defaultPixel);
+
+    quint8 srcPixel = 128;
+    quint8 dstPixel = 129;
+
+    srcDM.clear(QRect(0, 0, 64, 64), &srcPixel);
+    dstDM.clear(QRect(128, 128, 64, 64), &dstPixel);
+
+    dstDM.bitBlt(&srcDM, QRect(0, 0, 256, 256));
+
+    // the empty area of the source must not allocate tiles
+    QCOMPARE(dstDM.region(), QRegion(QRect(0, 0, 64, 64)));
+
+    QVERIFY(checkTilesShared(&srcDM, &dstDM, false, false, QRect(0, 0, 1, 1)));
+
+    quint8 pixel;
+    dstDM.readBytes(&pixel, 10, 10, 1, 1);
+    QCOMPARE(pixel, srcPixel);
+    dstDM.readBytes(&pixel, 150, 150, 1, 1);
+    QCOMPARE(pixel, defaultPixel);
+
+    // a different default pixel forbids the shortcut
+    quint8 otherDefaultPixel = 1;
+    KisTiledDataManager otherDM(1, &otherDefaultPixel);
+    otherDM.clear(QRect(128, 128, 64, 64), &dstPixel);
+    otherDM.bitBlt(&srcDM, QRect(0, 0, 256, 256));
+
+    otherDM.readBytes(&pixel, 150, 150, 1, 1);
+    QCOMPARE(pixel, defaultPixel);
+}
+
+void KisTiledDataManagerTest::testParallelWriteRead()
+{
+    quint8 defaultPixel = 0;
+    KisTiledDataManager srcDM(1, &defaultPixel);
+
+    const QRect rect(0, 0, 2048, 2048);
+    const int numPixels = rect.width() * rect.height();
+
+    /**
+     * The upper half is compressible, the lower half is noise,
+     * so both kinds of the tile blocks are present in the stream
+     */
+    QByteArray data(numPixels, 0);
+    for (int i = 0; i < numPixels; i++) {
+        data[i] = i < numPixels / 2 ? (i / 4096) % 256 : (quint32(i) * 2654435761U) >> 24;
+    }
+    srcDM.writeBytes((quint8*)data.data(), rect.x(), rect.y(), rect.width(), rect.height());
+
+    QVector<KisTileSP> tiles;
+    for (int row = 0; row < 32; row++) {
+        for (int col = 0; col < 32; col++) {
+            tiles << srcDM.getTile(col, row, false);
+        }
+    }
+
+    // the parallel writer should produce exactly the same stream
+    KisTileCompressor2 compressor;
+
+    KoStoreFake serialStore;
+    KisFakePaintDeviceWriter serialWriter(&serialStore);
+    QVERIFY(compressor.KisAbstractTileCompressor::writeTiles(tiles, serialWriter));
+
+    KoStoreFake parallelStore;
+    KisFakePaintDeviceWriter parallelWriter(&parallelStore);
+    QVERIFY(compressor.writeTiles(tiles, parallelWriter));
+
+    serialStore.startReading();
+    parallelStore.startReading();
+    QCOMPARE(parallelStore.device()->readAll(), serialStore.device()->readAll());
+
+    tiles.clear();
+
+    // and the whole round trip
+    KoStoreFake store;
+    KisFakePaintDeviceWriter writer(&store);
+    QVERIFY(srcDM.write(writer));
+
+    store.startReading();
+
+    KisTiledDataManager dstDM(1, &defaultPixel);
+    QVERIFY(dstDM.read(store.device()));
+
+    QCOMPARE(dstDM.extent(), srcDM.extent());
+
+    QByteArray result(numPixels, 1);
+    dstDM.readBytes((quint8*)result.data(), rect.x(), rect.y(), rect.width(), rect.height());
+    QVERIFY(result == data);
+}
+
 QTEST_MAIN(KisTiledDataManagerTest)
 
@@ -52,6 +52,10 @@ private Q_SLOTS:
     void testTransactions();
     void testPurgeHistory();
     void testUndoSetDefaultPixel();
+    void testHashTableGrowth();
+    void testRegionInRect();
+    void testBitBltSkipsDefaultTiles();
+    void testParallelWriteRead();
 
     void benchmarkReadOnlyTileLazy();
     void benchmarkSharedPointers();
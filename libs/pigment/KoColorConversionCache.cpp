@@ -19,6 +19,7 @@
 
 #include "KoColorConversionCache.h"
 
+#include <QAtomicInt>
 #include <QHash>
 #include <QList>
 #include <QMutex>
@@ -67,20 +68,94 @@ struct KoColorConversionCache::CachedTransformation {
     }
 
     bool available() {
-        return use == 0;
+        return use.load() == 0;
     }
 
     KoColorConversionTransformation* transfo;
-    int use;
+    QAtomicInt use;
 };
 
-typedef QPair<KoColorConversionCacheKey, KoCachedColorConversionTransformation> FastPathCacheItem;
+/**
+ * The transformations owned by a single thread. They are taken from the
+ * shared cache on the first request and are kept (marked as used) until
+ * one of the color spaces is destroyed, so all the following requests
+ * for the same conversion are served without any locking.
+ *
+ * QThreadStorage deletes the object when the thread exits, so the
+ * transformations of the finished threads are given back to the shared
+ * cache. A thread never keeps more than MAX_LOCAL_TRANSFORMATIONS of
+ * them though: when the limit is reached, the whole set is released
+ * and collected again.
+ */
+struct ThreadLocalCache {
+    ThreadLocalCache(int _generation)
+        : generation(_generation),
+          pendingHits(0)
+    {
+    }
+
+    ~ThreadLocalCache() {
+        qDeleteAll(transformations);
+    }
+
+    QHash<KoColorConversionCacheKey, KoCachedColorConversionTransformation*> transformations;
+
+    /**
+     * The value of KoColorConversionCache::Private::generation at the
+     * moment the transformations were taken. When it changes, some of
+     * the keys may point to the destroyed color spaces and the hash
+     * is dropped without looking into it.
+     */
+    int generation;
+
+    /**
+     * The hits are accumulated locally and added to the shared counter
+     * in batches, so that the counting itself did not make the threads
+     * fight for a single cache line
+     */
+    int pendingHits;
+};
 
 struct KoColorConversionCache::Private {
     QMultiHash< KoColorConversionCacheKey, CachedTransformation*> cache;
     QMutex cacheMutex;
 
-    QThreadStorage<FastPathCacheItem*> fastStorage;
+    /**
+     * The transformations of the destroyed color spaces, which were
+     * still owned by the thread-local caches of other threads at the
+     * moment of destruction. They are deleted as soon as they are
+     * released.
+     */
+    QList<CachedTransformation*> orphans;
+
+    QThreadStorage<ThreadLocalCache*> threadLocalCache;
+    QAtomicInt generation;
+
+    QAtomicInt hits;
+    QAtomicInt misses;
+    QAtomicInt contentions;
+
+    static const int HITS_BATCH_SIZE = 1024;
+    static const int MAX_LOCAL_TRANSFORMATIONS = 32;
+
+    void flushPendingHits(ThreadLocalCache *localCache) {
+        if (localCache->pendingHits) {
+            hits.fetchAndAddRelaxed(localCache->pendingHits);
+            localCache->pendingHits = 0;
+        }
+    }
+
+    void deleteReleasedOrphans() {
+        QList<CachedTransformation*>::iterator it = orphans.begin();
+        while (it != orphans.end()) {
+            if ((*it)->available()) {
+                delete *it;
+                it = orphans.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
 };
 
 
@@ -90,9 +165,17 @@ KoColorConversionCache::KoColorConversionCache() : d(new Private)
 
 KoColorConversionCache::~KoColorConversionCache()
 {
+    /**
+     * The transformations of the current thread are released before
+     * the shared ones are deleted. The other threads must have
+     * finished using the cache by this moment.
+     */
+    d->threadLocalCache.setLocalData(0);
+
     Q_FOREACH (CachedTransformation* transfo, d->cache) {
         delete transfo;
     }
+    qDeleteAll(d->orphans);
     delete d;
 }
 
@@ -103,56 +186,128 @@ KoCachedColorConversionTransformation KoColorConversionCache::cachedConverter(co
 {
     KoColorConversionCacheKey key(src, dst, _renderingIntent, _conversionFlags);
 
-    FastPathCacheItem *cacheItem =
-        d->fastStorage.localData();
+    ThreadLocalCache *localCache = d->threadLocalCache.localData();
+    const int generation = d->generation.load();
+
+    if (!localCache || localCache->generation != generation) {
+        if (localCache) {
+            d->flushPendingHits(localCache);
+        }
+
+        localCache = new ThreadLocalCache(generation);
+        d->threadLocalCache.setLocalData(localCache);
+    }
 
-    if (cacheItem) {
-        if (cacheItem->first == key) {
-            return cacheItem->second;
+    KoCachedColorConversionTransformation *localTransformation =
+        localCache->transformations.value(key, 0);
+
+    if (localTransformation) {
+        if (++localCache->pendingHits >= Private::HITS_BATCH_SIZE) {
+            d->flushPendingHits(localCache);
         }
+        return *localTransformation;
     }
 
-    cacheItem = 0;
+    d->flushPendingHits(localCache);
+    d->misses.ref();
+
+    if (!d->cacheMutex.tryLock()) {
+        d->contentions.ref();
+        d->cacheMutex.lock();
+    }
+
+    CachedTransformation *cachedTransformation = 0;
 
-    QMutexLocker lock(&d->cacheMutex);
     QList< CachedTransformation* > cachedTransfos = d->cache.values(key);
-    if (cachedTransfos.size() != 0) {
-        Q_FOREACH (CachedTransformation* ct, cachedTransfos) {
-            if (ct->available()) {
-                ct->transfo->setSrcColorSpace(src);
-                ct->transfo->setDstColorSpace(dst);
-
-                cacheItem = new FastPathCacheItem(key, KoCachedColorConversionTransformation(this, ct));
-                break;
-            }
+    Q_FOREACH (CachedTransformation* ct, cachedTransfos) {
+        if (ct->available()) {
+            ct->transfo->setSrcColorSpace(src);
+            ct->transfo->setDstColorSpace(dst);
+            cachedTransformation = ct;
+            break;
         }
     }
-    if (!cacheItem) {
+
+    if (!cachedTransformation) {
         KoColorConversionTransformation* transfo = src->createColorConverter(dst, _renderingIntent, _conversionFlags);
-        CachedTransformation* ct = new CachedTransformation(transfo);
-        d->cache.insert(key, ct);
-        cacheItem = new FastPathCacheItem(key, KoCachedColorConversionTransformation(this, ct));
+        cachedTransformation = new CachedTransformation(transfo);
+        d->cache.insert(key, cachedTransformation);
+    }
+
+    localTransformation = new KoCachedColorConversionTransformation(this, cachedTransformation);
+
+    d->deleteReleasedOrphans();
+    d->cacheMutex.unlock();
+
+    if (localCache->transformations.size() >= Private::MAX_LOCAL_TRANSFORMATIONS) {
+        qDeleteAll(localCache->transformations);
+        localCache->transformations.clear();
     }
 
-    d->fastStorage.setLocalData(cacheItem);
-    return cacheItem->second;
+    localCache->transformations.insert(key, localTransformation);
+    return *localTransformation;
 }
 
 void KoColorConversionCache::colorSpaceIsDestroyed(const KoColorSpace* cs)
 {
-    d->fastStorage.setLocalData(0);
+    /**
+     * Make all the threads drop their local transformations on the
+     * next request. Our own ones are dropped right now, so that they
+     * could be deleted immediately.
+     */
+    d->generation.ref();
+
+    ThreadLocalCache *localCache = d->threadLocalCache.localData();
+    if (localCache) {
+        d->flushPendingHits(localCache);
+        d->threadLocalCache.setLocalData(0);
+    }
 
     QMutexLocker lock(&d->cacheMutex);
     QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator endIt = d->cache.end();
     for (QMultiHash< KoColorConversionCacheKey, CachedTransformation*>::iterator it = d->cache.begin(); it != endIt;) {
         if (it.key().src == cs || it.key().dst == cs) {
-            Q_ASSERT(it.value()->available()); // That's terribely evil, if that assert fails, that means that someone is using a color transformation with a color space which is currently being deleted
-            delete it.value();
+            if (it.value()->available()) {
+                delete it.value();
+            } else {
+                d->orphans.append(it.value());
+            }
             it = d->cache.erase(it);
         } else {
             ++it;
         }
     }
+
+    d->deleteReleasedOrphans();
+}
+
+KoColorConversionCache::Statistics KoColorConversionCache::statistics() const
+{
+    Statistics stats;
+    stats.hits = d->hits.load();
+    stats.misses = d->misses.load();
+    stats.contentions = d->contentions.load();
+    return stats;
+}
+
+void KoColorConversionCache::resetStatistics()
+{
+    d->hits.store(0);
+    d->misses.store(0);
+    d->contentions.store(0);
+}
+
+int KoColorConversionCache::testingNumOrphans() const
+{
+    QMutexLocker lock(&d->cacheMutex);
+    return d->orphans.size();
+}
+
+int KoColorConversionCache::testingNumLocalTransformations() const
+{
+    ThreadLocalCache *localCache = d->threadLocalCache.localData();
+    return localCache && localCache->generation == d->generation.load() ?
+        localCache->transformations.size() : 0;
 }
 
 //--------- KoCachedColorConversionTransformation ----------//
@@ -168,18 +323,23 @@ KoCachedColorConversionTransformation::KoCachedColorConversionTransformation(KoC
     Q_ASSERT(transfo->available());
     d->cache = cache;
     d->transfo = transfo;
-    d->transfo->use++;
+    d->transfo->use.ref();
 }
 
 KoCachedColorConversionTransformation::KoCachedColorConversionTransformation(const KoCachedColorConversionTransformation& rhs) : d(new Private(*rhs.d))
 {
-    d->transfo->use++;
+    d->transfo->use.ref();
 }
 
 KoCachedColorConversionTransformation::~KoCachedColorConversionTransformation()
 {
-    d->transfo->use--;
-    Q_ASSERT(d->transfo->use >= 0);
+    /**
+     * As soon as the counter is dropped, the transformation may be
+     * deleted by any other thread, so it must not be touched after that
+     */
+    const int oldUse = d->transfo->use.fetchAndAddOrdered(-1);
+    Q_ASSERT(oldUse > 0);
+    Q_UNUSED(oldUse);
     delete d;
 }
 
@@ -24,16 +24,45 @@ class KoCachedColorConversionTransformation;
 class KoColorSpace;
 
 #include "KoColorConversionTransformation.h"
+#include "kritapigment_export.h"
 
 /**
  * This class holds a cache of KoColorConversionTransformations.
  *
+ * Every thread keeps its own set of transformations taken from the
+ * cache, so the repeated requests for the same conversion are served
+ * without any locking. The shared cache is locked only when the
+ * thread requests a conversion for the first time.
+ *
  * This class is not part of public API, and can be changed without notice.
  */
-class KoColorConversionCache
+class KRITAPIGMENT_EXPORT KoColorConversionCache
 {
 public:
     struct CachedTransformation;
+
+    struct Statistics {
+        Statistics() : hits(0), misses(0), contentions(0) {}
+
+        /**
+         * The number of requests served from the thread-local
+         * transformations. The threads report them in batches, so
+         * the value may lag a bit behind.
+         */
+        int hits;
+
+        /**
+         * The number of requests that had to go to the shared cache
+         */
+        int misses;
+
+        /**
+         * The number of misses that found the shared cache locked
+         * by another thread
+         */
+        int contentions;
+    };
+
 public:
     KoColorConversionCache();
     ~KoColorConversionCache();
@@ -56,6 +85,22 @@ public:
      * @param src source color space
      */
     void colorSpaceIsDestroyed(const KoColorSpace* src);
+
+    Statistics statistics() const;
+    void resetStatistics();
+
+    /**
+     * The number of the transformations of the destroyed color spaces
+     * that are still waiting to be released, for the unit tests only
+     */
+    int testingNumOrphans() const;
+
+    /**
+     * The number of the transformations the calling thread keeps
+     * locally, for the unit tests only
+     */
+    int testingNumLocalTransformations() const;
+
 private:
     struct Private;
     Private* const d;
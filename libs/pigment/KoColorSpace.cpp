@@ -37,8 +37,10 @@
 #include "KoConvolutionOp.h"
 #include "KoCompositeOpRegistry.h"
 #include "KoColorSpaceEngine.h"
+#include "KoHalfFloatConverter.h"
 
 #include <QThreadStorage>
+#include <QColor>
 #include <QByteArray>
 #include <QBitArray>
 #include <QPolygonF>
@@ -398,6 +400,46 @@ void KoColorSpace::fromLabA16(const quint8 * src, quint8 * dst, quint32 nPixels)
     fromLabA16Converter()->transform(src, dst, nPixels);
 }
 
+void KoColorSpace::fromQColors(const QColor *colors, quint8 *dst, qint32 nColors, const KoColorProfile *profile) const
+{
+    const qint32 pixelSize = this->pixelSize();
+
+    for (qint32 i = 0; i < nColors; i++) {
+        fromQColor(colors[i], dst, profile);
+        dst += pixelSize;
+    }
+}
+
+void KoColorSpace::toQColors(const quint8 *src, QColor *colors, qint32 nColors, const KoColorProfile *profile) const
+{
+    const qint32 pixelSize = this->pixelSize();
+
+    for (qint32 i = 0; i < nColors; i++) {
+        toQColor(src, &colors[i], profile);
+        src += pixelSize;
+    }
+}
+
+void KoColorSpace::differenceRow(const quint8 *src, const quint8 *row, qint32 nPixels, quint8 *differences) const
+{
+    const qint32 pixelSize = this->pixelSize();
+
+    for (qint32 i = 0; i < nPixels; i++) {
+        differences[i] = difference(src, row);
+        row += pixelSize;
+    }
+}
+
+void KoColorSpace::intensityRow(const quint8 *row, qint32 nPixels, quint8 *intensities) const
+{
+    const qint32 pixelSize = this->pixelSize();
+
+    for (qint32 i = 0; i < nPixels; i++) {
+        intensities[i] = intensity8(row);
+        row += pixelSize;
+    }
+}
+
 void KoColorSpace::toRgbA16(const quint8 * src, quint8 * dst, quint32 nPixels) const
 {
     toRgbA16Converter()->transform(src, dst, nPixels);
@@ -428,7 +470,7 @@ bool KoColorSpace::convertPixelsTo(const quint8 * src,
         if (src != dst) {
             memcpy(dst, src, numPixels * sizeof(quint8) * pixelSize());
         }
-    } else {
+    } else if (!KoHalfFloatConverter::convertPixels(this, src, dstColorSpace, dst, numPixels)) {
         KoCachedColorConversionTransformation cct = KoColorSpaceRegistry::instance()->colorConversionCache()->cachedConverter(this, dstColorSpace, renderingIntent, conversionFlags);
         cct.transformation()->transform(src, dst, numPixels);
     }
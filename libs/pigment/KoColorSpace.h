@@ -298,6 +298,20 @@ public:
      */
     virtual void toQColor(const quint8 *src, QColor *c, const KoColorProfile * profile = 0) const = 0;
 
+    /**
+     * The batched version of fromQColor(). Converts \p nColors colors
+     * into \p nColors consecutive pixels in \p dst. Use it instead of
+     * calling fromQColor() in a loop, the color spaces may convert the
+     * whole array in one go.
+     */
+    virtual void fromQColors(const QColor *colors, quint8 *dst, qint32 nColors, const KoColorProfile * profile = 0) const;
+
+    /**
+     * The batched version of toQColor(). Converts \p nColors
+     * consecutive pixels in \p src into \p nColors QColor's.
+     */
+    virtual void toQColors(const quint8 *src, QColor *colors, qint32 nColors, const KoColorProfile * profile = 0) const;
+
     /**
      * Convert the pixels in data to (8-bit BGRA) QImage using the specified profiles.
      *
@@ -505,6 +519,15 @@ public:
      */
     virtual quint8 differenceA(const quint8* src1, const quint8* src2) const = 0;
 
+    /**
+     * The batched version of difference(). Writes the differences
+     * between the pixel \p src and each of \p nPixels consecutive
+     * pixels in \p row into \p differences. Use it instead of calling
+     * difference() in a loop, the color spaces may process the whole
+     * row in one go.
+     */
+    virtual void differenceRow(const quint8 *src, const quint8 *row, qint32 nPixels, quint8 *differences) const;
+
     /**
      * @return the mix color operation of this colorspace (do not delete it locally, it's deleted by the colorspace).
      */
@@ -520,6 +543,12 @@ public:
      */
     virtual quint8 intensity8(const quint8 * src) const = 0;
 
+    /**
+     * The batched version of intensity8(). Writes the intensities of
+     * \p nPixels consecutive pixels in \p row into \p intensities.
+     */
+    virtual void intensityRow(const quint8 *row, qint32 nPixels, quint8 *intensities) const;
+
     /*
      *increase luminosity by step
      */
@@ -31,11 +31,53 @@
 #include "KoFallBackColorTransformation.h"
 #include "KoLabDarkenColorTransformation.h"
 #include "KoMixColorsOpImpl.h"
+#include "KoColorSpaceTraits.h"
+#include "compositeops/KoOptimizedCompositeOpFactory.h"
 
 #include "KoConvolutionOpImpl.h"
 #include "KoInvertColorTransformation.h"
 
 
+namespace _Private {
+
+/**
+ * Selects the vectorized mix colors op for the traits that have one
+ * and falls back to KoMixColorsOpImpl for the rest
+ */
+template<class Traits>
+struct OptimizedMixColorsOpSelector
+{
+    static KoMixColorsOp* createMixColorsOp() {
+        return new KoMixColorsOpImpl<Traits>();
+    }
+};
+
+template<>
+struct OptimizedMixColorsOpSelector<KoBgrU8Traits>
+{
+    static KoMixColorsOp* createMixColorsOp() {
+        return KoOptimizedCompositeOpFactory::createMixColorsOp32();
+    }
+};
+
+template<>
+struct OptimizedMixColorsOpSelector<KoLabU8Traits>
+{
+    static KoMixColorsOp* createMixColorsOp() {
+        return KoOptimizedCompositeOpFactory::createMixColorsOp32();
+    }
+};
+
+template<>
+struct OptimizedMixColorsOpSelector<KoRgbF32Traits>
+{
+    static KoMixColorsOp* createMixColorsOp() {
+        return KoOptimizedCompositeOpFactory::createMixColorsOp128();
+    }
+};
+
+}
+
 /**
  * This in an implementation of KoColorSpace which can be used as a base for colorspaces with as many
  * different channels of the same type.
@@ -51,7 +93,7 @@ class KoColorSpaceAbstract : public KoColorSpace
 {
 public:
     KoColorSpaceAbstract(const QString &id, const QString &name) :
-        KoColorSpace(id, name, new KoMixColorsOpImpl< _CSTrait>(), new KoConvolutionOpImpl< _CSTrait>()) {
+        KoColorSpace(id, name, _Private::OptimizedMixColorsOpSelector<_CSTrait>::createMixColorsOp(), new KoConvolutionOpImpl< _CSTrait>()) {
     }
 
     quint32 colorChannelCount() const override {
@@ -136,6 +178,25 @@ public:
         return static_cast<quint8>(c.red() * 0.30 + c.green() * 0.59 + c.blue() * 0.11);
     }
 
+    void intensityRow(const quint8 *row, qint32 nPixels, quint8 *intensities) const override {
+        const qint32 chunkSize = 64;
+        QColor colors[chunkSize];
+
+        while (nPixels > 0) {
+            const qint32 numColors = qMin(nPixels, chunkSize);
+            this->toQColors(row, colors, numColors);
+
+            for (qint32 i = 0; i < numColors; i++) {
+                const QColor &c = colors[i];
+                intensities[i] = static_cast<quint8>(c.red() * 0.30 + c.green() * 0.59 + c.blue() * 0.11);
+            }
+
+            row += numColors * _CSTrait::pixelSize;
+            intensities += numColors;
+            nPixels -= numColors;
+        }
+    }
+
     KoColorTransformation* createInvertTransformation() const override {
         return new KoInvertColorTransformation(this);
     }
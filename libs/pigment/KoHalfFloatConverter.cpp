@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "KoHalfFloatConverter.h"
+
+#include <cstring>
+
+#include <QList>
+#include <QScopedPointer>
+
+#include "KoColorSpace.h"
+#include "KoColorProfile.h"
+#include "KoChannelInfo.h"
+#include "KoColorModelStandardIds.h"
+#include "KoColorSpaceMaths.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_F16C_CONVERTER
+#define F16C_TARGET __attribute__((target("f16c")))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define HAVE_F16C_CONVERTER
+#define F16C_TARGET
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+
+namespace {
+
+inline float bitsToFloat(quint32 bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline quint32 floatToBits(float value)
+{
+    quint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float halfToFloatScalar(quint16 h)
+{
+    const quint32 shiftedExp = 0x7c00 << 13;
+
+    quint32 bits = (h & 0x7fff) << 13;
+    const quint32 exp = shiftedExp & bits;
+    bits += (127 - 15) << 23;
+
+    if (exp == shiftedExp) {
+        // Inf or NaN
+        bits += (128 - 16) << 23;
+    } else if (exp == 0) {
+        // zero or denormal, let the FPU renormalize it
+        bits += 1 << 23;
+        bits = floatToBits(bitsToFloat(bits) - bitsToFloat(113 << 23));
+    }
+
+    return bitsToFloat(bits | quint32(h & 0x8000) << 16);
+}
+
+inline quint16 floatToHalfScalar(float value)
+{
+    const quint32 f32Infinity = 255u << 23;
+    const quint32 f16Infinity = (127u + 16) << 23;
+    const quint32 denormMagic = ((127u - 15) + (23 - 10) + 1) << 23;
+
+    quint32 bits = floatToBits(value);
+    const quint32 sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    quint16 result;
+
+    if (bits >= f16Infinity) {
+        // overflow goes to Inf, all NaNs become quiet NaNs
+        result = bits > f32Infinity ? 0x7e00 : 0x7c00;
+    } else if (bits < (113u << 23)) {
+        /**
+         * The result is a denormal (or zero). Adding the magic value
+         * makes the FPU shift the mantissa into place and round it to
+         * the nearest even.
+         */
+        result = floatToBits(bitsToFloat(bits) + bitsToFloat(denormMagic)) - denormMagic;
+    } else {
+        const quint32 mantissaOdd = (bits >> 13) & 1;
+
+        // rebias the exponent and round to the nearest even
+        bits += (quint32(15 - 127) << 23) + 0xfff;
+        bits += mantissaOdd;
+        result = bits >> 13;
+    }
+
+    return result | (sign >> 16);
+}
+
+#ifdef HAVE_F16C_CONVERTER
+
+bool cpuSupportsF16C()
+{
+    const quint32 osxsaveBit = 1u << 27;
+    const quint32 avxBit = 1u << 28;
+    const quint32 f16cBit = 1u << 29;
+    const quint32 requiredBits = osxsaveBit | avxBit | f16cBit;
+
+#if defined(__GNUC__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+    if ((ecx & requiredBits) != requiredBits) return false;
+
+    unsigned int xcr0, xcr0High;
+    __asm__ ("xgetbv" : "=a" (xcr0), "=d" (xcr0High) : "c" (0));
+#else
+    int cpuInfo[4];
+    __cpuid(cpuInfo, 1);
+    if ((quint32(cpuInfo[2]) & requiredBits) != requiredBits) return false;
+
+    const quint32 xcr0 = quint32(_xgetbv(0));
+#endif
+
+    // the OS should also save the YMM registers on context switches
+    return (xcr0 & 0x6) == 0x6;
+}
+
+F16C_TARGET void halfToFloatF16C(const quint16 *src, float *dst, qint32 numValues)
+{
+    qint32 i = 0;
+
+    for (; i + 8 <= numValues; i += 8) {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+
+    for (; i < numValues; i++) {
+        dst[i] = halfToFloatScalar(src[i]);
+    }
+}
+
+F16C_TARGET void floatToHalfF16C(const float *src, quint16 *dst, qint32 numValues)
+{
+    qint32 i = 0;
+
+    for (; i + 8 <= numValues; i += 8) {
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+    }
+
+    /**
+     * The tail also goes through F16C, so that the NaN payloads
+     * were converted the same way for every value in the row
+     */
+    if (i < numValues) {
+        float srcTail[8] = {0};
+        quint16 dstTail[8];
+
+        memcpy(srcTail, src + i, (numValues - i) * sizeof(float));
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(srcTail), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dstTail), h);
+        memcpy(dst + i, dstTail, (numValues - i) * sizeof(quint16));
+    }
+}
+
+class KoHalfFloatConverterF16C : public KoHalfFloatConverter
+{
+public:
+    void halfToFloat(const quint16 *src, float *dst, qint32 numValues) const override {
+        halfToFloatF16C(src, dst, numValues);
+    }
+
+    void floatToHalf(const float *src, quint16 *dst, qint32 numValues) const override {
+        floatToHalfF16C(src, dst, numValues);
+    }
+};
+
+#endif /* HAVE_F16C_CONVERTER */
+
+KoHalfFloatConverter* createConverter()
+{
+#ifdef HAVE_F16C_CONVERTER
+    if (cpuSupportsF16C()) {
+        return new KoHalfFloatConverterF16C();
+    }
+#endif
+
+    return new KoHalfFloatConverter();
+}
+
+}
+
+KoHalfFloatConverter::~KoHalfFloatConverter()
+{
+}
+
+void KoHalfFloatConverter::halfToFloat(const quint16 *src, float *dst, qint32 numValues) const
+{
+    for (qint32 i = 0; i < numValues; i++) {
+        dst[i] = halfToFloatScalar(src[i]);
+    }
+}
+
+void KoHalfFloatConverter::floatToHalf(const float *src, quint16 *dst, qint32 numValues) const
+{
+    for (qint32 i = 0; i < numValues; i++) {
+        dst[i] = floatToHalfScalar(src[i]);
+    }
+}
+
+const KoHalfFloatConverter* KoHalfFloatConverter::instance()
+{
+    static const QScopedPointer<KoHalfFloatConverter> s_instance(createConverter());
+    return s_instance.data();
+}
+
+bool KoHalfFloatConverter::convertPixels(const KoColorSpace *srcColorSpace, const quint8 *src,
+                                         const KoColorSpace *dstColorSpace, quint8 *dst,
+                                         quint32 numPixels)
+{
+    const KoID srcDepth = srcColorSpace->colorDepthId();
+    const KoID dstDepth = dstColorSpace->colorDepthId();
+
+    const bool srcIsHalf = srcDepth == Float16BitsColorDepthID;
+    const bool dstIsHalf = dstDepth == Float16BitsColorDepthID;
+
+    if (srcIsHalf == dstIsHalf) return false;
+
+    const KoID model = srcColorSpace->colorModelId();
+    if (!(model == dstColorSpace->colorModelId())) return false;
+
+    const KoID otherDepth = srcIsHalf ? dstDepth : srcDepth;
+
+    /**
+     * LCMS encodes 8-bit XYZ differently from the floating point one,
+     * so only RGB and gray 8-bit pixels are just scaled floats
+     */
+    const bool otherIsFloat = otherDepth == Float32BitsColorDepthID;
+    const bool otherIsU8 =
+        otherDepth == Integer8BitsColorDepthID &&
+        (model == RGBAColorModelID || model == GrayAColorModelID);
+
+    if (!otherIsFloat && !otherIsU8) return false;
+
+    const KoColorProfile *srcProfile = srcColorSpace->profile();
+    const KoColorProfile *dstProfile = dstColorSpace->profile();
+    if (!srcProfile || !dstProfile || !(*srcProfile == *dstProfile)) return false;
+
+    const QList<KoChannelInfo*> srcChannels = srcColorSpace->channels();
+    const QList<KoChannelInfo*> dstChannels = dstColorSpace->channels();
+
+    const int maxChannels = 8;
+    const int numChannels = srcChannels.size();
+    if (numChannels != dstChannels.size() || numChannels > maxChannels) return false;
+
+    /**
+     * 8-bit RGB pixels are stored as BGRA, so the channels are
+     * matched by their display position. dstOffsets[i] is the index
+     * of the destination channel for the i-th channel in the source
+     * pixel.
+     */
+    int dstOffsets[maxChannels];
+    bool sameOrder = true;
+
+    for (int i = 0; i < numChannels; i++) {
+        const KoChannelInfo *srcChannel = srcChannels[i];
+        const int dstIndex =
+            KoChannelInfo::displayPositionToChannelIndex(srcChannel->displayPosition(), dstChannels);
+        if (dstIndex < 0) return false;
+
+        const KoChannelInfo *dstChannel = dstChannels[dstIndex];
+        const int srcOffset = srcChannel->pos() / srcChannel->size();
+        const int dstOffset = dstChannel->pos() / dstChannel->size();
+        if (srcOffset >= numChannels || dstOffset >= numChannels) return false;
+
+        dstOffsets[srcOffset] = dstOffset;
+        sameOrder &= srcOffset == dstOffset;
+    }
+
+    const KoHalfFloatConverter *converter = instance();
+
+    if (otherIsFloat) {
+        if (!sameOrder) return false;
+
+        const qint32 numValues = numPixels * numChannels;
+
+        if (srcIsHalf) {
+            converter->halfToFloat(reinterpret_cast<const quint16*>(src), reinterpret_cast<float*>(dst), numValues);
+        } else {
+            converter->floatToHalf(reinterpret_cast<const float*>(src), reinterpret_cast<quint16*>(dst), numValues);
+        }
+
+        return true;
+    }
+
+    /**
+     * 8-bit pixels are converted through a small float buffer that
+     * stays in L1 cache
+     */
+    const int bufferSize = 1024;
+    float buffer[bufferSize];
+    const quint32 pixelsPerChunk = bufferSize / numChannels;
+
+    for (quint32 start = 0; start < numPixels; start += pixelsPerChunk) {
+        const quint32 chunkPixels = qMin(pixelsPerChunk, numPixels - start);
+
+        if (srcIsHalf) {
+            converter->halfToFloat(reinterpret_cast<const quint16*>(src) + start * numChannels,
+                                   buffer, chunkPixels * numChannels);
+
+            const float *srcPixel = buffer;
+            quint8 *dstPixel = dst + start * numChannels;
+
+            for (quint32 i = 0; i < chunkPixels; i++) {
+                for (int c = 0; c < numChannels; c++) {
+                    dstPixel[dstOffsets[c]] = KoColorSpaceMaths<float, quint8>::scaleToA(srcPixel[c]);
+                }
+                srcPixel += numChannels;
+                dstPixel += numChannels;
+            }
+        } else {
+            const quint8 *srcPixel = src + start * numChannels;
+            float *dstPixel = buffer;
+
+            for (quint32 i = 0; i < chunkPixels; i++) {
+                for (int c = 0; c < numChannels; c++) {
+                    dstPixel[dstOffsets[c]] = KoColorSpaceMaths<quint8, float>::scaleToA(srcPixel[c]);
+                }
+                srcPixel += numChannels;
+                dstPixel += numChannels;
+            }
+
+            converter->floatToHalf(buffer, reinterpret_cast<quint16*>(dst) + start * numChannels,
+                                   chunkPixels * numChannels);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOHALFFLOATCONVERTER_H
+#define KOHALFFLOATCONVERTER_H
+
+#include <QtGlobal>
+
+#include "kritapigment_export.h"
+
+class KoColorSpace;
+
+/**
+ * Bulk conversions between 16-bit half floats (as in OpenEXR's half,
+ * passed as raw bits) and 32-bit floats.
+ *
+ * The base class implements bit-exact scalar conversions (round to
+ * nearest even, denormals and infinities preserved, NaNs are
+ * converted into quiet NaNs). instance() returns the version that
+ * uses the F16C instructions if the CPU supports them, the check is
+ * done in runtime, so the binary is still compatible with the older
+ * CPUs.
+ */
+class KRITAPIGMENT_EXPORT KoHalfFloatConverter
+{
+public:
+    virtual ~KoHalfFloatConverter();
+
+    virtual void halfToFloat(const quint16 *src, float *dst, qint32 numValues) const;
+    virtual void floatToHalf(const float *src, quint16 *dst, qint32 numValues) const;
+
+    static const KoHalfFloatConverter* instance();
+
+    /**
+     * Converts the pixels from \p srcColorSpace into \p
+     * dstColorSpace if one of them is a 16-bit float colorspace and
+     * the other one is its 32-bit float or 8-bit integer counterpart
+     * with the same color model and profile. Such a conversion is
+     * just a scaling of the channels, so it is done with the bulk
+     * conversions instead of going through LCMS. Returns false if
+     * the pair of colorspaces is not supported and nothing has been
+     * written.
+     */
+    static bool convertPixels(const KoColorSpace *srcColorSpace, const quint8 *src,
+                              const KoColorSpace *dstColorSpace, quint8 *dst,
+                              quint32 numPixels);
+};
+
+#endif /* KOHALFFLOATCONVERTER_H */
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "KoLabDifferenceOp.h"
+
+#include <cmath>
+
+#include <QScopedPointer>
+
+#include "compositeops/KoOptimizedCompositeOpFactory.h"
+
+
+KoLabDifferenceOp::~KoLabDifferenceOp()
+{
+}
+
+void KoLabDifferenceOp::differenceRow(const quint16 *srcLab, const quint16 *rowLab, qint32 nPixels, quint8 *differences) const
+{
+    // see cmsLabEncoded2Float()
+    const qreal lScale = 1.0 / 655.35;
+    const qreal abScale = 1.0 / 257.0;
+
+    for (qint32 i = 0; i < nPixels; i++) {
+        const qreal dL = (qint32(rowLab[0]) - srcLab[0]) * lScale;
+        const qreal da = (qint32(rowLab[1]) - srcLab[1]) * abScale;
+        const qreal db = (qint32(rowLab[2]) - srcLab[2]) * abScale;
+
+        const qreal diff = std::sqrt(dL * dL + da * da + db * db);
+        differences[i] = diff > 255.0 ? 255 : quint8(diff);
+
+        rowLab += 4;
+    }
+}
+
+const KoLabDifferenceOp* KoLabDifferenceOp::instance()
+{
+    static const QScopedPointer<KoLabDifferenceOp> s_instance(KoOptimizedCompositeOpFactory::createLabDifferenceOp());
+    return s_instance.data();
+}
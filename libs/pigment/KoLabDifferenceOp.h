@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOLABDIFFERENCEOP_H
+#define KOLABDIFFERENCEOP_H
+
+#include <QtGlobal>
+
+#include "kritapigment_export.h"
+
+/**
+ * Computes the difference between LabA16 pixels the way the LCMS color
+ * spaces do in KoColorSpace::difference(): CIE 1976 delta E, truncated
+ * and clamped into the range (0, 255). The alpha channel is ignored.
+ *
+ * The color spaces convert the pixels into LabA16 in batches and then
+ * pass them here. The base class implements the scalar version,
+ * instance() returns the version vectorized for the current CPU.
+ */
+class KRITAPIGMENT_EXPORT KoLabDifferenceOp
+{
+public:
+    virtual ~KoLabDifferenceOp();
+
+    /**
+     * Writes the differences between the pixel \p srcLab and each of
+     * \p nPixels consecutive pixels in \p rowLab into \p differences
+     */
+    virtual void differenceRow(const quint16 *srcLab, const quint16 *rowLab, qint32 nPixels, quint8 *differences) const;
+
+    static const KoLabDifferenceOp* instance();
+};
+
+#endif /* KOLABDIFFERENCEOP_H */
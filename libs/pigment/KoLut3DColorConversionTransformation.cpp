@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#include "KoLut3DColorConversionTransformation.h"
+
+#include <QVector>
+
+#include "KoColorSpace.h"
+#include "KoColorSpaceMaths.h"
+#include "KoColorSpaceRegistry.h"
+#include "KoColorModelStandardIds.h"
+#include "KoLut3DInterpolator.h"
+
+
+namespace {
+
+template <typename channel_t>
+void generateNodes(quint8 *bytes, qint32 gridSize)
+{
+    channel_t *pixel = reinterpret_cast<channel_t*>(bytes);
+
+    const quint32 unitValue = KoColorSpaceMathsTraits<channel_t>::unitValue;
+    const quint32 step = unitValue / (gridSize - 1);
+
+    for (qint32 r = 0; r < gridSize; r++) {
+        for (qint32 g = 0; g < gridSize; g++) {
+            for (qint32 b = 0; b < gridSize; b++) {
+                pixel[0] = b * step;
+                pixel[1] = g * step;
+                pixel[2] = r * step;
+                pixel[3] = unitValue;
+
+                pixel += 4;
+            }
+        }
+    }
+}
+
+}
+
+KoLut3DColorConversionTransformation::KoLut3DColorConversionTransformation(const KoColorSpace *srcCs,
+                                                                           const KoColorSpace *dstCs,
+                                                                           Intent renderingIntent,
+                                                                           ConversionFlags conversionFlags)
+    : KoColorConversionTransformation(srcCs, dstCs, renderingIntent, conversionFlags),
+      m_srcChannelSize(srcCs->pixelSize() / 4),
+      m_dstChannelSize(dstCs->pixelSize() / 4)
+{
+    Q_ASSERT(isSupported(srcCs, dstCs));
+
+    /**
+     * The nodes are converted into 16-bit integers with the profile of
+     * the destination, so that an 8-bit destination doesn't get the
+     * rounding error twice
+     */
+    const KoColorSpace *nodesCs =
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(),
+                                                     Integer16BitsColorDepthID.id(),
+                                                     dstCs->profile());
+    Q_ASSERT(nodesCs);
+
+    const qint32 numNodes = GRID_SIZE * GRID_SIZE * GRID_SIZE;
+
+    QVector<quint8> srcNodes(numNodes * srcCs->pixelSize());
+    QVector<quint16> dstNodes(numNodes * 4);
+
+    if (m_srcChannelSize == 1) {
+        generateNodes<quint8>(srcNodes.data(), GRID_SIZE);
+    } else {
+        generateNodes<quint16>(srcNodes.data(), GRID_SIZE);
+    }
+
+    srcCs->convertPixelsTo(srcNodes.constData(),
+                           reinterpret_cast<quint8*>(dstNodes.data()),
+                           nodesCs, numNodes,
+                           renderingIntent, conversionFlags);
+
+    const float dstUnit = m_dstChannelSize == 1 ?
+        KoColorSpaceMathsTraits<quint8>::unitValue :
+        KoColorSpaceMathsTraits<quint16>::unitValue;
+
+    const float scale = dstUnit / KoColorSpaceMathsTraits<quint16>::unitValue;
+
+    m_lut.resize(numNodes * 4);
+
+    for (qint32 i = 0; i < numNodes * 4; i += 4) {
+        m_lut[i] = dstNodes[i] * scale;
+        m_lut[i + 1] = dstNodes[i + 1] * scale;
+        m_lut[i + 2] = dstNodes[i + 2] * scale;
+        m_lut[i + 3] = 0.0f;
+    }
+}
+
+bool KoLut3DColorConversionTransformation::isSupported(const KoColorSpace *srcCs, const KoColorSpace *dstCs)
+{
+    auto isSupportedSpace = [] (const KoColorSpace *cs) {
+        return cs->colorModelId() == RGBAColorModelID &&
+            (cs->colorDepthId() == Integer8BitsColorDepthID ||
+             cs->colorDepthId() == Integer16BitsColorDepthID);
+    };
+
+    return isSupportedSpace(srcCs) && isSupportedSpace(dstCs);
+}
+
+void KoLut3DColorConversionTransformation::transform(const quint8 *src, quint8 *dst, qint32 nPixels) const
+{
+    KoLut3DInterpolator::instance()->interpolate(m_lut.constData(), GRID_SIZE,
+                                                 src, m_srcChannelSize,
+                                                 dst, m_dstChannelSize,
+                                                 nPixels);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef KOLUT3DCOLORCONVERSIONTRANSFORMATION_H
+#define KOLUT3DCOLORCONVERSIONTRANSFORMATION_H
+
+#include <QVector>
+
+#include "KoColorConversionTransformation.h"
+#include "kritapigment_export.h"
+
+/**
+ * A color conversion transformation that bakes the conversion from
+ * \p srcCs to \p dstCs into a 3D LUT and then applies it with
+ * tetrahedral interpolation (see KoLut3DInterpolator).
+ *
+ * The LUT is built once, in the constructor, by passing its nodes
+ * through the usual color conversion with the given intent and
+ * flags. After that transform() never calls the color management
+ * engine, which makes it much cheaper than a full ICC transform for
+ * the profiles LCMS cannot optimize, e.g. the calibrated monitor
+ * profiles built on top of a LUT.
+ *
+ * The result is approximate: the error of the interpolation is
+ * usually within one or two 8-bit steps. Only 8- and 16-bit RGBA
+ * color spaces are supported, see isSupported().
+ */
+class KRITAPIGMENT_EXPORT KoLut3DColorConversionTransformation : public KoColorConversionTransformation
+{
+public:
+    /**
+     * The number of nodes along every axis. 51 divides both 255 and
+     * 65535, so the nodes fall exactly on the integer channel values
+     * of both depths.
+     */
+    static const qint32 GRID_SIZE = 52;
+
+public:
+    KoLut3DColorConversionTransformation(const KoColorSpace *srcCs,
+                                         const KoColorSpace *dstCs,
+                                         Intent renderingIntent,
+                                         ConversionFlags conversionFlags);
+
+    /**
+     * Returns true if the conversion from \p srcCs to \p dstCs can be
+     * done with a LUT
+     */
+    static bool isSupported(const KoColorSpace *srcCs, const KoColorSpace *dstCs);
+
+    void transform(const quint8 *src, quint8 *dst, qint32 nPixels) const override;
+
+private:
+    QVector<float> m_lut;
+    qint32 m_srcChannelSize;
+    qint32 m_dstChannelSize;
+};
+
+#endif /* KOLUT3DCOLORCONVERSIONTRANSFORMATION_H */
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#include "KoLut3DInterpolator.h"
+
+#include <cmath>
+
+#include <QScopedPointer>
+
+#include "KoColorSpaceMaths.h"
+#include "compositeops/KoOptimizedCompositeOpFactory.h"
+
+
+namespace {
+
+template <typename src_t, typename dst_t>
+void interpolateImpl(const float *lut, qint32 gridSize,
+                     const quint8 *srcBytes, quint8 *dstBytes,
+                     qint32 nPixels)
+{
+    const src_t *src = reinterpret_cast<const src_t*>(srcBytes);
+    dst_t *dst = reinterpret_cast<dst_t*>(dstBytes);
+
+    const float scale = float(gridSize - 1) / KoColorSpaceMathsTraits<src_t>::unitValue;
+    const float alphaScale =
+        float(KoColorSpaceMathsTraits<dst_t>::unitValue) / KoColorSpaceMathsTraits<src_t>::unitValue;
+
+    const qint32 strideB = 4;
+    const qint32 strideG = strideB * gridSize;
+    const qint32 strideR = strideG * gridSize;
+    const qint32 lastCell = gridSize - 2;
+
+    for (qint32 i = 0; i < nPixels; i++) {
+        const float r = src[2] * scale;
+        const float g = src[1] * scale;
+        const float b = src[0] * scale;
+
+        const qint32 ri = qMin(qint32(r), lastCell);
+        const qint32 gi = qMin(qint32(g), lastCell);
+        const qint32 bi = qMin(qint32(b), lastCell);
+
+        const float fr = r - ri;
+        const float fg = g - gi;
+        const float fb = b - bi;
+
+        /**
+         * The cube is split into six tetrahedra along its main
+         * diagonal. The path from the node (0, 0, 0) to the node
+         * (1, 1, 1) steps along the axis with the biggest fraction
+         * first and along the one with the smallest fraction last.
+         */
+        const float maxF = qMax(fr, qMax(fg, fb));
+        const float minF = qMin(fr, qMin(fg, fb));
+        const float midF = fr + fg + fb - maxF - minF;
+
+        const qint32 maxOffset =
+            fr >= fg && fr >= fb ? strideR :
+            fg >= fb ? strideG : strideB;
+
+        const qint32 minOffset =
+            fb <= fr && fb <= fg ? strideB :
+            fg <= fr ? strideG : strideR;
+
+        const float *c0 = lut + ri * strideR + gi * strideG + bi * strideB;
+        const float *c1 = c0 + maxOffset;
+        const float *c2 = c0 + strideR + strideG + strideB - minOffset;
+        const float *c3 = c0 + strideR + strideG + strideB;
+
+        const float w0 = 1.0f - maxF;
+        const float w1 = maxF - midF;
+        const float w2 = midF - minF;
+        const float w3 = minF;
+
+        for (int k = 0; k < 3; k++) {
+            dst[k] = dst_t(std::lround(c0[k] * w0 + c1[k] * w1 + c2[k] * w2 + c3[k] * w3));
+        }
+        dst[3] = dst_t(std::lround(src[3] * alphaScale));
+
+        src += 4;
+        dst += 4;
+    }
+}
+
+}
+
+KoLut3DInterpolator::~KoLut3DInterpolator()
+{
+}
+
+void KoLut3DInterpolator::interpolate(const float *lut, qint32 gridSize,
+                                      const quint8 *src, qint32 srcChannelSize,
+                                      quint8 *dst, qint32 dstChannelSize,
+                                      qint32 nPixels) const
+{
+    if (srcChannelSize == 1) {
+        if (dstChannelSize == 1) {
+            interpolateImpl<quint8, quint8>(lut, gridSize, src, dst, nPixels);
+        } else {
+            interpolateImpl<quint8, quint16>(lut, gridSize, src, dst, nPixels);
+        }
+    } else {
+        if (dstChannelSize == 1) {
+            interpolateImpl<quint16, quint8>(lut, gridSize, src, dst, nPixels);
+        } else {
+            interpolateImpl<quint16, quint16>(lut, gridSize, src, dst, nPixels);
+        }
+    }
+}
+
+const KoLut3DInterpolator* KoLut3DInterpolator::instance()
+{
+    static const QScopedPointer<KoLut3DInterpolator> s_instance(KoOptimizedCompositeOpFactory::createLut3DInterpolator());
+    return s_instance.data();
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef KOLUT3DINTERPOLATOR_H
+#define KOLUT3DINTERPOLATOR_H
+
+#include <QtGlobal>
+
+#include "kritapigment_export.h"
+
+/**
+ * Applies a baked 3D LUT to RGBA pixels using tetrahedral
+ * interpolation. Used by KoLut3DColorConversionTransformation.
+ *
+ * The source and destination pixels are BGRA, 8 or 16 bit per channel
+ * (as in KoBgrU8Traits and KoBgrU16Traits). The LUT has gridSize^3
+ * nodes, the node (r, g, b) is stored at ((r * gridSize + g) *
+ * gridSize + b) * 4 and keeps the blue, green and red values of the
+ * destination pixel, already scaled to the destination channel
+ * range. The fourth float of the node is padding. The alpha channel
+ * is copied with the depth scaled.
+ *
+ * The base class implements the scalar version, instance() returns
+ * the version vectorized for the current CPU.
+ */
+class KRITAPIGMENT_EXPORT KoLut3DInterpolator
+{
+public:
+    virtual ~KoLut3DInterpolator();
+
+    /**
+     * \p srcChannelSize and \p dstChannelSize are the sizes of the
+     * channels in bytes, either 1 or 2
+     */
+    virtual void interpolate(const float *lut, qint32 gridSize,
+                             const quint8 *src, qint32 srcChannelSize,
+                             quint8 *dst, qint32 dstChannelSize,
+                             qint32 nPixels) const;
+
+    static const KoLut3DInterpolator* instance();
+};
+
+#endif /* KOLUT3DINTERPOLATOR_H */
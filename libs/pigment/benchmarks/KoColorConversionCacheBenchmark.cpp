@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This library is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KoColorConversionCacheBenchmark.h"
+
+#include <QTest>
+#include <QThread>
+#include <QVector>
+
+#include <KoColorSpaceRegistry.h>
+#include <KoColorSpace.h>
+#include <KoColorConversionCache.h>
+
+const int NUM_PIXELS = 64;
+const int NUM_CONVERSIONS = 100000;
+
+/**
+ * Converts a short row back and forth between two color spaces, like
+ * the update threads do when converting the layers into the image
+ * color space and the projection into the display one
+ */
+void convertBackAndForth(const KoColorSpace *cs1, const KoColorSpace *cs2, int numConversions)
+{
+    QVector<quint8> data1(NUM_PIXELS * cs1->pixelSize());
+    QVector<quint8> data2(NUM_PIXELS * cs2->pixelSize());
+
+    for (int i = 0; i < numConversions; i++) {
+        cs1->convertPixelsTo(data1.constData(), data2.data(), cs2, NUM_PIXELS,
+                             KoColorConversionTransformation::internalRenderingIntent(),
+                             KoColorConversionTransformation::internalConversionFlags());
+        cs2->convertPixelsTo(data2.constData(), data1.data(), cs1, NUM_PIXELS,
+                             KoColorConversionTransformation::internalRenderingIntent(),
+                             KoColorConversionTransformation::internalConversionFlags());
+    }
+}
+
+class ConversionThread : public QThread
+{
+public:
+    ConversionThread(const KoColorSpace *cs1, const KoColorSpace *cs2, int numConversions)
+        : m_cs1(cs1), m_cs2(cs2), m_numConversions(numConversions)
+    {
+    }
+
+    void run() override {
+        convertBackAndForth(m_cs1, m_cs2, m_numConversions);
+    }
+
+private:
+    const KoColorSpace *m_cs1;
+    const KoColorSpace *m_cs2;
+    int m_numConversions;
+};
+
+void printStatistics(const KoColorConversionCache::Statistics &stats)
+{
+    qDebug() << "hits:" << stats.hits
+             << "misses:" << stats.misses
+             << "contentions:" << stats.contentions;
+}
+
+void KoColorConversionCacheBenchmark::benchmarkSingleThread()
+{
+    const KoColorSpace *cs1 = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *cs2 = KoColorSpaceRegistry::instance()->rgb16();
+    KoColorConversionCache *cache = KoColorSpaceRegistry::instance()->colorConversionCache();
+
+    cache->resetStatistics();
+
+    QBENCHMARK {
+        convertBackAndForth(cs1, cs2, NUM_CONVERSIONS);
+    }
+
+    printStatistics(cache->statistics());
+}
+
+void KoColorConversionCacheBenchmark::benchmarkConcurrent_data()
+{
+    QTest::addColumn<int>("numThreads");
+
+    QTest::newRow("2") << 2;
+    QTest::newRow("4") << 4;
+    QTest::newRow("ideal") << QThread::idealThreadCount();
+}
+
+void KoColorConversionCacheBenchmark::benchmarkConcurrent()
+{
+    QFETCH(int, numThreads);
+
+    const KoColorSpace *cs1 = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *cs2 = KoColorSpaceRegistry::instance()->rgb16();
+    KoColorConversionCache *cache = KoColorSpaceRegistry::instance()->colorConversionCache();
+
+    cache->resetStatistics();
+
+    QBENCHMARK {
+        QVector<ConversionThread*> threads;
+
+        for (int i = 0; i < numThreads; i++) {
+            threads << new ConversionThread(cs1, cs2, NUM_CONVERSIONS / numThreads);
+        }
+
+        Q_FOREACH (ConversionThread *thread, threads) {
+            thread->start();
+        }
+
+        Q_FOREACH (ConversionThread *thread, threads) {
+            thread->wait();
+        }
+
+        qDeleteAll(threads);
+    }
+
+    printStatistics(cache->statistics());
+}
+
+QTEST_GUILESS_MAIN(KoColorConversionCacheBenchmark)
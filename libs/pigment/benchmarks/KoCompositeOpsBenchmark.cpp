@@ -20,11 +20,18 @@
 
 #include "../compositeops/KoCompositeOpAlphaDarken.h"
 #include "../compositeops/KoCompositeOpOver.h"
+#include "../compositeops/KoCompositeOpCopy2.h"
+#include "../compositeops/KoCompositeOpGeneric.h"
 #include <KoOptimizedCompositeOpFactory.h>
+#include <KoCompositeOpRegistry.h>
 
 #include <KoColorSpaceTraits.h>
 #include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
 
+#include <QScopedPointer>
+#include <QStringList>
+#include <QVector>
 #include <QTest>
 
 const int TILE_WIDTH = 64;
@@ -38,6 +45,9 @@ const quint8 OPACITY_HALF = 128;
 const int TILES_IN_WIDTH = IMG_WIDTH / TILE_WIDTH;
 const int TILES_IN_HEIGHT = IMG_HEIGHT / TILE_HEIGHT;
 
+// the biggest pixel used by the benchmarks
+const int MAX_PIXEL_SIZE = KoRgbF32Traits::pixelSize;
+
 
 #define COMPOSITE_BENCHMARK \
         for (int y = 0; y < TILES_IN_HEIGHT; y++){                                              \
@@ -52,15 +62,15 @@ const int TILES_IN_HEIGHT = IMG_HEIGHT / TILE_HEIGHT;
 
 void KoCompositeOpsBenchmark::initTestCase()
 {
-    m_dstBuffer = new quint8[ TILE_WIDTH * TILE_HEIGHT * KoBgrU16Traits::pixelSize ];
-    m_srcBuffer = new quint8[ TILE_WIDTH * TILE_HEIGHT * KoBgrU16Traits::pixelSize ];
+    m_dstBuffer = new quint8[ TILE_WIDTH * TILE_HEIGHT * MAX_PIXEL_SIZE ];
+    m_srcBuffer = new quint8[ TILE_WIDTH * TILE_HEIGHT * MAX_PIXEL_SIZE ];
 }
 
 // this is called before every benchmark
 void KoCompositeOpsBenchmark::init()
 {
-    memset(m_dstBuffer, 42 , TILE_WIDTH * TILE_HEIGHT * KoBgrU16Traits::pixelSize);
-    memset(m_srcBuffer, 42 , TILE_WIDTH * TILE_HEIGHT * KoBgrU16Traits::pixelSize);
+    memset(m_dstBuffer, 42 , TILE_WIDTH * TILE_HEIGHT * MAX_PIXEL_SIZE);
+    memset(m_srcBuffer, 42 , TILE_WIDTH * TILE_HEIGHT * MAX_PIXEL_SIZE);
 }
 
 
@@ -72,7 +82,7 @@ void KoCompositeOpsBenchmark::cleanupTestCase()
 
 void KoCompositeOpsBenchmark::benchmarkCompositeOver()
 {
-    KoCompositeOp *compositeOp = KoOptimizedCompositeOpFactory::createOverOp32(KoColorSpaceRegistry::instance()->rgb16());
+    KoCompositeOp *compositeOp = KoOptimizedCompositeOpFactory::createOverOp64(KoColorSpaceRegistry::instance()->rgb16());
     QBENCHMARK{
         COMPOSITE_BENCHMARK
     }
@@ -81,11 +91,230 @@ void KoCompositeOpsBenchmark::benchmarkCompositeOver()
 void KoCompositeOpsBenchmark::benchmarkCompositeAlphaDarken()
 {
     //KoCompositeOpAlphaDarken<KoBgrU16Traits> compositeOp(0);
-    KoCompositeOp *compositeOp = KoOptimizedCompositeOpFactory::createAlphaDarkenOp32(KoColorSpaceRegistry::instance()->rgb16());
+    KoCompositeOp *compositeOp = KoOptimizedCompositeOpFactory::createAlphaDarkenOp64(KoColorSpaceRegistry::instance()->rgb16());
+    QBENCHMARK{
+        COMPOSITE_BENCHMARK
+    }
+}
+
+void KoCompositeOpsBenchmark::benchmarkCompositeCopy()
+{
+    KoCompositeOp *compositeOp = KoOptimizedCompositeOpFactory::createCopyOp64(KoColorSpaceRegistry::instance()->rgb16());
     QBENCHMARK{
         COMPOSITE_BENCHMARK
     }
 }
 
+KoCompositeOp* createU16Op(const QString &id, bool optimized)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16();
+
+    if (optimized) {
+        return
+            id == COMPOSITE_OVER ? KoOptimizedCompositeOpFactory::createOverOp64(cs) :
+            id == COMPOSITE_ALPHA_DARKEN ? KoOptimizedCompositeOpFactory::createAlphaDarkenOp64(cs) :
+            KoOptimizedCompositeOpFactory::createCopyOp64(cs);
+    }
+
+    return
+        id == COMPOSITE_OVER ? (KoCompositeOp*) new KoCompositeOpOver<KoBgrU16Traits>(cs) :
+        id == COMPOSITE_ALPHA_DARKEN ? (KoCompositeOp*) new KoCompositeOpAlphaDarken<KoBgrU16Traits>(cs) :
+        (KoCompositeOp*) new KoCompositeOpCopy2<KoBgrU16Traits>(cs);
+}
+
+void KoCompositeOpsBenchmark::compareU16Ops_data()
+{
+    QTest::addColumn<QString>("id");
+    QTest::addColumn<bool>("useMask");
+
+    QStringList ids;
+    ids << COMPOSITE_OVER << COMPOSITE_ALPHA_DARKEN << COMPOSITE_COPY;
+
+    Q_FOREACH (const QString &id, ids) {
+        QTest::newRow(qPrintable(id)) << id << false;
+        QTest::newRow(qPrintable(id + "-mask")) << id << true;
+    }
+}
+
+void KoCompositeOpsBenchmark::compareU16Ops()
+{
+    QFETCH(QString, id);
+    QFETCH(bool, useMask);
+
+    QScopedPointer<KoCompositeOp> optimizedOp(createU16Op(id, true));
+    QScopedPointer<KoCompositeOp> scalarOp(createU16Op(id, false));
+
+    const int numPixels = TILE_WIDTH * TILE_HEIGHT;
+    const int pixelSize = KoBgrU16Traits::pixelSize;
+
+    QVector<quint8> expectedDst(numPixels * pixelSize);
+    QVector<quint8> mask(numPixels);
+
+    // every 16-bit pixel is filled as two random 8-bit ones
+    fillRandomPixels(m_srcBuffer, 2 * numPixels, false, 1);
+    fillRandomPixels(m_dstBuffer, 2 * numPixels, false, 2);
+    for (int i = 0; i < numPixels; i++) {
+        mask[i] = qrand() & 0xff;
+    }
+    memcpy(expectedDst.data(), m_dstBuffer, numPixels * pixelSize);
+
+    optimizedOp->composite(m_dstBuffer, TILE_WIDTH * pixelSize,
+                           m_srcBuffer, TILE_WIDTH * pixelSize,
+                           useMask ? mask.data() : 0, TILE_WIDTH,
+                           TILE_HEIGHT, TILE_WIDTH,
+                           OPACITY_HALF);
+
+    scalarOp->composite(expectedDst.data(), TILE_WIDTH * pixelSize,
+                        m_srcBuffer, TILE_WIDTH * pixelSize,
+                        useMask ? mask.data() : 0, TILE_WIDTH,
+                        TILE_HEIGHT, TILE_WIDTH,
+                        OPACITY_HALF);
+
+    const quint16 *act = reinterpret_cast<const quint16*>(m_dstBuffer);
+    const quint16 *exp = reinterpret_cast<const quint16*>(expectedDst.constData());
+
+    for (int i = 0; i < numPixels * 4; i++) {
+        const bool isAlpha = i % 4 == 3;
+        const int pixelAlphaIndex = i - i % 4 + 3;
+
+        /**
+         * The integer reference version divides by the new alpha
+         * when unmultiplying the colors, so its own precision is too
+         * low for the colors of almost transparent pixels
+         */
+        if (!isAlpha && exp[pixelAlphaIndex] < 256) continue;
+
+        if (qAbs(int(act[i]) - int(exp[i])) > 16) {
+            QFAIL(QString("Pixel %1 channel %2: %3 != %4").arg(i / 4).arg(i % 4).arg(act[i]).arg(exp[i]).toLatin1());
+        }
+    }
+}
+
+/**
+ * Creates either the generic op or its vectorized version from
+ * the blend function, exactly as addStandardCompositeOps() does
+ */
+template<class Traits, typename Traits::channels_type compositeFunc(typename Traits::channels_type, typename Traits::channels_type)>
+KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString &id, bool optimized)
+{
+    typedef typename Traits::channels_type T;
+
+    if (!optimized) {
+        return new KoCompositeOpGenericSC<Traits, compositeFunc>(cs, id, id, "");
+    }
+
+    const KoStreamedBlendFunctions::BlendMode blendMode =
+        KoStreamedBlendFunctions::blendModeForFunction<T, compositeFunc>();
+
+    return Traits::pixelSize == 4 ?
+        KoOptimizedCompositeOpFactory::createGenericSCOp32(cs, blendMode, id, id, "") :
+        KoOptimizedCompositeOpFactory::createGenericSCOp128(cs, blendMode, id, id, "");
+}
+
+template<class Traits>
+KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString &id, bool optimized)
+{
+    typedef typename Traits::channels_type T;
+
+    return
+        id == COMPOSITE_MULT ? createGenericSCOp<Traits, &cfMultiply<T> >(cs, id, optimized) :
+        id == COMPOSITE_SCREEN ? createGenericSCOp<Traits, &cfScreen<T> >(cs, id, optimized) :
+        id == COMPOSITE_OVERLAY ? createGenericSCOp<Traits, &cfOverlay<T> >(cs, id, optimized) :
+        id == COMPOSITE_HARD_LIGHT ? createGenericSCOp<Traits, &cfHardLight<T> >(cs, id, optimized) :
+        id == COMPOSITE_SOFT_LIGHT_PHOTOSHOP ? createGenericSCOp<Traits, &cfSoftLight<T> >(cs, id, optimized) :
+        id == COMPOSITE_DODGE ? createGenericSCOp<Traits, &cfColorDodge<T> >(cs, id, optimized) :
+        id == COMPOSITE_ADD ? createGenericSCOp<Traits, &cfAddition<T> >(cs, id, optimized) :
+        id == COMPOSITE_SUBTRACT ? createGenericSCOp<Traits, &cfSubtract<T> >(cs, id, optimized) :
+        id == COMPOSITE_DIFF ? createGenericSCOp<Traits, &cfDifference<T> >(cs, id, optimized) :
+        id == COMPOSITE_DARKEN ? createGenericSCOp<Traits, &cfDarkenOnly<T> >(cs, id, optimized) :
+        id == COMPOSITE_LIGHTEN ? createGenericSCOp<Traits, &cfLightenOnly<T> >(cs, id, optimized) :
+        id == COMPOSITE_EXCLUSION ? createGenericSCOp<Traits, &cfExclusion<T> >(cs, id, optimized) :
+        (KoCompositeOp*)0;
+}
+
+const KoColorSpace* blendModesColorSpace(bool useFloat)
+{
+    return useFloat ?
+        KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float32BitsColorDepthID.id(), "") :
+        KoColorSpaceRegistry::instance()->rgb8();
+}
+
+KoCompositeOp* createBlendModeOp(const QString &id, bool useFloat, bool optimized)
+{
+    const KoColorSpace *cs = blendModesColorSpace(useFloat);
+
+    return useFloat ?
+        createGenericSCOp<KoRgbF32Traits>(cs, id, optimized) :
+        createGenericSCOp<KoBgrU8Traits>(cs, id, optimized);
+}
+
+void fillRandomPixels(quint8 *buffer, int numPixels, bool useFloat, int seed)
+{
+    qsrand(seed);
+
+    if (useFloat) {
+        float *ptr = reinterpret_cast<float*>(buffer);
+        for (int i = 0; i < numPixels * 4; i++) {
+            ptr[i] = float(qrand()) / RAND_MAX;
+        }
+    } else {
+        for (int i = 0; i < numPixels * 4; i++) {
+            buffer[i] = qrand() & 0xff;
+        }
+    }
+}
+
+void KoCompositeOpsBenchmark::benchmarkBlendModes_data()
+{
+    QTest::addColumn<QString>("id");
+    QTest::addColumn<bool>("useFloat");
+    QTest::addColumn<bool>("optimized");
+
+    QStringList ids;
+    ids << COMPOSITE_MULT << COMPOSITE_SCREEN << COMPOSITE_OVERLAY
+        << COMPOSITE_HARD_LIGHT << COMPOSITE_SOFT_LIGHT_PHOTOSHOP
+        << COMPOSITE_DODGE << COMPOSITE_ADD << COMPOSITE_SUBTRACT
+        << COMPOSITE_DIFF << COMPOSITE_DARKEN << COMPOSITE_LIGHTEN
+        << COMPOSITE_EXCLUSION;
+
+    Q_FOREACH (const QString &id, ids) {
+        for (int useFloat = 0; useFloat <= 1; useFloat++) {
+            const QString name = id + (useFloat ? "-f32" : "-u8");
+
+            QTest::newRow(qPrintable(name + "-scalar")) << id << bool(useFloat) << false;
+            QTest::newRow(qPrintable(name + "-optimized")) << id << bool(useFloat) << true;
+        }
+    }
+}
+
+void KoCompositeOpsBenchmark::benchmarkBlendModes()
+{
+    QFETCH(QString, id);
+    QFETCH(bool, useFloat);
+    QFETCH(bool, optimized);
+
+    QScopedPointer<KoCompositeOp> compositeOp(createBlendModeOp(id, useFloat, optimized));
+
+    if (!compositeOp) {
+        QSKIP("No vector implementation on this CPU");
+    }
+
+    const int pixelSize = useFloat ? KoRgbF32Traits::pixelSize : KoBgrU8Traits::pixelSize;
+
+    fillRandomPixels(m_srcBuffer, TILE_WIDTH * TILE_HEIGHT, useFloat, 1);
+    fillRandomPixels(m_dstBuffer, TILE_WIDTH * TILE_HEIGHT, useFloat, 2);
+
+    QBENCHMARK{
+        for (int y = 0; y < TILES_IN_HEIGHT; y++){
+            for (int x = 0; x < TILES_IN_WIDTH; x++){
+                compositeOp->composite(m_dstBuffer, TILE_WIDTH * pixelSize,
+                                       m_srcBuffer, TILE_WIDTH * pixelSize,
+                                       0, 0,
+                                       TILE_HEIGHT, TILE_WIDTH,
+                                       OPACITY_HALF);
+            }
+        }
+    }
+}
 
 QTEST_GUILESS_MAIN(KoCompositeOpsBenchmark)
@@ -32,6 +32,13 @@ private Q_SLOTS:
     
     void benchmarkCompositeOver();
     void benchmarkCompositeAlphaDarken();
+    void benchmarkCompositeCopy();
+
+    void compareU16Ops_data();
+    void compareU16Ops();
+
+    void benchmarkBlendModes_data();
+    void benchmarkBlendModes();
 
 private:
     quint8 * m_dstBuffer;
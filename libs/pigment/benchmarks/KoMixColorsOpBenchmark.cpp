@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This library is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KoMixColorsOpBenchmark.h"
+
+#include <QTest>
+#include <QScopedPointer>
+#include <QVector>
+
+#include <KoColorSpaceTraits.h>
+#include <KoMixColorsOpImpl.h>
+#include <KoOptimizedCompositeOpFactory.h>
+
+const int NUM_MIXES = 10000;
+
+void KoMixColorsOpBenchmark::benchmarkMixColors_data()
+{
+    QTest::addColumn<bool>("useFloat");
+    QTest::addColumn<bool>("useOptimizedOp");
+    QTest::addColumn<bool>("useWeights");
+    QTest::addColumn<int>("numColors");
+
+    QList<int> sizes;
+    sizes << 4 << 16 << 64 << 256;
+
+    for (int i = 0; i < 8; i++) {
+        const bool useFloat = i & 0x1;
+        const bool useOptimizedOp = i & 0x2;
+        const bool useWeights = i & 0x4;
+
+        Q_FOREACH (int numColors, sizes) {
+            const QString name = QString("%1-%2-%3-%4")
+                .arg(useFloat ? "f32" : "u8")
+                .arg(useOptimizedOp ? "optimized" : "generic")
+                .arg(useWeights ? "weighted" : "unweighted")
+                .arg(numColors);
+
+            QTest::newRow(name.toLatin1()) << useFloat << useOptimizedOp << useWeights << numColors;
+        }
+    }
+}
+
+/**
+ * Mixes a contiguous array of pixels, like the color smudge and
+ * KisRandomSubAccessor do for every dab/pixel
+ */
+void KoMixColorsOpBenchmark::benchmarkMixColors()
+{
+    QFETCH(bool, useFloat);
+    QFETCH(bool, useOptimizedOp);
+    QFETCH(bool, useWeights);
+    QFETCH(int, numColors);
+
+    QScopedPointer<KoMixColorsOp> op;
+
+    if (useFloat) {
+        op.reset(useOptimizedOp ?
+                 KoOptimizedCompositeOpFactory::createMixColorsOp128() :
+                 new KoMixColorsOpImpl<KoRgbF32Traits>());
+    } else {
+        op.reset(useOptimizedOp ?
+                 KoOptimizedCompositeOpFactory::createMixColorsOp32() :
+                 new KoMixColorsOpImpl<KoBgrU8Traits>());
+    }
+
+    const int pixelSize = useFloat ? KoRgbF32Traits::pixelSize : KoBgrU8Traits::pixelSize;
+
+    QVector<quint8> colors(numColors * pixelSize);
+    QVector<qint16> weights(numColors);
+    quint8 dst[16];
+
+    if (useFloat) {
+        float *ptr = reinterpret_cast<float*>(colors.data());
+        for (int i = 0; i < 4 * numColors; i++) {
+            ptr[i] = float(qrand() % 256) / 255;
+        }
+    } else {
+        for (int i = 0; i < colors.size(); i++) {
+            colors[i] = qrand() % 256;
+        }
+    }
+
+    for (int i = 0; i < numColors; i++) {
+        weights[i] = 255 / numColors;
+    }
+
+    QBENCHMARK {
+        for (int i = 0; i < NUM_MIXES; i++) {
+            if (useWeights) {
+                op->mixColors(colors.constData(), weights.constData(), numColors, dst);
+            } else {
+                op->mixColors(colors.constData(), numColors, dst);
+            }
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(KoMixColorsOpBenchmark)
@@ -0,0 +1,395 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This library is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "KoPigmentBenchmarkMatrix.h"
+
+#include <QTest>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QBitArray>
+#include <QRegularExpression>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QHash>
+#include <QStringList>
+
+#include <limits>
+
+#include <KoColorSpaceRegistry.h>
+#include <KoColorSpace.h>
+#include <KoChannelInfo.h>
+#include <KoCompositeOp.h>
+
+const int TILE_WIDTH = 64;
+const int TILE_HEIGHT = 64;
+const int TILE_PIXELS = TILE_WIDTH * TILE_HEIGHT;
+
+const int NUM_RANDOM_COLORS = 256;
+
+namespace {
+
+struct Settings {
+    Settings()
+        : outputFileName(qgetenv("KRITA_BENCHMARK_MATRIX_OUTPUT")),
+          baselineFileName(qgetenv("KRITA_BENCHMARK_MATRIX_BASELINE")),
+          threshold(25.0),
+          filter(QString(qgetenv("KRITA_BENCHMARK_MATRIX_FILTER"))),
+          minTime(20),
+          numSamples(5)
+    {
+        if (outputFileName.isEmpty()) {
+            outputFileName = "KoPigmentBenchmarkMatrix.json";
+        }
+
+        bool ok = false;
+
+        const qreal envThreshold = qgetenv("KRITA_BENCHMARK_MATRIX_THRESHOLD").toDouble(&ok);
+        if (ok) threshold = envThreshold;
+
+        const int envTime = qgetenv("KRITA_BENCHMARK_MATRIX_TIME").toInt(&ok);
+        if (ok && envTime > 0) minTime = envTime;
+
+        const int envSamples = qgetenv("KRITA_BENCHMARK_MATRIX_SAMPLES").toInt(&ok);
+        if (ok && envSamples > 0) numSamples = envSamples;
+    }
+
+    bool accepts(const QString &name) const {
+        return filter.pattern().isEmpty() || filter.match(name).hasMatch();
+    }
+
+    QString outputFileName;
+    QString baselineFileName;
+    qreal threshold;
+    QRegularExpression filter;
+    int minTime;
+    int numSamples;
+};
+
+Q_GLOBAL_STATIC(Settings, s_settings)
+
+QList<const KoColorSpace*> allColorSpaces()
+{
+    return KoColorSpaceRegistry::instance()->allColorSpaces(KoColorSpaceRegistry::AllColorSpaces,
+                                                            KoColorSpaceRegistry::OnlyDefaultProfile);
+}
+
+/**
+ * Random bytes would make NaNs and denormals in the float
+ * colorspaces, so the tile is filled with the random normalized
+ * colors instead
+ */
+QVector<quint8> randomPixels(const KoColorSpace *cs, int numPixels)
+{
+    const int pixelSize = cs->pixelSize();
+    const int numChannels = cs->channelCount();
+
+    QVector<quint8> colors(NUM_RANDOM_COLORS * pixelSize);
+    QVector<float> channelValues(numChannels);
+
+    for (int i = 0; i < NUM_RANDOM_COLORS; i++) {
+        for (int c = 0; c < numChannels; c++) {
+            channelValues[c] = qrand() / float(RAND_MAX);
+        }
+        cs->fromNormalisedChannelsValue(colors.data() + i * pixelSize, channelValues);
+    }
+
+    QVector<quint8> pixels(numPixels * pixelSize);
+
+    for (int i = 0; i < numPixels; i++) {
+        const int color = qrand() % NUM_RANDOM_COLORS;
+        memcpy(pixels.data() + i * pixelSize, colors.constData() + color * pixelSize, pixelSize);
+    }
+
+    return pixels;
+}
+
+/**
+ * Measures the throughput of \p func processing \p numPixels pixels
+ * in every call.
+ *
+ * The first run of at least the minimal time warms up the caches and
+ * the lazily created conversions and finds out how many calls fit
+ * into a sample. Then the samples of that many calls are taken and the
+ * fastest of them is returned: the noise (preemption, frequency
+ * scaling, other processes) can only make a sample slower, so the
+ * fastest one is the most reproducible.
+ */
+template <class Func>
+qreal measurePixelsPerSecond(int numPixels, Func func)
+{
+    const int minIterations = 3;
+    const qint64 minTime = qint64(s_settings->minTime) * 1000000;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    qint64 numIterations = 0;
+
+    do {
+        func();
+        numIterations++;
+    } while (numIterations < minIterations || timer.nsecsElapsed() < minTime);
+
+    qint64 bestElapsed = std::numeric_limits<qint64>::max();
+
+    for (int sample = 0; sample < s_settings->numSamples; sample++) {
+        timer.restart();
+
+        for (qint64 i = 0; i < numIterations; i++) {
+            func();
+        }
+
+        bestElapsed = qMin(bestElapsed, qMax(qint64(1), timer.nsecsElapsed()));
+    }
+
+    return qreal(numIterations) * numPixels / (bestElapsed * 1e-9);
+}
+
+QString resultName(const KoPigmentBenchmarkMatrix::Result &result)
+{
+    if (result.group == "composite") {
+        return QString("composite/%1/%2/%3/%4/%5")
+            .arg(result.colorSpace)
+            .arg(result.target)
+            .arg(result.haveMask ? "mask" : "nomask")
+            .arg(result.opacity)
+            .arg(result.channelFlags);
+    }
+
+    return QString("%1/%2/%3").arg(result.group).arg(result.colorSpace).arg(result.target);
+}
+
+QJsonObject toJson(const KoPigmentBenchmarkMatrix::Result &result)
+{
+    QJsonObject object;
+    object["name"] = result.name;
+    object["group"] = result.group;
+    object["colorSpace"] = result.colorSpace;
+    object["target"] = result.target;
+    object["haveMask"] = result.haveMask;
+    object["opacity"] = result.opacity;
+    object["channelFlags"] = result.channelFlags;
+    object["pixelsPerSecond"] = result.pixelsPerSecond;
+    return object;
+}
+
+}
+
+void KoPigmentBenchmarkMatrix::initTestCase()
+{
+    qsrand(1);
+
+    QVERIFY(!allColorSpaces().isEmpty());
+    QVERIFY(s_settings->filter.isValid());
+}
+
+void KoPigmentBenchmarkMatrix::benchmarkCompositeOps()
+{
+    QVector<quint8> mask(TILE_PIXELS);
+    for (int i = 0; i < TILE_PIXELS; i++) {
+        mask[i] = qrand() % 256;
+    }
+
+    const qreal opacities[] = {1.0, 0.5};
+
+    Q_FOREACH (const KoColorSpace *cs, allColorSpaces()) {
+        const QVector<quint8> src = randomPixels(cs, TILE_PIXELS);
+        const QVector<quint8> dstOriginal = randomPixels(cs, TILE_PIXELS);
+        QVector<quint8> dst = dstOriginal;
+
+        const int rowStride = TILE_WIDTH * cs->pixelSize();
+
+        QBitArray alphaLockedFlags;
+        const QList<KoChannelInfo*> channels = cs->channels();
+        for (int i = 0; i < channels.size(); i++) {
+            if (channels[i]->channelType() == KoChannelInfo::ALPHA) {
+                alphaLockedFlags = QBitArray(channels.size(), true);
+                alphaLockedFlags.clearBit(i);
+            }
+        }
+
+        QList<QPair<QString, QBitArray>> channelFlagsVariants;
+        channelFlagsVariants << qMakePair(QString("all"), QBitArray());
+        if (!alphaLockedFlags.isEmpty()) {
+            channelFlagsVariants << qMakePair(QString("alphalocked"), alphaLockedFlags);
+        }
+
+        Q_FOREACH (const KoCompositeOp *op, cs->compositeOps()) {
+            for (int haveMask = 0; haveMask <= 1; haveMask++) {
+                for (qreal opacity : opacities) {
+                    for (int f = 0; f < channelFlagsVariants.size(); f++) {
+                        Result result;
+                        result.group = "composite";
+                        result.colorSpace = cs->id();
+                        result.target = op->id();
+                        result.haveMask = haveMask;
+                        result.opacity = opacity;
+                        result.channelFlags = channelFlagsVariants[f].first;
+                        result.name = resultName(result);
+
+                        if (!s_settings->accepts(result.name)) continue;
+
+                        KoCompositeOp::ParameterInfo params;
+                        params.dstRowStride = rowStride;
+                        params.srcRowStart = src.constData();
+                        params.srcRowStride = rowStride;
+                        params.maskRowStart = haveMask ? mask.constData() : 0;
+                        params.maskRowStride = haveMask ? TILE_WIDTH : 0;
+                        params.rows = TILE_HEIGHT;
+                        params.cols = TILE_WIDTH;
+                        params.opacity = opacity;
+                        params.flow = 1.0;
+                        params.channelFlags = channelFlagsVariants[f].second;
+
+                        /**
+                         * Restore the destination before every case, otherwise
+                         * the ops that saturate the pixels (like "copy" or
+                         * "erase") would make the next ops run on degenerated data
+                         */
+                        dst = dstOriginal;
+                        params.dstRowStart = dst.data();
+
+                        result.pixelsPerSecond = measurePixelsPerSecond(TILE_PIXELS, [&] () {
+                            op->composite(params);
+                        });
+
+                        m_results << result;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void KoPigmentBenchmarkMatrix::benchmarkColorConversions()
+{
+    const QList<const KoColorSpace*> colorSpaces = allColorSpaces();
+
+    Q_FOREACH (const KoColorSpace *srcCS, colorSpaces) {
+        const QVector<quint8> src = randomPixels(srcCS, TILE_PIXELS);
+
+        Q_FOREACH (const KoColorSpace *dstCS, colorSpaces) {
+            if (srcCS == dstCS) continue;
+
+            Result result;
+            result.group = "conversion";
+            result.colorSpace = srcCS->id();
+            result.target = dstCS->id();
+            result.haveMask = false;
+            result.opacity = 1.0;
+            result.name = resultName(result);
+
+            if (!s_settings->accepts(result.name)) continue;
+
+            QVector<quint8> dst(TILE_PIXELS * dstCS->pixelSize());
+
+            result.pixelsPerSecond = measurePixelsPerSecond(TILE_PIXELS, [&] () {
+                srcCS->convertPixelsTo(src.constData(), dst.data(), dstCS, TILE_PIXELS,
+                                       KoColorConversionTransformation::internalRenderingIntent(),
+                                       KoColorConversionTransformation::internalConversionFlags());
+            });
+
+            m_results << result;
+        }
+    }
+}
+
+void KoPigmentBenchmarkMatrix::saveResults()
+{
+    QFile file(s_settings->outputFileName);
+    QVERIFY2(file.open(QIODevice::WriteOnly | QIODevice::Truncate),
+             qPrintable(QString("Cannot open %1").arg(s_settings->outputFileName)));
+
+    if (s_settings->outputFileName.endsWith(".csv", Qt::CaseInsensitive)) {
+        QTextStream stream(&file);
+        stream << "name,group,colorSpace,target,haveMask,opacity,channelFlags,pixelsPerSecond\n";
+
+        Q_FOREACH (const Result &result, m_results) {
+            stream << result.name << ','
+                   << result.group << ','
+                   << result.colorSpace << ','
+                   << result.target << ','
+                   << int(result.haveMask) << ','
+                   << result.opacity << ','
+                   << result.channelFlags << ','
+                   << qint64(result.pixelsPerSecond) << '\n';
+        }
+    } else {
+        QJsonArray array;
+        Q_FOREACH (const Result &result, m_results) {
+            array.append(toJson(result));
+        }
+
+        QJsonObject root;
+        root["results"] = array;
+        file.write(QJsonDocument(root).toJson());
+    }
+
+    qDebug() << "Saved" << m_results.size() << "results into" << s_settings->outputFileName;
+}
+
+void KoPigmentBenchmarkMatrix::compareWithBaseline()
+{
+    if (s_settings->baselineFileName.isEmpty()) {
+        QSKIP("KRITA_BENCHMARK_MATRIX_BASELINE is not set");
+    }
+
+    QFile file(s_settings->baselineFileName);
+    QVERIFY2(file.open(QIODevice::ReadOnly),
+             qPrintable(QString("Cannot open %1").arg(s_settings->baselineFileName)));
+
+    const QJsonArray baselineArray =
+        QJsonDocument::fromJson(file.readAll()).object().value("results").toArray();
+
+    QHash<QString, qreal> baseline;
+    Q_FOREACH (const QJsonValue &value, baselineArray) {
+        const QJsonObject object = value.toObject();
+        baseline.insert(object.value("name").toString(), object.value("pixelsPerSecond").toDouble());
+    }
+
+    const qreal minRatio = 1.0 - s_settings->threshold / 100.0;
+
+    QStringList regressions;
+    int numCompared = 0;
+
+    Q_FOREACH (const Result &result, m_results) {
+        const qreal baselineSpeed = baseline.value(result.name, 0.0);
+        if (baselineSpeed <= 0.0) continue;
+
+        numCompared++;
+
+        const qreal ratio = result.pixelsPerSecond / baselineSpeed;
+        if (ratio < minRatio) {
+            regressions << QString("%1: %2% of the baseline").arg(result.name).arg(qRound(ratio * 100));
+        }
+    }
+
+    qDebug() << "Compared" << numCompared << "cases with the baseline";
+
+    Q_FOREACH (const QString &regression, regressions) {
+        qWarning() << "REGRESSION:" << regression;
+    }
+
+    QVERIFY2(regressions.isEmpty(),
+             qPrintable(QString("%1 cases are slower than the baseline").arg(regressions.size())));
+}
+
+QTEST_GUILESS_MAIN(KoPigmentBenchmarkMatrix)
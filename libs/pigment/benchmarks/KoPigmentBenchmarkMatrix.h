@@ -0,0 +1,84 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This library is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KO_PIGMENT_BENCHMARK_MATRIX_H_
+#define KO_PIGMENT_BENCHMARK_MATRIX_H_
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+/**
+ * Sweeps every composite op of every registered colorspace (with the
+ * default profile) and every pair of colorspaces for convertPixelsTo(),
+ * measures the throughput in pixels per second and saves it in a
+ * machine-readable form.
+ *
+ * Every composite op is measured with and without a mask, with full
+ * and half opacity and with all the channels or with the alpha
+ * channel locked.
+ *
+ * The run is controlled by the environment variables:
+ *
+ * KRITA_BENCHMARK_MATRIX_OUTPUT    the file to save the results into,
+ *                                  CSV if the name ends with ".csv",
+ *                                  JSON otherwise (default:
+ *                                  KoPigmentBenchmarkMatrix.json)
+ * KRITA_BENCHMARK_MATRIX_BASELINE  the JSON file of a previous run; if
+ *                                  set, the test fails if any case
+ *                                  became slower than the threshold
+ * KRITA_BENCHMARK_MATRIX_THRESHOLD allowed slowdown in percent
+ *                                  (default: 25)
+ * KRITA_BENCHMARK_MATRIX_FILTER    a regular expression, only the cases
+ *                                  whose names match it are run
+ * KRITA_BENCHMARK_MATRIX_TIME      minimal measuring time of a single
+ *                                  sample in milliseconds (default: 20)
+ * KRITA_BENCHMARK_MATRIX_SAMPLES   number of the samples taken for every
+ *                                  case, the fastest one is reported
+ *                                  (default: 5)
+ */
+class KoPigmentBenchmarkMatrix : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Result {
+        QString name;
+        QString group;
+        QString colorSpace;
+        QString target;
+        bool haveMask;
+        qreal opacity;
+        QString channelFlags;
+        qreal pixelsPerSecond;
+    };
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void benchmarkCompositeOps();
+    void benchmarkColorConversions();
+
+    void saveResults();
+    void compareWithBaseline();
+
+private:
+    QVector<Result> m_results;
+};
+
+#endif
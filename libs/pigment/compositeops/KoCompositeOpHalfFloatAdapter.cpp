@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "KoCompositeOpHalfFloatAdapter.h"
+
+#include "KoColorSpace.h"
+#include "KoHalfFloatConverter.h"
+
+
+KoCompositeOpHalfFloatAdapter::KoCompositeOpHalfFloatAdapter(const KoColorSpace *cs, KoCompositeOp *floatOp)
+    : KoCompositeOp(cs, floatOp->id(), floatOp->description(), floatOp->category()),
+      m_floatOp(floatOp)
+{
+}
+
+KoCompositeOpHalfFloatAdapter::~KoCompositeOpHalfFloatAdapter()
+{
+}
+
+void KoCompositeOpHalfFloatAdapter::composite(const KoCompositeOp::ParameterInfo& params) const
+{
+    const KoHalfFloatConverter *converter = KoHalfFloatConverter::instance();
+
+    const qint32 numChannels = colorSpace()->channelCount();
+    const qint32 maxChunkPixels = 256;
+    const qint32 maxChannels = 4;
+
+    Q_ASSERT(numChannels <= maxChannels);
+
+    float srcBuffer[maxChunkPixels * maxChannels];
+    float dstBuffer[maxChunkPixels * maxChannels];
+
+    /**
+     * Zero source stride means that the source is a single color, so
+     * it is converted only once
+     */
+    const bool constantSource = !params.srcRowStride;
+
+    if (constantSource) {
+        converter->halfToFloat(reinterpret_cast<const quint16*>(params.srcRowStart), srcBuffer, numChannels);
+    }
+
+    KoCompositeOp::ParameterInfo floatParams(params);
+    floatParams.srcRowStart = reinterpret_cast<const quint8*>(srcBuffer);
+    floatParams.dstRowStart = reinterpret_cast<quint8*>(dstBuffer);
+    floatParams.rows = 1;
+
+    for (qint32 row = 0; row < params.rows; row++) {
+        const quint16 *srcRow = reinterpret_cast<const quint16*>(params.srcRowStart + row * params.srcRowStride);
+        quint16 *dstRow = reinterpret_cast<quint16*>(params.dstRowStart + row * params.dstRowStride);
+        const quint8 *maskRow = params.maskRowStart ? params.maskRowStart + row * params.maskRowStride : 0;
+
+        for (qint32 col = 0; col < params.cols; col += maxChunkPixels) {
+            const qint32 chunkPixels = qMin(maxChunkPixels, params.cols - col);
+            const qint32 chunkValues = chunkPixels * numChannels;
+
+            if (!constantSource) {
+                converter->halfToFloat(srcRow + col * numChannels, srcBuffer, chunkValues);
+            }
+            converter->halfToFloat(dstRow + col * numChannels, dstBuffer, chunkValues);
+
+            floatParams.srcRowStride = constantSource ? 0 : chunkValues * sizeof(float);
+            floatParams.dstRowStride = chunkValues * sizeof(float);
+            floatParams.maskRowStart = maskRow ? maskRow + col : 0;
+            floatParams.cols = chunkPixels;
+
+            m_floatOp->composite(floatParams);
+
+            converter->floatToHalf(dstBuffer, dstRow + col * numChannels, chunkValues);
+        }
+    }
+}
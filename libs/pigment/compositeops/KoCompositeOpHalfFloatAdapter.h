@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOCOMPOSITEOPHALFFLOATADAPTER_H
+#define KOCOMPOSITEOPHALFFLOATADAPTER_H
+
+#include <QScopedPointer>
+
+#include "KoCompositeOp.h"
+#include "kritapigment_export.h"
+
+/**
+ * Runs a composite op written for 32-bit float pixels on 16-bit float
+ * ones. The source and destination rows are converted into small
+ * float buffers with KoHalfFloatConverter, composited by \p floatOp
+ * and the result is converted back.
+ *
+ * The generic half ops convert every channel value between half and
+ * float a few times per pixel, so for the ops that have an optimized
+ * 32-bit float version that is much slower than the bulk conversion
+ * of the whole row.
+ *
+ * The float op must expect the same number and order of the channels
+ * as the half colorspace \p cs has.
+ */
+class KRITAPIGMENT_EXPORT KoCompositeOpHalfFloatAdapter : public KoCompositeOp
+{
+public:
+    /**
+     * Takes the ownership of \p floatOp
+     */
+    KoCompositeOpHalfFloatAdapter(const KoColorSpace *cs, KoCompositeOp *floatOp);
+    ~KoCompositeOpHalfFloatAdapter() override;
+
+    using KoCompositeOp::composite;
+
+    void composite(const KoCompositeOp::ParameterInfo& params) const override;
+
+private:
+    QScopedPointer<KoCompositeOp> m_floatOp;
+};
+
+#endif /* KOCOMPOSITEOPHALFFLOATADAPTER_H */
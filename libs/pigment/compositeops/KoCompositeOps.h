@@ -40,6 +40,7 @@
 #include "compositeops/KoCompositeOpGreater.h"
 
 #include "KoOptimizedCompositeOpFactory.h"
+#include "KoCompositeOpHalfFloatAdapter.h"
 
 namespace _Private {
 
@@ -52,45 +53,130 @@ struct AddGeneralOps
 template<class Traits>
 struct OptimizedOpsSelector
 {
+    typedef typename Traits::channels_type Arg;
+
     static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
         return new KoCompositeOpAlphaDarken<Traits>(cs);
     }
     static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
         return new KoCompositeOpOver<Traits>(cs);
     }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return new KoCompositeOpCopy2<Traits>(cs);
+    }
+    template<Arg compositeFunc(Arg, Arg)>
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString& id, const QString& description, const QString& category) {
+        return new KoCompositeOpGenericSC<Traits, compositeFunc>(cs, id, description, category);
+    }
 };
 
 template<>
 struct OptimizedOpsSelector<KoBgrU8Traits>
 {
+    typedef KoBgrU8Traits::channels_type Arg;
+
     static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createAlphaDarkenOp32(cs);
     }
     static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createOverOp32(cs);
     }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return new KoCompositeOpCopy2<KoBgrU8Traits>(cs);
+    }
+    template<Arg compositeFunc(Arg, Arg)>
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString& id, const QString& description, const QString& category) {
+        KoCompositeOp *op = KoOptimizedCompositeOpFactory::createGenericSCOp32(cs, KoStreamedBlendFunctions::blendModeForFunction<Arg, compositeFunc>(), id, description, category);
+        return op ? op : new KoCompositeOpGenericSC<KoBgrU8Traits, compositeFunc>(cs, id, description, category);
+    }
 };
 
 template<>
 struct OptimizedOpsSelector<KoLabU8Traits>
 {
+    typedef KoLabU8Traits::channels_type Arg;
+
     static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createAlphaDarkenOp32(cs);
     }
     static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createOverOp32(cs);
     }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return new KoCompositeOpCopy2<KoLabU8Traits>(cs);
+    }
+    template<Arg compositeFunc(Arg, Arg)>
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString& id, const QString& description, const QString& category) {
+        return new KoCompositeOpGenericSC<KoLabU8Traits, compositeFunc>(cs, id, description, category);
+    }
 };
 
 template<>
 struct OptimizedOpsSelector<KoRgbF32Traits>
 {
+    typedef KoRgbF32Traits::channels_type Arg;
+
     static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
         return new KoCompositeOpAlphaDarken<KoRgbF32Traits>(cs);
     }
     static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
         return KoOptimizedCompositeOpFactory::createOverOp128(cs);
     }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return new KoCompositeOpCopy2<KoRgbF32Traits>(cs);
+    }
+    template<Arg compositeFunc(Arg, Arg)>
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString& id, const QString& description, const QString& category) {
+        KoCompositeOp *op = KoOptimizedCompositeOpFactory::createGenericSCOp128(cs, KoStreamedBlendFunctions::blendModeForFunction<Arg, compositeFunc>(), id, description, category);
+        return op ? op : new KoCompositeOpGenericSC<KoRgbF32Traits, compositeFunc>(cs, id, description, category);
+    }
+};
+
+#ifdef HAVE_OPENEXR
+/**
+ * Half float pixels are composited by the 32-bit float ops with the
+ * rows converted in bulk, see KoCompositeOpHalfFloatAdapter
+ */
+template<>
+struct OptimizedOpsSelector<KoRgbF16Traits>
+{
+    typedef KoRgbF16Traits::channels_type Arg;
+
+    static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
+        return new KoCompositeOpHalfFloatAdapter(cs, new KoCompositeOpAlphaDarken<KoRgbF32Traits>(cs));
+    }
+    static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
+        return new KoCompositeOpHalfFloatAdapter(cs, KoOptimizedCompositeOpFactory::createOverOp128(cs));
+    }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return new KoCompositeOpCopy2<KoRgbF16Traits>(cs);
+    }
+    template<Arg compositeFunc(Arg, Arg)>
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString& id, const QString& description, const QString& category) {
+        KoCompositeOp *op = KoOptimizedCompositeOpFactory::createGenericSCOp128(cs, KoStreamedBlendFunctions::blendModeForFunction<Arg, compositeFunc>(), id, description, category);
+        return op ? new KoCompositeOpHalfFloatAdapter(cs, op) : new KoCompositeOpGenericSC<KoRgbF16Traits, compositeFunc>(cs, id, description, category);
+    }
+};
+#endif
+
+template<>
+struct OptimizedOpsSelector<KoBgrU16Traits>
+{
+    typedef KoBgrU16Traits::channels_type Arg;
+
+    static KoCompositeOp* createAlphaDarkenOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createAlphaDarkenOp64(cs);
+    }
+    static KoCompositeOp* createOverOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createOverOp64(cs);
+    }
+    static KoCompositeOp* createCopyOp(const KoColorSpace *cs) {
+        return KoOptimizedCompositeOpFactory::createCopyOp64(cs);
+    }
+    template<Arg compositeFunc(Arg, Arg)>
+    static KoCompositeOp* createGenericSCOp(const KoColorSpace *cs, const QString& id, const QString& description, const QString& category) {
+        return new KoCompositeOpGenericSC<KoBgrU16Traits, compositeFunc>(cs, id, description, category);
+    }
 };
 
 template<class Traits>
@@ -102,13 +188,13 @@ struct AddGeneralOps<Traits, true>
 
      template<CompositeFunc func>
      static void add(KoColorSpace* cs, const QString& id, const QString& description, const QString& category) {
-         cs->addCompositeOp(new KoCompositeOpGenericSC<Traits, func>(cs, id, description, category));
+         cs->addCompositeOp(OptimizedOpsSelector<Traits>::template createGenericSCOp<func>(cs, id, description, category));
      }
 
      static void add(KoColorSpace* cs) {
          cs->addCompositeOp(OptimizedOpsSelector<Traits>::createOverOp(cs));
          cs->addCompositeOp(OptimizedOpsSelector<Traits>::createAlphaDarkenOp(cs));
-         cs->addCompositeOp(new KoCompositeOpCopy2<Traits>(cs));
+         cs->addCompositeOp(OptimizedOpsSelector<Traits>::createCopyOp(cs));
          cs->addCompositeOp(new KoCompositeOpErase<Traits>(cs));
          cs->addCompositeOp(new KoCompositeOpBehind<Traits>(cs));
          cs->addCompositeOp(new KoCompositeOpDestinationIn<Traits>(cs));
@@ -169,7 +169,7 @@ struct AlphaDarkenCompositor32 {
             dst_alpha = (fullFlowAlpha - zeroFlowAlpha) * flow_norm_vec + zeroFlowAlpha;
         }
 
-        KoStreamedMath<_impl>::write_channels_32(dst, dst_alpha, dst_c1, dst_c2, dst_c3);
+        KoStreamedMath<_impl>::template write_channels_32<true>(dst, dst_alpha, dst_c1, dst_c2, dst_c3);
     }
 
     /**
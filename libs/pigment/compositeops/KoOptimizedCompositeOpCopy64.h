@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDCOMPOSITEOPCOPY64_H_
+#define KOOPTIMIZEDCOMPOSITEOPCOPY64_H_
+
+#include "KoCompositeOpBase.h"
+#include "KoCompositeOpRegistry.h"
+#include <klocalizedstring.h>
+#include "KoStreamedMath.h"
+
+
+/**
+ * The vector version of KoCompositeOpCopy2 for 16-bit channels. The
+ * source is blended into the destination with the opacity of the
+ * mask, the colors are blended in premultiplied form, like
+ * KoCompositeOpCopy2 does.
+ */
+template<typename channels_type, typename pixel_type, bool alphaLocked, bool allChannelsFlag>
+struct CopyCompositor64 {
+    struct OptionalParams {
+        OptionalParams(const KoCompositeOp::ParameterInfo& params)
+            : channelFlags(params.channelFlags)
+        {
+        }
+        const QBitArray &channelFlags;
+    };
+
+    // \see docs in AlphaDarkenCompositor32
+    template<bool haveMask, bool src_aligned, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeVector(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        Q_UNUSED(oparams);
+
+        Vc::float_v uint8MaxRec1((float)1.0 / 255.0);
+        Vc::float_v zeroValue(Vc::Zero);
+        Vc::float_v oneValue(Vc::One);
+
+        Vc::float_v blend(opacity);
+
+        if (haveMask) {
+            Vc::float_v mask_vec = KoStreamedMath<_impl>::fetch_mask_8(mask);
+            blend *= mask_vec * uint8MaxRec1;
+        }
+
+        if ((blend == oneValue).isFull()) {
+            memcpy(dst, src, 8 * Vc::float_v::size());
+            return;
+        }
+
+        Vc::float_v src_alpha = KoStreamedMath<_impl>::fetch_alpha_64(src);
+        Vc::float_v dst_alpha = KoStreamedMath<_impl>::fetch_alpha_64(dst);
+
+        Vc::float_v src_c1;
+        Vc::float_v src_c2;
+        Vc::float_v src_c3;
+
+        Vc::float_v dst_c1;
+        Vc::float_v dst_c2;
+        Vc::float_v dst_c3;
+
+        KoStreamedMath<_impl>::fetch_colors_64(src, src_c1, src_c2, src_c3);
+        KoStreamedMath<_impl>::fetch_colors_64(dst, dst_c1, dst_c2, dst_c3);
+
+        Vc::float_v new_alpha = (src_alpha - dst_alpha) * blend + dst_alpha;
+
+        /**
+         * The color of the fully transparent destination is undefined,
+         * so it is just overwritten with the source. Where the result
+         * is fully transparent the colors are left untouched.
+         */
+        Vc::float_m copy_pixels_mask = (dst_alpha == zeroValue) | (blend == oneValue);
+        Vc::float_m blend_pixels_mask = !copy_pixels_mask & (new_alpha != zeroValue);
+
+        if (!blend_pixels_mask.isEmpty()) {
+            Vc::float_v src_mult = src_alpha * blend;
+            Vc::float_v dst_mult = dst_alpha * (oneValue - blend);
+            Vc::float_v new_alpha_rec = oneValue / new_alpha;
+
+            dst_c1(blend_pixels_mask) = (src_c1 * src_mult + dst_c1 * dst_mult) * new_alpha_rec;
+            dst_c2(blend_pixels_mask) = (src_c2 * src_mult + dst_c2 * dst_mult) * new_alpha_rec;
+            dst_c3(blend_pixels_mask) = (src_c3 * src_mult + dst_c3 * dst_mult) * new_alpha_rec;
+        }
+
+        dst_c1(copy_pixels_mask) = src_c1;
+        dst_c2(copy_pixels_mask) = src_c2;
+        dst_c3(copy_pixels_mask) = src_c3;
+
+        KoStreamedMath<_impl>::write_channels_64(dst, new_alpha, dst_c1, dst_c2, dst_c3);
+    }
+
+    template <bool haveMask, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeOnePixelScalar(const quint8 *srcPtr, quint8 *dstPtr, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        const qint32 alpha_pos = 3;
+
+        const channels_type *src = reinterpret_cast<const channels_type*>(srcPtr);
+        channels_type *dst = reinterpret_cast<channels_type*>(dstPtr);
+
+        const float uint8Rec1 = 1.0 / 255.0;
+
+        float blend = opacity;
+
+        if (haveMask) {
+            blend *= float(*mask) * uint8Rec1;
+        }
+
+        const quint16 dstAlphaInt = dst[alpha_pos];
+
+        // the same as KoCompositeOpBase does for the partial channel flags
+        if (!allChannelsFlag && dstAlphaInt == 0) {
+            pixel_type *d = reinterpret_cast<pixel_type*>(dst);
+            *d = 0;
+        }
+
+        const QBitArray &channelFlags = oparams.channelFlags;
+
+        const float srcAlpha = src[alpha_pos];
+        const float dstAlpha = dstAlphaInt;
+        float newAlpha = dstAlpha;
+
+        if (dstAlphaInt == 0 || blend == 1.0) {
+            newAlpha = (srcAlpha - dstAlpha) * blend + dstAlpha;
+
+            for (int i = 0; i < 3; i++) {
+                if (allChannelsFlag || channelFlags.at(i)) {
+                    dst[i] = src[i];
+                }
+            }
+        } else if (blend != 0.0) {
+            newAlpha = (srcAlpha - dstAlpha) * blend + dstAlpha;
+
+            if (KoStreamedMath<_impl>::round_float_to_u16(newAlpha) != 0) {
+                const float srcMult = srcAlpha * blend;
+                const float dstMult = dstAlpha * (1.0 - blend);
+                const float newAlphaRec = 1.0 / newAlpha;
+
+                for (int i = 0; i < 3; i++) {
+                    if (allChannelsFlag || channelFlags.at(i)) {
+                        dst[i] = KoStreamedMath<_impl>::round_float_to_u16((src[i] * srcMult + dst[i] * dstMult) * newAlphaRec);
+                    }
+                }
+            }
+        }
+
+        if (!alphaLocked) {
+            dst[alpha_pos] = KoStreamedMath<_impl>::round_float_to_u16(newAlpha);
+        }
+    }
+};
+
+/**
+ * An optimized version of KoCompositeOpCopy2 for the use in 8 byte
+ * colorspaces with 16-bit channels and alpha channel placed at
+ * the last word of the pixel: C1_C2_C3_A.
+ */
+template<Vc::Implementation _impl>
+class KoOptimizedCompositeOpCopy64 : public KoCompositeOp
+{
+public:
+    KoOptimizedCompositeOpCopy64(const KoColorSpace* cs)
+        : KoCompositeOp(cs, COMPOSITE_COPY, i18n("Copy"), KoCompositeOp::categoryMisc()) {}
+
+    using KoCompositeOp::composite;
+
+    virtual void composite(const KoCompositeOp::ParameterInfo& params) const
+    {
+        if(params.maskRowStart) {
+            composite<true>(params);
+        } else {
+            composite<false>(params);
+        }
+    }
+
+    template <bool haveMask>
+    inline void composite(const KoCompositeOp::ParameterInfo& params) const {
+        if (params.channelFlags.isEmpty() ||
+            params.channelFlags == QBitArray(4, true)) {
+
+            KoStreamedMath<_impl>::template genericComposite64<haveMask, false, CopyCompositor64<quint16, quint64, false, true> >(params);
+        } else {
+            const bool allChannelsFlag =
+                params.channelFlags.at(0) &&
+                params.channelFlags.at(1) &&
+                params.channelFlags.at(2);
+
+            const bool alphaLocked =
+                !params.channelFlags.at(3);
+
+            if (allChannelsFlag && alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite64_novector<haveMask, false, CopyCompositor64<quint16, quint64, true, true> >(params);
+            } else if (!allChannelsFlag && !alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite64_novector<haveMask, false, CopyCompositor64<quint16, quint64, false, false> >(params);
+            } else /*if (!allChannelsFlag && alphaLocked) */{
+                KoStreamedMath<_impl>::template genericComposite64_novector<haveMask, false, CopyCompositor64<quint16, quint64, true, false> >(params);
+            }
+        }
+    }
+};
+
+#endif // KOOPTIMIZEDCOMPOSITEOPCOPY64_H_
@@ -44,3 +44,50 @@ KoCompositeOp* KoOptimizedCompositeOpFactory::createOverOp128(const KoColorSpace
 {
     return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver128> >(cs);
 }
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createAlphaDarkenOp64(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpAlphaDarken64> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createOverOp64(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver64> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createCopyOp64(const KoColorSpace *cs)
+{
+    return createOptimizedClass<KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpCopy64> >(cs);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createGenericSCOp32(const KoColorSpace *cs, KoStreamedBlendFunctions::BlendMode blendMode, const QString &id, const QString &description, const QString &category)
+{
+    const KoOptimizedCompositeOpGenericSCParams params = {cs, blendMode, id, description, category};
+    return createOptimizedClass<KoOptimizedCompositeOpGenericSCFactoryPerArch<KoOptimizedCompositeOpGenericSC32> >(params);
+}
+
+KoCompositeOp* KoOptimizedCompositeOpFactory::createGenericSCOp128(const KoColorSpace *cs, KoStreamedBlendFunctions::BlendMode blendMode, const QString &id, const QString &description, const QString &category)
+{
+    const KoOptimizedCompositeOpGenericSCParams params = {cs, blendMode, id, description, category};
+    return createOptimizedClass<KoOptimizedCompositeOpGenericSCFactoryPerArch<KoOptimizedCompositeOpGenericSC128> >(params);
+}
+
+KoMixColorsOp* KoOptimizedCompositeOpFactory::createMixColorsOp32()
+{
+    return createOptimizedClass<KoOptimizedMixColorsOpFactoryPerArch<KoOptimizedMixColorsOp32> >(0);
+}
+
+KoMixColorsOp* KoOptimizedCompositeOpFactory::createMixColorsOp128()
+{
+    return createOptimizedClass<KoOptimizedMixColorsOpFactoryPerArch<KoOptimizedMixColorsOp128> >(0);
+}
+
+KoLabDifferenceOp* KoOptimizedCompositeOpFactory::createLabDifferenceOp()
+{
+    return createOptimizedClass<KoOptimizedLabDifferenceOpFactoryPerArch>(0);
+}
+
+KoLut3DInterpolator* KoOptimizedCompositeOpFactory::createLut3DInterpolator()
+{
+    return createOptimizedClass<KoOptimizedLut3DInterpolatorFactoryPerArch>(0);
+}
@@ -21,9 +21,14 @@
 #define KOOPTIMIZEDCOMPOSITEOPFACTORY_H
 
 #include "kritapigment_export.h"
+#include "KoStreamedBlendMode.h"
 
+class QString;
 class KoCompositeOp;
 class KoColorSpace;
+class KoMixColorsOp;
+class KoLabDifferenceOp;
+class KoLut3DInterpolator;
 
 /**
  * The creation of the optimized composite ops is moved into a separate
@@ -44,6 +49,39 @@ public:
     static KoCompositeOp* createOverOp32(const KoColorSpace *cs);
     static KoCompositeOp* createAlphaDarkenOp128(const KoColorSpace *cs);
     static KoCompositeOp* createOverOp128(const KoColorSpace *cs);
+    static KoCompositeOp* createAlphaDarkenOp64(const KoColorSpace *cs);
+    static KoCompositeOp* createOverOp64(const KoColorSpace *cs);
+    static KoCompositeOp* createCopyOp64(const KoColorSpace *cs);
+
+    /**
+     * Create vectorized versions of KoCompositeOpGenericSC for the
+     * blend function \p blendMode, see
+     * KoStreamedBlendFunctions::blendModeForFunction(). If the mode
+     * or the CPU has no vectorized implementation, null is returned
+     * and the caller should use the generic op instead.
+     */
+    static KoCompositeOp* createGenericSCOp32(const KoColorSpace *cs, KoStreamedBlendFunctions::BlendMode blendMode, const QString &id, const QString &description, const QString &category);
+    static KoCompositeOp* createGenericSCOp128(const KoColorSpace *cs, KoStreamedBlendFunctions::BlendMode blendMode, const QString &id, const QString &description, const QString &category);
+
+    /**
+     * Create vectorized versions of KoMixColorsOpImpl for 4-channel
+     * colorspaces with alpha in the last channel: 8-bit integer
+     * (createMixColorsOp32()) and 32-bit float (createMixColorsOp128())
+     */
+    static KoMixColorsOp* createMixColorsOp32();
+    static KoMixColorsOp* createMixColorsOp128();
+
+    /**
+     * Create a vectorized version of KoLabDifferenceOp. Use
+     * KoLabDifferenceOp::instance() instead of calling it directly.
+     */
+    static KoLabDifferenceOp* createLabDifferenceOp();
+
+    /**
+     * Create a vectorized version of KoLut3DInterpolator. Use
+     * KoLut3DInterpolator::instance() instead of calling it directly.
+     */
+    static KoLut3DInterpolator* createLut3DInterpolator();
 };
 
 #endif /* KOOPTIMIZEDCOMPOSITEOPFACTORY_H */
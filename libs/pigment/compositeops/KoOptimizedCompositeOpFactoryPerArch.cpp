@@ -26,6 +26,14 @@
 #include "KoOptimizedCompositeOpAlphaDarken128.h"
 #include "KoOptimizedCompositeOpOver32.h"
 #include "KoOptimizedCompositeOpOver128.h"
+#include "KoOptimizedCompositeOpAlphaDarken64.h"
+#include "KoOptimizedCompositeOpOver64.h"
+#include "KoOptimizedCompositeOpCopy64.h"
+#include "KoOptimizedCompositeOpGenericSC32.h"
+#include "KoOptimizedCompositeOpGenericSC128.h"
+#include "KoOptimizedMixColorsOp.h"
+#include "KoOptimizedLabDifferenceOp.h"
+#include "KoOptimizedLut3DInterpolator.h"
 
 #include <QString>
 #include "DebugPigment.h"
@@ -67,3 +75,85 @@ KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver128>::create<Vc::
 {
     return new KoOptimizedCompositeOpOver128<Vc::CurrentImplementation::current()>(param);
 }
+
+template<>
+template<>
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpAlphaDarken64>::ReturnType
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpAlphaDarken64>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    return new KoOptimizedCompositeOpAlphaDarken64<Vc::CurrentImplementation::current()>(param);
+}
+
+template<>
+template<>
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver64>::ReturnType
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver64>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    return new KoOptimizedCompositeOpOver64<Vc::CurrentImplementation::current()>(param);
+}
+
+template<>
+template<>
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpCopy64>::ReturnType
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpCopy64>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    return new KoOptimizedCompositeOpCopy64<Vc::CurrentImplementation::current()>(param);
+}
+
+template<>
+template<>
+KoOptimizedCompositeOpGenericSCFactoryPerArch<KoOptimizedCompositeOpGenericSC32>::ReturnType
+KoOptimizedCompositeOpGenericSCFactoryPerArch<KoOptimizedCompositeOpGenericSC32>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    if (param.blendMode == KoStreamedBlendFunctions::BlendModeUnsupported) {
+        return 0;
+    }
+
+    return new KoOptimizedCompositeOpGenericSC32<Vc::CurrentImplementation::current()>(param);
+}
+
+template<>
+template<>
+KoOptimizedCompositeOpGenericSCFactoryPerArch<KoOptimizedCompositeOpGenericSC128>::ReturnType
+KoOptimizedCompositeOpGenericSCFactoryPerArch<KoOptimizedCompositeOpGenericSC128>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    if (param.blendMode == KoStreamedBlendFunctions::BlendModeUnsupported) {
+        return 0;
+    }
+
+    return new KoOptimizedCompositeOpGenericSC128<Vc::CurrentImplementation::current()>(param);
+}
+
+template<>
+template<>
+KoOptimizedMixColorsOpFactoryPerArch<KoOptimizedMixColorsOp32>::ReturnType
+KoOptimizedMixColorsOpFactoryPerArch<KoOptimizedMixColorsOp32>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    Q_UNUSED(param);
+    return new KoOptimizedMixColorsOp32<Vc::CurrentImplementation::current()>();
+}
+
+template<>
+template<>
+KoOptimizedMixColorsOpFactoryPerArch<KoOptimizedMixColorsOp128>::ReturnType
+KoOptimizedMixColorsOpFactoryPerArch<KoOptimizedMixColorsOp128>::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    Q_UNUSED(param);
+    return new KoOptimizedMixColorsOp128<Vc::CurrentImplementation::current()>();
+}
+
+template<>
+KoOptimizedLabDifferenceOpFactoryPerArch::ReturnType
+KoOptimizedLabDifferenceOpFactoryPerArch::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    Q_UNUSED(param);
+    return new KoOptimizedLabDifferenceOp<Vc::CurrentImplementation::current()>();
+}
+
+template<>
+KoOptimizedLut3DInterpolatorFactoryPerArch::ReturnType
+KoOptimizedLut3DInterpolatorFactoryPerArch::create<Vc::CurrentImplementation::current()>(ParamType param)
+{
+    Q_UNUSED(param);
+    return new KoOptimizedLut3DInterpolator<Vc::CurrentImplementation::current()>();
+}
@@ -23,9 +23,16 @@
 
 #include <compositeops/KoVcMultiArchBuildSupport.h>
 
+#include <QString>
+
+#include "KoStreamedBlendMode.h"
+
 
 class KoCompositeOp;
 class KoColorSpace;
+class KoMixColorsOp;
+class KoLabDifferenceOp;
+class KoLut3DInterpolator;
 
 
 template<Vc::Implementation _impl>
@@ -40,6 +47,33 @@ class KoOptimizedCompositeOpAlphaDarken128;
 template<Vc::Implementation _impl>
 class KoOptimizedCompositeOpOver128;
 
+template<Vc::Implementation _impl>
+class KoOptimizedCompositeOpAlphaDarken64;
+
+template<Vc::Implementation _impl>
+class KoOptimizedCompositeOpOver64;
+
+template<Vc::Implementation _impl>
+class KoOptimizedCompositeOpCopy64;
+
+template<Vc::Implementation _impl>
+class KoOptimizedCompositeOpGenericSC32;
+
+template<Vc::Implementation _impl>
+class KoOptimizedCompositeOpGenericSC128;
+
+template<Vc::Implementation _impl>
+class KoOptimizedMixColorsOp32;
+
+template<Vc::Implementation _impl>
+class KoOptimizedMixColorsOp128;
+
+template<Vc::Implementation _impl>
+class KoOptimizedLabDifferenceOp;
+
+template<Vc::Implementation _impl>
+class KoOptimizedLut3DInterpolator;
+
 template<template<Vc::Implementation I> class CompositeOp>
 struct KoOptimizedCompositeOpFactoryPerArch
 {
@@ -50,5 +84,68 @@ struct KoOptimizedCompositeOpFactoryPerArch
     static ReturnType create(ParamType param);
 };
 
+struct KoOptimizedCompositeOpGenericSCParams
+{
+    const KoColorSpace *cs;
+    KoStreamedBlendFunctions::BlendMode blendMode;
+    QString id;
+    QString description;
+    QString category;
+};
+
+/**
+ * The factory for the vectorized versions of KoCompositeOpGenericSC.
+ * create() returns null if the op has no vectorized version for
+ * the architecture.
+ */
+template<template<Vc::Implementation I> class CompositeOp>
+struct KoOptimizedCompositeOpGenericSCFactoryPerArch
+{
+    typedef const KoOptimizedCompositeOpGenericSCParams& ParamType;
+    typedef KoCompositeOp* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType param);
+};
+
+/**
+ * The factory for the vectorized versions of KoMixColorsOpImpl. The
+ * mix ops need no construction parameters, so \p param is ignored.
+ */
+template<template<Vc::Implementation I> class MixColorsOp>
+struct KoOptimizedMixColorsOpFactoryPerArch
+{
+    typedef int ParamType;
+    typedef KoMixColorsOp* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType param);
+};
+
+/**
+ * The factory for the vectorized version of KoLabDifferenceOp,
+ * \p param is ignored.
+ */
+struct KoOptimizedLabDifferenceOpFactoryPerArch
+{
+    typedef int ParamType;
+    typedef KoLabDifferenceOp* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType param);
+};
+
+/**
+ * The factory for the vectorized version of KoLut3DInterpolator,
+ * \p param is ignored.
+ */
+struct KoOptimizedLut3DInterpolatorFactoryPerArch
+{
+    typedef int ParamType;
+    typedef KoLut3DInterpolator* ReturnType;
+
+    template<Vc::Implementation _impl>
+    static ReturnType create(ParamType param);
+};
 
 #endif /* KOOPTIMIZEDCOMPOSITEOPFACTORYPERARCH_H */
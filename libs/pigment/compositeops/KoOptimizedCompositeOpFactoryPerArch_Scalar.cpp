@@ -22,6 +22,10 @@
 #include "KoColorSpaceTraits.h"
 #include "KoCompositeOpAlphaDarken.h"
 #include "KoCompositeOpOver.h"
+#include "KoCompositeOpCopy2.h"
+#include "KoMixColorsOpImpl.h"
+#include "KoLabDifferenceOp.h"
+#include "KoLut3DInterpolator.h"
 
 
 template<>
@@ -55,3 +59,84 @@ KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver128>::create<Vc::
 {
     return new KoCompositeOpOver<KoRgbF32Traits>(param);
 }
+
+template<>
+template<>
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpAlphaDarken64>::ReturnType
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpAlphaDarken64>::create<Vc::ScalarImpl>(ParamType param)
+{
+    return new KoCompositeOpAlphaDarken<KoBgrU16Traits>(param);
+}
+
+template<>
+template<>
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver64>::ReturnType
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpOver64>::create<Vc::ScalarImpl>(ParamType param)
+{
+    return new KoCompositeOpOver<KoBgrU16Traits>(param);
+}
+
+template<>
+template<>
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpCopy64>::ReturnType
+KoOptimizedCompositeOpFactoryPerArch<KoOptimizedCompositeOpCopy64>::create<Vc::ScalarImpl>(ParamType param)
+{
+    return new KoCompositeOpCopy2<KoBgrU16Traits>(param);
+}
+
+/**
+ * There is no point in a scalar copy of KoCompositeOpGenericSC, the
+ * callers fall back to the generic op itself
+ */
+
+template<>
+template<>
+KoOptimizedCompositeOpGenericSCFactoryPerArch<KoOptimizedCompositeOpGenericSC32>::ReturnType
+KoOptimizedCompositeOpGenericSCFactoryPerArch<KoOptimizedCompositeOpGenericSC32>::create<Vc::ScalarImpl>(ParamType param)
+{
+    Q_UNUSED(param);
+    return 0;
+}
+
+template<>
+template<>
+KoOptimizedCompositeOpGenericSCFactoryPerArch<KoOptimizedCompositeOpGenericSC128>::ReturnType
+KoOptimizedCompositeOpGenericSCFactoryPerArch<KoOptimizedCompositeOpGenericSC128>::create<Vc::ScalarImpl>(ParamType param)
+{
+    Q_UNUSED(param);
+    return 0;
+}
+
+template<>
+template<>
+KoOptimizedMixColorsOpFactoryPerArch<KoOptimizedMixColorsOp32>::ReturnType
+KoOptimizedMixColorsOpFactoryPerArch<KoOptimizedMixColorsOp32>::create<Vc::ScalarImpl>(ParamType param)
+{
+    Q_UNUSED(param);
+    return new KoMixColorsOpImpl<KoBgrU8Traits>();
+}
+
+template<>
+template<>
+KoOptimizedMixColorsOpFactoryPerArch<KoOptimizedMixColorsOp128>::ReturnType
+KoOptimizedMixColorsOpFactoryPerArch<KoOptimizedMixColorsOp128>::create<Vc::ScalarImpl>(ParamType param)
+{
+    Q_UNUSED(param);
+    return new KoMixColorsOpImpl<KoRgbF32Traits>();
+}
+
+template<>
+KoOptimizedLabDifferenceOpFactoryPerArch::ReturnType
+KoOptimizedLabDifferenceOpFactoryPerArch::create<Vc::ScalarImpl>(ParamType param)
+{
+    Q_UNUSED(param);
+    return new KoLabDifferenceOp();
+}
+
+template<>
+KoOptimizedLut3DInterpolatorFactoryPerArch::ReturnType
+KoOptimizedLut3DInterpolatorFactoryPerArch::create<Vc::ScalarImpl>(ParamType param)
+{
+    Q_UNUSED(param);
+    return new KoLut3DInterpolator();
+}
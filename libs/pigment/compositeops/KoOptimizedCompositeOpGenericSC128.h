@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDCOMPOSITEOPGENERICSC128_H_
+#define KOOPTIMIZEDCOMPOSITEOPGENERICSC128_H_
+
+#include "KoCompositeOpBase.h"
+#include "KoCompositeOpRegistry.h"
+#include "KoStreamedMath.h"
+#include "KoStreamedBlendFunctions.h"
+#include "KoOptimizedCompositeOpFactoryPerArch.h"
+
+
+template<class BlendFunction, bool alphaLocked, bool allChannelsFlag>
+struct GenericSCCompositor128 {
+    struct OptionalParams {
+        OptionalParams(const KoCompositeOp::ParameterInfo& params)
+            : channelFlags(params.channelFlags)
+        {
+        }
+        const QBitArray &channelFlags;
+    };
+
+    struct Pixel {
+        float red;
+        float green;
+        float blue;
+        float alpha;
+    };
+
+    /**
+     * The vector version is used only when all the channels are
+     * enabled, so it never handles the locked alpha
+     *
+     * \see docs in AlphaDarkenCompositor32
+     */
+    template<bool haveMask, bool src_aligned, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeVector(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        Q_UNUSED(oparams);
+        using namespace KoStreamedBlendFunctions;
+
+        const Pixel *sp = reinterpret_cast<const Pixel*>(src);
+        Pixel *dp = reinterpret_cast<Pixel*>(dst);
+
+        Vc::float_v src_alpha;
+        Vc::float_v dst_alpha;
+
+        Vc::float_v src_c1;
+        Vc::float_v src_c2;
+        Vc::float_v src_c3;
+
+        const Vc::float_v::IndexType indexes(Vc::IndexesFromZero);
+        Vc::InterleavedMemoryWrapper<Pixel, Vc::float_v> data(const_cast<Pixel*>(sp));
+        tie(src_c1, src_c2, src_c3, src_alpha) = data[indexes];
+
+        src_alpha *= Vc::float_v(opacity);
+
+        if (haveMask) {
+            const Vc::float_v uint8MaxRec1((float)1.0 / 255);
+            Vc::float_v mask_vec = KoStreamedMath<_impl>::fetch_mask_8(mask);
+            src_alpha *= mask_vec * uint8MaxRec1;
+        }
+
+        const Vc::float_v zeroValue(Vc::Zero);
+        // The source cannot change the colors in the destination,
+        // since its fully transparent
+        if ((src_alpha == zeroValue).isFull()) {
+            return;
+        }
+
+        Vc::float_v dst_c1;
+        Vc::float_v dst_c2;
+        Vc::float_v dst_c3;
+
+        Vc::InterleavedMemoryWrapper<Pixel, Vc::float_v> dataDest(dp);
+        tie(dst_c1, dst_c2, dst_c3, dst_alpha) = dataDest[indexes];
+
+        const UnionWeights<Vc::float_v> weights(src_alpha, dst_alpha);
+
+        dst_c1 = weights.template compose<BlendFunction, false>(src_c1, dst_c1);
+        dst_c2 = weights.template compose<BlendFunction, false>(src_c2, dst_c2);
+        dst_c3 = weights.template compose<BlendFunction, false>(src_c3, dst_c3);
+
+        dataDest[indexes] = tie(dst_c1, dst_c2, dst_c3, weights.newAlpha);
+    }
+
+    template <bool haveMask, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeOnePixelScalar(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        using namespace KoStreamedBlendFunctions;
+        const qint32 alpha_pos = 3;
+
+        const float *s = reinterpret_cast<const float*>(src);
+        float *d = reinterpret_cast<float*>(dst);
+
+        float srcAlpha = s[alpha_pos] * opacity;
+
+        if (haveMask) {
+            const float uint8Rec1 = 1.0 / 255;
+            srcAlpha *= float(*mask) * uint8Rec1;
+        }
+
+        const float dstAlpha = d[alpha_pos];
+
+        if (!allChannelsFlag && dstAlpha == 0.0) {
+            KoStreamedMathFunctions::clearPixel<16>(dst);
+        }
+
+        if (srcAlpha == 0.0) return;
+
+        const QBitArray &channelFlags = oparams.channelFlags;
+
+        if (alphaLocked) {
+            if (dstAlpha != 0.0) {
+                for (int i = 0; i < alpha_pos; i++) {
+                    if (allChannelsFlag || channelFlags.testBit(i)) {
+                        d[i] = composeAlphaLocked<BlendFunction, false>(s[i], d[i], srcAlpha);
+                    }
+                }
+            }
+        } else {
+            const UnionWeights<float> weights(srcAlpha, dstAlpha);
+
+            if (weights.newAlpha != 0.0) {
+                for (int i = 0; i < alpha_pos; i++) {
+                    if (allChannelsFlag || channelFlags.testBit(i)) {
+                        d[i] = weights.template compose<BlendFunction, false>(s[i], d[i]);
+                    }
+                }
+            }
+
+            d[alpha_pos] = weights.newAlpha;
+        }
+    }
+};
+
+/**
+ * An optimized version of KoCompositeOpGenericSC for the use in 16 byte
+ * colorspaces with alpha channel placed at the last byte of
+ * the pixel: C1_C2_C3_A.
+ *
+ * The blend function is passed in the parameters, see
+ * KoStreamedBlendFunctions::blendModeForFunction()
+ */
+template<Vc::Implementation _impl>
+class KoOptimizedCompositeOpGenericSC128 : public KoCompositeOp
+{
+public:
+    KoOptimizedCompositeOpGenericSC128(const KoOptimizedCompositeOpGenericSCParams &params)
+        : KoCompositeOp(params.cs, params.id, params.description, params.category),
+          m_blendMode(params.blendMode)
+    {
+        Q_ASSERT(m_blendMode != KoStreamedBlendFunctions::BlendModeUnsupported);
+    }
+
+    using KoCompositeOp::composite;
+
+    virtual void composite(const KoCompositeOp::ParameterInfo& params) const
+    {
+        using namespace KoStreamedBlendFunctions;
+
+        switch (m_blendMode) {
+        case BlendModeMultiply:
+            compositeBlend<BlendMultiply>(params);
+            break;
+        case BlendModeScreen:
+            compositeBlend<BlendScreen>(params);
+            break;
+        case BlendModeOverlay:
+            compositeBlend<BlendOverlay>(params);
+            break;
+        case BlendModeHardLight:
+            compositeBlend<BlendHardLight>(params);
+            break;
+        case BlendModeSoftLight:
+            compositeBlend<BlendSoftLight>(params);
+            break;
+        case BlendModeColorDodge:
+            compositeBlend<BlendColorDodge>(params);
+            break;
+        case BlendModeAddition:
+            compositeBlend<BlendAddition>(params);
+            break;
+        case BlendModeSubtract:
+            compositeBlend<BlendSubtract>(params);
+            break;
+        case BlendModeDifference:
+            compositeBlend<BlendDifference>(params);
+            break;
+        case BlendModeDarken:
+            compositeBlend<BlendDarken>(params);
+            break;
+        case BlendModeLighten:
+            compositeBlend<BlendLighten>(params);
+            break;
+        case BlendModeExclusion:
+            compositeBlend<BlendExclusion>(params);
+            break;
+        case BlendModeUnsupported:
+            break;
+        }
+    }
+
+private:
+    template <class BlendFunction>
+    inline void compositeBlend(const KoCompositeOp::ParameterInfo& params) const {
+        if(params.maskRowStart) {
+            composite<true, BlendFunction>(params);
+        } else {
+            composite<false, BlendFunction>(params);
+        }
+    }
+
+    template <bool haveMask, class BlendFunction>
+    inline void composite(const KoCompositeOp::ParameterInfo& params) const {
+        if (params.channelFlags.isEmpty() ||
+            params.channelFlags == QBitArray(4, true)) {
+
+            KoStreamedMath<_impl>::template genericComposite128<haveMask, false, GenericSCCompositor128<BlendFunction, false, true> >(params);
+        } else {
+            const bool allChannelsFlag =
+                params.channelFlags.at(0) &&
+                params.channelFlags.at(1) &&
+                params.channelFlags.at(2);
+
+            const bool alphaLocked =
+                !params.channelFlags.at(3);
+
+            if (allChannelsFlag && alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite128_novector<haveMask, false, GenericSCCompositor128<BlendFunction, true, true> >(params);
+            } else if (!allChannelsFlag && !alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite128_novector<haveMask, false, GenericSCCompositor128<BlendFunction, false, false> >(params);
+            } else /*if (!allChannelsFlag && alphaLocked) */{
+                KoStreamedMath<_impl>::template genericComposite128_novector<haveMask, false, GenericSCCompositor128<BlendFunction, true, false> >(params);
+            }
+        }
+    }
+
+private:
+    const KoStreamedBlendFunctions::BlendMode m_blendMode;
+};
+
+#endif // KOOPTIMIZEDCOMPOSITEOPGENERICSC128_H_
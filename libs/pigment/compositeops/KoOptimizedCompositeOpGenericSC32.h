@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDCOMPOSITEOPGENERICSC32_H_
+#define KOOPTIMIZEDCOMPOSITEOPGENERICSC32_H_
+
+#include "KoCompositeOpBase.h"
+#include "KoCompositeOpRegistry.h"
+#include "KoStreamedMath.h"
+#include "KoStreamedBlendFunctions.h"
+#include "KoOptimizedCompositeOpFactoryPerArch.h"
+
+
+template<class BlendFunction, bool alphaLocked, bool allChannelsFlag>
+struct GenericSCCompositor32 {
+    struct OptionalParams {
+        OptionalParams(const KoCompositeOp::ParameterInfo& params)
+            : channelFlags(params.channelFlags)
+        {
+        }
+        const QBitArray &channelFlags;
+    };
+
+    /**
+     * The vector version is used only when all the channels are
+     * enabled, so it never handles the locked alpha
+     *
+     * \see docs in AlphaDarkenCompositor32
+     */
+    template<bool haveMask, bool src_aligned, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeVector(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        Q_UNUSED(oparams);
+        using namespace KoStreamedBlendFunctions;
+
+        const Vc::float_v uint8Max((float)255.0);
+        const Vc::float_v uint8MaxRec1((float)1.0 / 255.0);
+        const Vc::float_v zeroValue(Vc::Zero);
+
+        Vc::float_v src_alpha = KoStreamedMath<_impl>::template fetch_alpha_32<src_aligned>(src);
+        src_alpha *= Vc::float_v(opacity) * uint8MaxRec1;
+
+        if (haveMask) {
+            Vc::float_v mask_vec = KoStreamedMath<_impl>::fetch_mask_8(mask);
+            src_alpha *= mask_vec * uint8MaxRec1;
+        }
+
+        // The source cannot change the colors in the destination,
+        // since its fully transparent
+        if ((src_alpha == zeroValue).isFull()) {
+            return;
+        }
+
+        Vc::float_v dst_alpha = KoStreamedMath<_impl>::template fetch_alpha_32<true>(dst);
+        dst_alpha *= uint8MaxRec1;
+
+        Vc::float_v src_c1;
+        Vc::float_v src_c2;
+        Vc::float_v src_c3;
+
+        Vc::float_v dst_c1;
+        Vc::float_v dst_c2;
+        Vc::float_v dst_c3;
+
+        KoStreamedMath<_impl>::template fetch_colors_32<src_aligned>(src, src_c1, src_c2, src_c3);
+        KoStreamedMath<_impl>::template fetch_colors_32<true>(dst, dst_c1, dst_c2, dst_c3);
+
+        const UnionWeights<Vc::float_v> weights(src_alpha, dst_alpha);
+
+        dst_c1 = weights.template compose<BlendFunction, true>(src_c1 * uint8MaxRec1, dst_c1 * uint8MaxRec1);
+        dst_c2 = weights.template compose<BlendFunction, true>(src_c2 * uint8MaxRec1, dst_c2 * uint8MaxRec1);
+        dst_c3 = weights.template compose<BlendFunction, true>(src_c3 * uint8MaxRec1, dst_c3 * uint8MaxRec1);
+
+        KoStreamedMath<_impl>::template write_channels_32<true>(dst,
+                                                                weights.newAlpha * uint8Max,
+                                                                dst_c1 * uint8Max,
+                                                                dst_c2 * uint8Max,
+                                                                dst_c3 * uint8Max);
+    }
+
+    template <bool haveMask, Vc::Implementation _impl>
+    static ALWAYS_INLINE void compositeOnePixelScalar(const quint8 *src, quint8 *dst, const quint8 *mask, float opacity, const OptionalParams &oparams)
+    {
+        using namespace KoStreamedBlendFunctions;
+        const qint32 alpha_pos = 3;
+
+        const float uint8Rec1 = 1.0 / 255.0;
+        const float uint8Max = 255.0;
+
+        float srcAlpha = src[alpha_pos] * uint8Rec1 * opacity;
+
+        if (haveMask) {
+            srcAlpha *= float(*mask) * uint8Rec1;
+        }
+
+        const float dstAlpha = dst[alpha_pos] * uint8Rec1;
+
+        if (!allChannelsFlag && dstAlpha == 0.0) {
+            KoStreamedMathFunctions::clearPixel<4>(dst);
+        }
+
+        if (srcAlpha == 0.0) return;
+
+        const QBitArray &channelFlags = oparams.channelFlags;
+
+        if (alphaLocked) {
+            if (dstAlpha != 0.0) {
+                for (int i = 0; i < alpha_pos; i++) {
+                    if (allChannelsFlag || channelFlags.testBit(i)) {
+                        const float result =
+                            composeAlphaLocked<BlendFunction, true>(src[i] * uint8Rec1, dst[i] * uint8Rec1, srcAlpha);
+                        dst[i] = KoStreamedMath<_impl>::round_float_to_uint(result * uint8Max);
+                    }
+                }
+            }
+        } else {
+            const UnionWeights<float> weights(srcAlpha, dstAlpha);
+
+            if (weights.newAlpha != 0.0) {
+                for (int i = 0; i < alpha_pos; i++) {
+                    if (allChannelsFlag || channelFlags.testBit(i)) {
+                        const float result =
+                            weights.template compose<BlendFunction, true>(src[i] * uint8Rec1, dst[i] * uint8Rec1);
+                        dst[i] = KoStreamedMath<_impl>::round_float_to_uint(result * uint8Max);
+                    }
+                }
+            }
+
+            dst[alpha_pos] = KoStreamedMath<_impl>::round_float_to_uint(weights.newAlpha * uint8Max);
+        }
+    }
+};
+
+/**
+ * An optimized version of KoCompositeOpGenericSC for the use in 4 byte
+ * colorspaces with alpha channel placed at the last byte of
+ * the pixel: C1_C2_C3_A.
+ *
+ * The blend function is passed in the parameters, see
+ * KoStreamedBlendFunctions::blendModeForFunction()
+ */
+template<Vc::Implementation _impl>
+class KoOptimizedCompositeOpGenericSC32 : public KoCompositeOp
+{
+public:
+    KoOptimizedCompositeOpGenericSC32(const KoOptimizedCompositeOpGenericSCParams &params)
+        : KoCompositeOp(params.cs, params.id, params.description, params.category),
+          m_blendMode(params.blendMode)
+    {
+        Q_ASSERT(m_blendMode != KoStreamedBlendFunctions::BlendModeUnsupported);
+    }
+
+    using KoCompositeOp::composite;
+
+    virtual void composite(const KoCompositeOp::ParameterInfo& params) const
+    {
+        using namespace KoStreamedBlendFunctions;
+
+        switch (m_blendMode) {
+        case BlendModeMultiply:
+            compositeBlend<BlendMultiply>(params);
+            break;
+        case BlendModeScreen:
+            compositeBlend<BlendScreen>(params);
+            break;
+        case BlendModeOverlay:
+            compositeBlend<BlendOverlay>(params);
+            break;
+        case BlendModeHardLight:
+            compositeBlend<BlendHardLight>(params);
+            break;
+        case BlendModeSoftLight:
+            compositeBlend<BlendSoftLight>(params);
+            break;
+        case BlendModeColorDodge:
+            compositeBlend<BlendColorDodge>(params);
+            break;
+        case BlendModeAddition:
+            compositeBlend<BlendAddition>(params);
+            break;
+        case BlendModeSubtract:
+            compositeBlend<BlendSubtract>(params);
+            break;
+        case BlendModeDifference:
+            compositeBlend<BlendDifference>(params);
+            break;
+        case BlendModeDarken:
+            compositeBlend<BlendDarken>(params);
+            break;
+        case BlendModeLighten:
+            compositeBlend<BlendLighten>(params);
+            break;
+        case BlendModeExclusion:
+            compositeBlend<BlendExclusion>(params);
+            break;
+        case BlendModeUnsupported:
+            break;
+        }
+    }
+
+private:
+    template <class BlendFunction>
+    inline void compositeBlend(const KoCompositeOp::ParameterInfo& params) const {
+        if(params.maskRowStart) {
+            composite<true, BlendFunction>(params);
+        } else {
+            composite<false, BlendFunction>(params);
+        }
+    }
+
+    template <bool haveMask, class BlendFunction>
+    inline void composite(const KoCompositeOp::ParameterInfo& params) const {
+        if (params.channelFlags.isEmpty() ||
+            params.channelFlags == QBitArray(4, true)) {
+
+            KoStreamedMath<_impl>::template genericComposite32<haveMask, false, GenericSCCompositor32<BlendFunction, false, true> >(params);
+        } else {
+            const bool allChannelsFlag =
+                params.channelFlags.at(0) &&
+                params.channelFlags.at(1) &&
+                params.channelFlags.at(2);
+
+            const bool alphaLocked =
+                !params.channelFlags.at(3);
+
+            if (allChannelsFlag && alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite32_novector<haveMask, false, GenericSCCompositor32<BlendFunction, true, true> >(params);
+            } else if (!allChannelsFlag && !alphaLocked) {
+                KoStreamedMath<_impl>::template genericComposite32_novector<haveMask, false, GenericSCCompositor32<BlendFunction, false, false> >(params);
+            } else /*if (!allChannelsFlag && alphaLocked) */{
+                KoStreamedMath<_impl>::template genericComposite32_novector<haveMask, false, GenericSCCompositor32<BlendFunction, true, false> >(params);
+            }
+        }
+    }
+
+private:
+    const KoStreamedBlendFunctions::BlendMode m_blendMode;
+};
+
+#endif // KOOPTIMIZEDCOMPOSITEOPGENERICSC32_H_
@@ -156,7 +156,7 @@ struct OverCompositor32 {
             }
         }
 
-        KoStreamedMath<_impl>::write_channels_32(dst, new_alpha, dst_c1, dst_c2, dst_c3);
+        KoStreamedMath<_impl>::template write_channels_32<true>(dst, new_alpha, dst_c1, dst_c2, dst_c3);
     }
 
     template <bool haveMask, Vc::Implementation _impl>
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDLABDIFFERENCEOP_H
+#define KOOPTIMIZEDLABDIFFERENCEOP_H
+
+#include "KoLabDifferenceOp.h"
+#include "KoStreamedMath.h"
+#include "KoOptimizedCompositeOpFactoryPerArch.h"
+
+
+/**
+ * Computes Vc::float_v::size() differences at a time. The math is done
+ * in single precision, so a difference lying right at an integer
+ * boundary may be truncated differently than by the scalar version.
+ */
+template<Vc::Implementation _impl>
+class KoOptimizedLabDifferenceOp : public KoLabDifferenceOp
+{
+public:
+    void differenceRow(const quint16 *srcLab, const quint16 *rowLab, qint32 nPixels, quint8 *differences) const override {
+        typedef typename KoStreamedMath<_impl>::int_v int_v;
+
+        const qint32 vectorSize = Vc::float_v::size();
+        const qint32 numVectorizedPixels = nPixels - nPixels % vectorSize;
+
+        const Vc::float_v srcL(float(srcLab[0]));
+        const Vc::float_v srcA(float(srcLab[1]));
+        const Vc::float_v srcB(float(srcLab[2]));
+
+        // see cmsLabEncoded2Float()
+        const Vc::float_v lScale(float(1.0 / 655.35));
+        const Vc::float_v abScale(float(1.0 / 257.0));
+        const Vc::float_v maxValue(255.0f);
+
+        for (qint32 i = 0; i < numVectorizedPixels; i += vectorSize) {
+            Vc::float_v L;
+            Vc::float_v a;
+            Vc::float_v b;
+
+            // the words are fetched in reverse order: b, a, L
+            KoStreamedMath<_impl>::fetch_colors_64(reinterpret_cast<const quint8*>(rowLab), b, a, L);
+
+            const Vc::float_v dL = (L - srcL) * lScale;
+            const Vc::float_v da = (a - srcA) * abScale;
+            const Vc::float_v db = (b - srcB) * abScale;
+
+            const int_v diff(Vc::min(Vc::sqrt(dL * dL + da * da + db * db), maxValue));
+
+            for (qint32 j = 0; j < vectorSize; j++) {
+                differences[j] = diff[j];
+            }
+
+            rowLab += 4 * vectorSize;
+            differences += vectorSize;
+        }
+
+        KoLabDifferenceOp::differenceRow(srcLab, rowLab, nPixels - numVectorizedPixels, differences);
+    }
+};
+
+#endif /* KOOPTIMIZEDLABDIFFERENCEOP_H */
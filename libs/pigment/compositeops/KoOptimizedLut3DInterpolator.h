@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef KOOPTIMIZEDLUT3DINTERPOLATOR_H
+#define KOOPTIMIZEDLUT3DINTERPOLATOR_H
+
+#include "KoLut3DInterpolator.h"
+#include "KoStreamedMath.h"
+#include "KoOptimizedCompositeOpFactoryPerArch.h"
+
+
+/**
+ * Interpolates Vc::float_v::size() pixels at a time. The corners of
+ * the tetrahedra are fetched from the LUT with gathers, the choice of
+ * the tetrahedron is done with masks, so there are no branches in the
+ * inner loop.
+ *
+ * \see KoLut3DInterpolator for the layout of the LUT
+ */
+template<Vc::Implementation _impl>
+class KoOptimizedLut3DInterpolator : public KoLut3DInterpolator
+{
+public:
+    void interpolate(const float *lut, qint32 gridSize,
+                     const quint8 *src, qint32 srcChannelSize,
+                     quint8 *dst, qint32 dstChannelSize,
+                     qint32 nPixels) const override {
+
+        if (srcChannelSize == 1) {
+            if (dstChannelSize == 1) {
+                interpolateImpl<1, 1>(lut, gridSize, src, dst, nPixels);
+            } else {
+                interpolateImpl<1, 2>(lut, gridSize, src, dst, nPixels);
+            }
+        } else {
+            if (dstChannelSize == 1) {
+                interpolateImpl<2, 1>(lut, gridSize, src, dst, nPixels);
+            } else {
+                interpolateImpl<2, 2>(lut, gridSize, src, dst, nPixels);
+            }
+        }
+    }
+
+private:
+    template <int srcChannelSize, int dstChannelSize>
+    void interpolateImpl(const float *lut, qint32 gridSize,
+                         const quint8 *src, quint8 *dst,
+                         qint32 nPixels) const {
+
+        typedef typename KoStreamedMath<_impl>::int_v int_v;
+
+        const qint32 vectorSize = Vc::float_v::size();
+        const qint32 numVectorizedPixels = nPixels - nPixels % vectorSize;
+
+        const float srcUnit = srcChannelSize == 1 ? 255.0f : 65535.0f;
+        const float dstUnit = dstChannelSize == 1 ? 255.0f : 65535.0f;
+
+        const Vc::float_v scale(float(gridSize - 1) / srcUnit);
+        const Vc::float_v alphaScale(dstUnit / srcUnit);
+        const Vc::float_v one(1.0f);
+
+        const qint32 strideB = 4;
+        const qint32 strideG = strideB * gridSize;
+        const qint32 strideR = strideG * gridSize;
+        const qint32 diagonal = strideR + strideG + strideB;
+
+        /**
+         * The offsets are selected with float masks, they are small
+         * enough to be represented exactly
+         */
+        const Vc::float_v strideBf(float(strideB));
+        const Vc::float_v strideGf(float(strideG));
+        const Vc::float_v strideRf(float(strideR));
+        const Vc::float_v diagonalf(float(diagonal));
+
+        const int_v lastCell(gridSize - 2);
+
+        for (qint32 i = 0; i < numVectorizedPixels; i += vectorSize) {
+            Vc::float_v r;
+            Vc::float_v g;
+            Vc::float_v b;
+            Vc::float_v alpha;
+
+            if (srcChannelSize == 1) {
+                KoStreamedMath<_impl>::template fetch_colors_32<false>(src, r, g, b);
+                alpha = KoStreamedMath<_impl>::template fetch_alpha_32<false>(src);
+            } else {
+                KoStreamedMath<_impl>::fetch_colors_64(src, r, g, b);
+                alpha = KoStreamedMath<_impl>::fetch_alpha_64(src);
+            }
+
+            r *= scale;
+            g *= scale;
+            b *= scale;
+
+            const int_v ri = Vc::min(int_v(r), lastCell);
+            const int_v gi = Vc::min(int_v(g), lastCell);
+            const int_v bi = Vc::min(int_v(b), lastCell);
+
+            const Vc::float_v fr = r - Vc::float_v(ri);
+            const Vc::float_v fg = g - Vc::float_v(gi);
+            const Vc::float_v fb = b - Vc::float_v(bi);
+
+            // see the scalar version in KoLut3DInterpolator
+            const Vc::float_v maxF = Vc::max(fr, Vc::max(fg, fb));
+            const Vc::float_v minF = Vc::min(fr, Vc::min(fg, fb));
+            const Vc::float_v midF = fr + fg + fb - maxF - minF;
+
+            const Vc::float_v maxOffset =
+                Vc::iif(fr >= fg && fr >= fb, strideRf,
+                        Vc::iif(fg >= fb, strideGf, strideBf));
+
+            const Vc::float_v minOffset =
+                Vc::iif(fb <= fr && fb <= fg, strideBf,
+                        Vc::iif(fg <= fr, strideGf, strideRf));
+
+            const int_v index0 = ri * strideR + gi * strideG + bi * strideB;
+            const int_v index1 = index0 + int_v(maxOffset);
+            const int_v index2 = index0 + int_v(diagonalf - minOffset);
+            const int_v index3 = index0 + diagonal;
+
+            const Vc::float_v w0 = one - maxF;
+            const Vc::float_v w1 = maxF - midF;
+            const Vc::float_v w2 = midF - minF;
+            const Vc::float_v w3 = minF;
+
+            Vc::float_v result[3];
+
+            for (int k = 0; k < 3; k++) {
+                const float *channel = lut + k;
+
+                const Vc::float_v c0(channel, index0);
+                const Vc::float_v c1(channel, index1);
+                const Vc::float_v c2(channel, index2);
+                const Vc::float_v c3(channel, index3);
+
+                result[k] = c0 * w0 + c1 * w1 + c2 * w2 + c3 * w3;
+            }
+
+            alpha *= alphaScale;
+
+            // the nodes keep blue, green and red, the writers expect red first
+            if (dstChannelSize == 1) {
+                KoStreamedMath<_impl>::template write_channels_32<false>(dst, alpha, result[2], result[1], result[0]);
+            } else {
+                KoStreamedMath<_impl>::write_channels_64(dst, alpha, result[2], result[1], result[0]);
+            }
+
+            src += 4 * srcChannelSize * vectorSize;
+            dst += 4 * dstChannelSize * vectorSize;
+        }
+
+        KoLut3DInterpolator::interpolate(lut, gridSize,
+                                         src, srcChannelSize,
+                                         dst, dstChannelSize,
+                                         nPixels - numVectorizedPixels);
+    }
+};
+
+#endif /* KOOPTIMIZEDLUT3DINTERPOLATOR_H */
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef KOOPTIMIZEDMIXCOLORSOP_H
+#define KOOPTIMIZEDMIXCOLORSOP_H
+
+#include "KoColorSpaceTraits.h"
+#include "KoMixColorsOpImpl.h"
+#include "KoStreamedMath.h"
+#include "KoOptimizedCompositeOpFactoryPerArch.h"
+
+
+/**
+ * Vectorized versions of KoMixColorsOpImpl for 4-channel colorspaces
+ * with the alpha channel placed at the last position of the pixel:
+ * C1_C2_C3_A.
+ *
+ * Only the variants reading the colors from a contiguous array are
+ * vectorized, Vc::float_v::size() pixels are accumulated at a time.
+ * The array-of-pointers variants cannot fetch the pixels with a
+ * single load, so they are forwarded to the generic implementation.
+ */
+
+/**
+ * 8-bit version. The sums are accumulated in 32-bit integers, exactly
+ * like KoMixColorsOpImpl<KoBgrU8Traits> does, so the result is
+ * bit-exact with the generic implementation.
+ */
+template<Vc::Implementation _impl>
+class KoOptimizedMixColorsOp32 : public KoMixColorsOp
+{
+    typedef typename KoStreamedMath<_impl>::int_v int_v;
+    typedef typename KoStreamedMath<_impl>::uint_v uint_v;
+
+public:
+    void mixColors(const quint8 * const* colors, const qint16 *weights, quint32 nColors, quint8 *dst) const override {
+        m_genericOp.mixColors(colors, weights, nColors, dst);
+    }
+
+    void mixColors(const quint8 *colors, const qint16 *weights, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl<true>(colors, weights, nColors, dst);
+    }
+
+    void mixColors(const quint8 * const* colors, quint32 nColors, quint8 *dst) const override {
+        m_genericOp.mixColors(colors, nColors, dst);
+    }
+
+    void mixColors(const quint8 *colors, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl<false>(colors, 0, nColors, dst);
+    }
+
+private:
+    template<bool useWeights>
+    inline void mixColorsImpl(const quint8 *colors, const qint16 *weights, quint32 nColors, quint8 *dst) const {
+        const quint32 vectorSize = Vc::float_v::size();
+        const quint32 numVectorizedPixels = nColors - nColors % vectorSize;
+
+        const uint_v mask(quint32(0xFF));
+
+        int_v totalC1(Vc::Zero);
+        int_v totalC2(Vc::Zero);
+        int_v totalC3(Vc::Zero);
+        int_v totalAlphaVec(Vc::Zero);
+
+        for (quint32 i = 0; i < numVectorizedPixels; i += vectorSize) {
+            uint_v data;
+            data.load(reinterpret_cast<const quint32*>(colors), Vc::Unaligned);
+
+            int_v alphaTimesWeight(data >> 24);
+
+            if (useWeights) {
+                alphaTimesWeight *= int_v(weights, Vc::Unaligned);
+                weights += vectorSize;
+            }
+
+            totalC1 += int_v(data & mask) * alphaTimesWeight;
+            totalC2 += int_v((data >> 8) & mask) * alphaTimesWeight;
+            totalC3 += int_v((data >> 16) & mask) * alphaTimesWeight;
+            totalAlphaVec += alphaTimesWeight;
+
+            colors += vectorSize * 4;
+        }
+
+        qint32 totals[3] = {totalC1.sum(), totalC2.sum(), totalC3.sum()};
+        qint32 totalAlpha = totalAlphaVec.sum();
+
+        for (quint32 i = numVectorizedPixels; i < nColors; i++) {
+            qint32 alphaTimesWeight = colors[3];
+
+            if (useWeights) {
+                alphaTimesWeight *= *weights;
+                weights++;
+            }
+
+            totals[0] += colors[0] * alphaTimesWeight;
+            totals[1] += colors[1] * alphaTimesWeight;
+            totals[2] += colors[2] * alphaTimesWeight;
+            totalAlpha += alphaTimesWeight;
+
+            colors += 4;
+        }
+
+        const qint32 sumOfWeights = useWeights ? 255 : nColors;
+
+        if (totalAlpha > 255 * sumOfWeights) {
+            totalAlpha = 255 * sumOfWeights;
+        }
+
+        if (totalAlpha > 0) {
+            for (int i = 0; i < 3; i++) {
+                dst[i] = qBound(0, totals[i] / totalAlpha, 255);
+            }
+            dst[3] = totalAlpha / sumOfWeights;
+        } else {
+            memset(dst, 0, 4);
+        }
+    }
+
+private:
+    KoMixColorsOpImpl<KoBgrU8Traits> m_genericOp;
+};
+
+/**
+ * Floating point version. The lanes are accumulated in single
+ * precision and summed up in double precision at the end, so the
+ * result may differ from KoMixColorsOpImpl<KoRgbF32Traits> in the
+ * last bits.
+ */
+template<Vc::Implementation _impl>
+class KoOptimizedMixColorsOp128 : public KoMixColorsOp
+{
+    struct Pixel {
+        float c1;
+        float c2;
+        float c3;
+        float alpha;
+    };
+
+public:
+    void mixColors(const quint8 * const* colors, const qint16 *weights, quint32 nColors, quint8 *dst) const override {
+        m_genericOp.mixColors(colors, weights, nColors, dst);
+    }
+
+    void mixColors(const quint8 *colors, const qint16 *weights, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl<true>(colors, weights, nColors, dst);
+    }
+
+    void mixColors(const quint8 * const* colors, quint32 nColors, quint8 *dst) const override {
+        m_genericOp.mixColors(colors, nColors, dst);
+    }
+
+    void mixColors(const quint8 *colors, quint32 nColors, quint8 *dst) const override {
+        mixColorsImpl<false>(colors, 0, nColors, dst);
+    }
+
+private:
+    template<bool useWeights>
+    inline void mixColorsImpl(const quint8 *colors, const qint16 *weights, quint32 nColors, quint8 *dst) const {
+        const quint32 vectorSize = Vc::float_v::size();
+        const quint32 numVectorizedPixels = nColors - nColors % vectorSize;
+
+        const Pixel *pixel = reinterpret_cast<const Pixel*>(colors);
+        const Vc::float_v::IndexType indexes(Vc::IndexesFromZero);
+
+        Vc::float_v totalC1(Vc::Zero);
+        Vc::float_v totalC2(Vc::Zero);
+        Vc::float_v totalC3(Vc::Zero);
+        Vc::float_v totalAlphaVec(Vc::Zero);
+
+        for (quint32 i = 0; i < numVectorizedPixels; i += vectorSize) {
+            Vc::float_v c1;
+            Vc::float_v c2;
+            Vc::float_v c3;
+            Vc::float_v alphaTimesWeight;
+
+            Vc::InterleavedMemoryWrapper<Pixel, Vc::float_v> data(const_cast<Pixel*>(pixel));
+            tie(c1, c2, c3, alphaTimesWeight) = data[indexes];
+
+            if (useWeights) {
+                alphaTimesWeight *= Vc::float_v(weights, Vc::Unaligned);
+                weights += vectorSize;
+            }
+
+            totalC1 += c1 * alphaTimesWeight;
+            totalC2 += c2 * alphaTimesWeight;
+            totalC3 += c3 * alphaTimesWeight;
+            totalAlphaVec += alphaTimesWeight;
+
+            pixel += vectorSize;
+        }
+
+        double totals[3] = {0.0, 0.0, 0.0};
+        double totalAlpha = 0.0;
+
+        for (quint32 i = 0; i < vectorSize; i++) {
+            totals[0] += totalC1[i];
+            totals[1] += totalC2[i];
+            totals[2] += totalC3[i];
+            totalAlpha += totalAlphaVec[i];
+        }
+
+        for (quint32 i = numVectorizedPixels; i < nColors; i++) {
+            double alphaTimesWeight = pixel->alpha;
+
+            if (useWeights) {
+                alphaTimesWeight *= *weights;
+                weights++;
+            }
+
+            totals[0] += pixel->c1 * alphaTimesWeight;
+            totals[1] += pixel->c2 * alphaTimesWeight;
+            totals[2] += pixel->c3 * alphaTimesWeight;
+            totalAlpha += alphaTimesWeight;
+
+            pixel++;
+        }
+
+        const int sumOfWeights = useWeights ? 255 : nColors;
+        const double unitValue = KoColorSpaceMathsTraits<float>::unitValue;
+
+        if (totalAlpha > unitValue * sumOfWeights) {
+            totalAlpha = unitValue * sumOfWeights;
+        }
+
+        float *dstColor = reinterpret_cast<float*>(dst);
+
+        if (totalAlpha > 0) {
+            for (int i = 0; i < 3; i++) {
+                dstColor[i] = qBound<double>(KoColorSpaceMathsTraits<float>::min,
+                                             totals[i] / totalAlpha,
+                                             KoColorSpaceMathsTraits<float>::max);
+            }
+            dstColor[3] = totalAlpha / sumOfWeights;
+        } else {
+            memset(dst, 0, 4 * sizeof(float));
+        }
+    }
+
+private:
+    KoMixColorsOpImpl<KoRgbF32Traits> m_genericOp;
+};
+
+#endif /* KOOPTIMIZEDMIXCOLORSOP_H */
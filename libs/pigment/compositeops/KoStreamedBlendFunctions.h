@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KOSTREAMED_BLEND_FUNCTIONS_H
+#define __KOSTREAMED_BLEND_FUNCTIONS_H
+
+#include <cmath>
+
+#include <KoAlwaysInline.h>
+#include "KoCompositeOpBase.h"
+#include "KoStreamedMath.h"
+#include "KoStreamedBlendMode.h"
+
+
+/**
+ * The separable blend functions of KoCompositeOpFunctions.h rewritten
+ * for the colors normalized to [0, 1]. Every function is a template,
+ * so the same code is used both for Vc::float_v, when processing the
+ * vectorized part of the row, and for float, when processing the
+ * unaligned pixels at its ends.
+ */
+namespace KoStreamedBlendFunctions {
+
+ALWAYS_INLINE float minOf(float a, float b) { return qMin(a, b); }
+ALWAYS_INLINE float maxOf(float a, float b) { return qMax(a, b); }
+ALWAYS_INLINE float absOf(float a) { return std::abs(a); }
+ALWAYS_INLINE float sqrtOf(float a) { return std::sqrt(a); }
+ALWAYS_INLINE float select(bool condition, float a, float b) { return condition ? a : b; }
+
+ALWAYS_INLINE Vc::float_v minOf(Vc::float_v::AsArg a, Vc::float_v::AsArg b) { return Vc::min(a, b); }
+ALWAYS_INLINE Vc::float_v maxOf(Vc::float_v::AsArg a, Vc::float_v::AsArg b) { return Vc::max(a, b); }
+ALWAYS_INLINE Vc::float_v absOf(Vc::float_v::AsArg a) { return Vc::abs(a); }
+ALWAYS_INLINE Vc::float_v sqrtOf(Vc::float_v::AsArg a) { return Vc::sqrt(a); }
+ALWAYS_INLINE Vc::float_v select(const Vc::float_m &condition, Vc::float_v::AsArg a, Vc::float_v::AsArg b) { return Vc::iif(condition, a, b); }
+
+struct BlendMultiply {
+    template<typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return src * dst;
+    }
+};
+
+struct BlendScreen {
+    template<typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return src + dst - src * dst;
+    }
+};
+
+struct BlendHardLight {
+    template<typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        const T src2 = src + src;
+        const T screenSrc = src2 - T(1.0f);
+
+        return select(src > T(0.5f),
+                      screenSrc + dst - screenSrc * dst,
+                      src2 * dst);
+    }
+};
+
+struct BlendOverlay {
+    template<typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return BlendHardLight::apply(dst, src);
+    }
+};
+
+struct BlendSoftLight {
+    template<typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        const T src2 = src + src;
+
+        return select(src > T(0.5f),
+                      dst + (src2 - T(1.0f)) * (sqrtOf(dst) - dst),
+                      dst - (T(1.0f) - src2) * dst * (T(1.0f) - dst));
+    }
+};
+
+struct BlendColorDodge {
+    template<typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        const T invSrc = T(1.0f) - src;
+
+        /**
+         * The division by zero happens only in the lanes that
+         * are overridden by the selects below
+         */
+        T result = minOf(dst / invSrc, T(1.0f));
+        result = select(invSrc < dst, T(1.0f), result);
+        return select(dst == T(0.0f), T(0.0f), result);
+    }
+};
+
+struct BlendAddition {
+    template<typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return src + dst;
+    }
+};
+
+struct BlendSubtract {
+    template<typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return dst - src;
+    }
+};
+
+struct BlendDifference {
+    template<typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return absOf(src - dst);
+    }
+};
+
+struct BlendDarken {
+    template<typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return minOf(src, dst);
+    }
+};
+
+struct BlendLighten {
+    template<typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        return maxOf(src, dst);
+    }
+};
+
+struct BlendExclusion {
+    template<typename T>
+    static ALWAYS_INLINE T apply(const T &src, const T &dst) {
+        const T x = src * dst;
+        return dst + src - (x + x);
+    }
+};
+
+/**
+ * The integer color spaces clamp the result of the blend function
+ * to the channel range, the floating point ones don't
+ */
+template<bool clampResult, typename T>
+ALWAYS_INLINE T clampBlendResult(const T &value) {
+    return clampResult ? minOf(maxOf(value, T(0.0f)), T(1.0f)) : value;
+}
+
+/**
+ * The weights of the source, destination and blended colors used by
+ * KoCompositeOpGenericSC::composeColorChannels() when the alpha
+ * channel is not locked. The alpha values are normalized to [0, 1].
+ */
+template<typename T>
+struct UnionWeights {
+    UnionWeights(const T &srcAlpha, const T &dstAlpha)
+        : both(srcAlpha * dstAlpha),
+          srcOnly(srcAlpha - both),
+          dstOnly(dstAlpha - both),
+          newAlpha(srcAlpha + dstAlpha - both),
+          newAlphaRec(select(newAlpha == T(0.0f), T(0.0f), T(1.0f) / newAlpha))
+    {
+    }
+
+    /**
+     * KoCompositeOpGenericSC doesn't touch the colors of the pixel
+     * if both the source and the destination are transparent, so
+     * the destination color is kept in such lanes
+     */
+    template<class BlendFunction, bool clampResult>
+    ALWAYS_INLINE T compose(const T &src, const T &dst) const {
+        const T result = clampBlendResult<clampResult>(BlendFunction::apply(src, dst));
+        return select(newAlpha == T(0.0f), dst,
+                      (dstOnly * dst + srcOnly * src + both * result) * newAlphaRec);
+    }
+
+    const T both;
+    const T srcOnly;
+    const T dstOnly;
+    const T newAlpha;
+    const T newAlphaRec;
+};
+
+/**
+ * The alpha-locked counterpart of UnionWeights::compose()
+ */
+template<class BlendFunction, bool clampResult, typename T>
+ALWAYS_INLINE T composeAlphaLocked(const T &src, const T &dst, const T &srcAlpha) {
+    const T result = clampBlendResult<clampResult>(BlendFunction::apply(src, dst));
+    return dst + (result - dst) * srcAlpha;
+}
+
+}
+
+#endif /* __KOSTREAMED_BLEND_FUNCTIONS_H */
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KOSTREAMED_BLEND_MODE_H
+#define __KOSTREAMED_BLEND_MODE_H
+
+#include "KoCompositeOpFunctions.h"
+
+
+namespace KoStreamedBlendFunctions {
+
+/**
+ * The blend functions that have a vectorized version in
+ * KoStreamedBlendFunctions.h
+ */
+enum BlendMode {
+    BlendModeUnsupported = -1,
+    BlendModeMultiply,
+    BlendModeScreen,
+    BlendModeOverlay,
+    BlendModeHardLight,
+    BlendModeSoftLight,
+    BlendModeColorDodge,
+    BlendModeAddition,
+    BlendModeSubtract,
+    BlendModeDifference,
+    BlendModeDarken,
+    BlendModeLighten,
+    BlendModeExclusion
+};
+
+/**
+ * Returns the vectorized counterpart of the blend function
+ * \p compositeFunc of KoCompositeOpGenericSC, or BlendModeUnsupported
+ * if the function has no vectorized version. The mode is derived from
+ * the function itself, so the optimized op can never compute anything
+ * different from the generic op it replaces.
+ */
+template<typename T, T compositeFunc(T, T)>
+inline BlendMode blendModeForFunction()
+{
+    return
+        compositeFunc == &cfMultiply<T> ? BlendModeMultiply :
+        compositeFunc == &cfScreen<T> ? BlendModeScreen :
+        compositeFunc == &cfOverlay<T> ? BlendModeOverlay :
+        compositeFunc == &cfHardLight<T> ? BlendModeHardLight :
+        compositeFunc == &cfSoftLight<T> ? BlendModeSoftLight :
+        compositeFunc == &cfColorDodge<T> ? BlendModeColorDodge :
+        compositeFunc == &cfAddition<T> ? BlendModeAddition :
+        compositeFunc == &cfSubtract<T> ? BlendModeSubtract :
+        compositeFunc == &cfDifference<T> ? BlendModeDifference :
+        compositeFunc == &cfDarkenOnly<T> ? BlendModeDarken :
+        compositeFunc == &cfLightenOnly<T> ? BlendModeLighten :
+        compositeFunc == &cfExclusion<T> ? BlendModeExclusion :
+        BlendModeUnsupported;
+}
+
+}
+
+#endif /* __KOSTREAMED_BLEND_MODE_H */
@@ -102,6 +102,12 @@ template<bool useMask, bool useFlow, class Compositor>
     genericComposite_novector<useMask, useFlow, Compositor, 16>(params);
 }
 
+template<bool useMask, bool useFlow, class Compositor>
+    static void genericComposite64_novector(const KoCompositeOp::ParameterInfo& params)
+{
+    genericComposite_novector<useMask, useFlow, Compositor, 8>(params);
+}
+
 static inline quint8 round_float_to_uint(float value) {
     return quint8(value + float(0.5));
 }
@@ -110,6 +116,14 @@ static inline quint8 lerp_mixed_u8_float(quint8 a, quint8 b, float alpha) {
     return round_float_to_uint(qint16(b - a) * alpha + a);
 }
 
+static inline quint16 round_float_to_u16(float value) {
+    return quint16(value + float(0.5));
+}
+
+static inline quint16 lerp_mixed_u16_float(quint16 a, quint16 b, float alpha) {
+    return round_float_to_u16(qint32(b - a) * alpha + a);
+}
+
 /**
  * Get a vector containing first Vc::float_v::size() values of mask.
  * Each source mask element is considered to be a 8-bit integer
@@ -181,8 +195,10 @@ static inline void fetch_colors_32(const quint8 *data,
  * to be stored in the 3 least significant bytes of the pixel, alpha -
  * in the most significant byte
  *
- * NOTE: \p data must be aligned pointer!
+ * \p aligned controls whether the \p data is written using aligned
+ *            instruction or not, see fetch_alpha_32()
  */
+template <bool aligned>
 static inline void write_channels_32(quint8 *data,
                                      Vc::float_v::AsArg alpha,
                                      Vc::float_v::AsArg c1,
@@ -205,7 +221,78 @@ static inline void write_channels_32(quint8 *data,
     uint_v v4 = uint_v(int_v(Vc::round(c3))) & mask;
     v1 = v1 | v2;
     v3 = v3 | v4;
-    (v1 | v3).store((quint32*)data, Vc::Aligned);
+
+    if (aligned) {
+        (v1 | v3).store((quint32*)data, Vc::Aligned);
+    } else {
+        (v1 | v3).store((quint32*)data, Vc::Unaligned);
+    }
+}
+
+/**
+ * Get an alpha values from Vc::float_v::size() pixels 64-bit each
+ * (4 channels, 16 bit per channel).  The alpha value is considered
+ * to be stored in the most significant word of the pixel.
+ *
+ * The pixels are twice as big as the float lanes, so they cannot be
+ * fetched with a single load. Instead the upper halves of the pixels
+ * are gathered, which has no alignment requirements for \p data
+ */
+static inline Vc::float_v fetch_alpha_64(const quint8 *data) {
+    const int_v indexes = int_v::IndexesFromZero() * 2 + 1;
+    uint_v data_i(reinterpret_cast<const quint32*>(data), indexes);
+
+    return Vc::float_v(int_v(data_i >> 16));
+}
+
+/**
+ * Get color values from Vc::float_v::size() pixels 64-bit each
+ * (4 channels, 16 bit per channel).  The color data is considered
+ * to be stored in the 3 least significant words of the pixel.
+ *
+ * \see fetch_alpha_64()
+ */
+static inline void fetch_colors_64(const quint8 *data,
+                                   Vc::float_v &c1,
+                                   Vc::float_v &c2,
+                                   Vc::float_v &c3) {
+    const int_v indexes = int_v::IndexesFromZero() * 2;
+    uint_v low(reinterpret_cast<const quint32*>(data), indexes);
+    uint_v high(reinterpret_cast<const quint32*>(data), indexes + 1);
+
+    const quint32 lowWordMask = 0xFFFF;
+    uint_v mask(lowWordMask);
+
+    c1 = Vc::float_v(int_v(high & mask));
+    c2 = Vc::float_v(int_v(low >> 16));
+    c3 = Vc::float_v(int_v(low & mask));
+}
+
+/**
+ * Pack color and alpha values to Vc::float_v::size() pixels 64-bit each
+ * (4 channels, 16 bit per channel).  The color data is considered
+ * to be stored in the 3 least significant words of the pixel, alpha -
+ * in the most significant word.
+ *
+ * The pixels are scattered, so \p data has no alignment requirements
+ */
+static inline void write_channels_64(quint8 *data,
+                                     Vc::float_v::AsArg alpha,
+                                     Vc::float_v::AsArg c1,
+                                     Vc::float_v::AsArg c2,
+                                     Vc::float_v::AsArg c3) {
+    const int_v indexes = int_v::IndexesFromZero() * 2;
+
+    const quint32 lowWordMask = 0xFFFF;
+    uint_v mask(lowWordMask);
+
+    uint_v v1 = uint_v(int_v(Vc::round(alpha))) << 16;
+    uint_v v2 = uint_v(int_v(Vc::round(c1))) & mask;
+    uint_v v3 = (uint_v(int_v(Vc::round(c2))) & mask) << 16;
+    uint_v v4 = uint_v(int_v(Vc::round(c3))) & mask;
+
+    (v3 | v4).scatter(reinterpret_cast<quint32*>(data), indexes);
+    (v1 | v2).scatter(reinterpret_cast<quint32*>(data), indexes + 1);
 }
 
 /**
@@ -381,6 +468,12 @@ template<bool useMask, bool useFlow, class Compositor>
     genericComposite<useMask, useFlow, Compositor, 16>(params);
 }
 
+template<bool useMask, bool useFlow, class Compositor>
+    static void genericComposite64(const KoCompositeOp::ParameterInfo& params)
+{
+    genericComposite<useMask, useFlow, Compositor, 8>(params);
+}
+
 };
 
 namespace KoStreamedMathFunctions {
@@ -395,6 +488,13 @@ ALWAYS_INLINE void clearPixel<4>(quint8* dst)
     *d = 0;
 }
 
+template<>
+ALWAYS_INLINE void clearPixel<8>(quint8* dst)
+{
+    quint64 *d = reinterpret_cast<quint64*>(dst);
+    *d = 0;
+}
+
 template<>
 ALWAYS_INLINE void clearPixel<16>(quint8* dst)
 {
@@ -414,6 +514,14 @@ ALWAYS_INLINE void copyPixel<4>(const quint8 *src, quint8* dst)
     *d = *s;
 }
 
+template<>
+ALWAYS_INLINE void copyPixel<8>(const quint8 *src, quint8* dst)
+{
+    const quint64 *s = reinterpret_cast<const quint64*>(src);
+    quint64 *d = reinterpret_cast<quint64*>(dst);
+    *d = *s;
+}
+
 template<>
 ALWAYS_INLINE void copyPixel<16>(const quint8 *src, quint8* dst)
 {
@@ -0,0 +1,239 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#include "TestKoColorConversionCache.h"
+
+#include <functional>
+
+#include <QTest>
+#include <QThread>
+#include <QSemaphore>
+
+#include <KoColorConversionCache.h>
+#include <KoColorSpaceRegistry.h>
+
+const KoColorConversionTransformation::Intent INTENT = KoColorConversionTransformation::internalRenderingIntent();
+const KoColorConversionTransformation::ConversionFlags FLAGS = KoColorConversionTransformation::internalConversionFlags();
+
+/**
+ * A thread that runs the steps given by the test one by one and
+ * waits for the next one in between, so it keeps its thread-local
+ * transformations until finish() is called
+ */
+class CacheUserThread : public QThread
+{
+public:
+    void runStep(std::function<void()> step) {
+        m_step = step;
+        m_stepRequested.release();
+        m_stepDone.acquire();
+    }
+
+    void finish() {
+        m_step = std::function<void()>();
+        m_stepRequested.release();
+        wait();
+    }
+
+protected:
+    void run() override {
+        while (true) {
+            m_stepRequested.acquire();
+            if (!m_step) break;
+
+            m_step();
+            m_stepDone.release();
+        }
+    }
+
+private:
+    std::function<void()> m_step;
+    QSemaphore m_stepRequested;
+    QSemaphore m_stepDone;
+};
+
+void TestKoColorConversionCache::testOrphansAreFreedWhenReleased()
+{
+    const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *rgb16 = KoColorSpaceRegistry::instance()->rgb16();
+    const KoColorSpace *lab16 = KoColorSpaceRegistry::instance()->lab16();
+
+    KoColorConversionCache cache;
+
+    CacheUserThread thread;
+    thread.start();
+
+    thread.runStep([&] () {
+        cache.cachedConverter(rgb8, rgb16, INTENT, FLAGS);
+    });
+
+    cache.cachedConverter(rgb8, rgb16, INTENT, FLAGS);
+    QCOMPARE(cache.testingNumLocalTransformations(), 1);
+
+    /**
+     * Our own transformations are dropped immediately, but the other
+     * thread still holds its one
+     */
+    cache.colorSpaceIsDestroyed(rgb16);
+    QCOMPARE(cache.testingNumLocalTransformations(), 0);
+    QCOMPARE(cache.testingNumOrphans(), 1);
+
+    cache.cachedConverter(rgb8, lab16, INTENT, FLAGS);
+    QCOMPARE(cache.testingNumOrphans(), 1);
+
+    // the next request of the thread releases the orphan
+    thread.runStep([&] () {
+        cache.cachedConverter(lab16, rgb8, INTENT, FLAGS);
+    });
+    QCOMPARE(cache.testingNumOrphans(), 0);
+
+    /**
+     * The transformations of a finished thread are released as well,
+     * the orphan is deleted on the next miss
+     */
+    cache.colorSpaceIsDestroyed(lab16);
+    QCOMPARE(cache.testingNumOrphans(), 1);
+
+    thread.finish();
+
+    cache.cachedConverter(rgb8, rgb16, INTENT, FLAGS);
+    QCOMPARE(cache.testingNumOrphans(), 0);
+}
+
+void TestKoColorConversionCache::testLocalTransformationsLimit()
+{
+    const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *rgb16 = KoColorSpaceRegistry::instance()->rgb16();
+    const KoColorSpace *lab16 = KoColorSpaceRegistry::instance()->lab16();
+
+    struct Conversion {
+        const KoColorSpace *src;
+        const KoColorSpace *dst;
+        KoColorConversionTransformation::Intent intent;
+        KoColorConversionTransformation::ConversionFlags flags;
+    };
+
+    const KoColorConversionTransformation::ConversionFlags flagSets[] = {
+        KoColorConversionTransformation::Empty,
+        KoColorConversionTransformation::HighQuality,
+        KoColorConversionTransformation::BlackpointCompensation
+    };
+
+    QVector<Conversion> conversions;
+
+    for (int intent = KoColorConversionTransformation::IntentPerceptual;
+         intent <= KoColorConversionTransformation::IntentAbsoluteColorimetric; intent++) {
+
+        for (int i = 0; i < 3; i++) {
+            const Conversion pairs[] = {
+                {rgb8, rgb16, KoColorConversionTransformation::Intent(intent), flagSets[i]},
+                {rgb8, lab16, KoColorConversionTransformation::Intent(intent), flagSets[i]},
+                {rgb16, rgb8, KoColorConversionTransformation::Intent(intent), flagSets[i]}
+            };
+
+            for (int j = 0; j < 3; j++) {
+                conversions << pairs[j];
+            }
+        }
+    }
+
+    // the limit of KoColorConversionCache::Private
+    const int maxLocalTransformations = 32;
+    QVERIFY(conversions.size() > maxLocalTransformations);
+
+    KoColorConversionCache cache;
+
+    const KoColorConversionTransformation *firstTransformation =
+        cache.cachedConverter(conversions[0].src, conversions[0].dst,
+                              conversions[0].intent, conversions[0].flags).transformation();
+
+    for (int i = 1; i < maxLocalTransformations; i++) {
+        cache.cachedConverter(conversions[i].src, conversions[i].dst,
+                              conversions[i].intent, conversions[i].flags);
+    }
+    QCOMPARE(cache.testingNumLocalTransformations(), maxLocalTransformations);
+
+    // the next new conversion resets the whole set
+    cache.cachedConverter(conversions[maxLocalTransformations].src, conversions[maxLocalTransformations].dst,
+                          conversions[maxLocalTransformations].intent, conversions[maxLocalTransformations].flags);
+    QCOMPARE(cache.testingNumLocalTransformations(), 1);
+
+    /**
+     * The dropped transformations are given back to the shared cache,
+     * so the first one is taken from it again instead of being created
+     */
+    const int misses = cache.statistics().misses;
+
+    const KoColorConversionTransformation *transformation =
+        cache.cachedConverter(conversions[0].src, conversions[0].dst,
+                              conversions[0].intent, conversions[0].flags).transformation();
+
+    QCOMPARE(cache.statistics().misses, misses + 1);
+    QCOMPARE(transformation, firstTransformation);
+    QCOMPARE(cache.testingNumLocalTransformations(), 2);
+}
+
+void TestKoColorConversionCache::testGenerationInvalidatesOtherThreads()
+{
+    const KoColorSpace *rgb8 = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColorSpace *rgb16 = KoColorSpaceRegistry::instance()->rgb16();
+    const KoColorSpace *lab16 = KoColorSpaceRegistry::instance()->lab16();
+
+    KoColorConversionCache cache;
+
+    CacheUserThread thread;
+    thread.start();
+
+    const KoColorConversionTransformation *firstTransformation = 0;
+    const KoColorConversionTransformation *secondTransformation = 0;
+    int numLocalTransformations = -1;
+
+    thread.runStep([&] () {
+        firstTransformation = cache.cachedConverter(rgb8, rgb16, INTENT, FLAGS).transformation();
+    });
+    QCOMPARE(cache.statistics().misses, 1);
+
+    // the repeated request is served locally
+    thread.runStep([&] () {
+        secondTransformation = cache.cachedConverter(rgb8, rgb16, INTENT, FLAGS).transformation();
+    });
+    QCOMPARE(cache.statistics().misses, 1);
+    QCOMPARE(secondTransformation, firstTransformation);
+
+    /**
+     * Destroying any color space, even an unrelated one, makes the
+     * other threads drop their local transformations
+     */
+    cache.colorSpaceIsDestroyed(lab16);
+
+    thread.runStep([&] () {
+        numLocalTransformations = cache.testingNumLocalTransformations();
+        secondTransformation = cache.cachedConverter(rgb8, rgb16, INTENT, FLAGS).transformation();
+    });
+
+    QCOMPARE(numLocalTransformations, 0);
+    QCOMPARE(cache.statistics().misses, 2);
+
+    // the released transformation is reused from the shared cache
+    QCOMPARE(secondTransformation, firstTransformation);
+
+    thread.finish();
+}
+
+QTEST_GUILESS_MAIN(TestKoColorConversionCache)
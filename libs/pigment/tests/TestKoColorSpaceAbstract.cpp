@@ -2,6 +2,7 @@
 
 #include "KoColorSpaceAbstract.h"
 #include "KoColorSpaceTraits.h"
+#include "KoOptimizedCompositeOpFactory.h"
 
 #include <cfloat>
 
@@ -385,5 +386,96 @@ void TestKoColorSpaceAbstract::testMixColorsOpU8NoAlphaLinear()
     QCOMPARE(outputPixel[COLOR_CHANNEL_2], mixOpNoAlphaExpectedColor(pixel1[COLOR_CHANNEL_2], pixel2[COLOR_CHANNEL_2], weights));
 }
 
+/**
+ * Generates \p numColors random pixels and weights summing up to 255
+ */
+template <class T>
+void generateMixOpData(int numColors, T maxValue, QVector<T> &pixels, QVector<qint16> &weights)
+{
+    pixels.resize(4 * numColors);
+    weights.resize(numColors);
+
+    for (int i = 0; i < pixels.size(); i++) {
+        pixels[i] = T(qreal(qrand() % 256) / 255 * maxValue);
+    }
+
+    int weightsLeft = 255;
+    for (int i = 0; i < numColors; i++) {
+        weights[i] = i < numColors - 1 ? qrand() % (weightsLeft + 1) : weightsLeft;
+        weightsLeft -= weights[i];
+    }
+}
+
+template <class T>
+void compareMixOps(const KoMixColorsOp *op, const KoMixColorsOp *refOp, T maxValue, bool exactMatch)
+{
+    QList<int> sizes;
+    sizes << 1 << 3 << 4 << 7 << 8 << 9 << 16 << 17 << 31 << 100;
+
+    Q_FOREACH (int numColors, sizes) {
+        QVector<T> pixels;
+        QVector<qint16> weights;
+        generateMixOpData(numColors, maxValue, pixels, weights);
+
+        QVector<const quint8*> pixelPtrs(numColors);
+        for (int i = 0; i < numColors; i++) {
+            pixelPtrs[i] = reinterpret_cast<const quint8*>(pixels.constData() + 4 * i);
+        }
+
+        const quint8 *colors = reinterpret_cast<const quint8*>(pixels.constData());
+
+        for (int variant = 0; variant < 4; variant++) {
+            T result[4];
+            T expected[4];
+
+            quint8 *resultPtr = reinterpret_cast<quint8*>(result);
+            quint8 *expectedPtr = reinterpret_cast<quint8*>(expected);
+
+            switch (variant) {
+            case 0:
+                op->mixColors(colors, weights.constData(), numColors, resultPtr);
+                refOp->mixColors(colors, weights.constData(), numColors, expectedPtr);
+                break;
+            case 1:
+                op->mixColors(colors, numColors, resultPtr);
+                refOp->mixColors(colors, numColors, expectedPtr);
+                break;
+            case 2:
+                op->mixColors(pixelPtrs.constData(), weights.constData(), numColors, resultPtr);
+                refOp->mixColors(pixelPtrs.constData(), weights.constData(), numColors, expectedPtr);
+                break;
+            case 3:
+                op->mixColors(pixelPtrs.constData(), numColors, resultPtr);
+                refOp->mixColors(pixelPtrs.constData(), numColors, expectedPtr);
+                break;
+            }
+
+            for (int ch = 0; ch < 4; ch++) {
+                if (exactMatch) {
+                    QCOMPARE(result[ch], expected[ch]);
+                } else if (qAbs(result[ch] - expected[ch]) > 1e-5 * maxValue) {
+                    qDebug() << "numColors" << numColors << "variant" << variant << "channel" << ch;
+                    QCOMPARE(result[ch], expected[ch]);
+                }
+            }
+        }
+    }
+}
+
+void TestKoColorSpaceAbstract::testOptimizedMixColorsOpU8()
+{
+    QScopedPointer<KoMixColorsOp> op(KoOptimizedCompositeOpFactory::createMixColorsOp32());
+    KoMixColorsOpImpl<KoBgrU8Traits> refOp;
+
+    compareMixOps<quint8>(op.data(), &refOp, 255, true);
+}
+
+void TestKoColorSpaceAbstract::testOptimizedMixColorsOpF32()
+{
+    QScopedPointer<KoMixColorsOp> op(KoOptimizedCompositeOpFactory::createMixColorsOp128());
+    KoMixColorsOpImpl<KoRgbF32Traits> refOp;
+
+    compareMixOps<float>(op.data(), &refOp, 1.0f, false);
+}
 
 QTEST_GUILESS_MAIN(TestKoColorSpaceAbstract)
@@ -11,6 +11,8 @@ private Q_SLOTS:
     void testMixColorsOpF32();
     void testMixColorsOpU8NoAlpha();
     void testMixColorsOpU8NoAlphaLinear();
+    void testOptimizedMixColorsOpU8();
+    void testOptimizedMixColorsOpF32();
 };
 
 #endif
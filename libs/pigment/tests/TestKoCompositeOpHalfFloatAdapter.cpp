@@ -0,0 +1,242 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#include "TestKoCompositeOpHalfFloatAdapter.h"
+
+#include <QTest>
+#include <QBitArray>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QVector>
+
+#include <KoConfig.h>
+#include <KoCompositeOpRegistry.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+
+#ifdef HAVE_OPENEXR
+#include <KoColorSpaceTraits.h>
+#include <KoOptimizedCompositeOpFactory.h>
+#include "../compositeops/KoCompositeOpAlphaDarken.h"
+#include "../compositeops/KoCompositeOpOver.h"
+#include "../compositeops/KoCompositeOpGeneric.h"
+#include "../compositeops/KoCompositeOpHalfFloatAdapter.h"
+
+using namespace KoStreamedBlendFunctions;
+
+const int NUM_ROWS = 3;
+
+/**
+ * The generic ops round every intermediate value to half, the
+ * adapter only the result, so they may differ by a few steps of half
+ */
+const float HALF_EPSILON = 0.0009765625f;
+const float TOLERANCE = 4 * HALF_EPSILON;
+
+/**
+ * Creates the generic half op and the adapter around the float one,
+ * exactly as OptimizedOpsSelector<KoRgbF16Traits> does
+ */
+template<half compositeFunc(half, half)>
+void createGenericSCOps(const KoColorSpace *cs, const QString &id,
+                        QScopedPointer<KoCompositeOp> &genericOp,
+                        QScopedPointer<KoCompositeOp> &adapterOp)
+{
+    genericOp.reset(new KoCompositeOpGenericSC<KoRgbF16Traits, compositeFunc>(cs, id, id, ""));
+
+    KoCompositeOp *floatOp = KoOptimizedCompositeOpFactory::createGenericSCOp128(cs, blendModeForFunction<half, compositeFunc>(), id, id, "");
+    adapterOp.reset(floatOp ? new KoCompositeOpHalfFloatAdapter(cs, floatOp) : 0);
+}
+
+void createOpsForId(const KoColorSpace *cs, const QString &id,
+                    QScopedPointer<KoCompositeOp> &genericOp,
+                    QScopedPointer<KoCompositeOp> &adapterOp)
+{
+    if (id == COMPOSITE_OVER) {
+        genericOp.reset(new KoCompositeOpOver<KoRgbF16Traits>(cs));
+        adapterOp.reset(new KoCompositeOpHalfFloatAdapter(cs, KoOptimizedCompositeOpFactory::createOverOp128(cs)));
+    } else if (id == COMPOSITE_ALPHA_DARKEN) {
+        genericOp.reset(new KoCompositeOpAlphaDarken<KoRgbF16Traits>(cs));
+        adapterOp.reset(new KoCompositeOpHalfFloatAdapter(cs, new KoCompositeOpAlphaDarken<KoRgbF32Traits>(cs)));
+    } else if (id == COMPOSITE_MULT) {
+        createGenericSCOps<&cfMultiply<half> >(cs, id, genericOp, adapterOp);
+    } else if (id == COMPOSITE_SCREEN) {
+        createGenericSCOps<&cfScreen<half> >(cs, id, genericOp, adapterOp);
+    } else if (id == COMPOSITE_OVERLAY) {
+        createGenericSCOps<&cfOverlay<half> >(cs, id, genericOp, adapterOp);
+    } else if (id == COMPOSITE_DARKEN) {
+        createGenericSCOps<&cfDarkenOnly<half> >(cs, id, genericOp, adapterOp);
+    } else if (id == COMPOSITE_DIFF) {
+        createGenericSCOps<&cfDifference<half> >(cs, id, genericOp, adapterOp);
+    }
+}
+
+void fillRandomPixels(QVector<half> &pixels, int seed)
+{
+    qsrand(seed);
+
+    for (int i = 0; i < pixels.size(); i++) {
+        pixels[i] = half(float(qrand()) / RAND_MAX);
+    }
+}
+#endif
+
+void TestKoCompositeOpHalfFloatAdapter::testCompareWithGeneric_data()
+{
+    QTest::addColumn<QString>("id");
+    QTest::addColumn<int>("cols");
+    QTest::addColumn<bool>("useMask");
+    QTest::addColumn<bool>("constantSource");
+    QTest::addColumn<float>("opacity");
+    QTest::addColumn<float>("averageOpacity");
+    QTest::addColumn<float>("flow");
+    QTest::addColumn<QBitArray>("channelFlags");
+
+    QBitArray noGreen(4, true);
+    noGreen.clearBit(1);
+
+    QBitArray alphaLocked(4, true);
+    alphaLocked.clearBit(3);
+
+    QStringList ids;
+    ids << COMPOSITE_OVER << COMPOSITE_ALPHA_DARKEN
+        << COMPOSITE_MULT << COMPOSITE_SCREEN << COMPOSITE_OVERLAY
+        << COMPOSITE_DARKEN << COMPOSITE_DIFF;
+
+    /**
+     * The adapter converts the rows in chunks of 256 pixels, so the
+     * widths check a single pixel, a partial chunk and the tails
+     * after the full ones
+     */
+    Q_FOREACH (const QString &id, ids) {
+        QTest::newRow(qPrintable(id + "-single"))
+            << id << 1 << true << false << 0.7f << 0.0f << 1.0f << QBitArray();
+        QTest::newRow(qPrintable(id + "-mask"))
+            << id << 300 << true << false << 0.7f << 0.0f << 1.0f << QBitArray();
+        QTest::newRow(qPrintable(id + "-no-mask"))
+            << id << 257 << false << false << 1.0f << 0.0f << 1.0f << QBitArray();
+        QTest::newRow(qPrintable(id + "-flow"))
+            << id << 513 << true << false << 0.5f << 0.9f << 0.4f << QBitArray();
+        QTest::newRow(qPrintable(id + "-constant-source"))
+            << id << 600 << true << true << 0.8f << 0.0f << 1.0f << QBitArray();
+        QTest::newRow(qPrintable(id + "-no-green"))
+            << id << 255 << true << false << 0.9f << 0.0f << 1.0f << noGreen;
+        QTest::newRow(qPrintable(id + "-alpha-locked"))
+            << id << 770 << true << false << 0.9f << 0.0f << 1.0f << alphaLocked;
+    }
+}
+
+void TestKoCompositeOpHalfFloatAdapter::testCompareWithGeneric()
+{
+#ifdef HAVE_OPENEXR
+    QFETCH(QString, id);
+    QFETCH(int, cols);
+    QFETCH(bool, useMask);
+    QFETCH(bool, constantSource);
+    QFETCH(float, opacity);
+    QFETCH(float, averageOpacity);
+    QFETCH(float, flow);
+    QFETCH(QBitArray, channelFlags);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float16BitsColorDepthID.id(), "");
+    QVERIFY(cs);
+
+    QScopedPointer<KoCompositeOp> genericOp;
+    QScopedPointer<KoCompositeOp> adapterOp;
+    createOpsForId(cs, id, genericOp, adapterOp);
+
+    QVERIFY(genericOp);
+
+    if (!adapterOp) {
+        QSKIP("No optimized float version of the op on this CPU");
+    }
+
+    const int numChannels = 4;
+    const int pixelSize = KoRgbF16Traits::pixelSize;
+    const int numValues = NUM_ROWS * cols * numChannels;
+
+    QVector<half> src(numValues);
+    QVector<half> actualDst(numValues);
+    QVector<half> expectedDst(numValues);
+    QVector<quint8> mask(NUM_ROWS * cols);
+
+    fillRandomPixels(src, 1);
+    fillRandomPixels(actualDst, 2);
+    for (int i = 0; i < mask.size(); i++) {
+        mask[i] = qrand() & 0xff;
+    }
+    expectedDst = actualDst;
+
+    KoCompositeOp::ParameterInfo params;
+    params.srcRowStart = reinterpret_cast<const quint8*>(src.constData());
+    params.srcRowStride = constantSource ? 0 : cols * pixelSize;
+    params.maskRowStart = useMask ? mask.constData() : 0;
+    params.maskRowStride = useMask ? cols : 0;
+    params.rows = NUM_ROWS;
+    params.cols = cols;
+    params.flow = flow;
+    params.channelFlags = channelFlags;
+
+    /**
+     * A lower opacity than the average one makes the alpha darken
+     * ops use the averaged opacity, as they do in the middle of a
+     * stroke
+     */
+    if (averageOpacity > 0.0f) {
+        params.opacity = averageOpacity;
+        params.updateOpacityAndAverage(opacity);
+    } else {
+        params.opacity = opacity;
+    }
+
+    params.dstRowStart = reinterpret_cast<quint8*>(actualDst.data());
+    params.dstRowStride = cols * pixelSize;
+    adapterOp->composite(params);
+
+    params.dstRowStart = reinterpret_cast<quint8*>(expectedDst.data());
+    genericOp->composite(params);
+
+    for (int i = 0; i < numValues; i += numChannels) {
+        const float actualAlpha = actualDst[i + 3];
+        const float expectedAlpha = expectedDst[i + 3];
+
+        if (qAbs(actualAlpha - expectedAlpha) > TOLERANCE) {
+            QFAIL(QString("Pixel %1 alpha: %2 != %3").arg(i / numChannels).arg(actualAlpha).arg(expectedAlpha).toLatin1());
+        }
+
+        /**
+         * The colors are compared premultiplied, the generic op
+         * divides by the rounded alpha, so the error of the colors of
+         * almost transparent pixels is not limited otherwise
+         */
+        for (int channel = 0; channel < 3; channel++) {
+            const float actual = float(actualDst[i + channel]) * actualAlpha;
+            const float expected = float(expectedDst[i + channel]) * expectedAlpha;
+
+            if (qAbs(actual - expected) > TOLERANCE) {
+                QFAIL(QString("Pixel %1 channel %2: %3 != %4").arg(i / numChannels).arg(channel).arg(float(actualDst[i + channel])).arg(float(expectedDst[i + channel])).toLatin1());
+            }
+        }
+    }
+#else
+    QSKIP("Half float color spaces need OpenEXR");
+#endif
+}
+
+QTEST_GUILESS_MAIN(TestKoCompositeOpHalfFloatAdapter)
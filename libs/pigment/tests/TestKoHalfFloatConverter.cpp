@@ -0,0 +1,135 @@
+#include "TestKoHalfFloatConverter.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <QTest>
+#include <QDebug>
+#include <QVector>
+
+#include "KoColorSpaceMaths.h"
+#include "KoHalfFloatConverter.h"
+
+Q_DECLARE_METATYPE(const KoHalfFloatConverter*)
+
+namespace {
+
+quint32 floatBits(float value)
+{
+    quint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsFloat(quint32 bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+}
+
+void TestKoHalfFloatConverter::testHalfToFloat_data()
+{
+    static KoHalfFloatConverter scalarConverter;
+
+    QTest::addColumn<const KoHalfFloatConverter*>("converter");
+
+    QTest::newRow("scalar") << &scalarConverter;
+    QTest::newRow("instance") << KoHalfFloatConverter::instance();
+}
+
+void TestKoHalfFloatConverter::testHalfToFloat()
+{
+    QFETCH(const KoHalfFloatConverter*, converter);
+
+    // an odd number of values checks the unaligned tail as well
+    const int numValues = 0x10000 + 3;
+
+    QVector<quint16> src(numValues);
+    QVector<float> dst(numValues);
+
+    for (int i = 0; i < numValues; i++) {
+        src[i] = quint16(i);
+    }
+
+    converter->halfToFloat(src.constData(), dst.data(), numValues);
+
+    for (int i = 0; i < numValues; i++) {
+        const quint16 h = src[i];
+
+#ifdef HAVE_OPENEXR
+        half reference;
+        reference.setBits(h);
+        const float expected = reference;
+#else
+        // compare to the scalar version at least
+        float expected;
+        KoHalfFloatConverter().halfToFloat(&h, &expected, 1);
+#endif
+
+        if (std::isnan(expected)) {
+            QVERIFY(std::isnan(dst[i]));
+        } else if (floatBits(dst[i]) != floatBits(expected)) {
+            qDebug() << "Wrong conversion of" << hex << h << dst[i] << expected;
+            QFAIL("half to float conversion failed");
+        }
+    }
+}
+
+void TestKoHalfFloatConverter::testFloatToHalf_data()
+{
+    testHalfToFloat_data();
+}
+
+void TestKoHalfFloatConverter::testFloatToHalf()
+{
+    QFETCH(const KoHalfFloatConverter*, converter);
+
+    QVector<float> src;
+
+    src << 0.0f << -0.0f << 1.0f << -1.0f << 0.5f << 65504.0f << 65520.0f << -65520.0f
+        << 1e10f << 1e-10f << -1e-10f << 5.96e-8f << 2.98e-8f << 6.1e-5f
+        << bitsFloat(0x7f800000) << bitsFloat(0xff800000);
+
+    // ties and near-ties around every exponent, including the denormals
+    for (quint32 exp = 100; exp < 145; exp++) {
+        for (quint32 mantissa = 0; mantissa < 0x4000; mantissa += 0x3ff) {
+            src << bitsFloat((exp << 23) | mantissa);
+            src << bitsFloat((exp << 23) | 0x1000 | mantissa);
+            src << bitsFloat((exp << 23) | 0x3000 | (mantissa << 9));
+        }
+    }
+
+    qsrand(1);
+    for (int i = 0; i < 10001; i++) {
+        src << (qrand() - RAND_MAX / 2) / float(RAND_MAX) * 4.0f;
+    }
+
+    QVector<quint16> dst(src.size());
+    converter->floatToHalf(src.constData(), dst.data(), src.size());
+
+    for (int i = 0; i < src.size(); i++) {
+#ifdef HAVE_OPENEXR
+        const quint16 expected = half(src[i]).bits();
+#else
+        quint16 expected;
+        KoHalfFloatConverter().floatToHalf(&src[i], &expected, 1);
+#endif
+
+        if (dst[i] != expected) {
+            qDebug() << "Wrong conversion of" << src[i] << hex << floatBits(src[i]) << dst[i] << expected;
+            QFAIL("float to half conversion failed");
+        }
+    }
+
+    // NaN stays NaN
+    const float nan = bitsFloat(0x7fc00001);
+    quint16 nanResult;
+    converter->floatToHalf(&nan, &nanResult, 1);
+    QCOMPARE(nanResult & 0x7c00, 0x7c00);
+    QVERIFY(nanResult & 0x03ff);
+}
+
+QTEST_GUILESS_MAIN(TestKoHalfFloatConverter)
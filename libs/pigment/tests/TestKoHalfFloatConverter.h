@@ -0,0 +1,16 @@
+#ifndef TESTKOHALFFLOATCONVERTER_H
+#define TESTKOHALFFLOATCONVERTER_H
+
+#include <QObject>
+
+class TestKoHalfFloatConverter : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testHalfToFloat_data();
+    void testHalfToFloat();
+    void testFloatToHalf_data();
+    void testFloatToHalf();
+};
+
+#endif
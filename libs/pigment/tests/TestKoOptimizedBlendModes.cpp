@@ -0,0 +1,224 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#include "TestKoOptimizedBlendModes.h"
+
+#include <QTest>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QVector>
+
+#include "../compositeops/KoCompositeOpGeneric.h"
+#include <KoOptimizedCompositeOpFactory.h>
+#include <KoCompositeOpRegistry.h>
+#include <KoColorSpaceTraits.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColorModelStandardIds.h>
+
+using namespace KoStreamedBlendFunctions;
+
+const int TILE_WIDTH = 64;
+const int TILE_HEIGHT = 64;
+const int NUM_PIXELS = TILE_WIDTH * TILE_HEIGHT;
+
+const quint8 OPACITY_HALF = 128;
+
+/**
+ * Creates the generic op and its vectorized version from the same
+ * blend function, exactly as addStandardCompositeOps() does
+ */
+template<class Traits, typename Traits::channels_type compositeFunc(typename Traits::channels_type, typename Traits::channels_type)>
+void createOps(const KoColorSpace *cs, const QString &id,
+               QScopedPointer<KoCompositeOp> &scalarOp,
+               QScopedPointer<KoCompositeOp> &optimizedOp)
+{
+    typedef typename Traits::channels_type T;
+    const BlendMode blendMode = blendModeForFunction<T, compositeFunc>();
+
+    scalarOp.reset(new KoCompositeOpGenericSC<Traits, compositeFunc>(cs, id, id, ""));
+    optimizedOp.reset(Traits::pixelSize == 4 ?
+                      KoOptimizedCompositeOpFactory::createGenericSCOp32(cs, blendMode, id, id, "") :
+                      KoOptimizedCompositeOpFactory::createGenericSCOp128(cs, blendMode, id, id, ""));
+}
+
+template<class Traits>
+void createOpsForId(const KoColorSpace *cs, const QString &id,
+                    QScopedPointer<KoCompositeOp> &scalarOp,
+                    QScopedPointer<KoCompositeOp> &optimizedOp)
+{
+    typedef typename Traits::channels_type T;
+
+    if (id == COMPOSITE_MULT) {
+        createOps<Traits, &cfMultiply<T> >(cs, id, scalarOp, optimizedOp);
+    } else if (id == COMPOSITE_SCREEN) {
+        createOps<Traits, &cfScreen<T> >(cs, id, scalarOp, optimizedOp);
+    } else if (id == COMPOSITE_OVERLAY) {
+        createOps<Traits, &cfOverlay<T> >(cs, id, scalarOp, optimizedOp);
+    } else if (id == COMPOSITE_HARD_LIGHT) {
+        createOps<Traits, &cfHardLight<T> >(cs, id, scalarOp, optimizedOp);
+    } else if (id == COMPOSITE_SOFT_LIGHT_PHOTOSHOP) {
+        createOps<Traits, &cfSoftLight<T> >(cs, id, scalarOp, optimizedOp);
+    } else if (id == COMPOSITE_DODGE) {
+        createOps<Traits, &cfColorDodge<T> >(cs, id, scalarOp, optimizedOp);
+    } else if (id == COMPOSITE_ADD) {
+        createOps<Traits, &cfAddition<T> >(cs, id, scalarOp, optimizedOp);
+    } else if (id == COMPOSITE_SUBTRACT) {
+        createOps<Traits, &cfSubtract<T> >(cs, id, scalarOp, optimizedOp);
+    } else if (id == COMPOSITE_DIFF) {
+        createOps<Traits, &cfDifference<T> >(cs, id, scalarOp, optimizedOp);
+    } else if (id == COMPOSITE_DARKEN) {
+        createOps<Traits, &cfDarkenOnly<T> >(cs, id, scalarOp, optimizedOp);
+    } else if (id == COMPOSITE_LIGHTEN) {
+        createOps<Traits, &cfLightenOnly<T> >(cs, id, scalarOp, optimizedOp);
+    } else if (id == COMPOSITE_EXCLUSION) {
+        createOps<Traits, &cfExclusion<T> >(cs, id, scalarOp, optimizedOp);
+    }
+}
+
+/**
+ * Every fourth pixel is transparent both in the source and in the
+ * destination, the ops must keep the colors of such pixels
+ */
+bool isTransparentPixel(int pixel)
+{
+    return pixel % 4 == 0;
+}
+
+void fillRandomPixels(quint8 *buffer, int numPixels, bool useFloat, int seed)
+{
+    qsrand(seed);
+
+    if (useFloat) {
+        float *ptr = reinterpret_cast<float*>(buffer);
+        for (int i = 0; i < numPixels * 4; i++) {
+            ptr[i] = isTransparentPixel(i / 4) && i % 4 == 3 ? 0.0f : float(qrand()) / RAND_MAX;
+        }
+    } else {
+        for (int i = 0; i < numPixels * 4; i++) {
+            buffer[i] = isTransparentPixel(i / 4) && i % 4 == 3 ? 0 : qrand() & 0xff;
+        }
+    }
+}
+
+void TestKoOptimizedBlendModes::testBlendModeForFunction()
+{
+    QCOMPARE((blendModeForFunction<quint8, &cfMultiply<quint8> >()), BlendModeMultiply);
+    QCOMPARE((blendModeForFunction<quint8, &cfOverlay<quint8> >()), BlendModeOverlay);
+    QCOMPARE((blendModeForFunction<quint8, &cfDarkenOnly<quint8> >()), BlendModeDarken);
+    QCOMPARE((blendModeForFunction<float, &cfSoftLight<float> >()), BlendModeSoftLight);
+    QCOMPARE((blendModeForFunction<float, &cfExclusion<float> >()), BlendModeExclusion);
+
+    QCOMPARE((blendModeForFunction<quint8, &cfColorBurn<quint8> >()), BlendModeUnsupported);
+    QCOMPARE((blendModeForFunction<float, &cfSoftLightSvg<float> >()), BlendModeUnsupported);
+}
+
+void TestKoOptimizedBlendModes::testCompareWithGeneric_data()
+{
+    QTest::addColumn<QString>("id");
+    QTest::addColumn<bool>("useFloat");
+
+    QStringList ids;
+    ids << COMPOSITE_MULT << COMPOSITE_SCREEN << COMPOSITE_OVERLAY
+        << COMPOSITE_HARD_LIGHT << COMPOSITE_SOFT_LIGHT_PHOTOSHOP
+        << COMPOSITE_DODGE << COMPOSITE_ADD << COMPOSITE_SUBTRACT
+        << COMPOSITE_DIFF << COMPOSITE_DARKEN << COMPOSITE_LIGHTEN
+        << COMPOSITE_EXCLUSION;
+
+    Q_FOREACH (const QString &id, ids) {
+        QTest::newRow(qPrintable(id + "-u8")) << id << false;
+        QTest::newRow(qPrintable(id + "-f32")) << id << true;
+    }
+}
+
+void TestKoOptimizedBlendModes::testCompareWithGeneric()
+{
+    QFETCH(QString, id);
+    QFETCH(bool, useFloat);
+
+    QScopedPointer<KoCompositeOp> scalarOp;
+    QScopedPointer<KoCompositeOp> optimizedOp;
+
+    if (useFloat) {
+        const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), Float32BitsColorDepthID.id(), "");
+        createOpsForId<KoRgbF32Traits>(cs, id, scalarOp, optimizedOp);
+    } else {
+        const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+        createOpsForId<KoBgrU8Traits>(cs, id, scalarOp, optimizedOp);
+    }
+
+    QVERIFY(scalarOp);
+
+    if (!optimizedOp) {
+        QSKIP("No vector implementation on this CPU");
+    }
+
+    const int pixelSize = useFloat ? KoRgbF32Traits::pixelSize : KoBgrU8Traits::pixelSize;
+
+    QVector<quint8> src(NUM_PIXELS * pixelSize);
+    QVector<quint8> actualDst(NUM_PIXELS * pixelSize);
+    QVector<quint8> expectedDst(NUM_PIXELS * pixelSize);
+    QVector<quint8> mask(NUM_PIXELS);
+
+    fillRandomPixels(src.data(), NUM_PIXELS, useFloat, 1);
+    fillRandomPixels(actualDst.data(), NUM_PIXELS, useFloat, 2);
+    for (int i = 0; i < NUM_PIXELS; i++) {
+        mask[i] = qrand() & 0xff;
+    }
+    expectedDst = actualDst;
+
+    optimizedOp->composite(actualDst.data(), TILE_WIDTH * pixelSize,
+                           src.constData(), TILE_WIDTH * pixelSize,
+                           mask.constData(), TILE_WIDTH,
+                           TILE_HEIGHT, TILE_WIDTH,
+                           OPACITY_HALF);
+
+    scalarOp->composite(expectedDst.data(), TILE_WIDTH * pixelSize,
+                        src.constData(), TILE_WIDTH * pixelSize,
+                        mask.constData(), TILE_WIDTH,
+                        TILE_HEIGHT, TILE_WIDTH,
+                        OPACITY_HALF);
+
+    for (int i = 0; i < NUM_PIXELS * 4; i++) {
+        const bool isAlpha = i % 4 == 3;
+        const int pixelAlphaIndex = i - i % 4 + 3;
+
+        if (useFloat) {
+            const float *act = reinterpret_cast<const float*>(actualDst.constData());
+            const float *exp = reinterpret_cast<const float*>(expectedDst.constData());
+
+            // the colors of the pixels that became transparent are undefined
+            if (!isAlpha && exp[pixelAlphaIndex] == 0.0f && !isTransparentPixel(i / 4)) continue;
+
+            if (qAbs(act[i] - exp[i]) > 1e-5) {
+                QFAIL(QString("Pixel %1 channel %2: %3 != %4").arg(i / 4).arg(i % 4).arg(act[i]).arg(exp[i]).toLatin1());
+            }
+        } else {
+            const quint8 *act = actualDst.constData();
+            const quint8 *exp = expectedDst.constData();
+
+            if (!isAlpha && exp[pixelAlphaIndex] == 0 && !isTransparentPixel(i / 4)) continue;
+
+            if (qAbs(int(act[i]) - int(exp[i])) > 2) {
+                QFAIL(QString("Pixel %1 channel %2: %3 != %4").arg(i / 4).arg(i % 4).arg(act[i]).arg(exp[i]).toLatin1());
+            }
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(TestKoOptimizedBlendModes)
@@ -361,6 +361,12 @@ KisDisplayColorConverter::conversionFlags()
     return conversionFlags;
 }
 
+bool KisDisplayColorConverter::useLut3D()
+{
+    KisConfig cfg;
+    return cfg.useDisplayLut3D();
+}
+
 QSharedPointer<KisDisplayFilter> KisDisplayColorConverter::displayFilter() const
 {
     return m_d->displayFilter;
@@ -87,6 +87,13 @@ public:
     static KoColorConversionTransformation::Intent renderingIntent();
     static KoColorConversionTransformation::ConversionFlags conversionFlags();
 
+    /**
+     * Returns true if the projection should be converted into the
+     * monitor color space with a baked 3D LUT instead of a full
+     * color management transform (see KisDisplayLut3DCache)
+     */
+    static bool useLut3D();
+
     QSharedPointer<KisDisplayFilter> displayFilter() const;
     const KoColorProfile* monitorProfile() const;
 
@@ -0,0 +1,58 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_display_lut_3d_cache.h"
+
+#include <QMutexLocker>
+
+#include <KoColorSpace.h>
+#include <KoLut3DColorConversionTransformation.h>
+
+
+QSharedPointer<KoColorConversionTransformation>
+KisDisplayLut3DCache::transformation(const KoColorSpace *srcCS,
+                                     const KoColorSpace *dstCS,
+                                     KoColorConversionTransformation::Intent renderingIntent,
+                                     KoColorConversionTransformation::ConversionFlags conversionFlags)
+{
+    if (!KoLut3DColorConversionTransformation::isSupported(srcCS, dstCS)) {
+        return QSharedPointer<KoColorConversionTransformation>();
+    }
+
+    QMutexLocker l(&m_mutex);
+
+    if (!m_transformation ||
+        !(*m_transformation->srcColorSpace() == *srcCS) ||
+        !(*m_transformation->dstColorSpace() == *dstCS) ||
+        m_transformation->renderingIntent() != renderingIntent ||
+        m_transformation->conversionFlags() != conversionFlags) {
+
+        m_transformation.reset(
+            new KoLut3DColorConversionTransformation(srcCS, dstCS,
+                                                     renderingIntent,
+                                                     conversionFlags));
+    }
+
+    return m_transformation;
+}
+
+void KisDisplayLut3DCache::clear()
+{
+    QMutexLocker l(&m_mutex);
+    m_transformation.clear();
+}
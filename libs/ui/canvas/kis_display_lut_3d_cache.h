@@ -0,0 +1,65 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_DISPLAY_LUT_3D_CACHE_H
+#define __KIS_DISPLAY_LUT_3D_CACHE_H
+
+#include <QMutex>
+#include <QSharedPointer>
+
+#include <KoColorConversionTransformation.h>
+
+#include "kritaui_export.h"
+
+
+/**
+ * Keeps the baked 3D LUT conversion used for converting the projection
+ * into the monitor color space.
+ *
+ * Building the LUT costs about as much as converting a few tiles with
+ * LCMS, so it is rebuilt only when the color spaces (that is, the
+ * image or the monitor profile), the rendering intent or the
+ * conversion flags change. transformation() may be called from
+ * several update threads at once: the returned pointer keeps the
+ * transformation alive even if another thread replaces it meanwhile.
+ */
+class KRITAUI_EXPORT KisDisplayLut3DCache
+{
+public:
+    /**
+     * Returns the LUT conversion from \p srcCS to \p dstCS or null if
+     * the pair of color spaces is not supported
+     * (see KoLut3DColorConversionTransformation::isSupported())
+     */
+    QSharedPointer<KoColorConversionTransformation>
+    transformation(const KoColorSpace *srcCS,
+                   const KoColorSpace *dstCS,
+                   KoColorConversionTransformation::Intent renderingIntent,
+                   KoColorConversionTransformation::ConversionFlags conversionFlags);
+
+    /**
+     * Drops the cached LUT
+     */
+    void clear();
+
+private:
+    QMutex m_mutex;
+    QSharedPointer<KoColorConversionTransformation> m_transformation;
+};
+
+#endif /* __KIS_DISPLAY_LUT_3D_CACHE_H */
@@ -32,6 +32,7 @@
 #include "kis_debug.h"
 #include "kis_config.h"
 #include "kis_image_config.h"
+#include "kis_display_color_converter.h"
 
 //#define DEBUG_PYRAMID
 
@@ -324,8 +325,20 @@ void KisImagePyramid::retrieveImageData(const QRect &rect)
             originalBytes.swap(dst);
         }
 
+        QSharedPointer<KoColorConversionTransformation> lutTransform;
+
+        if (m_useLut3D && !(*projectionCs == *m_monitorColorSpace)) {
+            lutTransform = m_lut3DCache.transformation(projectionCs, m_monitorColorSpace, m_renderingIntent, m_conversionFlags);
+        }
+
         QScopedArrayPointer<quint8> dst(new quint8[m_monitorColorSpace->pixelSize() * numPixels]);
-        projectionCs->convertPixelsTo(originalBytes.data(), dst.data(), m_monitorColorSpace, numPixels, m_renderingIntent, m_conversionFlags);
+
+        if (lutTransform) {
+            lutTransform->transform(originalBytes.data(), dst.data(), numPixels);
+        } else {
+            projectionCs->convertPixelsTo(originalBytes.data(), dst.data(), m_monitorColorSpace, numPixels, m_renderingIntent, m_conversionFlags);
+        }
+
         originalBytes.swap(dst);
     }
 
@@ -533,5 +546,10 @@ void KisImagePyramid::configChanged()
 {
     KisConfig cfg;
     m_useOcio = cfg.useOcio();
+    m_useLut3D = KisDisplayColorConverter::useLut3D();
+
+    if (!m_useLut3D) {
+        m_lut3DCache.clear();
+    }
 }
 
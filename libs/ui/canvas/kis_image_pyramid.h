@@ -27,6 +27,7 @@
 #include <kis_image.h>
 #include <kis_paint_device.h>
 #include "kis_projection_backend.h"
+#include "kis_display_lut_3d_cache.h"
 
 
 class KisImagePyramid : QObject, public KisProjectionBackend
@@ -134,6 +135,9 @@ private:
 
     bool m_useOcio;
 
+    bool m_useLut3D;
+    KisDisplayLut3DCache m_lut3DCache;
+
     QBitArray m_channelFlags;
     bool m_allChannelsSelected;
     bool m_onlyOneChannelSelected;
@@ -559,6 +559,16 @@ void KisConfig::setAllowLCMSOptimization(bool allowLCMSOptimization)
     m_cfg.writeEntry("allowLCMSOptimization", allowLCMSOptimization);
 }
 
+bool KisConfig::useDisplayLut3D(bool defaultValue) const
+{
+    return (defaultValue ? false : m_cfg.readEntry("useDisplayLut3D", false));
+}
+
+void KisConfig::setUseDisplayLut3D(bool value)
+{
+    m_cfg.writeEntry("useDisplayLut3D", value);
+}
+
 
 bool KisConfig::showRulers(bool defaultValue) const
 {
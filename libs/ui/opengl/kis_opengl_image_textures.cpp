@@ -31,6 +31,7 @@
 
 #include "kis_image.h"
 #include "kis_config.h"
+#include "canvas/kis_display_color_converter.h"
 #include "KisPart.h"
 
 #ifdef HAVE_OPENEXR
@@ -68,6 +69,7 @@ KisOpenGLImageTextures::KisOpenGLImageTextures()
     if (cfg.useBlackPointCompensation()) m_conversionFlags |= KoColorConversionTransformation::BlackpointCompensation;
     if (!cfg.allowLCMSOptimization()) m_conversionFlags |= KoColorConversionTransformation::NoOptimization;
     m_useOcio = cfg.useOcio();
+    m_useLut3D = KisDisplayColorConverter::useLut3D();
 }
 
 KisOpenGLImageTextures::KisOpenGLImageTextures(KisImageWSP image,
@@ -88,6 +90,7 @@ KisOpenGLImageTextures::KisOpenGLImageTextures(KisImageWSP image,
     , m_initialized(false)
 {
     Q_ASSERT(renderingIntent < 4);
+    m_useLut3D = KisDisplayColorConverter::useLut3D();
 }
 
 void KisOpenGLImageTextures::initGL(QOpenGLFunctions *f)
@@ -304,6 +307,16 @@ KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect,
     const QRect bounds = m_image->bounds();
     const int levelOfDetail = m_image->currentLevelOfDetail();
 
+    QSharedPointer<KoColorConversionTransformation> lutTransform;
+
+    if (convertColorSpace && m_useLut3D) {
+        const KoColorSpace *projectionCs = m_image->projection()->colorSpace();
+
+        if (!(*projectionCs == *dstCS)) {
+            lutTransform = m_lut3DCache.transformation(projectionCs, dstCS, m_renderingIntent, m_conversionFlags);
+        }
+    }
+
     QRect alignedUpdateRect = updateRect;
     QRect alignedBounds = bounds;
 
@@ -343,6 +356,8 @@ KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect,
                 if (convertColorSpace) {
                     if (m_proofingConfig && m_proofingTransform && m_proofingConfig->conversionFlags.testFlag(KoColorConversionTransformation::SoftProofing)) {
                         tileInfo->proofTo(dstCS, m_proofingConfig->conversionFlags, m_proofingTransform.data());
+                    } else if (lutTransform) {
+                        tileInfo->convertTo(dstCS, lutTransform.data());
                     } else {
                         tileInfo->convertTo(dstCS, m_renderingIntent, m_conversionFlags);
                     }
@@ -444,6 +459,11 @@ void KisOpenGLImageTextures::setMonitorProfile(const KoColorProfile *monitorProf
     m_monitorProfile = monitorProfile;
     m_renderingIntent = renderingIntent;
     m_conversionFlags = conversionFlags;
+    m_useLut3D = KisDisplayColorConverter::useLut3D();
+
+    if (!m_useLut3D) {
+        m_lut3DCache.clear();
+    }
 
     createImageTextureTiles();
 }
@@ -27,6 +27,7 @@
 #include "kis_shared.h"
 
 #include "canvas/kis_update_info.h"
+#include "canvas/kis_display_lut_3d_cache.h"
 #include "opengl/kis_texture_tile.h"
 #include "KisProofingConfiguration.h"
 #include <KoColorProofingConversionTransformation.h>
@@ -198,6 +199,9 @@ private:
     int m_selectedChannelIndex;
 
     bool m_useOcio;
+
+    bool m_useLut3D;
+    KisDisplayLut3DCache m_lut3DCache;
     bool m_initialized;
 
     KisTextureTileInfoPoolSP m_infoChunksPool;
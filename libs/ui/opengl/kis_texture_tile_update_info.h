@@ -209,6 +209,26 @@ public:
         }
     }
 
+    /**
+     * Converts the patch with a ready-made \p transform, e.g. with
+     * the baked LUT of KisDisplayLut3DCache
+     */
+    void convertTo(const KoColorSpace* dstCS,
+                   const KoColorConversionTransformation *transform)
+    {
+        Q_ASSERT(*transform->srcColorSpace() == *m_patchColorSpace);
+
+        if (m_patchRect.isValid()) {
+            const qint32 numPixels = m_patchRect.width() * m_patchRect.height();
+            DataBuffer conversionCache(dstCS->pixelSize(), m_pool);
+
+            transform->transform(m_patchPixels.data(), conversionCache.data(), numPixels);
+
+            m_patchColorSpace = dstCS;
+            conversionCache.swap(m_patchPixels);
+        }
+    }
+
     void proofTo(const KoColorSpace* dstCS,
                    KoColorConversionTransformation::ConversionFlags conversionFlags,
                    KoColorConversionTransformation *proofingTransform)
@@ -27,6 +27,8 @@
 
 cmsHPROFILE KoLcmsDefaultTransformations::s_RGBProfile = 0;
 QMap< QString, QMap< LcmsColorProfileContainer *, KoLcmsDefaultTransformations * > > KoLcmsDefaultTransformations::s_transformations;
+QMutex KoLcmsDefaultTransformations::s_transformationsMutex;
+QAtomicInt KoLcmsRGBTransformationsCacheRef::s_lastOwnerId;
 
 // -- LcmsColorSpaceFactory --
 QList<KoColorConversionTransformationFactory *> LcmsColorSpaceFactory::colorConversionLinks() const
@@ -24,8 +24,13 @@
 
 #include <colorprofiles/LcmsColorProfileContainer.h>
 #include <KoColorSpaceAbstract.h>
+#include <KoLabDifferenceOp.h>
+#include <QAtomicInt>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QThreadStorage>
+#include <QVarLengthArray>
+#include <QVector>
 
 class LcmsColorProfileContainer;
 
@@ -64,11 +69,82 @@ private:
     Private *const d;
 };
 
+/**
+ * The transformations to and from sRGB, shared by all the color spaces
+ * with the same id and profile. They are created once, in
+ * LcmsColorSpace::init(), and s_transformations is guarded by
+ * s_transformationsMutex, since the color spaces may be created from
+ * several threads at once. cmsDoTransform() itself is thread-safe, so
+ * the transformations can be used without any locking.
+ */
 struct KoLcmsDefaultTransformations {
     cmsHTRANSFORM toRGB;
     cmsHTRANSFORM fromRGB;
     static cmsHPROFILE s_RGBProfile;
     static QMap< QString, QMap< LcmsColorProfileContainer *, KoLcmsDefaultTransformations * > > s_transformations;
+    static QMutex s_transformationsMutex;
+};
+
+/**
+ * The last used transformations to and from a custom RGB profile, the
+ * one passed to toQColor()/fromQColor(). Every thread keeps its own
+ * copy, so the color selectors and pickers running in different
+ * threads never wait for each other or replace each other's
+ * transformations.
+ *
+ * The copies are owned by the color space, not by the threads:
+ * QThreadStorage never deletes the data of the other threads when it
+ * is destroyed, so the transformations created in the worker threads
+ * would leak together with the color space otherwise.
+ */
+struct KoLcmsRGBTransformationsCache {
+    KoLcmsRGBTransformationsCache()
+        : toRGBProfile(0),
+          toRGB(0),
+          fromRGBProfile(0),
+          fromRGB(0)
+    {
+    }
+
+    ~KoLcmsRGBTransformationsCache()
+    {
+        if (toRGB) {
+            cmsDeleteTransform(toRGB);
+        }
+        if (fromRGB) {
+            cmsDeleteTransform(fromRGB);
+        }
+    }
+
+    cmsHPROFILE   toRGBProfile;
+    cmsHTRANSFORM toRGB;
+    cmsHPROFILE   fromRGBProfile;
+    cmsHTRANSFORM fromRGB;
+};
+
+/**
+ * A non-owning reference to the cache of the current thread, see
+ * KoLcmsRGBTransformationsCache
+ *
+ * QThreadStorage reuses the ids of the destroyed storages and never
+ * clears the data the other threads stored under them. So a color
+ * space may get the reference left by an already destroyed one, whose
+ * cache is freed. That is why the reference also keeps the id of the
+ * color space that created the cache, and the cache is used only when
+ * the ids match. The ids are never reused, unlike the addresses of the
+ * color spaces.
+ */
+struct KoLcmsRGBTransformationsCacheRef {
+    KoLcmsRGBTransformationsCacheRef() : ownerId(0), cache(0) {}
+    int ownerId;
+    KoLcmsRGBTransformationsCache *cache;
+
+    static int nextOwnerId() {
+        return s_lastOwnerId.fetchAndAddOrdered(1) + 1;
+    }
+
+private:
+    static QAtomicInt s_lastOwnerId;
 };
 
 /**
@@ -154,17 +230,32 @@ class LcmsColorSpace : public KoColorSpaceAbstract<_CSTraits>, public KoLcmsInfo
     };
 
     struct Private {
-        mutable quint8 *qcolordata; // A small buffer for conversion from and to qcolor.
         KoLcmsDefaultTransformations *defaultTransformations;
 
-        mutable cmsHPROFILE   lastRGBProfile;  // Last used profile to transform to/from RGB
-        mutable cmsHTRANSFORM lastToRGB;       // Last used transform to transform to RGB
-        mutable cmsHTRANSFORM lastFromRGB;     // Last used transform to transform from RGB
+        mutable QThreadStorage<KoLcmsRGBTransformationsCacheRef> rgbTransformations;
+        int rgbTransformationsOwnerId;
+
+        /**
+         * All the caches created by the threads, deleted together
+         * with the color space
+         */
+        mutable QMutex rgbTransformationsMutex;
+        mutable QVector<KoLcmsRGBTransformationsCache*> allRGBTransformations;
         LcmsColorProfileContainer *profile;
         KoColorProfile *colorProfile;
-        QMutex mutex;
     };
 
+    /**
+     * The number of colors converted by toQColors()/fromQColors()
+     * without allocating the intermediate buffer on the heap
+     */
+    static const int QCOLOR_BATCH_PREALLOC = 64;
+
+    /**
+     * The number of pixels differenceRow() converts into Lab at once
+     */
+    static const int DIFFERENCE_BATCH_SIZE = 256;
+
 protected:
 
     LcmsColorSpace(const QString &id,
@@ -181,29 +272,24 @@ protected:
         d->profile = asLcmsProfile(p);
         Q_ASSERT(d->profile);
         d->colorProfile = p;
-        d->qcolordata = 0;
-        d->lastRGBProfile = 0;
-        d->lastToRGB = 0;
-        d->lastFromRGB = 0;
         d->defaultTransformations = 0;
+        d->rgbTransformationsOwnerId = KoLcmsRGBTransformationsCacheRef::nextOwnerId();
     }
 
     ~LcmsColorSpace() override
     {
+        qDeleteAll(d->allRGBTransformations);
         delete d->colorProfile;
-        delete[] d->qcolordata;
         delete d->defaultTransformations;
         delete d;
     }
 
     void init()
     {
-        // Default pixel buffer for QColor conversion
-        d->qcolordata = new quint8[3];
-        Q_CHECK_PTR(d->qcolordata);
-
         Q_ASSERT(d->profile);
 
+        QMutexLocker l(&KoLcmsDefaultTransformations::s_transformationsMutex);
+
         if (KoLcmsDefaultTransformations::s_RGBProfile == 0) {
             KoLcmsDefaultTransformations::s_RGBProfile = cmsCreate_sRGBProfile();
         }
@@ -248,54 +334,51 @@ public:
 
     void fromQColor(const QColor &color, quint8 *dst, const KoColorProfile *koprofile = 0) const override
     {
-        QMutexLocker locker(&d->mutex);
-        d->qcolordata[2] = color.red();
-        d->qcolordata[1] = color.green();
-        d->qcolordata[0] = color.blue();
-
-        LcmsColorProfileContainer *profile = asLcmsProfile(koprofile);
-        if (profile == 0) {
-            // Default sRGB
-            Q_ASSERT(d->defaultTransformations && d->defaultTransformations->fromRGB);
+        fromQColors(&color, dst, 1, koprofile);
+    }
 
-            cmsDoTransform(d->defaultTransformations->fromRGB, d->qcolordata, dst, 1);
-        } else {
-            if (d->lastFromRGB == 0 || (d->lastFromRGB != 0 && d->lastRGBProfile != profile->lcmsProfile())) {
-                d->lastFromRGB = cmsCreateTransform(profile->lcmsProfile(),
-                                                    TYPE_BGR_8,
-                                                    d->profile->lcmsProfile(),
-                                                    this->colorSpaceType(),
-                                                    KoColorConversionTransformation::internalRenderingIntent(),
-                                                    KoColorConversionTransformation::internalConversionFlags());
-                d->lastRGBProfile = profile->lcmsProfile();
+    void toQColor(const quint8 *src, QColor *c, const KoColorProfile *koprofile = 0) const override
+    {
+        toQColors(src, c, 1, koprofile);
+    }
 
-            }
-            cmsDoTransform(d->lastFromRGB, d->qcolordata, dst, 1);
+    void fromQColors(const QColor *colors, quint8 *dst, qint32 nColors, const KoColorProfile *koprofile = 0) const override
+    {
+        QVarLengthArray<quint8, 3 * QCOLOR_BATCH_PREALLOC> rgbData(3 * nColors);
+        quint8 *rgb = rgbData.data();
+
+        for (qint32 i = 0; i < nColors; i++) {
+            rgb[2] = colors[i].red();
+            rgb[1] = colors[i].green();
+            rgb[0] = colors[i].blue();
+            rgb += 3;
         }
 
-        this->setOpacity(dst, (quint8)(color.alpha()), 1);
+        cmsDoTransform(fromRGBTransformation(koprofile), rgbData.data(), dst, nColors);
+
+        const qint32 pixelSize = this->pixelSize();
+
+        for (qint32 i = 0; i < nColors; i++) {
+            this->setOpacity(dst, (quint8)(colors[i].alpha()), 1);
+            dst += pixelSize;
+        }
     }
 
-    void toQColor(const quint8 *src, QColor *c, const KoColorProfile *koprofile = 0) const override
+    void toQColors(const quint8 *src, QColor *colors, qint32 nColors, const KoColorProfile *koprofile = 0) const override
     {
-        QMutexLocker locker(&d->mutex);
-        LcmsColorProfileContainer *profile = asLcmsProfile(koprofile);
-        if (profile == 0) {
-            // Default sRGB transform
-            Q_ASSERT(d->defaultTransformations && d->defaultTransformations->toRGB);
-            cmsDoTransform(d->defaultTransformations->toRGB, const_cast <quint8 *>(src), d->qcolordata, 1);
-        } else {
-            if (d->lastToRGB == 0 || (d->lastToRGB != 0 && d->lastRGBProfile != profile->lcmsProfile())) {
-                d->lastToRGB = cmsCreateTransform(d->profile->lcmsProfile(), this->colorSpaceType(),
-                                                  profile->lcmsProfile(), TYPE_BGR_8,
-                                                  KoColorConversionTransformation::internalRenderingIntent(),
-                                                  KoColorConversionTransformation::internalConversionFlags());
-                d->lastRGBProfile = profile->lcmsProfile();
-            }
-            cmsDoTransform(d->lastToRGB, const_cast <quint8 *>(src), d->qcolordata, 1);
+        QVarLengthArray<quint8, 3 * QCOLOR_BATCH_PREALLOC> rgbData(3 * nColors);
+
+        cmsDoTransform(toRGBTransformation(koprofile), const_cast <quint8 *>(src), rgbData.data(), nColors);
+
+        const quint8 *rgb = rgbData.constData();
+        const qint32 pixelSize = this->pixelSize();
+
+        for (qint32 i = 0; i < nColors; i++) {
+            colors[i].setRgb(rgb[2], rgb[1], rgb[0]);
+            colors[i].setAlpha(this->opacityU8(src));
+            rgb += 3;
+            src += pixelSize;
         }
-        c->setRgb(d->qcolordata[2], d->qcolordata[1], d->qcolordata[0]);
-        c->setAlpha(this->opacityU8(src));
     }
 
     KoColorTransformation *createBrightnessContrastAdjustment(const quint16 *transferValues) const override
@@ -382,6 +465,44 @@ public:
         }
     }
 
+    void differenceRow(const quint8 *src, const quint8 *row, qint32 nPixels, quint8 *differences) const override
+    {
+        const qint32 pixelSize = this->pixelSize();
+
+        if (this->opacityU8(src) == OPACITY_TRANSPARENT_U8) {
+            for (qint32 i = 0; i < nPixels; i++) {
+                differences[i] = this->opacityU8(row) == OPACITY_TRANSPARENT_U8 ? 0 : 255;
+                row += pixelSize;
+            }
+            return;
+        }
+
+        Q_ASSERT(this->toLabA16Converter());
+
+        quint16 srcLab[4];
+        this->toLabA16Converter()->transform(src, reinterpret_cast<quint8*>(srcLab), 1);
+
+        QVarLengthArray<quint16, 4 * DIFFERENCE_BATCH_SIZE> rowLab(4 * qMin(nPixels, qint32(DIFFERENCE_BATCH_SIZE)));
+        const KoLabDifferenceOp *op = KoLabDifferenceOp::instance();
+
+        while (nPixels > 0) {
+            const qint32 numPixels = qMin(nPixels, qint32(DIFFERENCE_BATCH_SIZE));
+
+            this->toLabA16Converter()->transform(row, reinterpret_cast<quint8*>(rowLab.data()), numPixels);
+            op->differenceRow(srcLab, rowLab.constData(), numPixels, differences);
+
+            for (qint32 i = 0; i < numPixels; i++) {
+                if (this->opacityU8(row) == OPACITY_TRANSPARENT_U8) {
+                    differences[i] = 255;
+                }
+                row += pixelSize;
+            }
+
+            differences += numPixels;
+            nPixels -= numPixels;
+        }
+    }
+
     quint8 differenceA(const quint8 *src1, const quint8 *src2) const override
     {
         quint8 lab1[8];
@@ -430,6 +551,77 @@ private:
         return d->profile;
     }
 
+    inline KoLcmsRGBTransformationsCache *rgbTransformationsCache() const
+    {
+        KoLcmsRGBTransformationsCacheRef &ref = d->rgbTransformations.localData();
+
+        /**
+         * A reference with a different owner id was left by a destroyed
+         * color space, its cache must not be touched
+         */
+        if (!ref.cache || ref.ownerId != d->rgbTransformationsOwnerId) {
+            ref.cache = new KoLcmsRGBTransformationsCache();
+            ref.ownerId = d->rgbTransformationsOwnerId;
+
+            QMutexLocker l(&d->rgbTransformationsMutex);
+            d->allRGBTransformations.append(ref.cache);
+        }
+
+        return ref.cache;
+    }
+
+    cmsHTRANSFORM fromRGBTransformation(const KoColorProfile *koprofile) const
+    {
+        LcmsColorProfileContainer *profile = asLcmsProfile(koprofile);
+        if (profile == 0) {
+            // Default sRGB
+            Q_ASSERT(d->defaultTransformations && d->defaultTransformations->fromRGB);
+            return d->defaultTransformations->fromRGB;
+        }
+
+        KoLcmsRGBTransformationsCache *cache = rgbTransformationsCache();
+
+        if (cache->fromRGB == 0 || cache->fromRGBProfile != profile->lcmsProfile()) {
+            if (cache->fromRGB) {
+                cmsDeleteTransform(cache->fromRGB);
+            }
+            cache->fromRGB = cmsCreateTransform(profile->lcmsProfile(),
+                                                TYPE_BGR_8,
+                                                d->profile->lcmsProfile(),
+                                                this->colorSpaceType(),
+                                                KoColorConversionTransformation::internalRenderingIntent(),
+                                                KoColorConversionTransformation::internalConversionFlags());
+            cache->fromRGBProfile = profile->lcmsProfile();
+        }
+
+        return cache->fromRGB;
+    }
+
+    cmsHTRANSFORM toRGBTransformation(const KoColorProfile *koprofile) const
+    {
+        LcmsColorProfileContainer *profile = asLcmsProfile(koprofile);
+        if (profile == 0) {
+            // Default sRGB transform
+            Q_ASSERT(d->defaultTransformations && d->defaultTransformations->toRGB);
+            return d->defaultTransformations->toRGB;
+        }
+
+        KoLcmsRGBTransformationsCache *cache = rgbTransformationsCache();
+
+        if (cache->toRGB == 0 || cache->toRGBProfile != profile->lcmsProfile()) {
+            if (cache->toRGB) {
+                cmsDeleteTransform(cache->toRGB);
+            }
+            cache->toRGB = cmsCreateTransform(d->profile->lcmsProfile(), this->colorSpaceType(),
+                                              profile->lcmsProfile(), TYPE_BGR_8,
+                                              KoColorConversionTransformation::internalRenderingIntent(),
+                                              KoColorConversionTransformation::internalConversionFlags());
+            cache->toRGBProfile = profile->lcmsProfile();
+        }
+
+        return cache->toRGB;
+    }
+
     inline static LcmsColorProfileContainer *asLcmsProfile(const KoColorProfile *p)
     {
         if (!p) {
@@ -5,8 +5,13 @@
 #include <LcmsColorProfileContainer.h>
 
 #include <KoColor.h>
+#include <KoColorModelStandardIds.h>
+#include <KoLut3DColorConversionTransformation.h>
+#include <KoColorConversionTransformation.h>
 
 #include <QTest>
+#include <QVector>
+#include <QColor>
 
 #include <lcms2.h>
 #include <cmath>
@@ -211,4 +216,205 @@ void TestKoLcmsColorProfile::testProofingConversion()
     Q_ASSERT((dst[0] == alarm[0]) && (dst[1] == alarm[1]) && (dst[2] == alarm[2]));
 
 }
+
+void TestKoLcmsColorProfile::testQColorBatchConversion_data()
+{
+    QTest::addColumn<QString>("qcolorProfileName");
+
+    QTest::newRow("default") << QString();
+    QTest::newRow("custom") << QString("scRGB (linear)");
+}
+
+void TestKoLcmsColorProfile::testQColorBatchConversion()
+{
+    QFETCH(QString, qcolorProfileName);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb16("sRGB built-in");
+    QVERIFY(cs);
+
+    const KoColorProfile *qcolorProfile = 0;
+    cmsHPROFILE rgbProfile = 0;
+
+    if (!qcolorProfileName.isEmpty()) {
+        qcolorProfile = KoColorSpaceRegistry::instance()->rgb16(qcolorProfileName)->profile();
+        QVERIFY(qcolorProfile);
+
+        QByteArray rawData = qcolorProfile->rawData();
+        rgbProfile = cmsOpenProfileFromMem((void *)rawData.constData(), rawData.size());
+    } else {
+        rgbProfile = cmsCreate_sRGBProfile();
+    }
+
+    QByteArray rawData = cs->profile()->rawData();
+    cmsHPROFILE csProfile = cmsOpenProfileFromMem((void *)rawData.constData(), rawData.size());
+
+    /**
+     * The reference transformations are created directly with LCMS,
+     * with the same parameters LcmsColorSpace uses for them
+     */
+    cmsHTRANSFORM fromRGB = cmsCreateTransform(rgbProfile, TYPE_BGR_8,
+                                               csProfile, TYPE_BGRA_16,
+                                               KoColorConversionTransformation::internalRenderingIntent(),
+                                               KoColorConversionTransformation::internalConversionFlags());
+
+    cmsHTRANSFORM toRGB = cmsCreateTransform(csProfile, TYPE_BGRA_16,
+                                             rgbProfile, TYPE_BGR_8,
+                                             KoColorConversionTransformation::internalRenderingIntent(),
+                                             KoColorConversionTransformation::internalConversionFlags());
+
+    const int numColors = 100;
+    const int pixelSize = cs->pixelSize();
+
+    QVector<QColor> colors;
+    for (int i = 0; i < numColors; i++) {
+        colors << QColor((i * 7) % 256, (i * 13) % 256, (i * 29) % 256, (i * 37) % 256);
+    }
+
+    QVector<quint8> batchPixels(numColors * pixelSize);
+    cs->fromQColors(colors.constData(), batchPixels.data(), numColors, qcolorProfile);
+
+    QVector<QColor> batchColors(numColors);
+    cs->toQColors(batchPixels.constData(), batchColors.data(), numColors, qcolorProfile);
+
+    for (int i = 0; i < numColors; i++) {
+        const quint8 bgr[3] = {
+            quint8(colors[i].blue()), quint8(colors[i].green()), quint8(colors[i].red())
+        };
+
+        quint16 expectedPixel[4] = {0, 0, 0, 0};
+        cmsDoTransform(fromRGB, bgr, expectedPixel, 1);
+
+        const quint16 *pixel = reinterpret_cast<const quint16*>(batchPixels.constData() + i * pixelSize);
+        QCOMPARE(pixel[0], expectedPixel[0]);
+        QCOMPARE(pixel[1], expectedPixel[1]);
+        QCOMPARE(pixel[2], expectedPixel[2]);
+        QCOMPARE(cs->opacityU8(batchPixels.constData() + i * pixelSize), quint8(colors[i].alpha()));
+
+        quint8 expectedBgr[3] = {0, 0, 0};
+        cmsDoTransform(toRGB, pixel, expectedBgr, 1);
+
+        QCOMPARE(batchColors[i].blue(), int(expectedBgr[0]));
+        QCOMPARE(batchColors[i].green(), int(expectedBgr[1]));
+        QCOMPARE(batchColors[i].red(), int(expectedBgr[2]));
+        QCOMPARE(batchColors[i].alpha(), colors[i].alpha());
+    }
+
+    cmsDeleteTransform(fromRGB);
+    cmsDeleteTransform(toRGB);
+    cmsCloseProfile(csProfile);
+    cmsCloseProfile(rgbProfile);
+}
+
+void TestKoLcmsColorProfile::testDifferenceRow_data()
+{
+    QTest::addColumn<QString>("colorDepthId");
+    QTest::addColumn<int>("srcAlpha");
+
+    QTest::newRow("u8") << QString("U8") << 255;
+    QTest::newRow("u16") << QString("U16") << 255;
+    QTest::newRow("f32") << QString("F32") << 255;
+    QTest::newRow("u8-transparent") << QString("U8") << 0;
+}
+
+void TestKoLcmsColorProfile::testDifferenceRow()
+{
+    QFETCH(QString, colorDepthId);
+    QFETCH(int, srcAlpha);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->colorSpace("RGBA", colorDepthId, 0);
+    QVERIFY(cs);
+
+    // not a multiple of any vector size to test the tails as well
+    const int numColors = 301;
+    const int pixelSize = cs->pixelSize();
+
+    QVector<QColor> colors;
+    for (int i = 0; i < numColors; i++) {
+        colors << QColor((i * 7) % 256, (i * 13) % 256, (i * 29) % 256, i % 5 ? 255 : 0);
+    }
+
+    QVector<quint8> pixels(numColors * pixelSize);
+    cs->fromQColors(colors.constData(), pixels.data(), numColors);
+
+    KoColor src(QColor(100, 150, 200, srcAlpha), cs);
+
+    QVector<quint8> differences(numColors);
+    cs->differenceRow(src.data(), pixels.constData(), numColors, differences.data());
+
+    QVector<quint8> intensities(numColors);
+    cs->intensityRow(pixels.constData(), numColors, intensities.data());
+
+    for (int i = 0; i < numColors; i++) {
+        const quint8 *pixel = pixels.constData() + i * pixelSize;
+
+        // the vectorized version uses single precision, so the
+        // truncation may differ right at the integer boundaries
+        QVERIFY(qAbs(differences[i] - cs->difference(src.data(), pixel)) <= 1);
+        QCOMPARE(intensities[i], cs->intensity8(pixel));
+    }
+}
+
+void TestKoLcmsColorProfile::testLut3DConversion_data()
+{
+    QTest::addColumn<QString>("srcDepthId");
+    QTest::addColumn<QString>("dstDepthId");
+    QTest::addColumn<QString>("dstProfileName");
+
+    QTest::newRow("u8-u8-same") << QString("U8") << QString("U8") << QString("sRGB built-in");
+    QTest::newRow("u8-u8") << QString("U8") << QString("U8") << QString("scRGB (linear)");
+    QTest::newRow("u8-u16") << QString("U8") << QString("U16") << QString("scRGB (linear)");
+    QTest::newRow("u16-u8") << QString("U16") << QString("U8") << QString("scRGB (linear)");
+    QTest::newRow("u16-u16") << QString("U16") << QString("U16") << QString("scRGB (linear)");
+}
+
+void TestKoLcmsColorProfile::testLut3DConversion()
+{
+    QFETCH(QString, srcDepthId);
+    QFETCH(QString, dstDepthId);
+    QFETCH(QString, dstProfileName);
+
+    const KoColorSpace *srcCs = KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), srcDepthId, "sRGB built-in");
+    const KoColorSpace *dstCs = KoColorSpaceRegistry::instance()->colorSpace(RGBAColorModelID.id(), dstDepthId, dstProfileName);
+    QVERIFY(srcCs);
+    QVERIFY(dstCs);
+    QVERIFY(KoLut3DColorConversionTransformation::isSupported(srcCs, dstCs));
+
+    const KoColorConversionTransformation::Intent intent = KoColorConversionTransformation::IntentPerceptual;
+    const KoColorConversionTransformation::ConversionFlags flags = KoColorConversionTransformation::HighQuality;
+
+    KoLut3DColorConversionTransformation lutTransform(srcCs, dstCs, intent, flags);
+
+    // not a multiple of any vector size to test the tails as well
+    const int numPixels = 1001;
+
+    QVector<quint8> src(numPixels * srcCs->pixelSize());
+    qsrand(1);
+    for (int i = 0; i < src.size(); i++) {
+        src[i] = qrand() % 256;
+    }
+
+    QVector<quint8> lutResult(numPixels * dstCs->pixelSize());
+    lutTransform.transform(src.constData(), lutResult.data(), numPixels);
+
+    QVector<quint8> lcmsResult(numPixels * dstCs->pixelSize());
+    srcCs->convertPixelsTo(src.constData(), lcmsResult.data(), dstCs, numPixels, intent, flags);
+
+    QVector<float> lutChannels(4);
+    QVector<float> lcmsChannels(4);
+
+    const float tolerance = 2.0f / 255.0f;
+
+    for (int i = 0; i < numPixels; i++) {
+        dstCs->normalisedChannelsValue(lutResult.constData() + i * dstCs->pixelSize(), lutChannels);
+        dstCs->normalisedChannelsValue(lcmsResult.constData() + i * dstCs->pixelSize(), lcmsChannels);
+
+        for (int channel = 0; channel < 4; channel++) {
+            if (qAbs(lutChannels[channel] - lcmsChannels[channel]) > tolerance) {
+                qDebug() << "pixel" << i << "channel" << channel << lutChannels << lcmsChannels;
+                QFAIL("the LUT result differs too much from the LCMS one");
+            }
+        }
+    }
+}
+
 QTEST_MAIN(TestKoLcmsColorProfile)
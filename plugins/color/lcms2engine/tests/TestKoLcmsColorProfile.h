@@ -12,6 +12,12 @@ class TestKoLcmsColorProfile : public QObject
 private Q_SLOTS:
     void testConversion();
     void testProofingConversion();
+    void testQColorBatchConversion_data();
+    void testQColorBatchConversion();
+    void testDifferenceRow_data();
+    void testDifferenceRow();
+    void testLut3DConversion_data();
+    void testLut3DConversion();
 
 };
 
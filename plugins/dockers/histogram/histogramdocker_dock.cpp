@@ -27,11 +27,13 @@
 #include "kis_image.h"
 #include "kis_paint_device.h"
 #include "kis_idle_watcher.h"
+#include "kis_signal_compressor.h"
 #include "histogramdockerwidget.h"
 
 HistogramDockerDock::HistogramDockerDock()
     : QDockWidget(i18n("Histogram")),
       m_imageIdleWatcher(new KisIdleWatcher(250, this)),
+      m_updateCompressor(new KisSignalCompressor(500, KisSignalCompressor::FIRST_INACTIVE, this)),
       m_canvas(0)
 {
     QWidget *page = new QWidget(this);
@@ -44,6 +46,12 @@ HistogramDockerDock::HistogramDockerDock()
     m_layout->addWidget(m_histogramWidget, 1);
     setWidget(page);
     connect(m_imageIdleWatcher, &KisIdleWatcher::startedIdleMode, this, &HistogramDockerDock::updateHistogram);
+
+    /**
+     * Only the updated tiles are recounted, so the histogram is cheap
+     * enough to be refreshed while the user is still painting
+     */
+    connect(m_updateCompressor, SIGNAL(timeout()), this, SLOT(updateHistogram()));
 }
 
 
@@ -65,7 +73,7 @@ void HistogramDockerDock::setCanvas(KoCanvasBase * canvas)
 
         m_imageIdleWatcher->setTrackedImage(m_canvas->image());
 
-        connect(m_canvas->image(), SIGNAL(sigImageUpdated(QRect)), this, SLOT(startUpdateCanvasProjection()), Qt::UniqueConnection);
+        connect(m_canvas->image(), SIGNAL(sigImageUpdated(QRect)), this, SLOT(slotImageUpdated(QRect)), Qt::UniqueConnection);
         connect(m_canvas->image(), SIGNAL(sigColorSpaceChanged(const KoColorSpace*)), this, SLOT(sigColorSpaceChanged(const KoColorSpace*)), Qt::UniqueConnection);
         m_imageIdleWatcher->startCountdown();
     }
@@ -86,6 +94,16 @@ void HistogramDockerDock::startUpdateCanvasProjection()
     }
 }
 
+void HistogramDockerDock::slotImageUpdated(const QRect &rect)
+{
+    m_histogramWidget->invalidateRect(rect);
+
+    if (isVisible()) {
+        m_updateCompressor->start();
+        m_imageIdleWatcher->startCountdown();
+    }
+}
+
 void HistogramDockerDock::showEvent(QShowEvent *event)
 {
     Q_UNUSED(event);
@@ -95,6 +113,9 @@ void HistogramDockerDock::showEvent(QShowEvent *event)
 
 void HistogramDockerDock::sigColorSpaceChanged(const KoColorSpace */*cs*/)
 {
+    // the number of channels might have changed, so start from scratch
+    m_histogramWidget->setPaintDevice(m_canvas);
+
     if (isVisible()) {
         m_imageIdleWatcher->startCountdown();
     }
@@ -29,6 +29,7 @@
 class QVBoxLayout;
 class KisHistogramView;
 class KisIdleWatcher;
+class KisSignalCompressor;
 class KoHistogramProducer;
 class HistogramDockerWidget;
 
@@ -43,6 +44,7 @@ public:
 
 public Q_SLOTS:
     void startUpdateCanvasProjection();
+    void slotImageUpdated(const QRect &rect);
     void sigColorSpaceChanged(const KoColorSpace* cs);
     void updateHistogram();
 
@@ -52,6 +54,7 @@ protected:
 private:
     QVBoxLayout *m_layout;
     KisIdleWatcher *m_imageIdleWatcher;
+    KisSignalCompressor *m_updateCompressor;
     HistogramDockerWidget *m_histogramWidget;
     QPointer<KisCanvas2> m_canvas;
 };
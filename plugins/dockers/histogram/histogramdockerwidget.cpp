@@ -28,7 +28,8 @@
 #include "KoChannelInfo.h"
 #include "kis_paint_device.h"
 #include "KoColorSpace.h"
-#include "kis_iterator_ng.h"
+#include "kis_default_bounds_base.h"
+#include "kis_tiled_histogram.h"
 #include "kis_canvas2.h"
 
 HistogramDockerWidget::HistogramDockerWidget(QWidget *parent, const char *name, Qt::WindowFlags f)
@@ -47,21 +48,32 @@ void HistogramDockerWidget::setPaintDevice(KisCanvas2* canvas)
     if (canvas) {
         m_paintDevice = canvas->image()->projection();
         m_bounds = canvas->image()->bounds();
+        m_histogram.reset(new KisTiledHistogram(m_paintDevice, m_bounds));
     } else {
         m_paintDevice.clear();
+        m_histogram.clear();
         m_bounds = QRect();
         m_histogramData.clear();
     }
 }
 
+void HistogramDockerWidget::invalidateRect(const QRect &rect)
+{
+    if (m_histogram) {
+        m_histogram->invalidate(rect);
+    }
+}
+
 void HistogramDockerWidget::updateHistogram()
 {
     if (!m_paintDevice.isNull()) {
-        KisPaintDeviceSP m_devClone = new KisPaintDevice(m_paintDevice->colorSpace());
-
-        m_devClone->makeCloneFrom(m_paintDevice, m_bounds);
-
-        HistogramComputationThread *workerThread = new HistogramComputationThread(m_devClone, m_bounds);
+        /**
+         * The histogram is recalculated right from the projection,
+         * only for the tiles that were updated since the last run.
+         * If some tile is modified while the thread is reading it,
+         * the update of the image will invalidate it once again.
+         */
+        HistogramComputationThread *workerThread = new HistogramComputationThread(m_histogram, m_paintDevice->defaultBounds()->bounds());
         connect(workerThread, &HistogramComputationThread::resultReady, this, &HistogramDockerWidget::receiveNewHistogram);
         connect(workerThread, &HistogramComputationThread::finished, workerThread, &QObject::deleteLater);
         workerThread->start();
@@ -79,7 +91,9 @@ void HistogramDockerWidget::receiveNewHistogram(HistVector *histogramData)
 
 void HistogramDockerWidget::paintEvent(QPaintEvent *event)
 {
-    if (!m_histogramData.empty()) {
+    if (!m_histogramData.empty() && m_paintDevice &&
+        m_histogramData.size() == m_paintDevice->channelCount()) {
+
         int nBins = m_histogramData.at(0).size();
         const KoColorSpace* cs = m_paintDevice->colorSpace();
 
@@ -156,40 +170,19 @@ void HistogramDockerWidget::paintEvent(QPaintEvent *event)
 
 void HistogramComputationThread::run()
 {
-    const KoColorSpace *cs = m_dev->colorSpace();
-    quint32 channelCount = m_dev->channelCount();
-    quint32 pixelSize = m_dev->pixelSize();
-
-    quint32 imageSize = m_bounds.width() * m_bounds.height();
-    quint32 nSkip = 1 + (imageSize >> 20); //for speed use about 1M pixels for computing histograms
-
-    //allocate space for the histogram data
-    bins.resize((int)channelCount);
-    for (auto &bin : bins) {
-        bin.resize(std::numeric_limits<quint8>::max() + 1);
+    /**
+     * Only the painted area is counted, just like before the
+     * histogram became incremental. When the exact bounds change,
+     * only the cells on their border are recounted.
+     */
+    const QRect bounds = m_histogram->device()->exactBounds() & m_bounds;
+
+    if (m_histogram->bounds() != bounds) {
+        m_histogram->setBounds(bounds);
     }
 
-    QRect bounds = m_dev->exactBounds();
-    if (bounds.isEmpty())
-        return;
-
-    KisSequentialConstIterator it(m_dev, m_dev->exactBounds());
-    int i;
-    quint32 toSkip = nSkip;
-
-    do {
-        i = it.nConseqPixels();
-        const quint8* pixel = it.rawDataConst();
-        for (int k = 0; k < i; ++k) {
-            if (--toSkip == 0) {
-                for (int chan = 0; chan < (int)channelCount; ++chan) {
-                    bins[chan][cs->scaleToU8(pixel, chan)]++;
-                }
-                toSkip = nSkip;
-            }
-            pixel += pixelSize;
-        }
-    } while (it.nextPixels(i));
+    m_histogram->recalculate();
+    bins = m_histogram->bins();
 
     emit resultReady(&bins);
 }
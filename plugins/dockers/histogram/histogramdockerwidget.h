@@ -23,10 +23,12 @@
 #include <QWidget>
 #include <QLabel>
 #include <QThread>
+#include <QSharedPointer>
 #include "kis_types.h"
 #include <vector>
 
 class KisCanvas2;
+class KisTiledHistogram;
 
 typedef std::vector<std::vector<quint32> > HistVector; //Don't use QVector here - it's too slow for this purpose
 
@@ -35,7 +37,7 @@ class HistogramComputationThread : public QThread
 {
     Q_OBJECT
 public:
-    HistogramComputationThread(KisPaintDeviceSP _dev, const QRect& _bounds) : m_dev(_dev), m_bounds(_bounds)
+    HistogramComputationThread(QSharedPointer<KisTiledHistogram> _histogram, const QRect& _bounds) : m_histogram(_histogram), m_bounds(_bounds)
     {}
 
     void run() override;
@@ -44,7 +46,7 @@ Q_SIGNALS:
     void resultReady(HistVector*);
 
 private:
-    KisPaintDeviceSP m_dev;
+    QSharedPointer<KisTiledHistogram> m_histogram;
     QRect m_bounds;
     HistVector bins;
 };
@@ -63,9 +65,11 @@ public:
 public Q_SLOTS:
     void updateHistogram();
     void receiveNewHistogram(HistVector*);
+    void invalidateRect(const QRect &rect);
 
 private:
     KisPaintDeviceSP m_paintDevice;
+    QSharedPointer<KisTiledHistogram> m_histogram;
     HistVector m_histogramData;
     QRect m_bounds;
     bool m_smoothHistogram;
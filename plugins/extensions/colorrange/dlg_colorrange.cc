@@ -20,6 +20,7 @@
 
 #include "dlg_colorrange.h"
 #include <QApplication>
+#include <QVector>
 #include <QPushButton>
 #include <QCheckBox>
 #include <QSlider>
@@ -273,41 +274,53 @@ void DlgColorRange::slotSelectClicked()
 
     KisHLineConstIteratorSP hiter = m_view->activeDevice()->createHLineConstIteratorNG(x, y, w);
     KisHLineIteratorSP selIter = selection->pixelSelection()->createHLineIteratorNG(x, y, w);
-    QColor c;
+    QVector<QColor> colors;
     for (int row = y; row < h - y; ++row) {
+        qint32 numContiguousPixels = 0;
+
         do {
-            cs->toQColor(hiter->oldRawData(), &c);
-            // Don't try to select transparent pixels.
-            if (c.alpha() > OPACITY_TRANSPARENT_U8) {
-                quint8 match = matchColors(c, m_currentAction);
-
-                if (match) {
-                    if (!m_invert) {
-                        if (m_mode == SELECTION_ADD) {
-                            *(selIter->rawData()) =  match;
-                        } else if (m_mode == SELECTION_SUBTRACT) {
-                            quint8 selectedness = *(selIter->rawData());
-                            if (match < selectedness) {
-                                *(selIter->rawData()) = selectedness - match;
-                            } else {
-                                *(selIter->rawData()) = 0;
+            numContiguousPixels = qMin(hiter->nConseqPixels(), selIter->nConseqPixels());
+
+            colors.resize(numContiguousPixels);
+            cs->toQColors(hiter->oldRawData(), colors.data(), numContiguousPixels);
+
+            quint8 *selPixel = selIter->rawData();
+
+            for (int i = 0; i < numContiguousPixels; i++, selPixel++) {
+                const QColor &c = colors[i];
+
+                // Don't try to select transparent pixels.
+                if (c.alpha() > OPACITY_TRANSPARENT_U8) {
+                    quint8 match = matchColors(c, m_currentAction);
+
+                    if (match) {
+                        if (!m_invert) {
+                            if (m_mode == SELECTION_ADD) {
+                                *selPixel =  match;
+                            } else if (m_mode == SELECTION_SUBTRACT) {
+                                quint8 selectedness = *selPixel;
+                                if (match < selectedness) {
+                                    *selPixel = selectedness - match;
+                                } else {
+                                    *selPixel = 0;
+                                }
                             }
-                        }
-                    } else {
-                        if (m_mode == SELECTION_ADD) {
-                            quint8 selectedness = *(selIter->rawData());
-                            if (match < selectedness) {
-                                *(selIter->rawData()) = selectedness - match;
-                            } else {
-                                *(selIter->rawData()) = 0;
+                        } else {
+                            if (m_mode == SELECTION_ADD) {
+                                quint8 selectedness = *selPixel;
+                                if (match < selectedness) {
+                                    *selPixel = selectedness - match;
+                                } else {
+                                    *selPixel = 0;
+                                }
+                            } else if (m_mode == SELECTION_SUBTRACT) {
+                                *selPixel =  match;
                             }
-                        } else if (m_mode == SELECTION_SUBTRACT) {
-                            *(selIter->rawData()) =  match;
                         }
                     }
                 }
             }
-        } while (hiter->nextPixel() && selIter->nextPixel());
+        } while (hiter->nextPixels(numContiguousPixels) && selIter->nextPixels(numContiguousPixels));
         hiter->nextRow();
         selIter->nextRow();
     }
@@ -41,6 +41,7 @@
 #include <KoColorSpaceTraits.h>
 #include <KoColorModelStandardIds.h>
 #include <KoColor.h>
+#include <KoHalfFloatConverter.h>
 
 #include <KisDocument.h>
 #include <kis_group_layer.h>
@@ -147,6 +148,12 @@ struct EXRConverter::Private {
     template <class WrapperType>
     void unmultiplyAlpha(typename WrapperType::pixel_type *pixel);
 
+    template <class WrapperType>
+    void unmultiplyAlphaRow(typename WrapperType::pixel_type *pixels, int width);
+
+    template <class WrapperType>
+    void unmultiplyHalfAlphaRow(typename WrapperType::pixel_type *pixels, int width);
+
     template<typename _T_>
     void decodeData4(Imf::InputFile& file, ExrPaintLayerInfo& info, KisPaintLayerSP layer, int width, int xstart, int ystart, int height, Imf::PixelType ptype);
 
@@ -350,6 +357,68 @@ void EXRConverter::Private::unmultiplyAlpha(typename WrapperType::pixel_type *pi
     }
 }
 
+template <class WrapperType>
+void EXRConverter::Private::unmultiplyAlphaRow(typename WrapperType::pixel_type *pixels, int width)
+{
+    for (int i = 0; i < width; i++) {
+        unmultiplyAlpha<WrapperType>(pixels + i);
+    }
+}
+
+template <>
+void EXRConverter::Private::unmultiplyAlphaRow<RgbPixelWrapper<half> >(Rgba<half> *pixels, int width)
+{
+    unmultiplyHalfAlphaRow<RgbPixelWrapper<half> >(pixels, width);
+}
+
+template <>
+void EXRConverter::Private::unmultiplyAlphaRow<GrayPixelWrapper<half> >(KoGrayTraits<half>::Pixel *pixels, int width)
+{
+    unmultiplyHalfAlphaRow<GrayPixelWrapper<half> >(pixels, width);
+}
+
+/**
+ * Unmultiplying the half pixels one by one converts every channel
+ * value between half and float a few times. Instead, the whole row is
+ * converted to float in bulk and only the pixels with tiny alpha,
+ * which may need the alpha to be modified, go through the generic
+ * unmultiplyAlpha(). For the rest of the pixels the result is
+ * exactly the same, because half arithmetic is done in float anyway.
+ */
+template <class WrapperType>
+void EXRConverter::Private::unmultiplyHalfAlphaRow(typename WrapperType::pixel_type *pixels, int width)
+{
+    typedef typename WrapperType::pixel_type pixel_type;
+
+    // the alpha channel is the last one in both the gray and RGB pixels
+    const int numChannels = sizeof(pixel_type) / sizeof(half);
+    const int alphaPos = numChannels - 1;
+
+    const float noiseThreshold = alphaNoiseThreshold<half>();
+
+    const KoHalfFloatConverter *converter = KoHalfFloatConverter::instance();
+
+    QVector<float> values(width * numChannels);
+    converter->halfToFloat(reinterpret_cast<const quint16*>(pixels), values.data(), values.size());
+
+    float *value = values.data();
+
+    for (int i = 0; i < width; i++, value += numChannels) {
+        const qreal alpha = value[alphaPos];
+
+        if (alpha >= noiseThreshold) {
+            for (int c = 0; c < alphaPos; c++) {
+                value[c] = value[c] / alpha;
+            }
+        } else {
+            unmultiplyAlpha<WrapperType>(pixels + i);
+            converter->halfToFloat(reinterpret_cast<const quint16*>(pixels + i), value, numChannels);
+        }
+    }
+
+    converter->floatToHalf(values.constData(), reinterpret_cast<quint16*>(pixels), values.size());
+}
+
 template <typename T, typename Pixel, int size, int alphaPos>
 void multiplyAlpha(Pixel *pixel)
 {
@@ -401,14 +470,14 @@ void EXRConverter::Private::decodeData4(Imf::InputFile& file, ExrPaintLayerInfo&
 
         file.setFrameBuffer(frameBuffer);
         file.readPixels(ystart + y);
+
+        if (hasAlpha) {
+            unmultiplyAlphaRow<RgbPixelWrapper<_T_> >(pixels.data(), width);
+        }
+
         Rgba *rgba = pixels.data();
         KisHLineIteratorSP it = layer->paintDevice()->createHLineIteratorNG(0, y, width);
         do {
-
-            if (hasAlpha) {
-                unmultiplyAlpha<RgbPixelWrapper<_T_> >(rgba);
-            }
-
             typename KoRgbTraits<_T_>::Pixel* dst = reinterpret_cast<typename KoRgbTraits<_T_>::Pixel*>(it->rawData());
 
             dst->red = rgba->r;
@@ -463,14 +532,13 @@ void EXRConverter::Private::decodeData1(Imf::InputFile& file, ExrPaintLayerInfo&
         file.setFrameBuffer(frameBuffer);
         file.readPixels(ystart + y);
 
+        if (hasAlpha) {
+            unmultiplyAlphaRow<GrayPixelWrapper<_T_> >(pixels.data(), width);
+        }
+
         pixel_type *srcPtr = pixels.data();
         KisHLineIteratorSP it = layer->paintDevice()->createHLineIteratorNG(0, y, width);
         do {
-
-            if (hasAlpha) {
-                unmultiplyAlpha<GrayPixelWrapper<_T_> >(srcPtr);
-            }
-
             pixel_type* dstPtr = reinterpret_cast<pixel_type*>(it->rawData());
 
             dstPtr->gray = srcPtr->gray;
@@ -25,6 +25,7 @@
 #include <KoColorSpaceRegistry.h>
 #include <KoColor.h>
 #include <KoColorProfile.h>
+#include <KoCompositeOp.h>
 #include <KoCompositeOpRegistry.h>
 
 #include <kis_brush.h>
@@ -84,6 +85,9 @@ KisColorSmudgeOp::KisColorSmudgeOp(const KisPaintOpSettingsSP settings, KisPaint
     // Smudge Painter works in default COMPOSITE_OVER mode
     m_colorRatePainter->setCompositeOp(painter->compositeOp()->id());
 
+    m_smudgeDab = new KisFixedPaintDevice(m_tempDev->colorSpace());
+    m_smudgeSource = new KisFixedPaintDevice(m_tempDev->colorSpace());
+
     m_rotationOption.applyFanCornersInfo(this);
 }
 
@@ -120,6 +124,179 @@ inline void KisColorSmudgeOp::getTopLeftAligned(const QPointF &pos, const QPoint
     splitCoordinate(topLeft.y(), y, &yFraction);
 }
 
+KoColor KisColorSmudgeOp::pickSmudgeColor(const KisPaintInformation& info, const QRect &srcDabRect, const QPointF &hotSpot)
+{
+    QPoint pt = (srcDabRect.topLeft() + hotSpot).toPoint();
+
+    if (m_smudgeRadiusOption.isChecked()) {
+        qreal effectiveSize = 0.5 * (m_dstDabRect.width() + m_dstDabRect.height());
+        m_smudgeRadiusOption.apply(*m_smudgePainter, info, effectiveSize, pt.x(), pt.y(), painter()->device());
+
+        return m_smudgePainter->paintColor();
+    }
+
+    KoColor color = painter()->paintColor();
+
+    // get the pixel on the canvas that lies beneath the hot spot
+    // of the dab and fill  the temporary paint device with that color
+
+    KisCrossDeviceColorPickerInt colorPicker(painter()->device(), color);
+    colorPicker.pickColor(pt.x(), pt.y(), color.data());
+
+    return color;
+}
+
+bool KisColorSmudgeOp::canUseFusedSmudgeKernel() const
+{
+    /**
+     * The fused kernel reads the raw bytes of the source devices right
+     * into the dab buffer, so they must be stored in the color space
+     * of the dab. It is true for all the usual paint layers, the rest
+     * goes through the painters, which do the conversion.
+     */
+    const KoColorSpace *cs = m_tempDev->colorSpace();
+
+    if (*painter()->device()->colorSpace() != *cs) return false;
+
+    if (m_image && m_overlayModeOption.isChecked() &&
+        *m_image->projection()->colorSpace() != *cs) {
+
+        return false;
+    }
+
+    return true;
+}
+
+void KisColorSmudgeOp::renderFusedSmudgeDab(const KisPaintInformation& info, const QRect &srcDabRect, const QPointF &hotSpot, qreal fpOpacity)
+{
+    const KoColorSpace *cs = m_tempDev->colorSpace();
+    const QRect dabBounds(QPoint(), m_dstDabRect.size());
+    const qint32 rowStride = dabBounds.width() * cs->pixelSize();
+
+    const bool useOverlay = m_image && m_overlayModeOption.isChecked();
+    const bool smearingMode = m_smudgeRateOption.getMode() == KisSmudgeOption::SMEARING_MODE;
+
+    m_smudgeDab->setRect(dabBounds);
+    m_smudgeDab->lazyGrowBufferWithoutInitialization();
+
+    KoColor colorRateColor;
+    const KoCompositeOp *colorRateOp = 0;
+    quint8 colorRateOpacity = OPACITY_TRANSPARENT_U8;
+
+    if (m_colorRateOption.isChecked()) {
+        // the same rate and color as the ones of the painters path
+        qreal maxColorRate = qMax<qreal>(1.0 - m_smudgeRateOption.getRate(), 0.2);
+        m_colorRateOption.apply(*m_colorRatePainter, info, 0.0, maxColorRate, fpOpacity);
+
+        colorRateColor = painter()->paintColor();
+        m_gradientOption.apply(colorRateColor, m_gradient, info);
+        colorRateColor.convertTo(cs);
+
+        colorRateOp = m_colorRatePainter->compositeOp();
+        colorRateOpacity = m_colorRatePainter->opacity();
+    }
+
+    if (!smearingMode && !useOverlay) {
+        /**
+         * Without the background the whole dab has the same color, so
+         * mix it only once and just fill the buffer with the result
+         */
+        KoColor color = pickSmudgeColor(info, srcDabRect, hotSpot);
+        color.convertTo(cs);
+
+        if (colorRateOp) {
+            colorRateOp->composite(color.data(), 0,
+                                   colorRateColor.data(), 0,
+                                   0, 0,
+                                   1, 1,
+                                   colorRateOpacity);
+        }
+
+        m_smudgeDab->fill(0, 0, dabBounds.width(), dabBounds.height(), color.data());
+        return;
+    }
+
+    quint8 *dabData = m_smudgeDab->data();
+
+    if (useOverlay) {
+        m_image->blockUpdates();
+        m_image->projection()->readBytes(dabData, srcDabRect);
+        m_image->unblockUpdates();
+
+        const KoCompositeOp *overOp = cs->compositeOp(COMPOSITE_OVER);
+
+        if (smearingMode) {
+            m_smudgeSource->setRect(dabBounds);
+            m_smudgeSource->lazyGrowBufferWithoutInitialization();
+            painter()->device()->readBytes(m_smudgeSource->data(), srcDabRect);
+
+            overOp->composite(dabData, rowStride,
+                              m_smudgeSource->data(), rowStride,
+                              0, 0,
+                              dabBounds.height(), dabBounds.width(),
+                              OPACITY_OPAQUE_U8);
+        } else {
+            KoColor color = pickSmudgeColor(info, srcDabRect, hotSpot);
+            color.convertTo(cs);
+
+            overOp->composite(dabData, rowStride,
+                              color.data(), 0,
+                              0, 0,
+                              dabBounds.height(), dabBounds.width(),
+                              OPACITY_OPAQUE_U8);
+        }
+    } else {
+        // smearing over a transparent background is a plain copy
+        painter()->device()->readBytes(dabData, srcDabRect);
+    }
+
+    if (colorRateOp) {
+        colorRateOp->composite(dabData, rowStride,
+                               colorRateColor.data(), 0,
+                               0, 0,
+                               dabBounds.height(), dabBounds.width(),
+                               colorRateOpacity);
+    }
+}
+
+void KisColorSmudgeOp::renderLegacySmudgeDab(const KisPaintInformation& info, const QRect &srcDabRect, const QPointF &hotSpot, qreal fpOpacity)
+{
+    if (m_image && m_overlayModeOption.isChecked()) {
+        m_image->blockUpdates();
+        m_backgroundPainter->bitBlt(QPoint(), m_image->projection(), srcDabRect);
+        m_image->unblockUpdates();
+    }
+    else {
+        // IMPORTANT: clear the temporary painting device to color black with zero opacity:
+        //            it will only clear the extents of the brush.
+        m_tempDev->clear(QRect(QPoint(), m_dstDabRect.size()));
+    }
+
+    if (m_smudgeRateOption.getMode() == KisSmudgeOption::SMEARING_MODE) {
+        m_smudgePainter->bitBlt(QPoint(), painter()->device(), srcDabRect);
+    } else {
+        KoColor color = pickSmudgeColor(info, srcDabRect, hotSpot);
+        m_smudgePainter->fill(0, 0, m_dstDabRect.width(), m_dstDabRect.height(), color);
+    }
+
+    // if the user selected the color smudge option,
+    // we will mix some color into the temporary painting device (m_tempDev)
+    if (m_colorRateOption.isChecked()) {
+        // this will apply the opacity (selected by the user) to copyPainter
+        // (but fit the rate inbetween the range 0.0 to (1.0-SmudgeRate))
+        qreal maxColorRate = qMax<qreal>(1.0 - m_smudgeRateOption.getRate(), 0.2);
+        m_colorRateOption.apply(*m_colorRatePainter, info, 0.0, maxColorRate, fpOpacity);
+
+        // paint a rectangle with the current color (foreground color)
+        // or a gradient color (if enabled)
+        // into the temporary painting device and use the user selected
+        // composite mode
+        KoColor color = painter()->paintColor();
+        m_gradientOption.apply(color, m_gradient, info);
+        m_colorRatePainter->fill(0, 0, m_dstDabRect.width(), m_dstDabRect.height(), color);
+    }
+}
+
 KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
 {
     KisBrushSP brush = m_brush;
@@ -204,57 +381,12 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
     QString oldCompositeOpId = painter()->compositeOp()->id();
     qreal   fpOpacity  = (qreal(oldOpacity) / 255.0) * m_opacityOption.getOpacityf(info);
 
-    if (m_image && m_overlayModeOption.isChecked()) {
-        m_image->blockUpdates();
-        m_backgroundPainter->bitBlt(QPoint(), m_image->projection(), srcDabRect);
-        m_image->unblockUpdates();
-    }
-    else {
-        // IMPORTANT: clear the temporary painting device to color black with zero opacity:
-        //            it will only clear the extents of the brush.
-        m_tempDev->clear(QRect(QPoint(), m_dstDabRect.size()));
-    }
+    const bool useFusedKernel = canUseFusedSmudgeKernel();
 
-    if (m_smudgeRateOption.getMode() == KisSmudgeOption::SMEARING_MODE) {
-        m_smudgePainter->bitBlt(QPoint(), painter()->device(), srcDabRect);
+    if (useFusedKernel) {
+        renderFusedSmudgeDab(info, srcDabRect, hotSpot, fpOpacity);
     } else {
-        QPoint pt = (srcDabRect.topLeft() + hotSpot).toPoint();
-
-        if (m_smudgeRadiusOption.isChecked()) {
-            qreal effectiveSize = 0.5 * (m_dstDabRect.width() + m_dstDabRect.height());
-            m_smudgeRadiusOption.apply(*m_smudgePainter, info, effectiveSize, pt.x(), pt.y(), painter()->device());
-
-            KoColor color2 = m_smudgePainter->paintColor();
-            m_smudgePainter->fill(0, 0, m_dstDabRect.width(), m_dstDabRect.height(), color2);
-
-        } else {
-            KoColor color = painter()->paintColor();
-
-            // get the pixel on the canvas that lies beneath the hot spot
-            // of the dab and fill  the temporary paint device with that color
-
-            KisCrossDeviceColorPickerInt colorPicker(painter()->device(), color);
-            colorPicker.pickColor(pt.x(), pt.y(), color.data());
-
-            m_smudgePainter->fill(0, 0, m_dstDabRect.width(), m_dstDabRect.height(), color);
-        }
-    }
-
-    // if the user selected the color smudge option,
-    // we will mix some color into the temporary painting device (m_tempDev)
-    if (m_colorRateOption.isChecked()) {
-        // this will apply the opacity (selected by the user) to copyPainter
-        // (but fit the rate inbetween the range 0.0 to (1.0-SmudgeRate))
-        qreal maxColorRate = qMax<qreal>(1.0 - m_smudgeRateOption.getRate(), 0.2);
-        m_colorRateOption.apply(*m_colorRatePainter, info, 0.0, maxColorRate, fpOpacity);
-
-        // paint a rectangle with the current color (foreground color)
-        // or a gradient color (if enabled)
-        // into the temporary painting device and use the user selected
-        // composite mode
-        KoColor color = painter()->paintColor();
-        m_gradientOption.apply(color, m_gradient, info);
-        m_colorRatePainter->fill(0, 0, m_dstDabRect.width(), m_dstDabRect.height(), color);
+        renderLegacySmudgeDab(info, srcDabRect, hotSpot, fpOpacity);
     }
 
     // if color is disabled (only smudge) and "overlay mode" is enabled
@@ -277,8 +409,20 @@ KisSpacingInformation KisColorSmudgeOp::paintAt(const KisPaintInformation& info)
     // the alpha mask (maskDab) will be used here to only blit the pixels that are in the area (shape) of the brush
 
     painter()->setCompositeOp(COMPOSITE_COPY);
-    painter()->bitBltWithFixedSelection(m_dstDabRect.x(), m_dstDabRect.y(), m_tempDev, m_maskDab, m_dstDabRect.width(), m_dstDabRect.height());
-    painter()->renderMirrorMaskSafe(m_dstDabRect, m_tempDev, 0, 0, m_maskDab, !m_dabCache->needSeparateOriginal());
+
+    if (useFusedKernel) {
+        painter()->bltFixedWithFixedSelection(m_dstDabRect.x(), m_dstDabRect.y(), m_smudgeDab, m_maskDab, m_dstDabRect.width(), m_dstDabRect.height());
+
+        if (painter()->hasMirroring()) {
+            // renderMirrorMask() mirrors the mask in place, so don't spoil the cached one
+            KisFixedPaintDeviceSP mask = m_dabCache->needSeparateOriginal() ?
+                m_maskDab : new KisFixedPaintDevice(*m_maskDab);
+            painter()->renderMirrorMask(m_dstDabRect, m_smudgeDab, mask);
+        }
+    } else {
+        painter()->bitBltWithFixedSelection(m_dstDabRect.x(), m_dstDabRect.y(), m_tempDev, m_maskDab, m_dstDabRect.width(), m_dstDabRect.height());
+        painter()->renderMirrorMaskSafe(m_dstDabRect, m_tempDev, 0, 0, m_maskDab, !m_dabCache->needSeparateOriginal());
+    }
 
     // restore orginal opacy and composite mode values
     painter()->setOpacity(oldOpacity);
@@ -37,6 +37,7 @@
 
 class QPointF;
 class KoAbstractGradient;
+class KoColor;
 class KisBrushBasedPaintOpSettings;
 class KisPainter;
 
@@ -57,6 +58,20 @@ private:
 
     inline void getTopLeftAligned(const QPointF &pos, const QPointF &hotSpot, qint32 *x, qint32 *y);
 
+    // Returns the color the dab is filled with in the dulling mode
+    KoColor pickSmudgeColor(const KisPaintInformation& info, const QRect &srcDabRect, const QPointF &hotSpot);
+
+    bool canUseFusedSmudgeKernel() const;
+
+    /**
+     * Renders the smudged dab into m_smudgeDab in a single pass over the
+     * scratch buffers, instead of going through m_tempDev with three
+     * separate painters
+     */
+    void renderFusedSmudgeDab(const KisPaintInformation& info, const QRect &srcDabRect, const QPointF &hotSpot, qreal fpOpacity);
+
+    void renderLegacySmudgeDab(const KisPaintInformation& info, const QRect &srcDabRect, const QPointF &hotSpot, qreal fpOpacity);
+
 private:
     bool                      m_firstRun;
     KisImageWSP               m_image;
@@ -77,6 +92,8 @@ private:
     KisPressureGradientOption m_gradientOption;
     QRect                     m_dstDabRect;
     KisFixedPaintDeviceSP     m_maskDab;
+    KisFixedPaintDeviceSP     m_smudgeDab;
+    KisFixedPaintDeviceSP     m_smudgeSource;
     QPointF                   m_lastPaintPos;
 };
 
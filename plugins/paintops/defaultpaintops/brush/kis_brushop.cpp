@@ -40,6 +40,7 @@
 #include <kis_color_source.h>
 #include <kis_pressure_sharpness_option.h>
 #include <kis_fixed_paint_device.h>
+#include <kis_dab_rendering_queue.h>
 #include <kis_lod_transform.h>
 #include <kis_paintop_plugin_utils.h>
 
@@ -48,6 +49,7 @@ KisBrushOp::KisBrushOp(const KisPaintOpSettingsSP settings, KisPainter *painter,
     : KisBrushBasedPaintOp(settings, painter)
     , m_opacityOption(node)
     , m_hsvTransformation(0)
+    , m_queueDabs(false)
 {
     Q_UNUSED(image);
     Q_ASSERT(settings);
@@ -96,6 +98,8 @@ KisBrushOp::KisBrushOp(const KisPaintOpSettingsSP settings, KisPainter *painter,
 
     m_dabCache->setSharpnessPostprocessing(&m_sharpnessOption);
     m_rotationOption.applyFanCornersInfo(this);
+
+    m_dabRenderingQueue.reset(new KisDabRenderingQueue(m_dabCache, m_brush));
 }
 
 KisBrushOp::~KisBrushOp()
@@ -133,10 +137,25 @@ KisSpacingInformation KisBrushOp::paintAt(const KisPaintInformation& info)
                               brush->maskWidth(shape, 0, 0, info),
                               brush->maskHeight(shape, 0, 0, info));
 
+    const bool queueDab =
+        m_queueDabs && m_dabCache->canRenderDabsConcurrently(m_colorSource);
+
+    if (!queueDab) {
+        // the queued dabs should be painted first
+        m_dabRenderingQueue->flush(painter());
+    }
+
     quint8 origOpacity = painter()->opacity();
+    quint8 dabOpacity = OPACITY_OPAQUE_U8;
+    quint8 dabFlow = OPACITY_OPAQUE_U8;
 
     m_opacityOption.setFlow(m_flowOption.apply(info));
-    m_opacityOption.apply(painter(), info);
+
+    if (queueDab) {
+        m_opacityOption.apply(info, &dabOpacity, &dabFlow);
+    } else {
+        m_opacityOption.apply(painter(), info);
+    }
     m_colorSource->selectColor(m_mixOption.apply(info), info);
     m_darkenOption.apply(m_colorSource, info);
 
@@ -147,6 +166,21 @@ KisSpacingInformation KisBrushOp::paintAt(const KisPaintInformation& info)
         m_colorSource->applyColorTransformation(m_hsvTransformation);
     }
 
+    if (queueDab) {
+        KisDabCache::DabRequest request;
+        m_dabCache->prepareDab(device->compositionSourceColorSpace(),
+                               m_colorSource,
+                               cursorPos,
+                               shape,
+                               info,
+                               m_softnessOption.apply(info),
+                               &request);
+
+        m_dabRenderingQueue->addDab(request, dabOpacity, dabFlow);
+
+        return effectiveSpacing(scale, rotation, &m_airbrushOption, &m_spacingOption, info);
+    }
+
     QRect dabRect;
     KisFixedPaintDeviceSP dab = m_dabCache->fetchDab(device->compositionSourceColorSpace(),
                                 m_colorSource,
@@ -204,6 +238,10 @@ void KisBrushOp::paintLine(const KisPaintInformation& pi1, const KisPaintInforma
     painter()->renderMirrorMask(rc, m_lineCacheDevice);
     }
     else {
+        m_queueDabs = true;
         KisPaintOp::paintLine(pi1, pi2, currentDistance);
+        m_queueDabs = false;
+
+        m_dabRenderingQueue->flush(painter());
     }
 }
@@ -23,6 +23,8 @@
 #ifndef KIS_BRUSHOP_H_
 #define KIS_BRUSHOP_H_
 
+#include <QScopedPointer>
+
 #include "kis_brush_based_paintop.h"
 #include <kis_airbrush_option.h>
 #include <kis_pressure_darken_option.h>
@@ -43,6 +45,7 @@
 
 class KisPainter;
 class KisColorSource;
+class KisDabRenderingQueue;
 
 
 class KisBrushOp : public KisBrushBasedPaintOp
@@ -82,6 +85,13 @@ private:
     KoColorTransformation *m_hsvTransformation;
     KisPaintDeviceSP m_lineCacheDevice;
     KisPaintDeviceSP m_colorSourceDevice;
+
+    /**
+     * While a line is being painted, the dabs are only prepared in
+     * paintAt() and rendered all together in the end of paintLine()
+     */
+    QScopedPointer<KisDabRenderingQueue> m_dabRenderingQueue;
+    bool m_queueDabs;
 };
 
 #endif // KIS_BRUSHOP_H_
@@ -19,6 +19,7 @@
 #include "kis_dab_cache.h"
 
 #include <KoColor.h>
+#include <KoColorProfile.h>
 #include "kis_color_source.h"
 #include "kis_paint_device.h"
 #include "kis_brush.h"
@@ -28,6 +29,14 @@
 #include <kis_precision_option.h>
 #include <kis_fixed_paint_device.h>
 #include <brushengine/kis_paintop.h>
+#include <kis_assert.h>
+#include <kis_auto_brush.h>
+#include <kis_global.h>
+
+#include <QCryptographicHash>
+#include <QDomDocument>
+#include <QtMath>
+#include <cmath>
 
 #include <kundo2command.h>
 
@@ -36,17 +45,57 @@ struct PrecisionValues {
     qreal sizeFrac;
     qreal subPixel;
     qreal softnessFactor;
+
+    /**
+     * The quantization steps of the dabs stored in KisDabMaskCache.
+     * The scale is quantized in the relative (logarithmic) steps,
+     * the ratio in the absolute ones.
+     */
+    qreal maskScaleStep;
+    qreal maskRatioStep;
 };
 
 const qreal eps = 1e-6;
 static const PrecisionValues precisionLevels[] = {
-    {M_PI / 180, 0.05,   1, 0.01},
-    {M_PI / 180, 0.01,   1, 0.01},
-    {M_PI / 180,    0,   1, 0.01},
-    {M_PI / 180,    0, 0.5, 0.01},
-    {eps,         0, eps,  eps}
+    {M_PI / 180, 0.05,   1, 0.01,  0.02, 0.01},
+    {M_PI / 180, 0.01,   1, 0.01,  0.01, 0.01},
+    {M_PI / 180,    0,   1, 0.01, 0.002, 0.01},
+    {M_PI / 180,    0, 0.5, 0.01, 0.002, 0.01},
+    {eps,         0, eps,  eps,     0,    0}
 };
 
+/**
+ * Returns the key identifying \p brush with all its settings in
+ * KisDabMaskCache, or an empty array if the masks of the brush cannot
+ * be cached at all
+ */
+QByteArray brushMaskCacheKey(KisBrushSP brush)
+{
+    if (brush->brushType() != MASK && brush->brushType() != PIPE_MASK) {
+        return QByteArray();
+    }
+
+    /**
+     * The noise of a randomized auto brush should never be frozen
+     * in the cache
+     */
+    const KisAutoBrush *autoBrush = dynamic_cast<const KisAutoBrush*>(brush.data());
+    if (autoBrush && (autoBrush->randomness() > 0.0 || autoBrush->density() < 1.0)) {
+        return QByteArray();
+    }
+
+    QDomDocument doc;
+    QDomElement element = doc.createElement("brush");
+    brush->toXML(doc, element);
+    doc.appendChild(element);
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(doc.toByteArray());
+    hash.addData(brush->md5());
+
+    return hash.result();
+}
+
 struct KisDabCache::SavedDabParameters {
     KoColor color;
     qreal angle;
@@ -83,7 +132,9 @@ struct KisDabCache::Private {
           textureOption(0),
           precisionOption(0),
           subPixelPrecisionDisabled(false),
-          cachedDabParameters(new SavedDabParameters)
+          cachedDabParameters(new SavedDabParameters),
+          preparedColorSpace(0),
+          maskCacheBrushKey(brushMaskCacheKey(brush))
     {}
     KisFixedPaintDeviceSP dab;
     KisFixedPaintDeviceSP dabOriginal;
@@ -98,6 +149,18 @@ struct KisDabCache::Private {
     bool subPixelPrecisionDisabled;
 
     SavedDabParameters *cachedDabParameters;
+
+    /**
+     * The color space of the last dab prepared by prepareDab(), which
+     * may still be not rendered when the next one is being prepared
+     */
+    const KoColorSpace *preparedColorSpace;
+
+    /**
+     * Empty if the masks of the brush should not be shared via
+     * KisDabMaskCache
+     */
+    QByteArray maskCacheBrushKey;
 };
 
 
@@ -326,6 +389,8 @@ KisFixedPaintDeviceSP KisDabCache::fetchDabCommon(const KoColorSpace *cs,
 {
     Q_ASSERT(dstDabRect);
 
+    m_d->preparedColorSpace = 0;
+
     MirrorProperties mirrorProperties;
     if (m_d->mirrorOption) {
         mirrorProperties = m_d->mirrorOption->apply(info);
@@ -366,10 +431,27 @@ KisFixedPaintDeviceSP KisDabCache::fetchDabCommon(const KoColorSpace *cs,
     }
     else if (cachingIsPossible) {
         *m_d->cachedDabParameters = newParams;
-        m_d->brush->mask(m_d->dab, paintColor, shape,
-                         info,
-                         position.subPixel.x(), position.subPixel.y(),
-                         softnessFactor);
+
+        QPointF subPixel = position.subPixel;
+        KisDabMaskCache::Key maskCacheKey;
+        const bool useMaskCache =
+            quantizeMaskParameters(cs, paintColor, info,
+                                   &shape, &subPixel, &softnessFactor,
+                                   &maskCacheKey);
+
+        const bool cacheHit =
+            generateMask(m_d->dab, m_d->brush, paintColor, shape,
+                         info, subPixel, softnessFactor,
+                         useMaskCache ? &maskCacheKey : 0);
+
+        if (cacheHit) {
+            m_d->brush->notifyCachedDabPainted(info);
+        }
+
+        if (useMaskCache) {
+            *dstDabRect = correctDabRectWhenFetchedFromCache(*dstDabRect, m_d->dab->bounds().size());
+            position.rect = *dstDabRect;
+        }
     }
     else {
         if (!m_d->colorSourceDevice || *cs != *m_d->colorSourceDevice->colorSpace()) {
@@ -407,6 +489,104 @@ KisFixedPaintDeviceSP KisDabCache::fetchDabCommon(const KoColorSpace *cs,
     return m_d->dab;
 }
 
+inline bool KisDabCache::quantizeMaskParameters(const KoColorSpace *cs,
+                                                const KoColor &color,
+                                                const KisPaintInformation& info,
+                                                KisDabShape *shape,
+                                                QPointF *subPixel,
+                                                qreal *softnessFactor,
+                                                KisDabMaskCache::Key *key)
+{
+    if (m_d->maskCacheBrushKey.isEmpty() || shape->scale() <= 0.0) {
+        return false;
+    }
+
+    int precisionLevel = m_d->precisionOption ? m_d->precisionOption->precisionLevel() - 1 : 3;
+    const PrecisionValues &prec = precisionLevels[precisionLevel];
+
+    /**
+     * The highest precision level renders every dab exactly, the
+     * masks would (almost) never be hit there
+     */
+    if (prec.subPixel < eps * 2) {
+        return false;
+    }
+
+    const qreal scaleStep = std::log1p(prec.maskScaleStep);
+    const qint32 scaleIndex = qRound(std::log(shape->scale()) / scaleStep);
+
+    const qint32 ratioIndex = qMax(1, qRound(shape->ratio() / prec.maskRatioStep));
+
+    const qint32 numAngleSteps = qRound(2 * M_PI / prec.angle);
+    const qint32 rotationIndex =
+        qRound(normalizeAngle(shape->rotation()) / prec.angle) % numAngleSteps;
+
+    const qint32 softnessIndex = qRound(*softnessFactor / prec.softnessFactor);
+
+    /**
+     * The offset must stay inside the pixel, otherwise the size of
+     * the mask would change
+     */
+    const qint32 maxSubPixelIndex = qCeil(1.0 / prec.subPixel) - 1;
+    const qint32 subPixelXIndex = qBound(0, qRound(subPixel->x() / prec.subPixel), maxSubPixelIndex);
+    const qint32 subPixelYIndex = qBound(0, qRound(subPixel->y() / prec.subPixel), maxSubPixelIndex);
+
+    *shape = KisDabShape(std::exp(scaleIndex * scaleStep),
+                         ratioIndex * prec.maskRatioStep,
+                         rotationIndex * prec.angle);
+    *subPixel = QPointF(subPixelXIndex * prec.subPixel,
+                        subPixelYIndex * prec.subPixel);
+    *softnessFactor = softnessIndex * prec.softnessFactor;
+
+    key->brushKey = m_d->maskCacheBrushKey;
+    key->colorSpaceId = cs->id() + (cs->profile() ? cs->profile()->name() : QString());
+    key->color = QByteArray(reinterpret_cast<const char*>(color.data()),
+                            color.colorSpace()->pixelSize()) +
+        color.colorSpace()->id().toLatin1();
+    key->brushIndex = m_d->brush->brushIndex(info);
+    key->precisionLevel = precisionLevel;
+    key->scale = scaleIndex;
+    key->ratio = ratioIndex;
+    key->rotation = rotationIndex;
+    key->softness = softnessIndex;
+    key->subPixelX = subPixelXIndex;
+    key->subPixelY = subPixelYIndex;
+
+    return true;
+}
+
+bool KisDabCache::generateMask(KisFixedPaintDeviceSP dab,
+                               KisBrushSP brush,
+                               const KoColor &color,
+                               KisDabShape const& shape,
+                               const KisPaintInformation& info,
+                               const QPointF &subPixel,
+                               qreal softnessFactor,
+                               const KisDabMaskCache::Key *maskCacheKey)
+{
+    if (maskCacheKey) {
+        KisFixedPaintDeviceSP cachedMask =
+            KisDabMaskCache::instance()->fetch(*maskCacheKey);
+
+        if (cachedMask) {
+            *dab = *cachedMask;
+            return true;
+        }
+    }
+
+    brush->mask(dab, color, shape,
+                info,
+                subPixel.x(), subPixel.y(),
+                softnessFactor);
+
+    if (maskCacheKey) {
+        KisDabMaskCache::instance()->insert(*maskCacheKey,
+                                            new KisFixedPaintDevice(*dab));
+    }
+
+    return false;
+}
+
 void KisDabCache::postProcessDab(KisFixedPaintDeviceSP dab,
                                  const QPoint &dabTopLeft,
                                  const KisPaintInformation& info)
@@ -419,3 +599,141 @@ void KisDabCache::postProcessDab(KisFixedPaintDeviceSP dab,
         m_d->textureOption->apply(dab, dabTopLeft, info);
     }
 }
+
+bool KisDabCache::canRenderDabsConcurrently(const KisColorSource *colorSource) const
+{
+    return (!colorSource || colorSource->isUniformColor()) &&
+           m_d->brush->brushType() == MASK &&
+           !(m_d->textureOption && m_d->textureOption->m_enabled);
+}
+
+void KisDabCache::prepareDab(const KoColorSpace *cs,
+                             const KisColorSource *colorSource,
+                             const QPointF &cursorPoint,
+                             KisDabShape const& shape,
+                             const KisPaintInformation& info,
+                             qreal softnessFactor,
+                             DabRequest *request)
+{
+    KIS_ASSERT_RECOVER_RETURN(canRenderDabsConcurrently(colorSource));
+
+    MirrorProperties mirrorProperties;
+    if (m_d->mirrorOption) {
+        mirrorProperties = m_d->mirrorOption->apply(info);
+    }
+
+    DabPosition position = calculateDabRect(cursorPoint,
+                                            shape,
+                                            info,
+                                            mirrorProperties);
+
+    request->cs = cs;
+    request->color = colorSource ? colorSource->uniformColor() : KoColor();
+    request->shape = KisDabShape(shape.scale(), shape.ratio(), position.realAngle);
+    request->subPixel = position.subPixel;
+    request->softnessFactor = softnessFactor;
+    request->horizontalMirror = mirrorProperties.horizontalMirror;
+    request->verticalMirror = mirrorProperties.verticalMirror;
+    request->rect = position.rect;
+
+    SavedDabParameters newParams = getDabParameters(request->color,
+                                   request->shape, info,
+                                   position.subPixel.x(),
+                                   position.subPixel.y(),
+                                   softnessFactor,
+                                   mirrorProperties);
+
+    const KoColorSpace *cachedColorSpace =
+        m_d->preparedColorSpace ? m_d->preparedColorSpace :
+        m_d->dab ? m_d->dab->colorSpace() : 0;
+
+    int precisionLevel = m_d->precisionOption ? m_d->precisionOption->precisionLevel() - 1 : 3;
+
+    request->reusePrevious =
+        cachedColorSpace && *cachedColorSpace == *cs &&
+        newParams.compare(*m_d->cachedDabParameters, precisionLevel);
+
+    if (request->reusePrevious) {
+        m_d->brush->notifyCachedDabPainted(info);
+    } else {
+        *m_d->cachedDabParameters = newParams;
+        m_d->preparedColorSpace = cs;
+
+        request->useMaskCache =
+            quantizeMaskParameters(cs, request->color, info,
+                                   &request->shape,
+                                   &request->subPixel,
+                                   &request->softnessFactor,
+                                   &request->maskCacheKey);
+    }
+}
+
+KisFixedPaintDeviceSP KisDabCache::renderDab(const DabRequest &request,
+                                             KisBrushSP brush)
+{
+    KisFixedPaintDeviceSP dab = new KisFixedPaintDevice(request.cs);
+
+    /**
+     * The mask brushes do not use the paint information, and the
+     * original one may not be accessed from outside the paintop
+     * thread anyway
+     */
+    generateMask(dab, brush, request.color, request.shape,
+                 KisPaintInformation(),
+                 request.subPixel, request.softnessFactor,
+                 request.useMaskCache ? &request.maskCacheKey : 0);
+
+    if (request.horizontalMirror || request.verticalMirror) {
+        dab->mirror(request.horizontalMirror, request.verticalMirror);
+    }
+
+    return dab;
+}
+
+KisFixedPaintDeviceSP KisDabCache::finishDab(const DabRequest &request,
+                                             KisFixedPaintDeviceSP renderedDab,
+                                             QRect *dstDabRect)
+{
+    Q_ASSERT(dstDabRect);
+
+    *dstDabRect = request.rect;
+
+    if (request.reusePrevious) {
+        KIS_ASSERT_RECOVER(m_d->dab) {
+            m_d->dab = renderDab(request, m_d->brush);
+        }
+
+        if (needSeparateOriginal()) {
+            *m_d->dab = *m_d->dabOriginal;
+            *dstDabRect = correctDabRectWhenFetchedFromCache(*dstDabRect, m_d->dab->bounds().size());
+            postProcessDab(m_d->dab, dstDabRect->topLeft(), KisPaintInformation());
+        }
+        else {
+            *dstDabRect = correctDabRectWhenFetchedFromCache(*dstDabRect, m_d->dab->bounds().size());
+        }
+
+        return m_d->dab;
+    }
+
+    KIS_ASSERT_RECOVER(renderedDab) {
+        renderedDab = renderDab(request, m_d->brush);
+    }
+
+    m_d->dab = renderedDab;
+
+    if (request.useMaskCache) {
+        *dstDabRect = correctDabRectWhenFetchedFromCache(*dstDabRect, m_d->dab->bounds().size());
+    }
+
+    if (needSeparateOriginal()) {
+        if (!m_d->dabOriginal || *request.cs != *m_d->dabOriginal->colorSpace()) {
+            m_d->dabOriginal = new KisFixedPaintDevice(request.cs);
+        }
+
+        *m_d->dabOriginal = *m_d->dab;
+    }
+
+    postProcessDab(m_d->dab, dstDabRect->topLeft(), KisPaintInformation());
+
+    return m_d->dab;
+}
@@ -21,6 +21,9 @@
 
 #include "kritapaintop_export.h"
 #include "kis_brush.h"
+#include "kis_dab_mask_cache.h"
+
+#include <KoColor.h>
 
 class KisColorSource;
 class KisPressureSharpnessOption;
@@ -48,9 +51,64 @@ struct MirrorProperties;
  *  level.
  *
  *  The texturing and mirroring problems are solved.
+ *
+ *  When the previous dab cannot be reused, the masks of the mask brushes
+ *  are looked up in the shared KisDabMaskCache. The parameters of such
+ *  dabs are quantized with the steps allowed by the precision level, so
+ *  that the pressure-dependent strokes can reuse the masks rendered for
+ *  the nearby sizes and angles, even the ones from the previous strokes.
+ *  The highest precision level does not use the shared cache.
  */
 class PAINTOP_EXPORT KisDabCache
 {
+public:
+    /**
+     * Everything needed to generate a single dab outside the paintop
+     * thread. The request is filled by prepareDab(), rendered by
+     * renderDab() and passed back to the cache with finishDab().
+     *
+     * \see KisDabRenderingQueue
+     */
+    struct DabRequest {
+        DabRequest()
+            : cs(0),
+              softnessFactor(1.0),
+              horizontalMirror(false),
+              verticalMirror(false),
+              reusePrevious(false),
+              useMaskCache(false)
+        {
+        }
+
+        const KoColorSpace *cs;
+        KoColor color;
+        KisDabShape shape;
+        QPointF subPixel;
+        qreal softnessFactor;
+        bool horizontalMirror;
+        bool verticalMirror;
+
+        /**
+         * The rect of the dab before the correction for the size of
+         * the cached dab, see finishDab()
+         */
+        QRect rect;
+
+        /**
+         * The dab is equal to the previous one (up to the precision
+         * level), so it should not be rendered at all
+         */
+        bool reusePrevious;
+
+        /**
+         * The shape, the subpixel offset and the softness of the
+         * request are quantized, and the mask can be shared via
+         * KisDabMaskCache under maskCacheKey
+         */
+        bool useMaskCache;
+        KisDabMaskCache::Key maskCacheKey;
+    };
+
 public:
     KisDabCache(KisBrushSP brush);
     ~KisDabCache();
@@ -86,6 +144,50 @@ public:
                                    qreal softnessFactor,
                                    QRect *dstDabRect);
 
+    /**
+     * Returns true if the dabs painted with \p colorSource can be
+     * generated by prepareDab()/renderDab()/finishDab() instead of
+     * fetchDab(). That is possible only for plain mask brushes painted
+     * with a uniform color and without texturing, since the latter
+     * depends on the paint information of the dab.
+     */
+    bool canRenderDabsConcurrently(const KisColorSource *colorSource) const;
+
+    /**
+     * Calculates the position and the parameters of the dab and checks
+     * whether the previous dab can be reused for it. The cached
+     * parameters are updated immediately, so the requests must be
+     * prepared and finished in the same order, and all the prepared
+     * requests must be finished before the next call to fetchDab().
+     *
+     * Must be called from the paintop thread only.
+     */
+    void prepareDab(const KoColorSpace *cs,
+                    const KisColorSource *colorSource,
+                    const QPointF &cursorPoint,
+                    KisDabShape const&,
+                    const KisPaintInformation& info,
+                    qreal softnessFactor,
+                    DabRequest *request);
+
+    /**
+     * Generates the mask of the dab described by \p request. The
+     * function touches neither the cache nor the paintop, so it can
+     * be called from any thread, as long as every thread uses its own
+     * copy of the brush (see KisBrush::clone()).
+     */
+    static KisFixedPaintDeviceSP renderDab(const DabRequest &request,
+                                           KisBrushSP brush);
+
+    /**
+     * Postprocesses the dab rendered by renderDab() (or the previous
+     * dab, if request.reusePrevious is set) and makes it the current
+     * cached dab. Must be called from the paintop thread only, in the
+     * same order the requests were prepared.
+     */
+    KisFixedPaintDeviceSP finishDab(const DabRequest &request,
+                                    KisFixedPaintDeviceSP renderedDab,
+                                    QRect *dstDabRect);
 
 private:
     struct SavedDabParameters;
@@ -107,6 +209,23 @@ private:
     QRect correctDabRectWhenFetchedFromCache(const QRect &dabRect,
             const QSize &realDabSize);
 
+    inline bool quantizeMaskParameters(const KoColorSpace *cs,
+                                       const KoColor &color,
+                                       const KisPaintInformation& info,
+                                       KisDabShape *shape,
+                                       QPointF *subPixel,
+                                       qreal *softnessFactor,
+                                       KisDabMaskCache::Key *key);
+
+    static bool generateMask(KisFixedPaintDeviceSP dab,
+                             KisBrushSP brush,
+                             const KoColor &color,
+                             KisDabShape const& shape,
+                             const KisPaintInformation& info,
+                             const QPointF &subPixel,
+                             qreal softnessFactor,
+                             const KisDabMaskCache::Key *maskCacheKey);
+
     inline KisFixedPaintDeviceSP tryFetchFromCache(const SavedDabParameters &params,
             const KisPaintInformation& info,
             QRect *dstDabRect);
@@ -0,0 +1,194 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_dab_mask_cache.h"
+
+#include <QCache>
+#include <QGlobalStatic>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <KoColorSpace.h>
+#include "kis_fixed_paint_device.h"
+
+
+/**
+ * The masks of the big brushes take megabytes, so the memory is
+ * accounted in kibibytes to fit the int cost of QCache
+ */
+static const qint64 costUnit = 1024;
+static const qint64 defaultMemoryLimit = 64 * 1024 * 1024;
+
+Q_GLOBAL_STATIC_WITH_ARGS(KisDabMaskCache, s_instance, (defaultMemoryLimit))
+
+
+KisDabMaskCache::Key::Key()
+    : brushIndex(0),
+      precisionLevel(0),
+      scale(0),
+      ratio(0),
+      rotation(0),
+      softness(0),
+      subPixelX(0),
+      subPixelY(0)
+{
+}
+
+bool KisDabMaskCache::Key::operator==(const Key &rhs) const
+{
+    return scale == rhs.scale &&
+        rotation == rhs.rotation &&
+        ratio == rhs.ratio &&
+        softness == rhs.softness &&
+        subPixelX == rhs.subPixelX &&
+        subPixelY == rhs.subPixelY &&
+        brushIndex == rhs.brushIndex &&
+        precisionLevel == rhs.precisionLevel &&
+        color == rhs.color &&
+        colorSpaceId == rhs.colorSpaceId &&
+        brushKey == rhs.brushKey;
+}
+
+uint qHash(const KisDabMaskCache::Key &key, uint seed)
+{
+    uint hash = qHash(key.brushKey, seed);
+    hash ^= qHash(key.colorSpaceId) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= qHash(key.color) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+    const qint32 values[] = {
+        qint32(key.brushIndex), key.precisionLevel,
+        key.scale, key.ratio, key.rotation,
+        key.softness, key.subPixelX, key.subPixelY
+    };
+
+    for (qint32 value : values) {
+        hash ^= qHash(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+
+    return hash;
+}
+
+
+struct KisDabMaskCache::Private
+{
+    struct Entry {
+        Entry(KisFixedPaintDeviceSP _mask) : mask(_mask) {}
+        KisFixedPaintDeviceSP mask;
+    };
+
+    Private(qint64 _memoryLimit)
+        : masks(int(_memoryLimit / costUnit)),
+          memoryLimit(_memoryLimit),
+          numHits(0),
+          numMisses(0)
+    {
+    }
+
+    mutable QMutex mutex;
+    QCache<Key, Entry> masks;
+    qint64 memoryLimit;
+
+    qint64 numHits;
+    qint64 numMisses;
+};
+
+
+KisDabMaskCache::KisDabMaskCache(qint64 memoryLimit)
+    : m_d(new Private(memoryLimit))
+{
+}
+
+KisDabMaskCache::~KisDabMaskCache()
+{
+}
+
+KisDabMaskCache* KisDabMaskCache::instance()
+{
+    return s_instance;
+}
+
+KisFixedPaintDeviceSP KisDabMaskCache::fetch(const Key &key)
+{
+    QMutexLocker l(&m_d->mutex);
+
+    Private::Entry *entry = m_d->masks.object(key);
+
+    if (entry) {
+        m_d->numHits++;
+        return entry->mask;
+    }
+
+    m_d->numMisses++;
+    return 0;
+}
+
+void KisDabMaskCache::insert(const Key &key, KisFixedPaintDeviceSP mask)
+{
+    const QRect bounds = mask->bounds();
+    const qint64 bytes =
+        qint64(bounds.width()) * bounds.height() * mask->colorSpace()->pixelSize();
+
+    const int cost = qMax(1, int((bytes + costUnit - 1) / costUnit));
+
+    QMutexLocker l(&m_d->mutex);
+
+    /**
+     * If the mask is bigger than the whole cache, QCache just drops it
+     */
+    m_d->masks.insert(key, new Private::Entry(mask), cost);
+}
+
+void KisDabMaskCache::setMemoryLimit(qint64 bytes)
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->memoryLimit = bytes;
+    m_d->masks.setMaxCost(int(bytes / costUnit));
+}
+
+qint64 KisDabMaskCache::memoryLimit() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->memoryLimit;
+}
+
+void KisDabMaskCache::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->masks.clear();
+}
+
+KisDabMaskCache::Statistics KisDabMaskCache::statistics() const
+{
+    QMutexLocker l(&m_d->mutex);
+
+    Statistics stats;
+    stats.numHits = m_d->numHits;
+    stats.numMisses = m_d->numMisses;
+    stats.numMasks = m_d->masks.size();
+    stats.memoryUsage = qint64(m_d->masks.totalCost()) * costUnit;
+
+    return stats;
+}
+
+void KisDabMaskCache::resetStatistics()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->numHits = 0;
+    m_d->numMisses = 0;
+}
@@ -0,0 +1,148 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_DAB_MASK_CACHE_H
+#define __KIS_DAB_MASK_CACHE_H
+
+#include <QByteArray>
+#include <QScopedPointer>
+#include <QString>
+
+#include "kritapaintop_export.h"
+#include "kis_types.h"
+
+
+/**
+ * A bounded LRU cache of the rendered masks of the mask brushes.
+ *
+ * KisDabCache can reuse only the very last dab, so as soon as the
+ * size or the rotation of the brush depends on the pressure, it has
+ * to regenerate almost every dab. This cache keeps a set of masks
+ * rendered for the quantized parameters of the dab (scale, ratio,
+ * rotation, softness and subpixel offset), so the strokes with
+ * varying parameters hit the masks rendered earlier in the same or
+ * in any previous stroke painted with the same brush preset.
+ *
+ * The cache is shared by all the paintops, all the methods are
+ * thread-safe. The stored devices are shared as well, so they must
+ * never be modified: copy the data out of them instead.
+ */
+class PAINTOP_EXPORT KisDabMaskCache
+{
+public:
+    struct PAINTOP_EXPORT Key
+    {
+        Key();
+
+        bool operator==(const Key &rhs) const;
+
+        /**
+         * Identifies the brush with all its settings, so the masks
+         * are shared by all the strokes of the same brush preset
+         */
+        QByteArray brushKey;
+
+        /**
+         * The color space of the dab and the color the mask was
+         * filled with
+         */
+        QString colorSpaceId;
+        QByteArray color;
+
+        quint32 brushIndex;
+
+        /**
+         * Different precision levels quantize the parameters with
+         * different steps, so they never share the masks
+         */
+        qint32 precisionLevel;
+
+        /**
+         * The quantized parameters of the dab, measured in the
+         * quantization steps of the precision level
+         */
+        qint32 scale;
+        qint32 ratio;
+        qint32 rotation;
+        qint32 softness;
+        qint32 subPixelX;
+        qint32 subPixelY;
+    };
+
+    struct Statistics
+    {
+        Statistics()
+            : numHits(0),
+              numMisses(0),
+              numMasks(0),
+              memoryUsage(0)
+        {
+        }
+
+        qreal hitRate() const {
+            const qint64 total = numHits + numMisses;
+            return total ? qreal(numHits) / total : 0.0;
+        }
+
+        qint64 numHits;
+        qint64 numMisses;
+
+        qint32 numMasks;
+
+        /**
+         * The size of the cached masks (in bytes)
+         */
+        qint64 memoryUsage;
+    };
+
+public:
+    KisDabMaskCache(qint64 memoryLimit);
+    ~KisDabMaskCache();
+
+    static KisDabMaskCache* instance();
+
+    /**
+     * Returns the mask stored for \p key, or a null pointer if
+     * there is none. The mask becomes the most recently used one.
+     */
+    KisFixedPaintDeviceSP fetch(const Key &key);
+
+    /**
+     * Stores \p mask for \p key. If the cache grows over the memory
+     * limit, the least recently used masks are dropped. The cache
+     * takes the ownership of the device, so the caller should not
+     * modify it afterwards.
+     */
+    void insert(const Key &key, KisFixedPaintDeviceSP mask);
+
+    void setMemoryLimit(qint64 bytes);
+    qint64 memoryLimit() const;
+
+    void clear();
+
+    Statistics statistics() const;
+    void resetStatistics();
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+PAINTOP_EXPORT uint qHash(const KisDabMaskCache::Key &key, uint seed = 0);
+
+#endif /* __KIS_DAB_MASK_CACHE_H */
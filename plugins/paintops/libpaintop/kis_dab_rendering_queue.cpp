@@ -0,0 +1,227 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_dab_rendering_queue.h"
+
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include <kis_debug.h>
+#include <kis_painter.h>
+#include <kis_fixed_paint_device.h>
+#include <kis_auto_brush.h>
+
+
+namespace {
+
+struct DabJob {
+    KisDabCache::DabRequest request;
+    quint8 opacity;
+    quint8 flow;
+    KisFixedPaintDeviceSP renderedDab;
+};
+
+/**
+ * A contiguous range of the jobs rendered by a single worker with
+ * its own copy of the brush
+ */
+struct RenderingChunk {
+    DabJob *begin;
+    DabJob *end;
+    KisBrushSP brush;
+};
+
+struct RenderChunkOperator {
+    typedef void result_type;
+
+    void operator()(RenderingChunk &chunk) const {
+        for (DabJob *job = chunk.begin; job != chunk.end; ++job) {
+            if (job->request.reusePrevious) continue;
+            job->renderedDab = KisDabCache::renderDab(job->request, chunk.brush);
+        }
+    }
+};
+
+}
+
+struct KisDabRenderingQueue::Private
+{
+    Private(KisDabCache *_dabCache, KisBrushSP _brush)
+        : dabCache(_dabCache),
+          brush(_brush),
+          forcedNumChunks(0)
+    {
+    }
+
+    KisDabCache *dabCache;
+    KisBrushSP brush;
+
+    /**
+     * If non-zero, the jobs are always split into this number of
+     * chunks, see testingForceNumChunks()
+     */
+    int forcedNumChunks;
+
+    QVector<DabJob> jobs;
+
+    /**
+     * The brushes keep the state of the mask generator inside, so
+     * every worker needs a separate copy. The clones are created
+     * lazily and reused for the whole stroke.
+     */
+    QVector<KisBrushSP> brushClones;
+
+    void renderJobs();
+};
+
+KisDabRenderingQueue::KisDabRenderingQueue(KisDabCache *dabCache, KisBrushSP brush)
+    : m_d(new Private(dabCache, brush))
+{
+}
+
+KisDabRenderingQueue::~KisDabRenderingQueue()
+{
+}
+
+void KisDabRenderingQueue::addDab(const KisDabCache::DabRequest &request,
+                                  quint8 opacity, quint8 flow)
+{
+    DabJob job;
+    job.request = request;
+    job.opacity = opacity;
+    job.flow = flow;
+
+    m_d->jobs.append(job);
+}
+
+void KisDabRenderingQueue::testingForceNumChunks(int numChunks)
+{
+    m_d->forcedNumChunks = numChunks;
+}
+
+bool KisDabRenderingQueue::isEmpty() const
+{
+    return m_d->jobs.isEmpty();
+}
+
+void KisDabRenderingQueue::Private::renderJobs()
+{
+    int numDabsToRender = 0;
+    Q_FOREACH (const DabJob &job, jobs) {
+        if (!job.request.reusePrevious) {
+            numDabsToRender++;
+        }
+    }
+
+    if (!numDabsToRender) return;
+
+    const int numChunks =
+        qMin(numDabsToRender,
+             forcedNumChunks > 0 ? forcedNumChunks : QThread::idealThreadCount());
+
+    if (numChunks <= 1) {
+        for (int i = 0; i < jobs.size(); i++) {
+            DabJob &job = jobs[i];
+            if (job.request.reusePrevious) continue;
+            job.renderedDab = KisDabCache::renderDab(job.request, brush);
+        }
+        return;
+    }
+
+    if (brushClones.size() < numChunks) {
+        /**
+         * Share the pyramid between all the clones. The auto brushes
+         * generate their masks directly, so building a pyramid from
+         * their preview image would only waste the tip cache.
+         */
+        if (!dynamic_cast<const KisAutoBrush*>(brush.data())) {
+            brush->prepareBrushPyramid();
+        }
+
+        while (brushClones.size() < numChunks) {
+            brushClones.append(KisBrushSP(brush->clone()));
+        }
+    }
+
+    /**
+     * Split the jobs into the chunks with (roughly) the same number
+     * of dabs to render, the reused ones are almost free
+     */
+    QVector<RenderingChunk> chunks;
+    DabJob *it = jobs.data();
+    DabJob *const end = jobs.data() + jobs.size();
+
+    for (int i = 0; i < numChunks; i++) {
+        const int numDabsInChunk =
+            numDabsToRender / numChunks + (i < numDabsToRender % numChunks);
+
+        RenderingChunk chunk;
+        chunk.begin = it;
+        chunk.brush = brushClones[i];
+
+        int numDabsFound = 0;
+        while (it != end && numDabsFound < numDabsInChunk) {
+            if (!it->request.reusePrevious) {
+                numDabsFound++;
+            }
+            ++it;
+        }
+
+        chunk.end = i < numChunks - 1 ? it : end;
+        chunks.append(chunk);
+    }
+
+    QtConcurrent::blockingMap(chunks, RenderChunkOperator());
+}
+
+void KisDabRenderingQueue::flush(KisPainter *painter)
+{
+    if (m_d->jobs.isEmpty()) return;
+
+    m_d->renderJobs();
+
+    const quint8 origOpacity = painter->opacity();
+
+    for (int i = 0; i < m_d->jobs.size(); i++) {
+        DabJob &job = m_d->jobs[i];
+
+        QRect dabRect;
+        KisFixedPaintDeviceSP dab =
+            m_d->dabCache->finishDab(job.request, job.renderedDab, &dabRect);
+
+        // release the device as soon as possible, it may be not cached
+        job.renderedDab = 0;
+
+        // sanity check for the size calculation code
+        if (dab->bounds().size() != dabRect.size()) {
+            warnKrita << "KisDabRenderingQueue: dab bounds is not dab rect. See bug 327156" << dab->bounds().size() << dabRect.size();
+        }
+
+        painter->setOpacityUpdateAverage(job.opacity);
+        painter->setFlow(job.flow);
+
+        painter->bltFixed(dabRect.topLeft(), dab, dab->bounds());
+        painter->renderMirrorMaskSafe(dabRect,
+                                      dab,
+                                      !m_d->dabCache->needSeparateOriginal());
+        painter->setOpacity(origOpacity);
+    }
+
+    m_d->jobs.clear();
+}
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KIS_DAB_RENDERING_QUEUE_H
+#define __KIS_DAB_RENDERING_QUEUE_H
+
+#include <QScopedPointer>
+
+#include "kritapaintop_export.h"
+#include "kis_dab_cache.h"
+
+class KisPainter;
+
+
+/**
+ * Collects the dabs of a stroke segment and renders them in a batch.
+ *
+ * The paintop fills the queue with the requests prepared by
+ * KisDabCache::prepareDab(). On flush() the masks of all the dabs that
+ * cannot be reused from the cache are generated concurrently, every
+ * worker with its own clone of the brush, and after that the dabs are
+ * postprocessed and composited one by one in the order they were
+ * added, so the result is exactly the same as if they were painted
+ * sequentially.
+ */
+class PAINTOP_EXPORT KisDabRenderingQueue
+{
+public:
+    KisDabRenderingQueue(KisDabCache *dabCache, KisBrushSP brush);
+    ~KisDabRenderingQueue();
+
+    /**
+     * Adds a dab that will be painted with \p opacity and \p flow,
+     * (the values KisFlowOpacityOption would set to the painter)
+     */
+    void addDab(const KisDabCache::DabRequest &request,
+                quint8 opacity, quint8 flow);
+
+    bool isEmpty() const;
+
+    /**
+     * Renders all the queued dabs and composites them with \p painter.
+     * The opacity of the painter is restored afterwards.
+     */
+    void flush(KisPainter *painter);
+
+    /**
+     * Makes the queue split the dabs into \p numChunks chunks
+     * independently of the number of cores, so that the
+     * concurrent path could be tested on any machine. Zero
+     * restores the default behavior.
+     */
+    void testingForceNumChunks(int numChunks);
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif /* __KIS_DAB_RENDERING_QUEUE_H */
@@ -41,6 +41,12 @@ public:
     void setOpacity(qreal opacity);
     void apply(KisPainter* painter, const KisPaintInformation& info);
 
+    /**
+     * Calculates the opacity and the flow apply() would set to the
+     * painter, without touching the painter itself
+     */
+    void apply(const KisPaintInformation& info, quint8 *opacity, quint8 *flow);
+
     qreal getFlow() const;
     qreal getStaticOpacity() const;
     qreal getDynamicOpacity(const KisPaintInformation& info) const;
@@ -0,0 +1,148 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_dab_mask_cache_test.h"
+
+#include <QTest>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+
+#include "kis_dab_mask_cache.h"
+#include "kis_dab_cache.h"
+#include "kis_auto_brush.h"
+#include "kis_circle_mask_generator.h"
+#include "kis_fixed_paint_device.h"
+#include "kis_precision_option.h"
+#include <brushengine/kis_paint_information.h>
+
+
+KisFixedPaintDeviceSP createMask(const QSize &size)
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisFixedPaintDeviceSP dev = new KisFixedPaintDevice(cs);
+    dev->setRect(QRect(QPoint(), size));
+    dev->initialize();
+
+    return dev;
+}
+
+KisDabMaskCache::Key createKey(int scale)
+{
+    KisDabMaskCache::Key key;
+    key.brushKey = "brush";
+    key.colorSpaceId = "RGBA";
+    key.scale = scale;
+    return key;
+}
+
+void KisDabMaskCacheTest::testFetchAndInsert()
+{
+    KisDabMaskCache cache(1024 * 1024);
+
+    KisFixedPaintDeviceSP mask = createMask(QSize(16, 16));
+
+    QVERIFY(!cache.fetch(createKey(1)));
+    cache.insert(createKey(1), mask);
+
+    QCOMPARE(cache.fetch(createKey(1)), mask);
+    QVERIFY(!cache.fetch(createKey(2)));
+
+    KisDabMaskCache::Statistics stats = cache.statistics();
+    QCOMPARE(stats.numHits, qint64(1));
+    QCOMPARE(stats.numMisses, qint64(2));
+    QCOMPARE(stats.numMasks, 1);
+    QCOMPARE(stats.memoryUsage, qint64(16 * 16 * 4));
+    QCOMPARE(stats.hitRate(), 1.0 / 3.0);
+
+    cache.resetStatistics();
+    QCOMPARE(cache.statistics().numHits, qint64(0));
+
+    cache.clear();
+    QVERIFY(!cache.fetch(createKey(1)));
+}
+
+void KisDabMaskCacheTest::testLeastRecentlyUsedEviction()
+{
+    // every mask takes 64 KiB, so only three of them fit
+    KisDabMaskCache cache(3 * 64 * 1024);
+
+    for (int i = 0; i < 3; i++) {
+        cache.insert(createKey(i), createMask(QSize(128, 128)));
+    }
+
+    // touch the oldest mask, so that the second one becomes the LRU
+    QVERIFY(cache.fetch(createKey(0)));
+
+    cache.insert(createKey(3), createMask(QSize(128, 128)));
+
+    QVERIFY(cache.fetch(createKey(0)));
+    QVERIFY(!cache.fetch(createKey(1)));
+    QVERIFY(cache.fetch(createKey(2)));
+    QVERIFY(cache.fetch(createKey(3)));
+
+    QVERIFY(cache.statistics().memoryUsage <= cache.memoryLimit());
+
+    cache.setMemoryLimit(64 * 1024);
+    QCOMPARE(cache.statistics().numMasks, 1);
+}
+
+void KisDabMaskCacheTest::testSharedBetweenStrokes()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisDabMaskCache::instance()->clear();
+    KisDabMaskCache::instance()->resetStatistics();
+
+    KisPrecisionOption precisionOption;
+    precisionOption.setPrecisionLevel(3);
+
+    const KoColor color(Qt::black, cs);
+    const qreal scales[] = {1.0, 0.8, 0.6, 0.8, 1.0};
+
+    for (int stroke = 0; stroke < 2; stroke++) {
+        KisBrushSP brush =
+            new KisAutoBrush(new KisCircleMaskGenerator(40, 1.0, 0.5, 0.5, 2, true), 0.0, 0.0);
+
+        KisDabCache dabCache(brush);
+        dabCache.setPrecisionOption(&precisionOption);
+
+        for (qreal scale : scales) {
+            KisPaintInformation info(QPointF(100.3, 100.7), 1.0);
+            QRect dstRect;
+
+            KisFixedPaintDeviceSP dab =
+                dabCache.fetchDab(cs, color, info.pos(),
+                                  KisDabShape(scale, 1.0, 0.0),
+                                  info, 1.0, &dstRect);
+
+            QVERIFY(dab);
+            QCOMPARE(dstRect.size(), dab->bounds().size());
+        }
+    }
+
+    // the first stroke renders three distinct masks, the second one
+    // finds all of them in the cache
+    KisDabMaskCache::Statistics stats = KisDabMaskCache::instance()->statistics();
+    QCOMPARE(stats.numMisses, qint64(3));
+    QCOMPARE(stats.numHits, qint64(7));
+}
+
+QTEST_MAIN(KisDabMaskCacheTest)
@@ -0,0 +1,163 @@
+/*
+ *  Copyright (c) 2017 The Krita Team
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "kis_dab_rendering_queue_test.h"
+
+#include <QTest>
+
+#include <KoColor.h>
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoCompositeOpRegistry.h>
+
+#include "kis_dab_rendering_queue.h"
+#include "kis_dab_mask_cache.h"
+#include "kis_dab_cache.h"
+#include "kis_color_source.h"
+#include "kis_auto_brush.h"
+#include "kis_circle_mask_generator.h"
+#include "kis_fixed_paint_device.h"
+#include "kis_paint_device.h"
+#include "kis_painter.h"
+#include <brushengine/kis_paint_information.h>
+
+#include "testutil.h"
+
+
+struct TestDab {
+    QPointF pos;
+    KisDabShape shape;
+    quint8 opacity;
+};
+
+/**
+ * The dabs overlap each other and are painted with COPY and
+ * different opacities, so the result depends on the order of the
+ * dabs. The scale changes only every third dab and the subpixel
+ * offset stays the same, so some of the dabs reuse the previous
+ * one.
+ */
+QVector<TestDab> createDabs()
+{
+    QVector<TestDab> dabs;
+
+    for (int i = 0; i < 40; i++) {
+        TestDab dab;
+        dab.pos = QPointF(20 + 7 * i + 0.25, 30 + 5 * i + 0.5);
+        dab.shape = KisDabShape(0.3 + 0.1 * (i / 3), 1.0, 0.0);
+        dab.opacity = quint8(100 + 3 * i);
+        dabs.append(dab);
+    }
+
+    return dabs;
+}
+
+KisBrushSP createBrush()
+{
+    return new KisAutoBrush(new KisCircleMaskGenerator(40, 1.0, 0.5, 0.5, 2, true), 0.0, 0.0);
+}
+
+void KisDabRenderingQueueTest::testMultipleChunksMatchSequential_data()
+{
+    QTest::addColumn<int>("numChunks");
+
+    QTest::newRow("1 chunk") << 1;
+    QTest::newRow("2 chunks") << 2;
+    QTest::newRow("4 chunks") << 4;
+    QTest::newRow("7 chunks") << 7;
+}
+
+void KisDabRenderingQueueTest::testMultipleChunksMatchSequential()
+{
+    QFETCH(int, numChunks);
+
+    KisDabMaskCache::instance()->clear();
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const KoColor color(Qt::red, cs);
+    const QVector<TestDab> dabs = createDabs();
+
+    KisPaintDeviceSP refDev = new KisPaintDevice(cs);
+    KisPaintDeviceSP queueDev = new KisPaintDevice(cs);
+
+    {
+        KisBrushSP brush = createBrush();
+        KisDabCache dabCache(brush);
+        KisPlainColorSource colorSource(color, color);
+
+        KisPainter painter(refDev);
+        painter.setCompositeOp(COMPOSITE_COPY);
+
+        Q_FOREACH (const TestDab &dab, dabs) {
+            KisPaintInformation info(dab.pos);
+            colorSource.selectColor(0.0, info);
+
+            QRect dabRect;
+            KisFixedPaintDeviceSP dev =
+                dabCache.fetchDab(cs, &colorSource, dab.pos, dab.shape, info, 1.0, &dabRect);
+
+            painter.setOpacityUpdateAverage(dab.opacity);
+            painter.bltFixed(dabRect.topLeft(), dev, dev->bounds());
+            painter.renderMirrorMaskSafe(dabRect, dev, !dabCache.needSeparateOriginal());
+        }
+    }
+
+    {
+        KisBrushSP brush = createBrush();
+        KisDabCache dabCache(brush);
+        KisPlainColorSource colorSource(color, color);
+
+        QVERIFY(dabCache.canRenderDabsConcurrently(&colorSource));
+
+        KisDabRenderingQueue queue(&dabCache, brush);
+        queue.testingForceNumChunks(numChunks);
+
+        int numReusedDabs = 0;
+
+        Q_FOREACH (const TestDab &dab, dabs) {
+            KisPaintInformation info(dab.pos);
+            colorSource.selectColor(0.0, info);
+
+            KisDabCache::DabRequest request;
+            dabCache.prepareDab(cs, &colorSource, dab.pos, dab.shape, info, 1.0, &request);
+
+            if (request.reusePrevious) {
+                numReusedDabs++;
+            }
+
+            queue.addDab(request, dab.opacity, OPACITY_OPAQUE_U8);
+        }
+
+        QVERIFY(numReusedDabs > 0);
+        QVERIFY(numReusedDabs < dabs.size());
+
+        KisPainter painter(queueDev);
+        painter.setCompositeOp(COMPOSITE_COPY);
+        queue.flush(&painter);
+
+        QVERIFY(queue.isEmpty());
+    }
+
+    QPoint errorPoint;
+    if (!TestUtil::comparePaintDevices(errorPoint, refDev, queueDev)) {
+        QFAIL(QString("Batched dabs differ from the sequential ones at %1,%2")
+              .arg(errorPoint.x()).arg(errorPoint.y()).toLatin1());
+    }
+}
+
+QTEST_MAIN(KisDabRenderingQueueTest)